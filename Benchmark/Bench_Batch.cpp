@@ -0,0 +1,113 @@
+/*******************************************************************************
+ * Bench_Batch.cpp
+ *
+ * Scaling of ipc_plot_batch() with the number of Python tools. The same jobs
+ * are plotted with 1, 2, 4, ... workers up to the number of cores, Python
+ * start-up included, and compared with calling ipc_plot() once per job 
+ * with its pool disabled, i.e. one Python tool per job.
+ * An optional argument overrides the largest number of workers.
+ * Run from a directory next to Python/, like any program using the library.
+ ******************************************************************************/
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include <thread>
+
+#include "IPC_Plot_Internal.h"
+
+#define BENCH_JOBS    64
+#define BENCH_COLUMNS 2
+#define BENCH_ROWS    20000
+
+static LIB_DOUBLE GetTimeSec(void)
+{
+	struct timespec stNow;
+	timespec_get(&stNow, TIME_UTC);
+	return (LIB_DOUBLE)stNow.tv_sec + (LIB_DOUBLE)stNow.tv_nsec * 1e-9;
+}
+
+static void PrintRow(const LIB_CHAR* pszName, LIB_DOUBLE dElapsed, LIB_DOUBLE dBaseline, LIB_U32 u32Failed)
+{
+	printf("%-10s %10.2f %10.1f %8.2fx %8u\n", pszName, dElapsed, BENCH_JOBS / dElapsed, dBaseline / dElapsed, u32Failed);
+}
+
+int main(int argc, char** argv)
+{
+	LIB_ERROR_INFO stErr = LIB_ERROR_INFO();
+	LIB_U32 u32Cores = (argc > 1) ? (LIB_U32)atoi(argv[1]) : std::thread::hardware_concurrency();
+	if (u32Cores == 0)
+	{
+		u32Cores = 1;
+	}
+
+	// Each job plots its own sine waves so every figure is different
+	const LIB_CHAR* rgszLabels[BENCH_COLUMNS] = { "sin", "cos" };
+	LIB_DOUBLE* prgdData = (LIB_DOUBLE*)malloc((size_t)BENCH_JOBS * BENCH_COLUMNS * BENCH_ROWS * sizeof(LIB_DOUBLE));
+	LIB_INPUT* prgstInputs = new LIB_INPUT[BENCH_JOBS];
+	LIB_ERROR_INFO* prgstResults = new LIB_ERROR_INFO[BENCH_JOBS];
+	for (LIB_U32 u32Job = 0; u32Job < BENCH_JOBS; u32Job++)
+	{
+		LIB_DOUBLE* prgdJob = prgdData + (size_t)u32Job * BENCH_COLUMNS * BENCH_ROWS;
+		for (LIB_U32 u32Row = 0; u32Row < BENCH_ROWS; u32Row++)
+		{
+			LIB_DOUBLE dPhase = u32Row * 0.001 * (u32Job + 1);
+			prgdJob[u32Row] = sin(dPhase);
+			prgdJob[BENCH_ROWS + u32Row] = cos(dPhase);
+		}
+		prgstInputs[u32Job].u32ColSize = BENCH_COLUMNS;
+		prgstInputs[u32Job].u32RowSize = BENCH_ROWS;
+		prgstInputs[u32Job].prgszLabels = rgszLabels;
+		prgstInputs[u32Job].prgdBuffer = prgdJob;
+	}
+
+	printf("%u jobs of %u x %u doubles, %u cores\n", BENCH_JOBS, BENCH_COLUMNS, BENCH_ROWS, u32Cores);
+	printf("%-10s %10s %10s %9s %8s\n", "workers", "s", "plots/s", "speedup", "failed");
+
+	// Baseline: one Python tool per plot, one after the other
+	ipc_plot_pool_config(0, LIB_POOL_DEFAULT_IDLE_MS, &stErr);
+	LIB_U32 u32Failed = 0;
+	LIB_DOUBLE dStart = GetTimeSec();
+	for (LIB_U32 u32Job = 0; u32Job < BENCH_JOBS; u32Job++)
+	{
+		if (ipc_plot(&prgstInputs[u32Job], &stErr) != LIB_OK)
+		{
+			u32Failed++;
+		}
+	}
+	LIB_DOUBLE dBaseline = GetTimeSec() - dStart;
+	PrintRow("ipc_plot", dBaseline, dBaseline, u32Failed);
+
+	for (LIB_U32 u32Workers = 1; ; u32Workers *= 2)
+	{
+		if (u32Workers > u32Cores)
+		{
+			u32Workers = u32Cores;
+		}
+		dStart = GetTimeSec();
+		ipc_plot_batch(prgstInputs, BENCH_JOBS, u32Workers, prgstResults, &stErr);
+		LIB_DOUBLE dElapsed = GetTimeSec() - dStart;
+
+		u32Failed = 0;
+		for (LIB_U32 u32Job = 0; u32Job < BENCH_JOBS; u32Job++)
+		{
+			if (prgstResults[u32Job].u32ErrCode != LIB_STATUS_DONE)
+			{
+				u32Failed++;
+			}
+		}
+		LIB_CHAR szName[32];
+		snprintf(szName, sizeof(szName), "%u", u32Workers);
+		PrintRow(szName, dElapsed, dBaseline, u32Failed);
+		if (u32Workers == u32Cores)
+		{
+			break;
+		}
+	}
+
+	delete[] prgstInputs;
+	delete[] prgstResults;
+	free(prgdData);
+	return 0;
+}
@@ -0,0 +1,140 @@
+/*******************************************************************************
+ * Bench_Cache.cpp
+ *
+ * Cost of the render cache of ipc_plot(). The hash kernels of each
+ * instruction set supported by this CPU are timed on the same buffer and
+ * their digests compared with the scalar kernel, a mismatch is reported in
+ * the last column. Then the same figure is plotted with the cache on: the
+ * first call of each backend misses and renders, the others hit, and the
+ * p50 of both is printed next to the time spent hashing.
+ *
+ * Run from a directory next to Python/, e.g. a build directory in the
+ * repository.
+ ******************************************************************************/
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "IPC_Plot_Cache.h"
+
+#define BENCH_HASH_BYTES  (64ULL << 20)
+#define BENCH_ITERATIONS  10
+#define BENCH_ROWS        100000
+#define BENCH_COLS        4
+#define BENCH_HITS        50
+
+static LIB_DOUBLE GetTimeSec(void)
+{
+	struct timespec stNow;
+	timespec_get(&stNow, TIME_UTC);
+	return (LIB_DOUBLE)stNow.tv_sec + (LIB_DOUBLE)stNow.tv_nsec * 1e-9;
+}
+
+static LIB_DOUBLE Median(std::vector<LIB_DOUBLE>& vecSamples)
+{
+	if (vecSamples.empty())
+	{
+		return 0.0;
+	}
+	std::sort(vecSamples.begin(), vecSamples.end());
+	return vecSamples[(vecSamples.size() - 1) / 2];
+}
+
+int main(void)
+{
+	static const LIB_U32 s_rgu32Isas[] = { LIB_ISA_SCALAR, LIB_ISA_SSE2, LIB_ISA_AVX2 };
+
+	// Hash kernels on random bytes, fixed seed so every run sees the same data
+	LIB_CHAR* pcData = (LIB_CHAR*)malloc(BENCH_HASH_BYTES);
+	srand(1);
+	for (LIB_U64 u64Index = 0; u64Index < BENCH_HASH_BYTES; u64Index++)
+	{
+		pcData[u64Index] = (LIB_CHAR)rand();
+	}
+	LIB_HASH stReference = LIB_HASH();
+	HashBytes(HashGetKernels(LIB_ISA_SCALAR), pcData, BENCH_HASH_BYTES, &stReference);
+
+	printf("%llu MB hashed %d times\n", BENCH_HASH_BYTES >> 20, BENCH_ITERATIONS);
+	printf("%-8s %10s %10s %8s\n", "isa", "ms/call", "GB/s", "check");
+	for (size_t szIsa = 0; szIsa < sizeof(s_rgu32Isas) / sizeof(s_rgu32Isas[0]); szIsa++)
+	{
+		const LIB_HASH_KERNELS* pstKernels = HashGetKernels(s_rgu32Isas[szIsa]);
+		if (pstKernels == NULL)
+		{
+			continue;
+		}
+		LIB_HASH stHash = LIB_HASH();
+		LIB_DOUBLE dStart = GetTimeSec();
+		for (LIB_U32 u32Iteration = 0; u32Iteration < BENCH_ITERATIONS; u32Iteration++)
+		{
+			stHash = LIB_HASH();
+			HashBytes(pstKernels, pcData, BENCH_HASH_BYTES, &stHash);
+		}
+		LIB_DOUBLE dPerCall = (GetTimeSec() - dStart) / BENCH_ITERATIONS;
+		LIB_BOOLEAN bSame = (stHash.u64Low == stReference.u64Low && stHash.u64High == stReference.u64High) ? LIB_TRUE : LIB_FALSE;
+		printf("%-8s %10.2f %10.2f %8s\n", pstKernels->pszName, dPerCall * 1e3, BENCH_HASH_BYTES / dPerCall / 1e9,
+			bSame ? "ok" : "MISMATCH");
+	}
+	free(pcData);
+
+	// Same figure again and again through ipc_plot()
+	std::vector<LIB_DOUBLE> vecBuffer((size_t)BENCH_ROWS * BENCH_COLS);
+	for (LIB_U32 u32Col = 0; u32Col < BENCH_COLS; u32Col++)
+	{
+		for (LIB_U32 u32Row = 0; u32Row < BENCH_ROWS; u32Row++)
+		{
+			vecBuffer[(size_t)u32Col * BENCH_ROWS + u32Row] = sin(u32Row * 0.001 * (u32Col + 1));
+		}
+	}
+	const LIB_CHAR* rgszLabels[BENCH_COLS] = { "Column 1", "Column 2", "Column 3", "Column 4" };
+	static const LIB_U32 s_rgu32Backends[] = { LIB_BACKEND_PYTHON, LIB_BACKEND_NATIVE };
+	static const LIB_CHAR* s_rgszBackends[] = { "python", "native" };
+
+	LIB_ERROR_INFO stErr;
+	ipc_plot_cache_config(16, 0, &stErr);
+	printf("\n%u x %u doubles, min/max decimation, PNG in memory\n", BENCH_COLS, BENCH_ROWS);
+	printf("%-8s %12s %12s %12s %8s\n", "backend", "miss ms", "hit p50 ms", "hash p50 ms", "hits");
+	for (size_t szBackend = 0; szBackend < sizeof(s_rgu32Backends) / sizeof(s_rgu32Backends[0]); szBackend++)
+	{
+		LIB_IMAGE stImage;
+		LIB_PLOT_STATS stStats;
+		LIB_INPUT stInput;
+		stInput.u32ColSize = BENCH_COLS;
+		stInput.u32RowSize = BENCH_ROWS;
+		stInput.prgszLabels = rgszLabels;
+		stInput.prgdBuffer = vecBuffer.data();
+		stInput.u32Decimation = LIB_DECIMATE_MINMAX;
+		stInput.u32Backend = s_rgu32Backends[szBackend];
+		stInput.u32Output = LIB_OUTPUT_PNG;
+		stInput.pstImage = &stImage;
+		stInput.pstStats = &stStats;
+
+		if (ipc_plot(&stInput, &stErr) != LIB_OK)
+		{
+			printf("%-8s failed: %s %s\n", s_rgszBackends[szBackend], stErr.szErrMsg, stErr.szRuntime);
+			continue;
+		}
+		LIB_DOUBLE dMissMs = stStats.dTotalMs;
+		std::vector<LIB_DOUBLE> vecHitMs;
+		std::vector<LIB_DOUBLE> vecHashMs;
+		LIB_U32 u32Hits = 0;
+		for (LIB_U32 u32Plot = 0; u32Plot < BENCH_HITS; u32Plot++)
+		{
+			if (ipc_plot(&stInput, &stErr) == LIB_OK && stStats.bCacheHit)
+			{
+				u32Hits++;
+			}
+			vecHitMs.push_back(stStats.dTotalMs);
+			vecHashMs.push_back(stStats.dCacheMs);
+		}
+		printf("%-8s %12.2f %12.3f %12.3f %5u/%u\n", s_rgszBackends[szBackend], dMissMs, Median(vecHitMs), Median(vecHashMs),
+			u32Hits, BENCH_HITS);
+		ipc_plot_image_free(&stImage);
+	}
+	ipc_plot_cache_config(0, 0, &stErr);
+	return 0;
+}
@@ -0,0 +1,280 @@
+/*******************************************************************************
+ * Bench_Concurrency.cpp
+ *
+ * Stress of ipc_plot() from many threads at once. Every thread plots its own
+ * buffer a number of times with its own LIB_ERROR_INFO, once per admission
+ * policy of ipc_plot_concurrency_config(). Printed per policy: wall time,
+ * plots per second, plots made, refused with LIB_ERR_BUSY and failed
+ * otherwise, and p50/p99 of the time waiting for admission and of the whole
+ * call. At the end the peak number of admitted calls is checked against the
+ * limit. The pool is sized to the limit so admitted calls find a ready tool.
+ *
+ * The stand-in renderer is used by default, so the library and not
+ * Matplotlib is under stress. Run from a directory next to Python/ and
+ * Benchmark/, e.g. a build directory in the repository:
+ *
+ *   bench_concurrency [--threads N] [--plots N] [--limit N] [--queue N]
+ *                     [--renderer python|standin] [--standin PATH]
+ ******************************************************************************/
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+#include "IPC_Plot_Internal.h"
+
+#ifdef _WIN32
+#    define BENCH_STANDIN_PATH ".\\..\\Benchmark\\Bench_StandIn.py"
+#else
+#    define BENCH_STANDIN_PATH "./../Benchmark/Bench_StandIn.py"
+#endif
+
+#define BENCH_COLUMNS 2
+#define BENCH_ROWS    10000
+
+typedef struct BENCH_OPTIONS
+{
+	LIB_U32 u32Threads;
+	LIB_U32 u32Plots;       //!< Plots per thread
+	LIB_U32 u32Limit;       //!< Concurrency limit, 0 for the number of cores
+	LIB_U32 u32Queue;
+	LIB_BOOLEAN bPython;
+	const LIB_CHAR* pszStandIn;
+} BENCH_OPTIONS;
+
+// Results of one thread, merged once all threads are joined
+typedef struct BENCH_THREAD
+{
+	LIB_INPUT stInput;
+	LIB_U32 u32Plots;
+	LIB_U32 u32Done;
+	LIB_U32 u32Busy;
+	LIB_U32 u32Failed;
+	std::vector<LIB_DOUBLE> vecQueueMs;
+	std::vector<LIB_DOUBLE> vecTotalMs;
+} BENCH_THREAD;
+
+static LIB_DOUBLE GetTimeSec(void)
+{
+	struct timespec stNow;
+	timespec_get(&stNow, TIME_UTC);
+	return (LIB_DOUBLE)stNow.tv_sec + (LIB_DOUBLE)stNow.tv_nsec * 1e-9;
+}
+
+static void SetRenderer(const LIB_CHAR* pszPath)
+{
+#ifdef _WIN32
+	_putenv_s(LIB_RENDERER_ENV, (pszPath != NULL) ? pszPath : "");
+#else
+	if (pszPath != NULL)
+	{
+		setenv(LIB_RENDERER_ENV, pszPath, 1);
+	}
+	else
+	{
+		unsetenv(LIB_RENDERER_ENV);
+	}
+#endif
+}
+
+/***************************************************************************//**
+ * Percentile
+ *
+ * Nearest-rank percentile of the samples
+ *
+ * @param vecSamples Samples in milliseconds, sorted in place
+ * @param dRank      Percentile from 0 to 100
+ * @return           Percentile in milliseconds, 0 without samples
+ ******************************************************************************/
+static LIB_DOUBLE Percentile(std::vector<LIB_DOUBLE>& vecSamples, LIB_DOUBLE dRank)
+{
+	if (vecSamples.empty())
+	{
+		return 0.0;
+	}
+	std::sort(vecSamples.begin(), vecSamples.end());
+	size_t szIndex = (size_t)(dRank / 100.0 * vecSamples.size() + 0.999999);
+	szIndex = (szIndex == 0) ? 0 : szIndex - 1;
+	return vecSamples[std::min(szIndex, vecSamples.size() - 1)];
+}
+
+static void PlotThread(BENCH_THREAD* pstThread)
+{
+	LIB_PLOT_STATS stStats;
+	LIB_INPUT stInput = pstThread->stInput;
+	stInput.pstStats = &stStats;
+	for (LIB_U32 u32Plot = 0; u32Plot < pstThread->u32Plots; u32Plot++)
+	{
+		LIB_ERROR_INFO stErr;
+		if (ipc_plot(&stInput, &stErr) == LIB_OK)
+		{
+			pstThread->u32Done++;
+			pstThread->vecQueueMs.push_back(stStats.dQueueMs);
+			pstThread->vecTotalMs.push_back(stStats.dTotalMs);
+		}
+		else if (stErr.u32ErrCode == LIB_ERR_BUSY)
+		{
+			pstThread->u32Busy++;
+		}
+		else
+		{
+			printf("ipc_plot() failed: %s %s\n", stErr.szErrMsg, stErr.szRuntime);
+			pstThread->u32Failed++;
+		}
+	}
+}
+
+/***************************************************************************//**
+ * RunPolicy
+ *
+ * Starts all threads at once with one admission policy and prints a row
+ *
+ * @param pszName    Name of the policy
+ * @param u32Policy  LIB_ADMIT_* policy
+ * @param pstOptions Command line options
+ * @param vecThreads Threads with their input set, results are reset here
+ ******************************************************************************/
+static void RunPolicy(const LIB_CHAR* pszName, LIB_U32 u32Policy, const BENCH_OPTIONS* pstOptions,
+	std::vector<BENCH_THREAD>& vecThreads)
+{
+	LIB_ERROR_INFO stErr;
+	if (ipc_plot_concurrency_config(pstOptions->u32Limit, pstOptions->u32Queue, u32Policy, &stErr) != LIB_OK)
+	{
+		printf("ipc_plot_concurrency_config() failed: %s %s\n", stErr.szErrMsg, stErr.szRuntime);
+		return;
+	}
+
+	std::vector<std::thread> vecRunning;
+	LIB_DOUBLE dStart = GetTimeSec();
+	for (size_t szThread = 0; szThread < vecThreads.size(); szThread++)
+	{
+		BENCH_THREAD* pstThread = &vecThreads[szThread];
+		pstThread->u32Done = pstThread->u32Busy = pstThread->u32Failed = 0;
+		pstThread->vecQueueMs.clear();
+		pstThread->vecTotalMs.clear();
+		vecRunning.push_back(std::thread(PlotThread, pstThread));
+	}
+	for (size_t szThread = 0; szThread < vecRunning.size(); szThread++)
+	{
+		vecRunning[szThread].join();
+	}
+	LIB_DOUBLE dElapsed = GetTimeSec() - dStart;
+
+	LIB_U32 u32Done = 0, u32Busy = 0, u32Failed = 0;
+	std::vector<LIB_DOUBLE> vecQueueMs, vecTotalMs;
+	for (size_t szThread = 0; szThread < vecThreads.size(); szThread++)
+	{
+		const BENCH_THREAD* pstThread = &vecThreads[szThread];
+		u32Done += pstThread->u32Done;
+		u32Busy += pstThread->u32Busy;
+		u32Failed += pstThread->u32Failed;
+		vecQueueMs.insert(vecQueueMs.end(), pstThread->vecQueueMs.begin(), pstThread->vecQueueMs.end());
+		vecTotalMs.insert(vecTotalMs.end(), pstThread->vecTotalMs.begin(), pstThread->vecTotalMs.end());
+	}
+	printf("%-12s %8.2f %9.1f %7u %7u %7u %9.1f/%9.1f %9.1f/%9.1f\n", pszName, dElapsed, u32Done / dElapsed,
+		u32Done, u32Busy, u32Failed, Percentile(vecQueueMs, 50), Percentile(vecQueueMs, 99),
+		Percentile(vecTotalMs, 50), Percentile(vecTotalMs, 99));
+}
+
+static LIB_BOOLEAN ParseOptions(int argc, char** argv, BENCH_OPTIONS* pstOptions)
+{
+	for (int nArg = 1; nArg < argc; nArg++)
+	{
+		const LIB_CHAR* pszValue = (nArg + 1 < argc) ? argv[nArg + 1] : NULL;
+		if (pszValue == NULL)
+		{
+			return LIB_FALSE;
+		}
+		if (strcmp(argv[nArg], "--threads") == 0)
+		{
+			pstOptions->u32Threads = (LIB_U32)strtoul(pszValue, NULL, 10);
+		}
+		else if (strcmp(argv[nArg], "--plots") == 0)
+		{
+			pstOptions->u32Plots = (LIB_U32)strtoul(pszValue, NULL, 10);
+		}
+		else if (strcmp(argv[nArg], "--limit") == 0)
+		{
+			pstOptions->u32Limit = (LIB_U32)strtoul(pszValue, NULL, 10);
+		}
+		else if (strcmp(argv[nArg], "--queue") == 0)
+		{
+			pstOptions->u32Queue = (LIB_U32)strtoul(pszValue, NULL, 10);
+		}
+		else if (strcmp(argv[nArg], "--renderer") == 0)
+		{
+			pstOptions->bPython = (LIB_BOOLEAN)(strcmp(pszValue, "python") == 0);
+		}
+		else if (strcmp(argv[nArg], "--standin") == 0)
+		{
+			pstOptions->pszStandIn = pszValue;
+		}
+		else
+		{
+			return LIB_FALSE;
+		}
+		nArg++;
+	}
+	return (LIB_BOOLEAN)(pstOptions->u32Threads > 0 && pstOptions->u32Plots > 0);
+}
+
+int main(int argc, char** argv)
+{
+	BENCH_OPTIONS stOptions = { 64, 4, 0, 16, LIB_FALSE, BENCH_STANDIN_PATH };
+	if (!ParseOptions(argc, argv, &stOptions))
+	{
+		printf("Usage: %s [--threads N] [--plots N] [--limit N] [--queue N] [--renderer python|standin] [--standin PATH]\n", argv[0]);
+		return 1;
+	}
+	SetRenderer(stOptions.bPython ? NULL : stOptions.pszStandIn);
+
+	LIB_U32 u32Limit = stOptions.u32Limit;
+	if (u32Limit == 0)
+	{
+		u32Limit = std::max(std::thread::hardware_concurrency(), 1u);
+	}
+	LIB_ERROR_INFO stErr;
+	ipc_plot_pool_config(std::min(u32Limit, (LIB_U32)LIB_POOL_MAX_SIZE), LIB_POOL_DEFAULT_IDLE_MS, &stErr);
+
+	// Each thread plots its own sine waves
+	const LIB_CHAR* rgszLabels[BENCH_COLUMNS] = { "sin", "cos" };
+	std::vector<LIB_DOUBLE> vecData((size_t)stOptions.u32Threads * BENCH_COLUMNS * BENCH_ROWS);
+	std::vector<BENCH_THREAD> vecThreads(stOptions.u32Threads);
+	for (LIB_U32 u32Thread = 0; u32Thread < stOptions.u32Threads; u32Thread++)
+	{
+		LIB_DOUBLE* prgdThread = &vecData[(size_t)u32Thread * BENCH_COLUMNS * BENCH_ROWS];
+		for (LIB_U32 u32Row = 0; u32Row < BENCH_ROWS; u32Row++)
+		{
+			LIB_DOUBLE dPhase = u32Row * 0.001 * (u32Thread + 1);
+			prgdThread[u32Row] = sin(dPhase);
+			prgdThread[BENCH_ROWS + u32Row] = cos(dPhase);
+		}
+		BENCH_THREAD* pstThread = &vecThreads[u32Thread];
+		pstThread->stInput.u32ColSize = BENCH_COLUMNS;
+		pstThread->stInput.u32RowSize = BENCH_ROWS;
+		pstThread->stInput.prgszLabels = rgszLabels;
+		pstThread->stInput.prgdBuffer = prgdThread;
+		pstThread->u32Plots = stOptions.u32Plots;
+	}
+
+	printf("%u threads x %u plots, %s, limit %u, queue %u, times in ms\n", stOptions.u32Threads, stOptions.u32Plots,
+		stOptions.bPython ? "python" : "standin", u32Limit, stOptions.u32Queue);
+	printf("%-12s %8s %9s %7s %7s %7s %19s %19s\n", "policy", "s", "plots/s", "done", "busy", "failed", "queue p50/p99", "total p50/p99");
+	RunPolicy("block", LIB_ADMIT_BLOCK, &stOptions, vecThreads);
+	RunPolicy("fail_fast", LIB_ADMIT_FAIL_FAST, &stOptions, vecThreads);
+	RunPolicy("drop_oldest", LIB_ADMIT_DROP_OLDEST, &stOptions, vecThreads);
+
+	LIB_PLOT_COUNTERS stCounters;
+	ipc_plot_get_counters(&stCounters);
+	printf("Peak of %llu plots at once for a limit of %u: %s\n", (unsigned long long)stCounters.u64PeakActive, u32Limit,
+		(stCounters.u64PeakActive <= u32Limit) ? "ok" : "LIMIT EXCEEDED");
+
+	// The ready tools are stopped before exiting
+	ipc_plot_pool_config(0, LIB_POOL_DEFAULT_IDLE_MS, &stErr);
+	return (stCounters.u64PeakActive <= u32Limit) ? 0 : 1;
+}
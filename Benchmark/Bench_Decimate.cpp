@@ -0,0 +1,126 @@
+/*******************************************************************************
+ * Bench_Decimate.cpp
+ *
+ * Micro-benchmark of the decimation kernels used by ipc_plot() when
+ * LIB_INPUT.u32Decimation is set. Each instruction set supported by this CPU
+ * is timed on the same random walk, per kernel over the whole column and for
+ * the complete min/max and LTTB reductions to LIB_DEFAULT_MAX_POINTS.
+ *
+ * The points picked by each instruction set are compared with the scalar
+ * kernels, a mismatch is reported in the last column. A run of NaN samples
+ * fills more than a whole bucket of either reduction, so the first-index
+ * rule for a bucket without any number is checked as well.
+ ******************************************************************************/
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "IPC_Plot_Decimate.h"
+
+#define BENCH_SAMPLES    10000000
+#define BENCH_ITERATIONS 10
+#define BENCH_NAN_START  3000001 //!< Odd, so the run does not start on a vector boundary
+#define BENCH_NAN_COUNT  12001   //!< More than two buckets of min/max and of LTTB
+
+static LIB_DOUBLE GetTimeSec(void)
+{
+	struct timespec stNow;
+	timespec_get(&stNow, TIME_UTC);
+	return (LIB_DOUBLE)stNow.tv_sec + (LIB_DOUBLE)stNow.tv_nsec * 1e-9;
+}
+
+static void PrintRow(const LIB_CHAR* pszIsa, const LIB_CHAR* pszKernel, LIB_DOUBLE dElapsed, const LIB_CHAR* pszCheck)
+{
+	LIB_DOUBLE dPerCall = dElapsed / BENCH_ITERATIONS;
+	printf("%-8s %-12s %10.2f %12.1f %8s\n", pszIsa, pszKernel, dPerCall * 1e3, BENCH_SAMPLES / dPerCall / 1e6, pszCheck);
+}
+
+int main(void)
+{
+	static const LIB_U32 s_rgu32Isas[] = { LIB_ISA_SCALAR, LIB_ISA_SSE2, LIB_ISA_AVX2 };
+	const LIB_U32 u32Points = LIB_DEFAULT_MAX_POINTS;
+
+	// Random walk with occasional spikes, fixed seed so every run sees the same data
+	LIB_DOUBLE* prgdData = (LIB_DOUBLE*)malloc(BENCH_SAMPLES * sizeof(LIB_DOUBLE));
+	srand(1);
+	LIB_DOUBLE dValue = 0.0;
+	for (LIB_U32 u32Index = 0; u32Index < BENCH_SAMPLES; u32Index++)
+	{
+		dValue += (LIB_DOUBLE)rand() / RAND_MAX - 0.5;
+		prgdData[u32Index] = (rand() % 100000 == 0) ? dValue + 100.0 : dValue;
+	}
+	for (LIB_U32 u32Index = BENCH_NAN_START; u32Index < BENCH_NAN_START + BENCH_NAN_COUNT; u32Index++)
+	{
+		prgdData[u32Index] = NAN;
+	}
+
+	LIB_DOUBLE* prgdRefX = (LIB_DOUBLE*)malloc(2 * u32Points * sizeof(LIB_DOUBLE));
+	LIB_DOUBLE* prgdRefY = (LIB_DOUBLE*)malloc(2 * u32Points * sizeof(LIB_DOUBLE));
+	LIB_DOUBLE* prgdOutX = (LIB_DOUBLE*)malloc(2 * u32Points * sizeof(LIB_DOUBLE));
+	LIB_DOUBLE* prgdOutY = (LIB_DOUBLE*)malloc(2 * u32Points * sizeof(LIB_DOUBLE));
+	LIB_DOUBLE* prgdRefLttbX = prgdRefX + u32Points;
+	LIB_DOUBLE* prgdRefLttbY = prgdRefY + u32Points;
+	const LIB_DECIMATE_KERNELS* pstScalar = DecimateGetKernels(LIB_ISA_SCALAR);
+	DecimateMinMax(pstScalar, prgdData, BENCH_SAMPLES, u32Points, prgdRefX, prgdRefY);
+	DecimateLttb(pstScalar, prgdData, BENCH_SAMPLES, u32Points, prgdRefLttbX, prgdRefLttbY);
+
+	printf("%u samples, %u points after decimation\n", BENCH_SAMPLES, u32Points);
+	printf("%-8s %-12s %10s %12s %8s\n", "isa", "kernel", "ms/call", "Msamples/s", "check");
+	volatile LIB_DOUBLE dSink = 0.0;
+	for (LIB_U32 u32Isa = 0; u32Isa < sizeof(s_rgu32Isas) / sizeof(s_rgu32Isas[0]); u32Isa++)
+	{
+		const LIB_DECIMATE_KERNELS* pstKernels = DecimateGetKernels(s_rgu32Isas[u32Isa]);
+		if (pstKernels == NULL)
+		{
+			continue;
+		}
+
+		LIB_U64 u64Min = 0, u64Max = 0;
+		LIB_DOUBLE dStart = GetTimeSec();
+		for (LIB_U32 u32Iter = 0; u32Iter < BENCH_ITERATIONS; u32Iter++)
+		{
+			pstKernels->pfnMinMax(prgdData, BENCH_SAMPLES, &u64Min, &u64Max);
+		}
+		PrintRow(pstKernels->pszName, "minmax", GetTimeSec() - dStart, "");
+
+		dStart = GetTimeSec();
+		for (LIB_U32 u32Iter = 0; u32Iter < BENCH_ITERATIONS; u32Iter++)
+		{
+			dSink = dSink + pstKernels->pfnSum(prgdData, BENCH_SAMPLES);
+		}
+		PrintRow(pstKernels->pszName, "sum", GetTimeSec() - dStart, "");
+
+		dStart = GetTimeSec();
+		for (LIB_U32 u32Iter = 0; u32Iter < BENCH_ITERATIONS; u32Iter++)
+		{
+			dSink = dSink + (LIB_DOUBLE)pstKernels->pfnMaxArea(prgdData, BENCH_SAMPLES, 1.5, 0.25, -3.0);
+		}
+		PrintRow(pstKernels->pszName, "maxarea", GetTimeSec() - dStart, "");
+
+		dStart = GetTimeSec();
+		for (LIB_U32 u32Iter = 0; u32Iter < BENCH_ITERATIONS; u32Iter++)
+		{
+			DecimateMinMax(pstKernels, prgdData, BENCH_SAMPLES, u32Points, prgdOutX, prgdOutY);
+		}
+		LIB_DOUBLE dElapsed = GetTimeSec() - dStart;
+		LIB_BOOLEAN bMatch = (LIB_BOOLEAN)(memcmp(prgdOutX, prgdRefX, u32Points * sizeof(LIB_DOUBLE)) == 0);
+		PrintRow(pstKernels->pszName, "dec-minmax", dElapsed, bMatch ? "ok" : "MISMATCH");
+
+		dStart = GetTimeSec();
+		for (LIB_U32 u32Iter = 0; u32Iter < BENCH_ITERATIONS; u32Iter++)
+		{
+			DecimateLttb(pstKernels, prgdData, BENCH_SAMPLES, u32Points, prgdOutX, prgdOutY);
+		}
+		dElapsed = GetTimeSec() - dStart;
+		bMatch = (LIB_BOOLEAN)(memcmp(prgdOutX, prgdRefLttbX, u32Points * sizeof(LIB_DOUBLE)) == 0);
+		PrintRow(pstKernels->pszName, "dec-lttb", dElapsed, bMatch ? "ok" : "MISMATCH");
+	}
+
+	free(prgdData);
+	free(prgdRefX);
+	free(prgdRefY);
+	free(prgdOutX);
+	free(prgdOutY);
+	return 0;
+}
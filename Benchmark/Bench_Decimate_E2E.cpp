@@ -0,0 +1,76 @@
+/*******************************************************************************
+ * Bench_Decimate_E2E.cpp
+ *
+ * End-to-end time of ipc_plot_session_plot() for one 10M-sample column with
+ * each decimation method: transfer, Matplotlib render and savefig included.
+ * Run from a directory next to Python/, like any program using the library.
+ * Python start-up and the first figure of the session are not counted.
+ ******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "IPC_Plot.h"
+
+#define BENCH_SAMPLES 10000000
+
+static LIB_DOUBLE GetTimeSec(void)
+{
+	struct timespec stNow;
+	timespec_get(&stNow, TIME_UTC);
+	return (LIB_DOUBLE)stNow.tv_sec + (LIB_DOUBLE)stNow.tv_nsec * 1e-9;
+}
+
+int main(void)
+{
+	static const LIB_U32 s_rgu32Methods[] = { LIB_DECIMATE_LTTB, LIB_DECIMATE_MINMAX, LIB_DECIMATE_NONE };
+	static const LIB_CHAR* s_rgszMethods[] = { "none", "minmax", "lttb" };
+	LIB_ERROR_INFO stErr;
+
+	LIB_DOUBLE* prgdData = (LIB_DOUBLE*)malloc(BENCH_SAMPLES * sizeof(LIB_DOUBLE));
+	srand(1);
+	LIB_DOUBLE dValue = 0.0;
+	for (LIB_U32 u32Index = 0; u32Index < BENCH_SAMPLES; u32Index++)
+	{
+		dValue += (LIB_DOUBLE)rand() / RAND_MAX - 0.5;
+		prgdData[u32Index] = dValue;
+	}
+	const LIB_CHAR* rgszLabels[] = { "random walk" };
+	LIB_INPUT stInput;
+	stInput.u32ColSize = 1;
+	stInput.u32RowSize = BENCH_SAMPLES;
+	stInput.prgszLabels = rgszLabels;
+	stInput.prgdBuffer = prgdData;
+
+	// The session is opened first so Python start-up is not part of the numbers
+	LIB_SESSION* pstSession = NULL;
+	if (ipc_plot_session_open(&pstSession, &stErr) != LIB_OK)
+	{
+		printf("ipc_plot_session_open() failed: %s %s\n", stErr.szErrMsg, stErr.szRuntime);
+		return 1;
+	}
+
+	// The first figure of a session also pays for loading the Matplotlib backend
+	stInput.u32Decimation = LIB_DECIMATE_MINMAX;
+	ipc_plot_session_plot(pstSession, &stInput, &stErr);
+
+	printf("%u samples, %u points after decimation\n", BENCH_SAMPLES, LIB_DEFAULT_MAX_POINTS);
+	printf("%-8s %10s\n", "method", "s/plot");
+	for (LIB_U32 u32Method = 0; u32Method < sizeof(s_rgu32Methods) / sizeof(s_rgu32Methods[0]); u32Method++)
+	{
+		stInput.u32Decimation = s_rgu32Methods[u32Method];
+		LIB_DOUBLE dStart = GetTimeSec();
+		LIB_U32 u32Ret = ipc_plot_session_plot(pstSession, &stInput, &stErr);
+		LIB_DOUBLE dElapsed = GetTimeSec() - dStart;
+		if (u32Ret != LIB_OK)
+		{
+			printf("%-8s failed: %s %s\n", s_rgszMethods[stInput.u32Decimation], stErr.szErrMsg, stErr.szRuntime);
+			continue;
+		}
+		printf("%-8s %10.3f\n", s_rgszMethods[stInput.u32Decimation], dElapsed);
+	}
+
+	ipc_plot_session_close(pstSession);
+	free(prgdData);
+	return 0;
+}
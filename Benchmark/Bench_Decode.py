@@ -0,0 +1,110 @@
+"""
+Bench_Decode.py
+
+Summary
+-------
+Decode time per MB of the receive path of the Python tool: IPC_Plot_Protocol.readPlot() on
+an in-memory copy of the frames the C/C++ library sends, followed by IPC_Plot._processData().
+The transport is left out so only the Python work is measured, which must not grow faster
+than the data.
+
+Each size is decoded as one column of doubles, as 8 columns of doubles and as 8 columns of
+scaled 16-bit integers (LIB_COLUMN). The best of a few runs is reported.
+
+Usage: python3 Benchmark/Bench_Decode.py [largest size in MB, default 64]
+
+"""
+
+# Standard libraries
+import os
+import struct
+import sys
+import time
+
+# Third-party library imports
+import numpy as np
+
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "Python"))
+import IPC_Plot
+import IPC_Plot_Protocol as proto
+
+BENCH_REPEATS = 5
+BENCH_CHUNK_SIZE = 1 << 20
+
+def _packRequest(nColSize, nRowSize, abPayload, lstColumns=None):
+    """
+    Build the frames of a plot request as the C/C++ library streams them.
+
+    """
+    nFlags = 0 if lstColumns is None else proto.LIB_PLOT_FLAG_COLUMNS
+    stPlot = proto.LIB_PLOT_HDR(nColSize, nRowSize, proto.LIB_DTYPE_FLOAT64, nFlags, len(abPayload), 0,
+                                proto.LIB_OUTPUT_FILE, proto.LIB_DEFAULT_DPI)
+    abLabels = b"".join(struct.pack("<H", 1) + b"c" for _ in range(nColSize))
+    lstFrames = [proto.packFrame(proto.LIB_MSG_PLOT, bytes(stPlot)),
+                 proto.packFrame(proto.LIB_MSG_LABELS, abLabels)]
+    if lstColumns is not None:
+        lstFrames.append(proto.packFrame(proto.LIB_MSG_COLUMNS, b"".join(bytes(st) for st in lstColumns)))
+    mvPayload = memoryview(abPayload)
+    for nOffset in range(0, len(abPayload), BENCH_CHUNK_SIZE):
+        lstFrames.append(proto.packFrame(proto.LIB_MSG_DATA, mvPayload[nOffset : nOffset + BENCH_CHUNK_SIZE]))
+    return b"".join(lstFrames)
+
+def _decode(abStream):
+    """
+    Run the receive path on a complete request and return the time taken.
+
+    """
+    mvStream = memoryview(abStream)
+    lstOffset = [0]
+
+    def fnRecvInto(mvBuffer):
+        nSize = len(mvBuffer)
+        mvBuffer[:] = mvStream[lstOffset[0] : lstOffset[0] + nSize]
+        lstOffset[0] += nSize
+
+    def fnRecv(nSize):
+        abBuffer = bytearray(nSize)
+        fnRecvInto(memoryview(abBuffer))
+        return abBuffer
+
+    dStart = time.perf_counter()
+    stFrame = proto.unpackFrame(fnRecv(proto.SIZEOF_FRAME_HDR))
+    nColSize, nRowSize, aData, _, _ = proto.readPlot(fnRecv, fnRecvInto, lambda abData: None, stFrame, None)
+    aaData = IPC_Plot._processData(nColSize, nRowSize, aData)
+    dElapsed = time.perf_counter() - dStart
+    assert aaData.shape == (nRowSize, nColSize)
+    return dElapsed
+
+def _requests(nBytes):
+    """
+    Yield the name, stream and decoded size in MB of each request of about nBytes of doubles.
+
+    """
+    nValues = nBytes // 8
+    aValues = np.arange(nValues, dtype=np.double)
+    yield "1 x f64", _packRequest(1, nValues, aValues.tobytes()), nBytes / 1e6
+    yield "8 x f64", _packRequest(8, nValues // 8, aValues[: nValues // 8 * 8].tobytes()), nBytes / 1e6
+
+    # Same number of samples as 16-bit ADC counts, a quarter of the bytes on the wire
+    nRowSize = nValues // 8
+    lstColumns = [proto.LIB_COLUMN_HDR(proto.LIB_DTYPE_INT16, 2, 0.001, 0.0, i * nRowSize * 2) for i in range(8)]
+    abPayload = (aValues[: nRowSize * 8] % 4096).astype(np.int16).tobytes()
+    yield "8 x i16", _packRequest(8, nRowSize, abPayload, lstColumns), nBytes / 1e6
+
+def main():
+    """
+    Decode each request size and print the time per MB of doubles produced.
+
+    """
+    nMaxMB = int(sys.argv[1]) if len(sys.argv) > 1 else 64
+    print("%-8s %8s %10s %10s %10s" % ("format", "MB", "ms", "ms/MB", "MB/s"))
+    nMB = 1
+    while nMB <= nMaxMB:
+        for szName, abStream, dMB in _requests(nMB << 20):
+            dBest = min(_decode(abStream) for _ in range(BENCH_REPEATS))
+            print("%-8s %8d %10.2f %10.3f %10.0f" % (szName, nMB, dBest * 1e3, dBest * 1e3 / dMB, dMB / dBest))
+        nMB *= 4
+
+if __name__ == '__main__':
+    """ Entry point """
+    main()
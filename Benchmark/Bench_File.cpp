@@ -0,0 +1,249 @@
+/*******************************************************************************
+ * Bench_File.cpp
+ *
+ * Plotting a capture file larger than the caller wants to hold in memory:
+ * a 64-byte header followed by records of a timestamp and 8 float channels,
+ * 4 channels plotted against the timestamps with min/max decimation on the
+ * native backend.
+ *
+ *   load    the caller reads the whole file into a buffer and plots it as
+ *           strided columns of that buffer
+ *   mapped  the caller passes the path and the layout in LIB_INPUT.pstFile,
+ *           the library maps the file and decimates it window by window
+ *
+ * Each case runs in a child process so that its peak is its own. The peak
+ * of the anonymous memory (RssAnon, sampled every millisecond) is what the
+ * process cannot give back; the peak resident size (VmHWM) also counts the
+ * pages of the mapped file, which the kernel drops again under pressure.
+ *
+ * POSIX only. The files are written to the working directory, which needs
+ * room for the largest (--max-gb, default 2), and removed afterwards.
+ ******************************************************************************/
+#include <pthread.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <vector>
+
+#include "IPC_Plot_Internal.h"
+
+#define BENCH_PATH      "bench_file.bin"
+#define BENCH_HDR_SIZE  64
+#define BENCH_CHANNELS  8 //!< Channels in each record
+#define BENCH_PLOTTED   4 //!< Channels plotted, the first ones
+#define BENCH_MIN_MB    256
+
+// One acquisition, 40 bytes
+typedef struct BENCH_RECORD
+{
+	LIB_DOUBLE dTime;
+	LIB_FLOAT rgfChannels[BENCH_CHANNELS];
+} BENCH_RECORD;
+
+static std::atomic<LIB_BOOLEAN> s_bSampling(LIB_FALSE);
+static std::atomic<LIB_U64> s_u64PeakAnonKb(0);
+
+static LIB_DOUBLE GetTimeSec(void)
+{
+	struct timespec stNow;
+	timespec_get(&stNow, TIME_UTC);
+	return (LIB_DOUBLE)stNow.tv_sec + (LIB_DOUBLE)stNow.tv_nsec * 1e-9;
+}
+
+static LIB_U64 GetStatusKb(const LIB_CHAR* pszField)
+{
+	LIB_CHAR szLine[256];
+	LIB_U64 u64Kb = 0;
+	size_t szFieldLen = strlen(pszField);
+	FILE* pFile = fopen("/proc/self/status", "r");
+	if (pFile == NULL)
+	{
+		return 0;
+	}
+	while (fgets(szLine, sizeof(szLine), pFile) != NULL)
+	{
+		if (strncmp(szLine, pszField, szFieldLen) == 0)
+		{
+			u64Kb = strtoull(szLine + szFieldLen, NULL, 10);
+			break;
+		}
+	}
+	fclose(pFile);
+	return u64Kb;
+}
+
+static void* SampleAnon(void* pvArg)
+{
+	(void)pvArg;
+	while (s_bSampling.load())
+	{
+		LIB_U64 u64Kb = GetStatusKb("RssAnon:");
+		if (u64Kb > s_u64PeakAnonKb.load())
+		{
+			s_u64PeakAnonKb.store(u64Kb);
+		}
+		usleep(1000);
+	}
+	return NULL;
+}
+
+static LIB_BOOLEAN WriteFile(LIB_U64 u64Rows)
+{
+	FILE* pFile = fopen(BENCH_PATH, "wb");
+	if (pFile == NULL)
+	{
+		return LIB_FALSE;
+	}
+	LIB_CHAR rgcHdr[BENCH_HDR_SIZE] = "BENCH";
+	LIB_BOOLEAN bOk = (LIB_BOOLEAN)(fwrite(rgcHdr, 1, sizeof(rgcHdr), pFile) == sizeof(rgcHdr));
+	std::vector<BENCH_RECORD> vecChunk(65536);
+	for (LIB_U64 u64Row = 0; u64Row < u64Rows && bOk; u64Row += vecChunk.size())
+	{
+		size_t szCount = (size_t)((u64Rows - u64Row < vecChunk.size()) ? u64Rows - u64Row : vecChunk.size());
+		for (size_t szRecord = 0; szRecord < szCount; szRecord++)
+		{
+			LIB_U64 u64Sample = u64Row + szRecord;
+			vecChunk[szRecord].dTime = u64Sample * 1e-3;
+			for (LIB_U32 u32Channel = 0; u32Channel < BENCH_CHANNELS; u32Channel++)
+			{
+				vecChunk[szRecord].rgfChannels[u32Channel] = (LIB_FLOAT)((u64Sample * (u32Channel + 1)) % 1000) * 1e-3f;
+			}
+		}
+		bOk = (LIB_BOOLEAN)(fwrite(vecChunk.data(), sizeof(BENCH_RECORD), szCount, pFile) == szCount);
+	}
+	return (LIB_BOOLEAN)((fclose(pFile) == 0) && bOk);
+}
+
+// Runs in the child, prints one line
+static int RunCase(LIB_BOOLEAN bMapped, LIB_U64 u64Rows)
+{
+	const LIB_CHAR* rgszLabels[BENCH_PLOTTED] = { "Channel 1", "Channel 2", "Channel 3", "Channel 4" };
+	pthread_t hSampler;
+	s_bSampling.store(LIB_TRUE);
+	pthread_create(&hSampler, NULL, SampleAnon, NULL);
+
+	LIB_DOUBLE dStart = GetTimeSec();
+	LIB_IMAGE stImage;
+	LIB_INPUT stInput;
+	stInput.u32ColSize = BENCH_PLOTTED;
+	stInput.u32RowSize = (LIB_U32)u64Rows;
+	stInput.prgszLabels = rgszLabels;
+	stInput.u32Decimation = LIB_DECIMATE_MINMAX;
+	stInput.u32Backend = LIB_BACKEND_NATIVE;
+	stInput.u32Output = LIB_OUTPUT_PNG;
+	stInput.pstImage = &stImage;
+
+	LIB_FILE_COLUMN rgstFileColumns[BENCH_PLOTTED];
+	LIB_FILE_COLUMN stFileTime;
+	LIB_FILE_INPUT stFile;
+	LIB_COLUMN rgstColumns[BENCH_PLOTTED];
+	LIB_COLUMN stTime;
+	LIB_CHAR* pcLoaded = NULL;
+	if (bMapped)
+	{
+		for (LIB_U32 u32Col = 0; u32Col < BENCH_PLOTTED; u32Col++)
+		{
+			rgstFileColumns[u32Col].u64Offset = BENCH_HDR_SIZE + offsetof(BENCH_RECORD, rgfChannels) + u32Col * sizeof(LIB_FLOAT);
+			rgstFileColumns[u32Col].u32Dtype = LIB_DTYPE_FLOAT32;
+			rgstFileColumns[u32Col].u32Stride = sizeof(BENCH_RECORD);
+		}
+		stFileTime.u64Offset = BENCH_HDR_SIZE;
+		stFileTime.u32Dtype = LIB_DTYPE_FLOAT64;
+		stFileTime.u32Stride = sizeof(BENCH_RECORD);
+		stFile.pszPath = BENCH_PATH;
+		stFile.prgstColumns = rgstFileColumns;
+		stFile.pstXColumn = &stFileTime;
+		stInput.pstFile = &stFile;
+	}
+	else
+	{
+		LIB_U64 u64Size = BENCH_HDR_SIZE + u64Rows * sizeof(BENCH_RECORD);
+		FILE* pFile = fopen(BENCH_PATH, "rb");
+		pcLoaded = (LIB_CHAR*)malloc((size_t)u64Size);
+		if (pFile == NULL || pcLoaded == NULL || fread(pcLoaded, 1, (size_t)u64Size, pFile) != u64Size)
+		{
+			printf("%-8s unable to load %s\n", "load", BENCH_PATH);
+			return 1;
+		}
+		fclose(pFile);
+		const BENCH_RECORD* pstRecords = (const BENCH_RECORD*)(pcLoaded + BENCH_HDR_SIZE);
+		for (LIB_U32 u32Col = 0; u32Col < BENCH_PLOTTED; u32Col++)
+		{
+			rgstColumns[u32Col].pvData = &pstRecords[0].rgfChannels[u32Col];
+			rgstColumns[u32Col].u32Dtype = LIB_DTYPE_FLOAT32;
+			rgstColumns[u32Col].u32Stride = sizeof(BENCH_RECORD);
+		}
+		stTime.pvData = &pstRecords[0].dTime;
+		stTime.u32Dtype = LIB_DTYPE_FLOAT64;
+		stTime.u32Stride = sizeof(BENCH_RECORD);
+		stInput.prgstColumns = rgstColumns;
+		stInput.pstXColumn = &stTime;
+	}
+
+	LIB_ERROR_INFO stErr;
+	LIB_U32 u32Result = ipc_plot(&stInput, &stErr);
+	LIB_DOUBLE dMs = (GetTimeSec() - dStart) * 1e3;
+	s_bSampling.store(LIB_FALSE);
+	pthread_join(hSampler, NULL);
+	if (u32Result != LIB_OK)
+	{
+		printf("%-8s failed: %s %s\n", bMapped ? "mapped" : "load", stErr.szErrMsg, stErr.szRuntime);
+		return 1;
+	}
+	printf("%-8s %10.2f %12.1f %14.1f %12.1f\n", bMapped ? "mapped" : "load",
+		(BENCH_HDR_SIZE + u64Rows * sizeof(BENCH_RECORD)) / 1e9, dMs, s_u64PeakAnonKb.load() / 1024.0, GetStatusKb("VmHWM:") / 1024.0);
+	free(pcLoaded);
+	ipc_plot_image_free(&stImage);
+	return 0;
+}
+
+int main(int argc, char* argv[])
+{
+	LIB_DOUBLE dMaxGb = 2.0;
+	for (int nArg = 1; nArg < argc; nArg++)
+	{
+		if (strcmp(argv[nArg], "--max-gb") == 0 && nArg + 1 < argc)
+		{
+			dMaxGb = atof(argv[++nArg]);
+		}
+	}
+
+	printf("%u of %u float channels in %u-byte records, timestamps as X, min/max decimation, native backend\n",
+		BENCH_PLOTTED, BENCH_CHANNELS, (LIB_U32)sizeof(BENCH_RECORD));
+	printf("%-8s %10s %12s %14s %12s\n", "mode", "GB", "ms", "peak anon MB", "peak RSS MB");
+	for (LIB_U64 u64Mb = BENCH_MIN_MB; u64Mb <= (LIB_U64)(dMaxGb * 1024.0); u64Mb *= 2)
+	{
+		LIB_U64 u64Rows = u64Mb * 1024 * 1024 / sizeof(BENCH_RECORD);
+		if (u64Rows > 0xFFFFFFFFULL)
+		{
+			break;
+		}
+		if (!WriteFile(u64Rows))
+		{
+			printf("Unable to write %s of %llu MB\n", BENCH_PATH, u64Mb);
+			unlink(BENCH_PATH);
+			return 1;
+		}
+		for (LIB_U32 u32Mode = 0; u32Mode < 2; u32Mode++)
+		{
+			fflush(stdout);
+			pid_t nPid = fork();
+			if (nPid == 0)
+			{
+				int nResult = RunCase((LIB_BOOLEAN)(u32Mode == 1), u64Rows);
+				fflush(stdout);
+				_exit(nResult);
+			}
+			int nStatus = 0;
+			waitpid(nPid, &nStatus, 0);
+		}
+		unlink(BENCH_PATH);
+	}
+	return 0;
+}
@@ -0,0 +1,157 @@
+/*******************************************************************************
+ * Bench_Gather.cpp
+ *
+ * Plotting channels that live in an array of records, a timestamp followed
+ * by the samples of every channel, as acquisition code usually keeps them:
+ *
+ *   repack  the caller copies the timestamps and the plotted channels into
+ *           doubles, column after column, and plots that buffer with the
+ *           timestamps as the X column (what had to be done before strides)
+ *   gather  one LIB_COLUMN per channel and for the timestamps points into
+ *           the records with their size as stride, nothing is copied before
+ *           the data is streamed
+ *
+ * Both plot in an open session of Bench_StandIn.py, which decodes the
+ * request like the Python tool but does not draw, so the numbers are the
+ * caller's work and the transport. The p50 of the whole call is printed
+ * with the bytes sent.
+ *
+ * Run from a directory next to Benchmark/, e.g. a build directory in the
+ * repository.
+ ******************************************************************************/
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "IPC_Plot_Internal.h"
+
+#ifdef _WIN32
+#    define BENCH_STANDIN_PATH ".\\..\\Benchmark\\Bench_StandIn.py"
+#else
+#    define BENCH_STANDIN_PATH "./../Benchmark/Bench_StandIn.py"
+#endif
+
+#define BENCH_CHANNELS 8  //!< Channels in each record
+#define BENCH_PLOTTED  4  //!< Channels plotted, the first ones
+#define BENCH_CALLS    20
+
+// One acquisition, 40 bytes
+typedef struct BENCH_RECORD
+{
+	LIB_DOUBLE dTime;
+	LIB_FLOAT rgfChannels[BENCH_CHANNELS];
+} BENCH_RECORD;
+
+static LIB_DOUBLE GetTimeSec(void)
+{
+	struct timespec stNow;
+	timespec_get(&stNow, TIME_UTC);
+	return (LIB_DOUBLE)stNow.tv_sec + (LIB_DOUBLE)stNow.tv_nsec * 1e-9;
+}
+
+static LIB_DOUBLE Median(std::vector<LIB_DOUBLE>& vecSamples)
+{
+	if (vecSamples.empty())
+	{
+		return 0.0;
+	}
+	std::sort(vecSamples.begin(), vecSamples.end());
+	return vecSamples[(vecSamples.size() - 1) / 2];
+}
+
+int main(void)
+{
+	static const LIB_U32 s_rgu32Rows[] = { 10000, 100000, 1000000, 4000000 };
+	const LIB_CHAR* rgszLabels[BENCH_PLOTTED] = { "Channel 1", "Channel 2", "Channel 3", "Channel 4" };
+
+#ifdef _WIN32
+	_putenv_s(LIB_RENDERER_ENV, BENCH_STANDIN_PATH);
+#else
+	setenv(LIB_RENDERER_ENV, BENCH_STANDIN_PATH, 1);
+#endif
+	LIB_ERROR_INFO stErr;
+	LIB_SESSION* pstSession = NULL;
+	if (ipc_plot_session_open(&pstSession, &stErr) != LIB_OK)
+	{
+		printf("ipc_plot_session_open() failed: %s %s\n", stErr.szErrMsg, stErr.szRuntime);
+		return 1;
+	}
+
+	printf("%u of %u float channels in %u-byte records, timestamps as X\n", BENCH_PLOTTED, BENCH_CHANNELS, (LIB_U32)sizeof(BENCH_RECORD));
+	printf("%-8s %10s %12s %12s\n", "mode", "rows", "p50 ms", "MB sent");
+	for (size_t szRows = 0; szRows < sizeof(s_rgu32Rows) / sizeof(s_rgu32Rows[0]); szRows++)
+	{
+		LIB_U32 u32RowSize = s_rgu32Rows[szRows];
+		std::vector<BENCH_RECORD> vecRecords(u32RowSize);
+		for (LIB_U32 u32Row = 0; u32Row < u32RowSize; u32Row++)
+		{
+			vecRecords[u32Row].dTime = u32Row * 1e-3 + (rand() % 100) * 1e-6;
+			for (LIB_U32 u32Channel = 0; u32Channel < BENCH_CHANNELS; u32Channel++)
+			{
+				vecRecords[u32Row].rgfChannels[u32Channel] = (LIB_FLOAT)sin(u32Row * 0.001 * (u32Channel + 1));
+			}
+		}
+
+		for (LIB_U32 u32Mode = 0; u32Mode < 2; u32Mode++)
+		{
+			LIB_BOOLEAN bGather = (LIB_BOOLEAN)(u32Mode == 1);
+			std::vector<LIB_DOUBLE> vecMs;
+			LIB_PLOT_STATS stStats;
+			for (LIB_U32 u32Call = 0; u32Call < BENCH_CALLS; u32Call++)
+			{
+				LIB_DOUBLE dStart = GetTimeSec();
+				LIB_INPUT stInput;
+				stInput.u32ColSize = BENCH_PLOTTED;
+				stInput.u32RowSize = u32RowSize;
+				stInput.prgszLabels = rgszLabels;
+				stInput.pstStats = &stStats;
+				LIB_COLUMN rgstColumns[BENCH_PLOTTED];
+				LIB_COLUMN stTime;
+				stTime.u32Dtype = LIB_DTYPE_FLOAT64;
+				std::vector<LIB_DOUBLE> vecRepacked;
+				if (bGather)
+				{
+					for (LIB_U32 u32Col = 0; u32Col < BENCH_PLOTTED; u32Col++)
+					{
+						rgstColumns[u32Col].pvData = &vecRecords[0].rgfChannels[u32Col];
+						rgstColumns[u32Col].u32Dtype = LIB_DTYPE_FLOAT32;
+						rgstColumns[u32Col].u32Stride = sizeof(BENCH_RECORD);
+					}
+					stTime.pvData = &vecRecords[0].dTime;
+					stTime.u32Stride = sizeof(BENCH_RECORD);
+					stInput.prgstColumns = rgstColumns;
+				}
+				else
+				{
+					// Timestamps first, then the channels
+					vecRepacked.resize((size_t)(BENCH_PLOTTED + 1) * u32RowSize);
+					for (LIB_U32 u32Row = 0; u32Row < u32RowSize; u32Row++)
+					{
+						vecRepacked[u32Row] = vecRecords[u32Row].dTime;
+						for (LIB_U32 u32Col = 0; u32Col < BENCH_PLOTTED; u32Col++)
+						{
+							vecRepacked[(size_t)(u32Col + 1) * u32RowSize + u32Row] = vecRecords[u32Row].rgfChannels[u32Col];
+						}
+					}
+					stTime.pvData = vecRepacked.data();
+					stInput.prgdBuffer = vecRepacked.data() + u32RowSize;
+				}
+				stInput.pstXColumn = &stTime;
+				if (ipc_plot_session_plot(pstSession, &stInput, &stErr) != LIB_OK)
+				{
+					printf("%-8s failed: %s %s\n", bGather ? "gather" : "repack", stErr.szErrMsg, stErr.szRuntime);
+					ipc_plot_session_close(pstSession);
+					return 1;
+				}
+				vecMs.push_back((GetTimeSec() - dStart) * 1e3);
+			}
+			printf("%-8s %10u %12.2f %12.1f\n", bGather ? "gather" : "repack", u32RowSize, Median(vecMs), stStats.u64BytesSent / 1e6);
+		}
+	}
+	ipc_plot_session_close(pstSession);
+	return 0;
+}
@@ -0,0 +1,454 @@
+/*******************************************************************************
+ * Bench_Latency.cpp
+ *
+ * End-to-end latency of a plot split into the phases of the library, for the
+ * real Python tool and for Bench_StandIn.py, which speaks the same protocol
+ * but does not plot, so the IPC overhead can be told apart from Matplotlib.
+ *
+ * One-shot calls run like ipc_plot() without its pool, one renderer per call:
+ *   spawn    RendererOpen() until the process is started
+ *   connect  RendererOpen() until the READY frame, the renderer's start-up,
+ *            imports and pipe connection
+ *   transfer first request sent until the renderer has read all of it
+ *   render   request read until the reply frame arrives
+ *   ack      reply frame read and checked
+ *   close    renderer told to exit and reaped
+ * Session calls reuse one renderer, like ipc_plot_session_plot():
+ *   transfer, render, ack as above
+ * Pooled calls are plain ipc_plot() calls served by a ready renderer of the
+ * library's pool, timed with LIB_PLOT_STATS; render includes the ack.
+ *
+ * p50, p99 and mean of each phase and the throughput are printed and written
+ * as JSON for tracking over time. Run from a directory next to Python/ and
+ * Benchmark/, e.g. a build directory in the repository:
+ *
+ *   bench_latency [--cols N] [--rows N] [--calls N] [--renderer python|standin|both]
+ *                 [--standin PATH] [--json PATH]
+ ******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "IPC_Plot_Protocol.h"
+
+#ifdef _WIN32
+#    define BENCH_STANDIN_PATH ".\\..\\Benchmark\\Bench_StandIn.py"
+#    define BENCH_PLATFORM     "windows"
+#else
+#    define BENCH_STANDIN_PATH "./../Benchmark/Bench_StandIn.py"
+#    define BENCH_PLATFORM     "posix"
+#endif
+
+// Phases of one call, in the order they are printed
+enum { PHASE_SPAWN, PHASE_CONNECT, PHASE_TRANSFER, PHASE_RENDER, PHASE_ACK, PHASE_CLOSE, PHASE_TOTAL, PHASE_COUNT };
+static const LIB_CHAR* s_rgszPhases[PHASE_COUNT] = { "spawn", "connect", "transfer", "render", "ack", "close", "total" };
+
+typedef struct BENCH_OPTIONS
+{
+	LIB_U32 u32ColSize;
+	LIB_U32 u32RowSize;
+	LIB_U32 u32Calls;
+	LIB_BOOLEAN bPython;
+	LIB_BOOLEAN bStandIn;
+	const LIB_CHAR* pszStandIn;
+	const LIB_CHAR* pszJson;
+} BENCH_OPTIONS;
+
+// Samples of every phase of one renderer and mode, in seconds
+typedef struct BENCH_RESULT
+{
+	const LIB_CHAR* pszRenderer;
+	const LIB_CHAR* pszMode;
+	std::vector<LIB_DOUBLE> rgvecSamples[PHASE_COUNT];
+	LIB_DOUBLE dElapsed;  //!< Wall time of all calls
+	LIB_U32 u32Failed;
+} BENCH_RESULT;
+
+static LIB_DOUBLE GetTimeSec(void)
+{
+	struct timespec stNow;
+	timespec_get(&stNow, TIME_UTC);
+	return (LIB_DOUBLE)stNow.tv_sec + (LIB_DOUBLE)stNow.tv_nsec * 1e-9;
+}
+
+static void SetRenderer(const LIB_CHAR* pszPath)
+{
+#ifdef _WIN32
+	_putenv_s(LIB_RENDERER_ENV, (pszPath != NULL) ? pszPath : "");
+#else
+	if (pszPath != NULL)
+	{
+		setenv(LIB_RENDERER_ENV, pszPath, 1);
+	}
+	else
+	{
+		unsetenv(LIB_RENDERER_ENV);
+	}
+#endif
+}
+
+/***************************************************************************//**
+ * Percentile
+ *
+ * Nearest-rank percentile of the samples of one phase
+ *
+ * @param vecSamples Samples in seconds, sorted in place
+ * @param dRank      Percentile from 0 to 100
+ * @return           Percentile in milliseconds, 0 without samples
+ ******************************************************************************/
+static LIB_DOUBLE Percentile(std::vector<LIB_DOUBLE>& vecSamples, LIB_DOUBLE dRank)
+{
+	if (vecSamples.empty())
+	{
+		return 0.0;
+	}
+	std::sort(vecSamples.begin(), vecSamples.end());
+	size_t szIndex = (size_t)(dRank / 100.0 * vecSamples.size() + 0.999999);
+	szIndex = (szIndex == 0) ? 0 : szIndex - 1;
+	return vecSamples[std::min(szIndex, vecSamples.size() - 1)] * 1e3;
+}
+
+static LIB_DOUBLE Mean(const std::vector<LIB_DOUBLE>& vecSamples)
+{
+	LIB_DOUBLE dSum = 0.0;
+	for (size_t szIndex = 0; szIndex < vecSamples.size(); szIndex++)
+	{
+		dSum += vecSamples[szIndex];
+	}
+	return vecSamples.empty() ? 0.0 : dSum / vecSamples.size() * 1e3;
+}
+
+/***************************************************************************//**
+ * TimeRequest
+ *
+ * Sends one request and waits for the reply, timing each step
+ *
+ * @param pstSession Session with a running renderer
+ * @param pstInput   Request to send
+ * @param pstResult  Receives the samples
+ * @return           LIB_OK if the renderer acknowledged the request
+ ******************************************************************************/
+static LIB_U32 TimeRequest(LIB_SESSION* pstSession, LIB_INPUT* pstInput, BENCH_RESULT* pstResult)
+{
+	LIB_ERROR_INFO stErr = LIB_ERROR_INFO();
+	LIB_FRAME_HDR stFrame;
+
+	LIB_DOUBLE dStart = GetTimeSec();
+	if (ProtocolSendPlot(pstSession, pstInput, 0, -1, 0, &stErr) != LIB_OK)
+	{
+		return LIB_ERR;
+	}
+	LIB_DOUBLE dSent = GetTimeSec();
+	if (ProtocolRecvFrame(pstSession, &stFrame, &stErr) != LIB_OK)
+	{
+		return LIB_ERR;
+	}
+	LIB_DOUBLE dReply = GetTimeSec();
+	if (ProtocolRecvReply(pstSession, &stFrame, &stErr) != LIB_OK)
+	{
+		return LIB_ERR;
+	}
+	LIB_DOUBLE dAck = GetTimeSec();
+
+	pstResult->rgvecSamples[PHASE_TRANSFER].push_back(dSent - dStart);
+	pstResult->rgvecSamples[PHASE_RENDER].push_back(dReply - dSent);
+	pstResult->rgvecSamples[PHASE_ACK].push_back(dAck - dReply);
+	return LIB_OK;
+}
+
+/***************************************************************************//**
+ * RunOneShot
+ *
+ * Plots with a new renderer for every call, like ipc_plot()
+ *
+ * @param pstInput  Request to send
+ * @param u32Calls  Number of calls
+ * @param pstResult Receives the samples
+ ******************************************************************************/
+static void RunOneShot(LIB_INPUT* pstInput, LIB_U32 u32Calls, BENCH_RESULT* pstResult)
+{
+	LIB_DOUBLE dBenchStart = GetTimeSec();
+	for (LIB_U32 u32Call = 0; u32Call < u32Calls; u32Call++)
+	{
+		LIB_ERROR_INFO stErr = LIB_ERROR_INFO();
+		LIB_SESSION stSession = LIB_SESSION();
+
+		LIB_DOUBLE dStart = GetTimeSec();
+		if (RendererOpen(&stSession, &stErr) != LIB_OK)
+		{
+			printf("RendererOpen() failed: %s %s\n", stErr.szErrMsg, stErr.szRuntime);
+			pstResult->u32Failed++;
+			continue;
+		}
+		pstResult->rgvecSamples[PHASE_SPAWN].push_back(stSession.stStats.dSpawnMs * 1e-3);
+		pstResult->rgvecSamples[PHASE_CONNECT].push_back(stSession.stStats.dConnectMs * 1e-3);
+		LIB_U32 u32Ret = TimeRequest(&stSession, pstInput, pstResult);
+		LIB_DOUBLE dClose = GetTimeSec();
+		RendererClose(&stSession);
+		LIB_DOUBLE dEnd = GetTimeSec();
+		if (u32Ret != LIB_OK)
+		{
+			pstResult->u32Failed++;
+			continue;
+		}
+		pstResult->rgvecSamples[PHASE_CLOSE].push_back(dEnd - dClose);
+		pstResult->rgvecSamples[PHASE_TOTAL].push_back(dEnd - dStart);
+	}
+	pstResult->dElapsed = GetTimeSec() - dBenchStart;
+}
+
+/***************************************************************************//**
+ * RunSession
+ *
+ * Plots every call with the same renderer, like ipc_plot_session_plot().
+ * Start-up and the first request are not counted.
+ *
+ * @param pstInput  Request to send
+ * @param u32Calls  Number of calls
+ * @param pstResult Receives the samples
+ ******************************************************************************/
+static void RunSession(LIB_INPUT* pstInput, LIB_U32 u32Calls, BENCH_RESULT* pstResult)
+{
+	LIB_ERROR_INFO stErr = LIB_ERROR_INFO();
+	LIB_SESSION stSession = LIB_SESSION();
+	if (RendererOpen(&stSession, &stErr) != LIB_OK)
+	{
+		printf("RendererOpen() failed: %s %s\n", stErr.szErrMsg, stErr.szRuntime);
+		pstResult->u32Failed = u32Calls;
+		return;
+	}
+	BENCH_RESULT stWarmUp;
+	TimeRequest(&stSession, pstInput, &stWarmUp);
+
+	LIB_DOUBLE dBenchStart = GetTimeSec();
+	for (LIB_U32 u32Call = 0; u32Call < u32Calls; u32Call++)
+	{
+		LIB_DOUBLE dStart = GetTimeSec();
+		if (TimeRequest(&stSession, pstInput, pstResult) != LIB_OK)
+		{
+			pstResult->u32Failed++;
+			break;
+		}
+		pstResult->rgvecSamples[PHASE_TOTAL].push_back(GetTimeSec() - dStart);
+	}
+	pstResult->dElapsed = GetTimeSec() - dBenchStart;
+	RendererClose(&stSession);
+}
+
+/***************************************************************************//**
+ * RunPooled
+ *
+ * Plots every call with ipc_plot() and a pool of one ready renderer. The
+ * first call starts the renderer and is not counted.
+ *
+ * @param pstInput  Request to send
+ * @param u32Calls  Number of calls
+ * @param pstResult Receives the samples
+ ******************************************************************************/
+static void RunPooled(LIB_INPUT* pstInput, LIB_U32 u32Calls, BENCH_RESULT* pstResult)
+{
+	LIB_ERROR_INFO stErr = LIB_ERROR_INFO();
+	LIB_PLOT_STATS stStats;
+	LIB_INPUT stInput = *pstInput;
+	stInput.pstStats = &stStats;
+
+	ipc_plot_pool_config(1, LIB_WAIT_INFINITE, &stErr);
+	ipc_plot(&stInput, &stErr);
+	LIB_DOUBLE dBenchStart = GetTimeSec();
+	for (LIB_U32 u32Call = 0; u32Call < u32Calls; u32Call++)
+	{
+		if (ipc_plot(&stInput, &stErr) != LIB_OK)
+		{
+			printf("ipc_plot() failed: %s %s\n", stErr.szErrMsg, stErr.szRuntime);
+			pstResult->u32Failed++;
+			continue;
+		}
+		pstResult->rgvecSamples[PHASE_SPAWN].push_back(stStats.dSpawnMs * 1e-3);
+		pstResult->rgvecSamples[PHASE_CONNECT].push_back(stStats.dConnectMs * 1e-3);
+		pstResult->rgvecSamples[PHASE_TRANSFER].push_back(stStats.dSendMs * 1e-3);
+		pstResult->rgvecSamples[PHASE_RENDER].push_back(stStats.dRenderMs * 1e-3);
+		pstResult->rgvecSamples[PHASE_CLOSE].push_back(stStats.dCloseMs * 1e-3);
+		pstResult->rgvecSamples[PHASE_TOTAL].push_back(stStats.dTotalMs * 1e-3);
+	}
+	pstResult->dElapsed = GetTimeSec() - dBenchStart;
+
+	// The next renderer must not find this one ready
+	ipc_plot_pool_config(0, LIB_POOL_DEFAULT_IDLE_MS, &stErr);
+}
+
+static void PrintResult(BENCH_RESULT* pstResult, LIB_U64 u64Bytes)
+{
+	printf("%-8s %-8s", pstResult->pszRenderer, pstResult->pszMode);
+	for (LIB_U32 u32Phase = 0; u32Phase < PHASE_COUNT; u32Phase++)
+	{
+		std::vector<LIB_DOUBLE>& vecSamples = pstResult->rgvecSamples[u32Phase];
+		if (vecSamples.empty())
+		{
+			printf(" %17s", "-");
+			continue;
+		}
+		printf(" %8.2f/%8.2f", Percentile(vecSamples, 50), Percentile(vecSamples, 99));
+	}
+	size_t szDone = pstResult->rgvecSamples[PHASE_TOTAL].size();
+	printf(" %9.1f %9.1f %6u\n", szDone / pstResult->dElapsed, szDone * (u64Bytes / 1e6) / pstResult->dElapsed, pstResult->u32Failed);
+}
+
+static void WriteJson(FILE* pFile, const BENCH_OPTIONS* pstOptions, std::vector<BENCH_RESULT*>& vecResults, LIB_U64 u64Bytes)
+{
+	fprintf(pFile, "{\n  \"benchmark\": \"ipc_plot_latency\",\n  \"platform\": \"%s\",\n  \"protocol_version\": %u,\n",
+		BENCH_PLATFORM, LIB_PROTO_VERSION);
+	fprintf(pFile, "  \"cols\": %u,\n  \"rows\": %u,\n  \"calls\": %u,\n  \"bytes_per_call\": %llu,\n  \"results\": [\n",
+		pstOptions->u32ColSize, pstOptions->u32RowSize, pstOptions->u32Calls, u64Bytes);
+	for (size_t szResult = 0; szResult < vecResults.size(); szResult++)
+	{
+		BENCH_RESULT* pstResult = vecResults[szResult];
+		size_t szDone = pstResult->rgvecSamples[PHASE_TOTAL].size();
+		fprintf(pFile, "    {\n      \"renderer\": \"%s\",\n      \"mode\": \"%s\",\n      \"failed\": %u,\n",
+			pstResult->pszRenderer, pstResult->pszMode, pstResult->u32Failed);
+		fprintf(pFile, "      \"calls_per_s\": %.3f,\n      \"mb_per_s\": %.3f,\n      \"phases_ms\": {",
+			szDone / pstResult->dElapsed, szDone * (u64Bytes / 1e6) / pstResult->dElapsed);
+		const LIB_CHAR* pszSeparator = "\n";
+		for (LIB_U32 u32Phase = 0; u32Phase < PHASE_COUNT; u32Phase++)
+		{
+			std::vector<LIB_DOUBLE>& vecSamples = pstResult->rgvecSamples[u32Phase];
+			if (vecSamples.empty())
+			{
+				continue;
+			}
+			fprintf(pFile, "%s        \"%s\": { \"p50\": %.4f, \"p99\": %.4f, \"mean\": %.4f, \"count\": %zu }", pszSeparator,
+				s_rgszPhases[u32Phase], Percentile(vecSamples, 50), Percentile(vecSamples, 99), Mean(vecSamples), vecSamples.size());
+			pszSeparator = ",\n";
+		}
+		fprintf(pFile, "\n      }\n    }%s\n", (szResult + 1 < vecResults.size()) ? "," : "");
+	}
+	fprintf(pFile, "  ]\n}\n");
+}
+
+static LIB_BOOLEAN ParseOptions(int argc, char** argv, BENCH_OPTIONS* pstOptions)
+{
+	for (int nArg = 1; nArg < argc; nArg++)
+	{
+		const LIB_CHAR* pszValue = (nArg + 1 < argc) ? argv[nArg + 1] : NULL;
+		if (pszValue == NULL)
+		{
+			return LIB_FALSE;
+		}
+		if (strcmp(argv[nArg], "--cols") == 0)
+		{
+			pstOptions->u32ColSize = (LIB_U32)strtoul(pszValue, NULL, 10);
+		}
+		else if (strcmp(argv[nArg], "--rows") == 0)
+		{
+			pstOptions->u32RowSize = (LIB_U32)strtoul(pszValue, NULL, 10);
+		}
+		else if (strcmp(argv[nArg], "--calls") == 0)
+		{
+			pstOptions->u32Calls = (LIB_U32)strtoul(pszValue, NULL, 10);
+		}
+		else if (strcmp(argv[nArg], "--renderer") == 0)
+		{
+			pstOptions->bPython = (LIB_BOOLEAN)(strcmp(pszValue, "python") == 0 || strcmp(pszValue, "both") == 0);
+			pstOptions->bStandIn = (LIB_BOOLEAN)(strcmp(pszValue, "standin") == 0 || strcmp(pszValue, "both") == 0);
+		}
+		else if (strcmp(argv[nArg], "--standin") == 0)
+		{
+			pstOptions->pszStandIn = pszValue;
+		}
+		else if (strcmp(argv[nArg], "--json") == 0)
+		{
+			pstOptions->pszJson = pszValue;
+		}
+		else
+		{
+			return LIB_FALSE;
+		}
+		nArg++;
+	}
+	return (LIB_BOOLEAN)(pstOptions->u32ColSize > 0 && pstOptions->u32Calls > 0 && (pstOptions->bPython || pstOptions->bStandIn));
+}
+
+int main(int argc, char** argv)
+{
+	BENCH_OPTIONS stOptions = { 2, 100000, 20, LIB_TRUE, LIB_TRUE, BENCH_STANDIN_PATH, "bench_latency.json" };
+	if (!ParseOptions(argc, argv, &stOptions))
+	{
+		printf("Usage: %s [--cols N] [--rows N] [--calls N] [--renderer python|standin|both] [--standin PATH] [--json PATH]\n", argv[0]);
+		return 1;
+	}
+
+	// A ramp per column, the renderers only see the bytes
+	LIB_U64 u64Count = (LIB_U64)stOptions.u32ColSize * stOptions.u32RowSize;
+	LIB_DOUBLE* prgdData = (LIB_DOUBLE*)malloc((size_t)u64Count * sizeof(LIB_DOUBLE) + 1);
+	std::vector<const LIB_CHAR*> vecLabels(stOptions.u32ColSize, "column");
+	for (LIB_U64 u64Index = 0; u64Index < u64Count; u64Index++)
+	{
+		prgdData[u64Index] = (LIB_DOUBLE)(u64Index % stOptions.u32RowSize);
+	}
+	LIB_INPUT stInput;
+	stInput.u32ColSize = stOptions.u32ColSize;
+	stInput.u32RowSize = stOptions.u32RowSize;
+	stInput.prgszLabels = vecLabels.data();
+	stInput.prgdBuffer = prgdData;
+	LIB_U64 u64Bytes = u64Count * sizeof(LIB_DOUBLE);
+
+	std::vector<BENCH_RESULT*> vecResults;
+	for (LIB_U32 u32Renderer = 0; u32Renderer < 2; u32Renderer++)
+	{
+		if ((u32Renderer == 0 && !stOptions.bStandIn) || (u32Renderer == 1 && !stOptions.bPython))
+		{
+			continue;
+		}
+		SetRenderer((u32Renderer == 0) ? stOptions.pszStandIn : NULL);
+		const LIB_CHAR* pszRenderer = (u32Renderer == 0) ? "standin" : "python";
+
+		BENCH_RESULT* pstOneShot = new BENCH_RESULT();
+		pstOneShot->pszRenderer = pszRenderer;
+		pstOneShot->pszMode = "oneshot";
+		RunOneShot(&stInput, stOptions.u32Calls, pstOneShot);
+		vecResults.push_back(pstOneShot);
+
+		BENCH_RESULT* pstSession = new BENCH_RESULT();
+		pstSession->pszRenderer = pszRenderer;
+		pstSession->pszMode = "session";
+		RunSession(&stInput, stOptions.u32Calls, pstSession);
+		vecResults.push_back(pstSession);
+
+		BENCH_RESULT* pstPooled = new BENCH_RESULT();
+		pstPooled->pszRenderer = pszRenderer;
+		pstPooled->pszMode = "pooled";
+		RunPooled(&stInput, stOptions.u32Calls, pstPooled);
+		vecResults.push_back(pstPooled);
+	}
+	SetRenderer(NULL);
+
+	printf("%u x %u doubles (%.1f MB), %u calls, p50/p99 in ms\n", stOptions.u32ColSize, stOptions.u32RowSize, u64Bytes / 1e6, stOptions.u32Calls);
+	printf("%-8s %-8s", "renderer", "mode");
+	for (LIB_U32 u32Phase = 0; u32Phase < PHASE_COUNT; u32Phase++)
+	{
+		printf(" %17s", s_rgszPhases[u32Phase]);
+	}
+	printf(" %9s %9s %6s\n", "calls/s", "MB/s", "failed");
+	for (size_t szResult = 0; szResult < vecResults.size(); szResult++)
+	{
+		PrintResult(vecResults[szResult], u64Bytes);
+	}
+
+	FILE* pFile = fopen(stOptions.pszJson, "w");
+	if (pFile != NULL)
+	{
+		WriteJson(pFile, &stOptions, vecResults, u64Bytes);
+		fclose(pFile);
+		printf("Results written to %s\n", stOptions.pszJson);
+	}
+
+	for (size_t szResult = 0; szResult < vecResults.size(); szResult++)
+	{
+		delete vecResults[szResult];
+	}
+	free(prgdData);
+	return 0;
+}
@@ -0,0 +1,227 @@
+/*******************************************************************************
+ * Bench_Native.cpp
+ *
+ * Images per second of the native backend against the Python tool, for the
+ * same figure saved as PNG by both:
+ *   python  ipc_plot() with a pool of one ready Python tool, the first call
+ *           starts it and is not counted
+ *   native  ipc_plot() with LIB_BACKEND_NATIVE, drawn and encoded in this
+ *           process
+ * Both run once without decimation and once with min/max decimation to the
+ * default number of points, as long columns would be plotted.
+ *
+ * p50 of the draw and encode times (plot and savefig() for Python) and the
+ * images per second are printed and written as JSON. Run from a directory
+ * next to Python/, e.g. a build directory in the repository:
+ *
+ *   bench_native [--cols N] [--rows N] [--plots N] [--json PATH]
+ ******************************************************************************/
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "IPC_Plot.h"
+
+#ifdef _WIN32
+#    define BENCH_PLATFORM "windows"
+#else
+#    define BENCH_PLATFORM "posix"
+#endif
+
+typedef struct BENCH_OPTIONS
+{
+	LIB_U32 u32ColSize;
+	LIB_U32 u32RowSize;
+	LIB_U32 u32Plots;
+	const LIB_CHAR* pszJson;
+} BENCH_OPTIONS;
+
+// Timings of one backend and decimation, in milliseconds
+typedef struct BENCH_RESULT
+{
+	const LIB_CHAR* pszBackend;
+	const LIB_CHAR* pszDecimation;
+	std::vector<LIB_DOUBLE> vecDrawMs;
+	std::vector<LIB_DOUBLE> vecSaveMs;
+	std::vector<LIB_DOUBLE> vecTotalMs;
+	LIB_DOUBLE dElapsed;  //!< Wall time of all plots in seconds
+	LIB_U32 u32Failed;
+} BENCH_RESULT;
+
+static LIB_DOUBLE GetTimeSec(void)
+{
+	struct timespec stNow;
+	timespec_get(&stNow, TIME_UTC);
+	return (LIB_DOUBLE)stNow.tv_sec + (LIB_DOUBLE)stNow.tv_nsec * 1e-9;
+}
+
+static LIB_DOUBLE Median(std::vector<LIB_DOUBLE>& vecSamples)
+{
+	if (vecSamples.empty())
+	{
+		return 0.0;
+	}
+	std::sort(vecSamples.begin(), vecSamples.end());
+	return vecSamples[(vecSamples.size() - 1) / 2];
+}
+
+/***************************************************************************//**
+ * RunPlots
+ *
+ * Plots the input the given number of times with ipc_plot()
+ *
+ * @param pstInput  Input with the backend and decimation set
+ * @param u32Plots  Number of plots
+ * @param pstResult Receives the timings
+ ******************************************************************************/
+static void RunPlots(const LIB_INPUT* pstInput, LIB_U32 u32Plots, BENCH_RESULT* pstResult)
+{
+	LIB_ERROR_INFO stErr = LIB_ERROR_INFO();
+	LIB_PLOT_STATS stStats;
+	LIB_INPUT stInput = *pstInput;
+	stInput.pstStats = &stStats;
+
+	// Warm-up, starts the Python tool of the pool
+	ipc_plot(&stInput, &stErr);
+	LIB_DOUBLE dBenchStart = GetTimeSec();
+	for (LIB_U32 u32Plot = 0; u32Plot < u32Plots; u32Plot++)
+	{
+		if (ipc_plot(&stInput, &stErr) != LIB_OK)
+		{
+			printf("ipc_plot() failed: %s %s\n", stErr.szErrMsg, stErr.szRuntime);
+			pstResult->u32Failed++;
+			continue;
+		}
+		pstResult->vecDrawMs.push_back(stStats.dRendererPlotMs);
+		pstResult->vecSaveMs.push_back(stStats.dRendererSaveMs);
+		pstResult->vecTotalMs.push_back(stStats.dTotalMs);
+	}
+	pstResult->dElapsed = GetTimeSec() - dBenchStart;
+}
+
+static void WriteJson(FILE* pFile, const BENCH_OPTIONS* pstOptions, std::vector<BENCH_RESULT*>& vecResults)
+{
+	fprintf(pFile, "{\n  \"benchmark\": \"ipc_plot_native\",\n  \"platform\": \"%s\",\n", BENCH_PLATFORM);
+	fprintf(pFile, "  \"cols\": %u,\n  \"rows\": %u,\n  \"plots\": %u,\n  \"results\": [\n",
+		pstOptions->u32ColSize, pstOptions->u32RowSize, pstOptions->u32Plots);
+	for (size_t szResult = 0; szResult < vecResults.size(); szResult++)
+	{
+		BENCH_RESULT* pstResult = vecResults[szResult];
+		fprintf(pFile, "    {\n      \"backend\": \"%s\",\n      \"decimation\": \"%s\",\n      \"failed\": %u,\n",
+			pstResult->pszBackend, pstResult->pszDecimation, pstResult->u32Failed);
+		fprintf(pFile, "      \"images_per_s\": %.3f,\n      \"draw_ms_p50\": %.4f,\n      \"save_ms_p50\": %.4f,\n      \"total_ms_p50\": %.4f\n",
+			pstResult->vecTotalMs.size() / pstResult->dElapsed, Median(pstResult->vecDrawMs), Median(pstResult->vecSaveMs),
+			Median(pstResult->vecTotalMs));
+		fprintf(pFile, "    }%s\n", (szResult + 1 < vecResults.size()) ? "," : "");
+	}
+	fprintf(pFile, "  ]\n}\n");
+}
+
+static LIB_BOOLEAN ParseOptions(int argc, char** argv, BENCH_OPTIONS* pstOptions)
+{
+	for (int nArg = 1; nArg < argc; nArg++)
+	{
+		const LIB_CHAR* pszValue = (nArg + 1 < argc) ? argv[nArg + 1] : NULL;
+		if (pszValue == NULL)
+		{
+			return LIB_FALSE;
+		}
+		if (strcmp(argv[nArg], "--cols") == 0)
+		{
+			pstOptions->u32ColSize = (LIB_U32)strtoul(pszValue, NULL, 10);
+		}
+		else if (strcmp(argv[nArg], "--rows") == 0)
+		{
+			pstOptions->u32RowSize = (LIB_U32)strtoul(pszValue, NULL, 10);
+		}
+		else if (strcmp(argv[nArg], "--plots") == 0)
+		{
+			pstOptions->u32Plots = (LIB_U32)strtoul(pszValue, NULL, 10);
+		}
+		else if (strcmp(argv[nArg], "--json") == 0)
+		{
+			pstOptions->pszJson = pszValue;
+		}
+		else
+		{
+			return LIB_FALSE;
+		}
+		nArg++;
+	}
+	return (LIB_BOOLEAN)(pstOptions->u32ColSize > 0 && pstOptions->u32RowSize > 0 && pstOptions->u32Plots > 0);
+}
+
+int main(int argc, char** argv)
+{
+	BENCH_OPTIONS stOptions = { 3, 100000, 20, "bench_native.json" };
+	if (!ParseOptions(argc, argv, &stOptions))
+	{
+		printf("Usage: %s [--cols N] [--rows N] [--plots N] [--json PATH]\n", argv[0]);
+		return 1;
+	}
+
+	// A noisy sine per column, so the figure has lines and markers to draw
+	LIB_U64 u64Count = (LIB_U64)stOptions.u32ColSize * stOptions.u32RowSize;
+	LIB_DOUBLE* prgdData = (LIB_DOUBLE*)malloc((size_t)u64Count * sizeof(LIB_DOUBLE) + 1);
+	std::vector<const LIB_CHAR*> vecLabels(stOptions.u32ColSize, "column");
+	srand(1);
+	for (LIB_U64 u64Index = 0; u64Index < u64Count; u64Index++)
+	{
+		LIB_U32 u32Col = (LIB_U32)(u64Index / stOptions.u32RowSize);
+		LIB_DOUBLE dPhase = (LIB_DOUBLE)(u64Index % stOptions.u32RowSize) / stOptions.u32RowSize * 6.283185307179586;
+		prgdData[u64Index] = (u32Col + 1) * sin(4.0 * dPhase + u32Col) + 0.1 * rand() / RAND_MAX;
+	}
+	LIB_INPUT stInput;
+	stInput.u32ColSize = stOptions.u32ColSize;
+	stInput.u32RowSize = stOptions.u32RowSize;
+	stInput.prgszLabels = vecLabels.data();
+	stInput.prgdBuffer = prgdData;
+
+	LIB_ERROR_INFO stErr = LIB_ERROR_INFO();
+	ipc_plot_pool_config(1, LIB_WAIT_INFINITE, &stErr);
+	std::vector<BENCH_RESULT*> vecResults;
+	for (LIB_U32 u32Decimation = 0; u32Decimation < 2; u32Decimation++)
+	{
+		for (LIB_U32 u32Backend = LIB_BACKEND_PYTHON; u32Backend <= LIB_BACKEND_NATIVE; u32Backend++)
+		{
+			stInput.u32Backend = u32Backend;
+			stInput.u32Decimation = (u32Decimation == 0) ? LIB_DECIMATE_NONE : LIB_DECIMATE_MINMAX;
+			BENCH_RESULT* pstResult = new BENCH_RESULT();
+			pstResult->pszBackend = (u32Backend == LIB_BACKEND_PYTHON) ? "python" : "native";
+			pstResult->pszDecimation = (u32Decimation == 0) ? "none" : "minmax";
+			RunPlots(&stInput, stOptions.u32Plots, pstResult);
+			vecResults.push_back(pstResult);
+		}
+	}
+	ipc_plot_pool_config(0, LIB_POOL_DEFAULT_IDLE_MS, &stErr);
+
+	printf("%u x %u doubles, %u plots, p50 in ms\n", stOptions.u32ColSize, stOptions.u32RowSize, stOptions.u32Plots);
+	printf("%-8s %-10s %10s %10s %10s %10s %6s\n", "backend", "decimation", "draw", "save", "total", "images/s", "failed");
+	for (size_t szResult = 0; szResult < vecResults.size(); szResult++)
+	{
+		BENCH_RESULT* pstResult = vecResults[szResult];
+		printf("%-8s %-10s %10.2f %10.2f %10.2f %10.1f %6u\n", pstResult->pszBackend, pstResult->pszDecimation,
+			Median(pstResult->vecDrawMs), Median(pstResult->vecSaveMs), Median(pstResult->vecTotalMs),
+			pstResult->vecTotalMs.size() / pstResult->dElapsed, pstResult->u32Failed);
+	}
+
+	FILE* pFile = fopen(stOptions.pszJson, "w");
+	if (pFile != NULL)
+	{
+		WriteJson(pFile, &stOptions, vecResults);
+		fclose(pFile);
+		printf("Results written to %s\n", stOptions.pszJson);
+	}
+
+	for (size_t szResult = 0; szResult < vecResults.size(); szResult++)
+	{
+		delete vecResults[szResult];
+	}
+	free(prgdData);
+	return 0;
+}
@@ -0,0 +1,109 @@
+/*******************************************************************************
+ * Bench_Spool.cpp
+ *
+ * Cost of ipc_plot() with a spool log open, against a memcpy of the same
+ * bytes into a buffer as large as the ones of the spool. For each size the
+ * p50 and p99 of both are printed, and the MB/s of the whole run up to the
+ * log being flushed to the disk. The log is written to the current
+ * directory and deleted afterwards.
+ ******************************************************************************/
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "IPC_Plot.h"
+
+#define BENCH_LOG        "Bench_Spool.log"
+#define BENCH_LOG_BYTES  (512ULL << 20) //!< Bytes spooled for each size
+#define BENCH_MAX_PLOTS  20000
+
+static LIB_DOUBLE GetTimeSec(void)
+{
+	struct timespec stNow;
+	timespec_get(&stNow, TIME_UTC);
+	return (LIB_DOUBLE)stNow.tv_sec + (LIB_DOUBLE)stNow.tv_nsec * 1e-9;
+}
+
+static LIB_DOUBLE Percentile(std::vector<LIB_DOUBLE>& vecSamples, LIB_U32 u32Percent)
+{
+	if (vecSamples.empty())
+	{
+		return 0.0;
+	}
+	std::sort(vecSamples.begin(), vecSamples.end());
+	return vecSamples[(vecSamples.size() - 1) * u32Percent / 100];
+}
+
+int main(void)
+{
+	static const LIB_U32 s_rgu32Rows[] = { 1000, 10000, 100000, 1000000 };
+	static const LIB_U32 s_u32Cols = 4;
+
+	std::vector<LIB_DOUBLE> vecBuffer((size_t)s_rgu32Rows[3] * s_u32Cols);
+	for (size_t szIndex = 0; szIndex < vecBuffer.size(); szIndex++)
+	{
+		vecBuffer[szIndex] = sin(szIndex * 0.001);
+	}
+	const LIB_CHAR* rgszLabels[] = { "Column 1", "Column 2", "Column 3", "Column 4" };
+	std::vector<LIB_CHAR> vecCopy((size_t)LIB_SPOOL_DEFAULT_BUFFER + vecBuffer.size() * sizeof(LIB_DOUBLE));
+
+	printf("%u columns of doubles, %llu MB spooled per size, buffers of %llu MB\n", s_u32Cols, BENCH_LOG_BYTES >> 20,
+		LIB_SPOOL_DEFAULT_BUFFER >> 20);
+	printf("%-8s %7s %12s %12s %12s %12s %10s\n", "rows", "plots", "spool p50 us", "spool p99 us", "memcpy p50", "memcpy p99", "MB/s");
+	for (size_t szSize = 0; szSize < sizeof(s_rgu32Rows) / sizeof(s_rgu32Rows[0]); szSize++)
+	{
+		LIB_U64 u64Bytes = (LIB_U64)s_rgu32Rows[szSize] * s_u32Cols * sizeof(LIB_DOUBLE);
+		LIB_U32 u32Plots = (LIB_U32)std::min<LIB_U64>(BENCH_LOG_BYTES / u64Bytes, BENCH_MAX_PLOTS);
+		std::vector<LIB_DOUBLE> vecSpoolUs;
+		std::vector<LIB_DOUBLE> vecCopyUs;
+
+		// The copy goes where the next record would, wrapping like the fill buffer
+		LIB_U64 u64CopyOffset = 0;
+		for (LIB_U32 u32Plot = 0; u32Plot < u32Plots; u32Plot++)
+		{
+			if (u64CopyOffset + u64Bytes > LIB_SPOOL_DEFAULT_BUFFER)
+			{
+				u64CopyOffset = 0;
+			}
+			LIB_DOUBLE dStart = GetTimeSec();
+			memcpy(&vecCopy[u64CopyOffset], vecBuffer.data(), (size_t)u64Bytes);
+			vecCopyUs.push_back((GetTimeSec() - dStart) * 1e6);
+			u64CopyOffset += u64Bytes;
+		}
+
+		LIB_ERROR_INFO stErr;
+		remove(BENCH_LOG);
+		if (ipc_plot_spool_config(BENCH_LOG, 0, &stErr) != LIB_OK)
+		{
+			printf("%-8u failed: %s %s\n", s_rgu32Rows[szSize], stErr.szErrMsg, stErr.szRuntime);
+			return 1;
+		}
+		LIB_INPUT stInput;
+		stInput.u32ColSize = s_u32Cols;
+		stInput.u32RowSize = s_rgu32Rows[szSize];
+		stInput.prgszLabels = rgszLabels;
+		stInput.prgdBuffer = vecBuffer.data();
+		LIB_DOUBLE dRunStart = GetTimeSec();
+		for (LIB_U32 u32Plot = 0; u32Plot < u32Plots; u32Plot++)
+		{
+			LIB_DOUBLE dStart = GetTimeSec();
+			if (ipc_plot(&stInput, &stErr) != LIB_OK)
+			{
+				printf("%-8u failed: %s %s\n", s_rgu32Rows[szSize], stErr.szErrMsg, stErr.szRuntime);
+				return 1;
+			}
+			vecSpoolUs.push_back((GetTimeSec() - dStart) * 1e6);
+		}
+		ipc_plot_spool_config(NULL, 0, &stErr);
+		LIB_DOUBLE dRunSec = GetTimeSec() - dRunStart;
+		remove(BENCH_LOG);
+		printf("%-8u %7u %12.2f %12.2f %12.2f %12.2f %10.0f\n", s_rgu32Rows[szSize], u32Plots, Percentile(vecSpoolUs, 50),
+			Percentile(vecSpoolUs, 99), Percentile(vecCopyUs, 50), Percentile(vecCopyUs, 99), u32Plots * u64Bytes / dRunSec / 1e6);
+	}
+	return 0;
+}
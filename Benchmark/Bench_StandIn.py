@@ -0,0 +1,76 @@
+"""
+Bench_StandIn.py
+
+Summary
+-------
+Stand-in for IPC_Plot.py that speaks the same protocol over the same transports but never
+imports Matplotlib. Each request is received and decoded into columns exactly like the real
+Python tool does, then acknowledged without plotting, so Bench_Latency.cpp can measure the
+IPC overhead of the library on its own. An image asked for in memory comes back blank, with
+the pixel size Matplotlib would give its default 6.4 x 4.8 inch figure, or empty for a PNG.
+
+The C/C++ library runs it instead of IPC_Plot.py when the IPC_PLOT_RENDERER environment
+variable holds the path of this script.
+
+"""
+
+# Standard libraries
+import os
+import sys
+
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "Python"))
+import IPC_Plot_Protocol as proto
+
+# Named pipes on Windows, socket and shared memory everywhere else
+if os.name == "nt":
+    import IPC_Plot_Pipe as pipe
+else:
+    import IPC_Plot_Socket as pipe
+
+def main():
+    """
+    Request loop of the stand-in, same as IPC_Plot.main() without the figure.
+
+    """
+    pipe.reportReady()
+    while True:
+        try:
+            tupleData = pipe.retrieveData()
+        except proto.ProtocolError as e:
+            pipe.reportError(repr(e), proto.LIB_ERR_PROTOCOL)
+            break
+        if tupleData is None:
+            break
+        if isinstance(tupleData, proto.LiveStream):
+            # Drained without drawing, as fast as the C/C++ library appends
+            pipe.updateStatus(proto.getReadTime())
+            try:
+                while not pipe.waitStreamEnd(0.001):
+                    tupleData.read()
+                tupleData.read()
+            except proto.ProtocolError as e:
+                pipe.reportError(repr(e), proto.LIB_ERR_PROTOCOL)
+                break
+            finally:
+                tupleData.close()
+            pipe.updateStatus()
+            continue
+        nColSize, nRowSize, aData, _, nXMode = tupleData
+        try:
+            # Same column view as IPC_Plot._processData(), which would pull in Matplotlib
+            dictColumns = {proto.X_NONE: nColSize, proto.X_PER_COLUMN: nColSize * 2, proto.X_SHARED: nColSize + 1}
+            aData.reshape((nRowSize, dictColumns[nXMode]), order="F")
+        except Exception as e:
+            pipe.reportError(repr(e))
+            continue
+        nOutput, nDpi = proto.getOutput()
+        if nOutput == proto.LIB_OUTPUT_RGBA:
+            nWidth, nHeight = int(6.4 * nDpi), int(4.8 * nDpi)
+            pipe.sendImage(nOutput, nWidth, nHeight, bytes(nWidth * nHeight * 4))
+        elif nOutput == proto.LIB_OUTPUT_PNG:
+            pipe.sendImage(nOutput, 0, 0, b"")
+        pipe.updateStatus(proto.getReadTime())
+
+if __name__ == '__main__':
+    """ Entry point """
+    main()
@@ -0,0 +1,264 @@
+/*******************************************************************************
+ * Bench_Transport.cpp
+ *
+ * Compares moving a buffer of doubles to another process through a plain
+ * pipe against the shared memory transport used by ipc_plot() on POSIX.
+ *
+ *   pipe      write() the caller's buffer into a pipe, reader copies it out
+ *             (what ipc_plot() does for an ordinary buffer, in chunks)
+ *   shm-copy  copy into a new segment per call and pass the descriptor
+ *   shm-alloc pass the descriptor of a buffer from ipc_plot_alloc()
+ *
+ * The reader sums every value it receives in all modes, so the numbers
+ * include the cost of the data actually reaching the other process.
+ ******************************************************************************/
+#ifndef _WIN32
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "IPC_Plot_Protocol.h"
+
+#define BENCH_TOTAL_BYTES (1ULL << 30) //!< Bytes moved per mode and size, sets the iteration count
+#define BENCH_MIN_ITERATIONS 5
+
+typedef enum BENCH_MODE { BENCH_PIPE, BENCH_SHM_COPY, BENCH_SHM_ALLOC } BENCH_MODE;
+
+static LIB_DOUBLE GetTimeSec(void)
+{
+	struct timespec stNow;
+	clock_gettime(CLOCK_MONOTONIC, &stNow);
+	return (LIB_DOUBLE)stNow.tv_sec + (LIB_DOUBLE)stNow.tv_nsec * 1e-9;
+}
+
+static void PipeWriteAll(LIB_INT32 nFd, const void* pvData, LIB_U64 u64Size)
+{
+	const LIB_CHAR* pcData = (const LIB_CHAR*)pvData;
+	while (u64Size > 0)
+	{
+		ssize_t nWritten = write(nFd, pcData, u64Size);
+		if (nWritten <= 0)
+		{
+			perror("write");
+			exit(1);
+		}
+		pcData += nWritten;
+		u64Size -= (LIB_U64)nWritten;
+	}
+}
+
+static void PipeReadAll(LIB_INT32 nFd, void* pvData, LIB_U64 u64Size)
+{
+	LIB_CHAR* pcData = (LIB_CHAR*)pvData;
+	while (u64Size > 0)
+	{
+		ssize_t nRead = read(nFd, pcData, u64Size);
+		if (nRead <= 0)
+		{
+			exit(0);
+		}
+		pcData += nRead;
+		u64Size -= (LIB_U64)nRead;
+	}
+}
+
+static LIB_DOUBLE SumDoubles(const LIB_DOUBLE* prgdData, LIB_U64 u64Count)
+{
+	LIB_DOUBLE dSum = 0.0;
+	for (LIB_U64 u64Index = 0; u64Index < u64Count; u64Index++)
+	{
+		dSum += prgdData[u64Index];
+	}
+	return dSum;
+}
+
+/***************************************************************************//**
+ * RunReader
+ *
+ * Child process loop. Receives a buffer per iteration, reads every value and
+ * answers with one byte so the writer can time the whole round trip.
+ ******************************************************************************/
+static void RunReader(BENCH_MODE enMode, LIB_INT32 nDataFd, LIB_INT32 nAckFd, LIB_U64 u64Count, LIB_U32 u32Iterations)
+{
+	LIB_ERROR_INFO stErr;
+	LIB_DOUBLE* prgdBuffer = (enMode == BENCH_PIPE) ? (LIB_DOUBLE*)malloc(u64Count * sizeof(LIB_DOUBLE)) : NULL;
+	volatile LIB_DOUBLE dSink = 0.0;
+	for (LIB_U32 u32Iter = 0; u32Iter < u32Iterations; u32Iter++)
+	{
+		if (enMode == BENCH_PIPE)
+		{
+			PipeReadAll(nDataFd, prgdBuffer, u64Count * sizeof(LIB_DOUBLE));
+			dSink = dSink + SumDoubles(prgdBuffer, u64Count);
+		}
+		else
+		{
+			// Control message with the segment descriptor attached
+			LIB_PLOT_HDR stCtrl;
+			LIB_CHAR rgcControl[CMSG_SPACE(sizeof(LIB_INT32))];
+			struct iovec stIov = { &stCtrl, sizeof(stCtrl) };
+			struct msghdr stMsg;
+			memset(&stMsg, 0, sizeof(stMsg));
+			stMsg.msg_iov = &stIov;
+			stMsg.msg_iovlen = 1;
+			stMsg.msg_control = rgcControl;
+			stMsg.msg_controllen = sizeof(rgcControl);
+			if (recvmsg(nDataFd, &stMsg, MSG_WAITALL) != (ssize_t)sizeof(stCtrl))
+			{
+				exit(0);
+			}
+			LIB_INT32 nShmFd;
+			memcpy(&nShmFd, CMSG_DATA(CMSG_FIRSTHDR(&stMsg)), sizeof(nShmFd));
+			LIB_U64 u64MapSize = stCtrl.u64ShmOffset + stCtrl.u64PayloadSize;
+			LIB_CHAR* pcBase = (LIB_CHAR*)mmap(NULL, u64MapSize, PROT_READ, MAP_SHARED, nShmFd, 0);
+			close(nShmFd);
+			dSink = dSink + SumDoubles((const LIB_DOUBLE*)(pcBase + stCtrl.u64ShmOffset), u64Count);
+			munmap(pcBase, u64MapSize);
+		}
+		LIB_CHAR cAck = 1;
+		if (SocketSendAll(nAckFd, &cAck, 1, -1, &stErr) != LIB_OK)
+		{
+			exit(1);
+		}
+	}
+	free(prgdBuffer);
+	exit(0);
+}
+
+/***************************************************************************//**
+ * RunMode
+ *
+ * Times u32Iterations transfers of u64Count doubles and prints one row.
+ ******************************************************************************/
+static void RunMode(BENCH_MODE enMode, LIB_U64 u64Count)
+{
+	static const LIB_CHAR* s_rgszModes[] = { "pipe", "shm-copy", "shm-alloc" };
+	LIB_ERROR_INFO stErr;
+	LIB_U64 u64Size = u64Count * sizeof(LIB_DOUBLE);
+	LIB_U32 u32Iterations = (LIB_U32)(BENCH_TOTAL_BYTES / u64Size);
+	if (u32Iterations < BENCH_MIN_ITERATIONS)
+	{
+		u32Iterations = BENCH_MIN_ITERATIONS;
+	}
+
+	LIB_INT32 rgnData[2], rgnAck[2];
+	if (enMode == BENCH_PIPE ? pipe(rgnData) != 0 : socketpair(AF_UNIX, SOCK_STREAM, 0, rgnData) != 0)
+	{
+		perror("pipe");
+		exit(1);
+	}
+	if (socketpair(AF_UNIX, SOCK_STREAM, 0, rgnAck) != 0)
+	{
+		perror("socketpair");
+		exit(1);
+	}
+
+	fflush(stdout);
+	pid_t nPid = fork();
+	if (nPid == 0)
+	{
+		close(rgnData[1]);
+		close(rgnAck[0]);
+		RunReader(enMode, rgnData[0], rgnAck[1], u64Count, u32Iterations);
+	}
+	close(rgnData[0]);
+	close(rgnAck[1]);
+
+	// The caller's buffer, either ordinary memory or from ipc_plot_alloc()
+	LIB_DOUBLE* prgdSource = NULL;
+	if (enMode == BENCH_SHM_ALLOC)
+	{
+		if (ipc_plot_alloc((LIB_U32)u64Count, &prgdSource, &stErr) != LIB_OK)
+		{
+			printf("%-10s failed: %s %s\n", s_rgszModes[enMode], stErr.szErrMsg, stErr.szRuntime);
+			exit(1);
+		}
+	}
+	else
+	{
+		prgdSource = (LIB_DOUBLE*)malloc(u64Size);
+	}
+	for (LIB_U64 u64Index = 0; u64Index < u64Count; u64Index++)
+	{
+		prgdSource[u64Index] = (LIB_DOUBLE)u64Index;
+	}
+	LIB_DOUBLE dStart = GetTimeSec();
+	for (LIB_U32 u32Iter = 0; u32Iter < u32Iterations; u32Iter++)
+	{
+		if (enMode == BENCH_PIPE)
+		{
+			PipeWriteAll(rgnData[1], prgdSource, u64Size);
+		}
+		else
+		{
+			LIB_SHM_INFO stShm = { -1, NULL, 0 };
+			LIB_PLOT_HDR stCtrl = { 1, (LIB_U32)u64Count, LIB_DTYPE_FLOAT64, LIB_PLOT_FLAG_SHM, u64Size, 0, LIB_OUTPUT_FILE, LIB_DEFAULT_DPI };
+			if (enMode == BENCH_SHM_COPY)
+			{
+				if (SharedMemCreate(u64Size, &stShm, &stErr) != LIB_OK)
+				{
+					printf("%-10s failed: %s %s\n", s_rgszModes[enMode], stErr.szErrMsg, stErr.szRuntime);
+					exit(1);
+				}
+				memcpy(stShm.pvBase, prgdSource, u64Size);
+			}
+			else
+			{
+				// Same lookup as ipc_plot(), which duplicates the segment descriptor per call
+				if (!FindSharedMem(prgdSource, u64Size, &stShm.nFd, &stCtrl.u64ShmOffset))
+				{
+					printf("%-10s failed: buffer not found in a shared memory segment\n", s_rgszModes[enMode]);
+					exit(1);
+				}
+			}
+			LIB_INT32 nRet = SocketSendAll(rgnData[1], &stCtrl, sizeof(stCtrl), stShm.nFd, &stErr);
+			SharedMemClose(&stShm);
+			if (nRet != LIB_OK)
+			{
+				printf("%-10s failed: %s %s\n", s_rgszModes[enMode], stErr.szErrMsg, stErr.szRuntime);
+				exit(1);
+			}
+		}
+		LIB_CHAR cAck;
+		if (SocketRecvAll(rgnAck[0], &cAck, 1, &stErr) != LIB_OK)
+		{
+			printf("%-10s failed: %s %s\n", s_rgszModes[enMode], stErr.szErrMsg, stErr.szRuntime);
+			exit(1);
+		}
+	}
+	LIB_DOUBLE dElapsed = GetTimeSec() - dStart;
+
+	printf("%-10s %10llu %10u %14.1f %12.1f\n", s_rgszModes[enMode], u64Count, u32Iterations,
+		dElapsed / u32Iterations * 1e6, (LIB_DOUBLE)u64Size * u32Iterations / dElapsed / 1e6);
+
+	close(rgnData[1]);
+	close(rgnAck[0]);
+	waitpid(nPid, NULL, 0);
+	if (enMode == BENCH_SHM_ALLOC)
+	{
+		ipc_plot_free(prgdSource);
+	}
+	else
+	{
+		free(prgdSource);
+	}
+}
+
+int main(void)
+{
+	static const LIB_U64 s_rgu64Counts[] = { 1000, 10000, 100000, 1000000, 10000000 };
+	printf("%-10s %10s %10s %14s %12s\n", "mode", "doubles", "calls", "us/call", "MB/s");
+	for (LIB_U32 u32Size = 0; u32Size < sizeof(s_rgu64Counts) / sizeof(s_rgu64Counts[0]); u32Size++)
+	{
+		RunMode(BENCH_PIPE, s_rgu64Counts[u32Size]);
+		RunMode(BENCH_SHM_COPY, s_rgu64Counts[u32Size]);
+		RunMode(BENCH_SHM_ALLOC, s_rgu64Counts[u32Size]);
+	}
+	return 0;
+}
+
+#endif // !_WIN32
@@ -1,40 +1,224 @@
 #pragma once
 
-#ifdef LIB_EXPORT
-#    define LIB_API __declspec(dllexport)
+#include <string.h>
+
+#ifdef _WIN32
+#    ifdef LIB_EXPORT
+#        define LIB_API __declspec(dllexport)
+#    else
+#        define LIB_API __declspec(dllimport)
+#    endif
 #else
-#    define LIB_API __declspec(dllimport)
+#    define LIB_API __attribute__((visibility("default")))
 #endif
 
-#define LIB_MAX_DATA_SIZE 131072 //!< 1 MB of doubles over pipe
+#define LIB_MAX_DATA_SIZE 131072 //!< Former limit of 1 MB of doubles, larger buffers are now streamed
 #define LIB_MAX_BUFFER_SIZE 1024 //!< Maximum buffer size for error messages
 #define LIB_MAX_LABEL_SIZE 128   //!< Maximum buffer size for data column labels
 
 #define LIB_OK 0
 #define LIB_ERR 1
 
+// Decimation of each column before it is sent to the Python tool, see LIB_INPUT
+#define LIB_DECIMATE_NONE   0    //!< Send every sample (default)
+#define LIB_DECIMATE_MINMAX 1    //!< Minimum and maximum of each bucket, keeps the envelope of the signal
+#define LIB_DECIMATE_LTTB   2    //!< Largest-Triangle-Three-Buckets, keeps the visual shape of the line
+#define LIB_DEFAULT_MAX_POINTS 4000 //!< Points per column after decimation if u32MaxPoints is 0
+
+// Sample types of LIB_COLUMN
+#define LIB_DTYPE_FLOAT64 0 //!< LIB_DOUBLE
+#define LIB_DTYPE_FLOAT32 1 //!< LIB_FLOAT
+#define LIB_DTYPE_INT16   2 //!< LIB_INT16, e.g. raw ADC counts
+#define LIB_DTYPE_INT32   3 //!< LIB_INT32
+
+// Renderer of a plot, see LIB_INPUT
+#define LIB_BACKEND_PYTHON 0 //!< Python tool with Matplotlib, the reference figure (default)
+#define LIB_BACKEND_NATIVE 1 //!< Drawn in this process, same layout with a bitmap font, no Python needed
+
+// Destination of the figure, see LIB_INPUT
+#define LIB_OUTPUT_FILE 0 //!< IMG_<date>_<time>.png in the working directory of the renderer (default)
+#define LIB_OUTPUT_PNG  1 //!< PNG bytes returned in LIB_INPUT::pstImage, no file written
+#define LIB_OUTPUT_RGBA 2 //!< 8-bit R, G, B, A pixels from the top row down returned in LIB_INPUT::pstImage
+#define LIB_DEFAULT_DPI 200  //!< Resolution of the 6.4 x 4.8 inch figure if u32Dpi is 0
+#define LIB_MIN_DPI     10
+#define LIB_MAX_DPI     1200
+
 #include "IPC_Plot_Error.h"
 
 //!<  Datatypes
 typedef char                LIB_CHAR;   //!< 8-bit signed char
+typedef unsigned short      LIB_U16;    //!< 16-bit unsigned integer
+typedef short               LIB_INT16;  //!< 16-bit signed integer
 typedef unsigned int		LIB_U32;    //!< 32-bit unsigned integer
 typedef int 		        LIB_INT32;  //!< 32-bit signed integer
+typedef unsigned long long  LIB_U64;    //!< 64-bit unsigned integer
 typedef float				LIB_FLOAT;  //!< 32-bit single-precision float
 typedef double				LIB_DOUBLE; //!< 64-bit double-precision double 
 typedef enum LIB_BOOLEAN { LIB_FALSE, LIB_TRUE } LIB_BOOLEAN;
 
+// A column of samples in its own type, sent to the Python tool without conversion
+typedef struct LIB_COLUMN
+{
+	const void* pvData;           //!< First of u32RowSize samples of u32Dtype, e.g. a member of the first of an array of structs
+	LIB_U32 u32Dtype;             //!< LIB_DTYPE_*
+	LIB_U32 u32Stride;            //!< Bytes from one sample to the next, e.g. the size of the struct, 0 for packed samples
+	LIB_DOUBLE dScale;            //!< Plotted value is sample * dScale + dOffset, e.g. volts per ADC count
+	LIB_DOUBLE dOffset;           //!< Added after scaling
+	LIB_COLUMN()
+	{
+		memset(this, 0, sizeof(*this));
+		dScale = 1.0;
+	}
+} LIB_COLUMN;
+
+// A column of samples in a binary file, see LIB_FILE_INPUT
+typedef struct LIB_FILE_COLUMN
+{
+	LIB_U64 u64Offset;            //!< Byte offset of the first sample in the file, e.g. header size plus offset of the member
+	LIB_U32 u32Dtype;             //!< LIB_DTYPE_*
+	LIB_U32 u32Stride;            //!< Bytes from one sample to the next, e.g. the size of a record, 0 for packed samples
+	LIB_DOUBLE dScale;            //!< Plotted value is sample * dScale + dOffset
+	LIB_DOUBLE dOffset;           //!< Added after scaling
+	LIB_FILE_COLUMN()
+	{
+		memset(this, 0, sizeof(*this));
+		dScale = 1.0;
+	}
+} LIB_FILE_COLUMN;
+
+// Columns read from a binary file mapped into memory instead of the caller's buffers. Only the
+// pages holding the samples are read, and with decimation only a window of them at a time is
+// converted, so the memory needed does not grow with the file. u32RowSize 0 plots as many rows
+// as every column has in the file.
+typedef struct LIB_FILE_INPUT
+{
+	const LIB_CHAR* pszPath;      //!< File with the samples, opened read-only
+	const LIB_FILE_COLUMN* prgstColumns; //!< u32ColSize columns in the file
+	const LIB_FILE_COLUMN* pstXColumn;   //!< X values of every column in the file, NULL for the sample index
+	LIB_FILE_INPUT()
+	{
+		memset(this, 0, sizeof(*this));
+	}
+} LIB_FILE_INPUT;
+
+// Timings of one plot, filled in when LIB_INPUT::pstStats is set. Times are in milliseconds.
+typedef struct LIB_PLOT_STATS
+{
+	LIB_DOUBLE dQueueMs;          //!< Waiting for admission of ipc_plot(), see ipc_plot_concurrency_config()
+	LIB_DOUBLE dSpawnMs;          //!< Starting the Python tool, 0 when plotting in an open session or a ready one
+	LIB_DOUBLE dConnectMs;        //!< Waiting for the Python tool to connect and import its modules, 0 when plotting in an open session
+	LIB_DOUBLE dDecimateMs;       //!< Decimating the columns, 0 without decimation
+	LIB_DOUBLE dSendMs;           //!< Writing the request and data until the Python tool has taken all of it
+	LIB_DOUBLE dRenderMs;         //!< Waiting for the status of the Python tool after sending
+	LIB_DOUBLE dCloseMs;          //!< Waiting for the Python tool to exit, 0 when plotting in an open session or a ready one
+	LIB_DOUBLE dTotalMs;          //!< Whole call
+	LIB_U64 u64BytesSent;         //!< Bytes written to the Python tool, shared memory not included
+	LIB_U64 u64BytesReceived;     //!< Bytes read from the Python tool
+	LIB_DOUBLE dRendererDecodeMs; //!< Reported by the Python tool: receiving and decoding the data
+	LIB_DOUBLE dRendererPlotMs;   //!< Reported by the Python tool: creating the figure
+	LIB_DOUBLE dRendererSaveMs;   //!< Reported by the Python tool: savefig()
+	LIB_DOUBLE dCacheMs;          //!< Hashing the input and looking it up in the render cache, 0 with the cache off
+	LIB_BOOLEAN bCacheHit;        //!< The image came from the render cache, no renderer was used
+	LIB_PLOT_STATS()
+	{
+		memset(this, 0, sizeof(*this));
+	}
+} LIB_PLOT_STATS;
+
+// Image returned by a plot with LIB_OUTPUT_PNG or LIB_OUTPUT_RGBA. Either the caller passes its own
+// buffer in pcData, or leaves pcData NULL and the library allocates one, which is reused by later
+// plots into the same structure and freed with ipc_plot_image_free().
+typedef struct LIB_IMAGE
+{
+	LIB_CHAR* pcData;             //!< Caller's buffer of u64Capacity bytes, or NULL to have the library allocate one
+	LIB_U64 u64Capacity;          //!< Bytes available at pcData
+	LIB_U64 u64Size;              //!< Bytes of the image, also set when the caller's buffer is too small
+	LIB_U32 u32Width;             //!< Pixels
+	LIB_U32 u32Height;
+	LIB_U32 u32Format;            //!< LIB_OUTPUT_PNG or LIB_OUTPUT_RGBA
+	LIB_BOOLEAN bAllocated;       //!< pcData was allocated by the library
+	LIB_IMAGE()
+	{
+		memset(this, 0, sizeof(*this));
+	}
+} LIB_IMAGE;
+
+// Totals of every plot of the process, see ipc_plot_get_counters()
+typedef struct LIB_PLOT_COUNTERS
+{
+	LIB_U64 u64Calls;             //!< ipc_plot() and ipc_plot_session_plot() calls, including those made by the async and batch API
+	LIB_U64 u64Failures;          //!< Calls that returned LIB_ERR
+	LIB_U64 u64Timeouts;          //!< Failures with LIB_ERR_SERVER_TIMEOUT
+	LIB_U64 u64Rejected;          //!< Failures with LIB_ERR_BUSY, refused or dropped by the admission queue
+	LIB_U64 u64BytesSent;
+	LIB_U64 u64BytesReceived;
+	LIB_U64 u64PeakActive;        //!< Most ipc_plot() calls admitted at the same time
+	LIB_U64 u64CacheHits;         //!< Plots answered by the render cache, see ipc_plot_cache_config()
+	LIB_U64 u64CacheMisses;       //!< Plots looked up in the render cache and rendered
+	LIB_U64 u64CacheEvictions;    //!< Images dropped from the render cache to stay within its limits
+	LIB_U64 u64CacheEntries;      //!< Images in the render cache now
+	LIB_U64 u64CacheBytes;        //!< Bytes of those images
+	LIB_PLOT_COUNTERS()
+	{
+		memset(this, 0, sizeof(*this));
+	}
+} LIB_PLOT_COUNTERS;
+
 typedef struct LIB_INPUT
 {
 	LIB_U32 u32ColSize;           //!< Number of columns for plotting
 	LIB_U32 u32RowSize;           //!< Number of rows of data each column
 	const LIB_CHAR** prgszLabels; //!< Pointer to char array with labels for each column
 	LIB_DOUBLE* prgdBuffer;       //!< Pointer to double-precision data buffer 
+	LIB_U32 u32Decimation;        //!< LIB_DECIMATE_*, columns longer than u32MaxPoints are reduced before sending
+	LIB_U32 u32MaxPoints;         //!< Points per column after decimation, at least 4, 0 for LIB_DEFAULT_MAX_POINTS
+	const LIB_COLUMN* prgstColumns; //!< u32ColSize typed columns used instead of prgdBuffer, NULL for prgdBuffer
+	LIB_PLOT_STATS* pstStats;     //!< Receives the timings of the plot, may be NULL, must outlive an async plot
+	LIB_U32 u32Backend;           //!< LIB_BACKEND_*, renderer of the figure
+	LIB_U32 u32Output;            //!< LIB_OUTPUT_*, file or image returned in pstImage
+	LIB_U32 u32Dpi;               //!< Resolution of the figure, LIB_MIN_DPI to LIB_MAX_DPI, 0 for LIB_DEFAULT_DPI
+	LIB_IMAGE* pstImage;          //!< Receives the image unless u32Output is LIB_OUTPUT_FILE, must outlive an async plot
+	const LIB_COLUMN* pstXColumn; //!< X values of every column, e.g. timestamps, NULL for the sample index
+	const LIB_FILE_INPUT* pstFile; //!< Columns in a file used instead of prgdBuffer, prgstColumns and pstXColumn, NULL for memory
 	LIB_INPUT()
 	{
 		memset(this, 0, sizeof(*this));
 	}
 } LIB_INPUT;
 
+typedef struct LIB_SESSION LIB_SESSION; //!< Opaque handle to a running Python tool
+typedef struct LIB_PLOT_HANDLE LIB_PLOT_HANDLE; //!< Opaque handle to a plot started with ipc_plot_async()
+typedef struct LIB_STREAM LIB_STREAM; //!< Opaque handle to a live figure opened with ipc_plot_stream_open()
+
+// Buffer ownership of ipc_plot_async()
+#define LIB_ASYNC_COPY   0 //!< The data and labels are copied before returning, the caller may reuse them at once
+#define LIB_ASYNC_BORROW 1 //!< The data and labels are used in place and must stay valid until the plot completes
+
+#define LIB_WAIT_INFINITE 0xFFFFFFFF //!< Timeout of ipc_plot_wait() that never expires
+
+// Python tools kept ready for ipc_plot(), see ipc_plot_pool_config()
+#define LIB_POOL_DEFAULT_SIZE    1     //!< Python tools kept ready unless changed with ipc_plot_pool_config()
+#define LIB_POOL_DEFAULT_IDLE_MS 60000 //!< Time without ipc_plot() after which the ready Python tools are stopped
+#define LIB_POOL_MAX_SIZE        16
+
+// Admission of ipc_plot() calls beyond the concurrency limit, see ipc_plot_concurrency_config()
+#define LIB_ADMIT_BLOCK       0  //!< Wait until the queue has room (default)
+#define LIB_ADMIT_FAIL_FAST   1  //!< Fail with LIB_ERR_BUSY when the queue is full
+#define LIB_ADMIT_DROP_OLDEST 2  //!< Fail the call waiting longest with LIB_ERR_BUSY and queue the new one
+#define LIB_ADMIT_DEFAULT_QUEUE 64 //!< Calls waiting for admission unless changed with ipc_plot_concurrency_config()
+
+// Frame rate of the live figure of ipc_plot_stream_open()
+#define LIB_STREAM_DEFAULT_FPS 10 //!< Used when u32MaxFps is 0
+#define LIB_STREAM_MAX_FPS     60
+
+// Render cache of ipc_plot() and ipc_plot_session_plot(), see ipc_plot_cache_config()
+#define LIB_CACHE_DEFAULT_BYTES (64ULL << 20) //!< Image bytes kept when u64MaxBytes is 0
+
+// Spool log of ipc_plot(), see ipc_plot_spool_config()
+#define LIB_SPOOL_DEFAULT_BUFFER (4ULL << 20) //!< Bytes of each of the two write buffers when u64BufferSize is 0
+
+#define LIB_TRACE_MAX_EVENTS 100000 //!< Events kept by ipc_plot_trace_enable() until the next ipc_plot_trace_dump()
+
 typedef struct LIB_ERROR_INFO
 {
 	LIB_U32 u32ErrCode;                      //!< Refer to IPC_Plot_Error.h for error codes
@@ -47,14 +231,369 @@ typedef struct LIB_ERROR_INFO
 	}
 } LIB_ERROR_INFO;
 
+//!< Completion callback of ipc_plot_async(), runs on a library thread and must not block for long
+typedef void (*LIB_PLOT_CALLBACK)(LIB_PLOT_HANDLE* pstHandle, const LIB_ERROR_INFO* pstResult, void* pvUser);
+
 /***************************************************************************//**
  * ipc_plot
  *
  * API for interfacing the Python tool. Plots data from a buffer and into a 
  * graph figure and saves the figure created as an image file.
  *
+ * The plot is sent to a Python tool the library keeps ready in its pool, so
+ * that only the first call, or the first after the pool was idle, pays for 
+ * starting Python and importing Matplotlib. See ipc_plot_pool_config().
+ *
+ * ipc_plot() may be called from any number of threads at once, each with 
+ * its own LIB_ERROR_INFO. At most as many calls as the concurrency limit 
+ * plot at the same time, the others wait in the admission queue. See 
+ * ipc_plot_concurrency_config().
+ *
+ * With u32Backend set to LIB_BACKEND_NATIVE the figure is drawn and saved by
+ * the library itself, without a Python tool. It is faster but plainer than
+ * the Matplotlib figure.
+ *
+ * With u32Output set to LIB_OUTPUT_PNG or LIB_OUTPUT_RGBA no file is 
+ * written, the encoded image is returned in pstImage instead.
+ *
+ * With pstFile set the columns are read from a file mapped into memory, see
+ * LIB_FILE_INPUT. Combined with decimation this plots files larger than the
+ * memory of the machine.
+ *
  * @param pstInput Input structure including data buffer and labels
  * @param pstErr   Error information structure for logging any errors
  * @return         LIB_OK if success, else LIB_ERR if any error occurred
  ******************************************************************************/
 LIB_U32 LIB_API ipc_plot(LIB_INPUT* pstInput, LIB_ERROR_INFO* pstErr);
+
+/***************************************************************************//**
+ * ipc_plot_session_open
+ *
+ * Starts the Python tool once and keeps it connected, so that plots sent with
+ * ipc_plot_session_plot() do not pay for starting Python and importing 
+ * Matplotlib again. A session must only be used by one thread at a time.
+ *
+ * @param ppstOutSession Receives the session handle
+ * @param pstErr         Error information structure for logging any errors
+ * @return               LIB_OK if success, else LIB_ERR if any error occurred
+ ******************************************************************************/
+LIB_U32 LIB_API ipc_plot_session_open(LIB_SESSION** ppstOutSession, LIB_ERROR_INFO* pstErr);
+
+/***************************************************************************//**
+ * ipc_plot_session_plot
+ *
+ * Plots data from a buffer with the Python tool of an open session. Same 
+ * input and result as ipc_plot().
+ *
+ * @param pstSession Session from ipc_plot_session_open()
+ * @param pstInput   Input structure including data buffer and labels
+ * @param pstErr     Error information structure for logging any errors
+ * @return           LIB_OK if success, else LIB_ERR if any error occurred
+ ******************************************************************************/
+LIB_U32 LIB_API ipc_plot_session_plot(LIB_SESSION* pstSession, LIB_INPUT* pstInput, LIB_ERROR_INFO* pstErr);
+
+/***************************************************************************//**
+ * ipc_plot_session_close
+ *
+ * Ends the session and waits for the Python tool to exit. Passing NULL is a 
+ * no-op.
+ *
+ * @param pstSession Session from ipc_plot_session_open()
+ ******************************************************************************/
+void LIB_API ipc_plot_session_close(LIB_SESSION* pstSession);
+
+/***************************************************************************//**
+ * ipc_plot_alloc
+ *
+ * Allocates a data buffer that can be handed to the Python tool without 
+ * copying. On POSIX the buffer lives in a shared memory segment which the 
+ * Python tool maps directly, so filling it in place and passing it as 
+ * prgdBuffer avoids every copy of the data. On Windows the buffer is 
+ * ordinary heap memory and is sent over the named pipe as usual.
+ *
+ * @param u32Count       Number of doubles in the buffer (columns * rows)
+ * @param pprgdOutBuffer Receives the pointer to the buffer
+ * @param pstErr         Error information structure for logging any errors
+ * @return               LIB_OK if success, else LIB_ERR if any error occurred
+ ******************************************************************************/
+LIB_U32 LIB_API ipc_plot_alloc(LIB_U32 u32Count, LIB_DOUBLE** pprgdOutBuffer, LIB_ERROR_INFO* pstErr);
+
+/***************************************************************************//**
+ * ipc_plot_free
+ *
+ * Releases a buffer returned by ipc_plot_alloc(). Passing NULL is a no-op.
+ *
+ * @param prgdBuffer Buffer returned by ipc_plot_alloc()
+ ******************************************************************************/
+void LIB_API ipc_plot_free(LIB_DOUBLE* prgdBuffer);
+
+/***************************************************************************//**
+ * ipc_plot_image_free
+ *
+ * Releases the buffer the library allocated for an image and clears the 
+ * structure. A buffer of the caller is left alone. Passing NULL is a no-op.
+ *
+ * @param pstImage Image filled in by a plot
+ ******************************************************************************/
+void LIB_API ipc_plot_image_free(LIB_IMAGE* pstImage);
+
+/***************************************************************************//**
+ * ipc_plot_async
+ *
+ * Starts ipc_plot() on a background thread owned by the library and returns
+ * without waiting for the Python tool. The input is validated before 
+ * returning; everything else, including errors from the Python tool, is 
+ * reported as the result of the handle.
+ *
+ * @param pstInput      Input structure including data buffer and labels
+ * @param u32Mode       LIB_ASYNC_COPY or LIB_ASYNC_BORROW
+ * @param pfnCallback   Called with the result once the plot completes, may be NULL
+ * @param pvUser        Passed to pfnCallback
+ * @param ppstOutHandle Receives the handle, release it with ipc_plot_release().
+ *                      May be NULL if only the callback is of interest.
+ * @param pstErr        Error information structure for logging any errors
+ * @return              LIB_OK if the plot was started, else LIB_ERR
+ ******************************************************************************/
+LIB_U32 LIB_API ipc_plot_async(LIB_INPUT* pstInput, LIB_U32 u32Mode, LIB_PLOT_CALLBACK pfnCallback, void* pvUser,
+	LIB_PLOT_HANDLE** ppstOutHandle, LIB_ERROR_INFO* pstErr);
+
+/***************************************************************************//**
+ * ipc_plot_wait
+ *
+ * Waits for a plot started with ipc_plot_async() to complete
+ *
+ * @param pstHandle    Handle from ipc_plot_async()
+ * @param u32TimeoutMs Longest time to wait, 0 to poll, LIB_WAIT_INFINITE to wait until completion
+ * @param pstOutResult Receives the result, same as the error information of ipc_plot(). May be NULL.
+ * @return             LIB_OK if the plot has completed, LIB_ERR if it is still running
+ ******************************************************************************/
+LIB_U32 LIB_API ipc_plot_wait(LIB_PLOT_HANDLE* pstHandle, LIB_U32 u32TimeoutMs, LIB_ERROR_INFO* pstOutResult);
+
+/***************************************************************************//**
+ * ipc_plot_poll
+ *
+ * Checks whether a plot started with ipc_plot_async() has completed, 
+ * without waiting. Same as ipc_plot_wait() with a timeout of 0.
+ *
+ * @param pstHandle    Handle from ipc_plot_async()
+ * @param pstOutResult Receives the result if the plot has completed. May be NULL.
+ * @return             LIB_OK if the plot has completed, LIB_ERR if it is still running
+ ******************************************************************************/
+LIB_U32 LIB_API ipc_plot_poll(LIB_PLOT_HANDLE* pstHandle, LIB_ERROR_INFO* pstOutResult);
+
+/***************************************************************************//**
+ * ipc_plot_release
+ *
+ * Releases a handle from ipc_plot_async(). A plot still running is not 
+ * cancelled, it completes in the background and its callback is still 
+ * called. Passing NULL is a no-op.
+ *
+ * @param pstHandle Handle from ipc_plot_async()
+ ******************************************************************************/
+void LIB_API ipc_plot_release(LIB_PLOT_HANDLE* pstHandle);
+
+/***************************************************************************//**
+ * ipc_plot_batch
+ *
+ * Plots many inputs in parallel. Each worker thread keeps one Python tool 
+ * running and takes the next job from a shared queue until all are done, so 
+ * the Python start-up is paid once per worker instead of once per plot.
+ *
+ * @param prgstInputs     Array of u32Count input structures
+ * @param u32Count        Number of jobs
+ * @param u32Workers      Number of Python tools, 0 for the number of cores
+ * @param prgstOutResults Receives the result of each job, same as the error 
+ *                        information of ipc_plot(). May be NULL.
+ * @param pstErr          Error information structure, receives the first 
+ *                        failed job if any
+ * @return                LIB_OK if every job succeeded, else LIB_ERR
+ ******************************************************************************/
+LIB_U32 LIB_API ipc_plot_batch(LIB_INPUT* prgstInputs, LIB_U32 u32Count, LIB_U32 u32Workers,
+	LIB_ERROR_INFO* prgstOutResults, LIB_ERROR_INFO* pstErr);
+
+/***************************************************************************//**
+ * ipc_plot_cache_config
+ *
+ * Turns the render cache on or off. With the cache on, ipc_plot() and 
+ * ipc_plot_session_plot() hash the data, labels, sizes and render options 
+ * of each plot; a plot seen before is answered with its cached image, 
+ * copied into pstImage or saved as a new file, without admission or a 
+ * renderer. The least recently used images are dropped beyond either 
+ * limit. The cache is off by default. Plots of a file (LIB_FILE_INPUT) are
+ * never cached, hashing would read the whole file.
+ *
+ * @param u32MaxEntries Most images kept, 0 to turn the cache off and drop them
+ * @param u64MaxBytes   Most image bytes kept, 0 for LIB_CACHE_DEFAULT_BYTES
+ * @param pstErr        Error information structure for logging any errors
+ * @return              LIB_OK if success, else LIB_ERR if any error occurred
+ ******************************************************************************/
+LIB_U32 LIB_API ipc_plot_cache_config(LIB_U32 u32MaxEntries, LIB_U64 u64MaxBytes, LIB_ERROR_INFO* pstErr);
+
+/***************************************************************************//**
+ * ipc_plot_spool_config
+ *
+ * Opens or closes the spool log. While a log is open, ipc_plot() and 
+ * ipc_plot_async() render nothing: each plot is appended to the log as the
+ * Python tool would receive it, header, labels and data, and is rendered 
+ * later with IPC_Plot_Replay.py, on any machine. The record is only copied
+ * into one of two buffers, a library thread writes the other to the file, 
+ * so a call waits for the disk only when it outruns it. Data is decimated 
+ * and files (LIB_FILE_INPUT) are read before spooling, the cache, the 
+ * admission and the backend do not apply, and pstImage receives no image.
+ * Sessions and ipc_plot_batch() are not affected.
+ *
+ * An existing log is appended to. After a crash, the records written in 
+ * full are kept and the rest is cut off. Plots still in the buffers when 
+ * the process exits are lost, close the log or ipc_plot_spool_flush() it.
+ *
+ * @param pszPath       Log to append to, created if needed, NULL to write 
+ *                      and close the open log
+ * @param u64BufferSize Bytes of each buffer, 0 for LIB_SPOOL_DEFAULT_BUFFER
+ * @param pstErr        Error information structure for logging any errors
+ * @return              LIB_OK if success, else LIB_ERR if any error occurred
+ ******************************************************************************/
+LIB_U32 LIB_API ipc_plot_spool_config(const LIB_CHAR* pszPath, LIB_U64 u64BufferSize, LIB_ERROR_INFO* pstErr);
+
+/***************************************************************************//**
+ * ipc_plot_spool_flush
+ *
+ * Indexes the plots spooled so far and waits until they are written to the
+ * log, so that it can be replayed while the process goes on spooling
+ *
+ * @param pstErr Error information structure for logging any errors
+ * @return       LIB_OK if success, else LIB_ERR if any error occurred
+ ******************************************************************************/
+LIB_U32 LIB_API ipc_plot_spool_flush(LIB_ERROR_INFO* pstErr);
+
+/***************************************************************************//**
+ * ipc_plot_get_counters
+ *
+ * Reads the totals of every plot made by the process since it started. The
+ * counters are updated atomically and can be read from any thread.
+ *
+ * @param pstOutCounters Receives the counters
+ ******************************************************************************/
+void LIB_API ipc_plot_get_counters(LIB_PLOT_COUNTERS* pstOutCounters);
+
+/***************************************************************************//**
+ * ipc_plot_trace_enable
+ *
+ * Starts or stops recording the phases of every plot as trace events. 
+ * Recording is off by default and stops by itself once the buffer holds 
+ * LIB_TRACE_MAX_EVENTS events.
+ *
+ * @param bEnable LIB_TRUE to record, LIB_FALSE to stop
+ ******************************************************************************/
+void LIB_API ipc_plot_trace_enable(LIB_BOOLEAN bEnable);
+
+/***************************************************************************//**
+ * ipc_plot_trace_dump
+ *
+ * Writes the recorded events to a file in the Chrome trace-event JSON 
+ * format, which chrome://tracing and Perfetto open directly, and clears 
+ * the buffer. Recording is left as it is.
+ *
+ * @param pszPath Path of the JSON file
+ * @param pstErr  Error information structure for logging any errors
+ * @return        LIB_OK if success, else LIB_ERR if any error occurred
+ ******************************************************************************/
+LIB_U32 LIB_API ipc_plot_trace_dump(const LIB_CHAR* pszPath, LIB_ERROR_INFO* pstErr);
+
+/***************************************************************************//**
+ * ipc_plot_pool_config
+ *
+ * Sets how many Python tools the library keeps ready for ipc_plot() and 
+ * ipc_plot_async(). The tools are started in the background at once and 
+ * replaced when one is lost, and they are stopped once no plot has been 
+ * made for u32IdleTimeoutMs. A size of 0 starts a new Python tool for every
+ * plot, as before the pool existed. Sessions and ipc_plot_batch() are not 
+ * affected.
+ *
+ * @param u32Size          Number of Python tools, 0 to LIB_POOL_MAX_SIZE 
+ *                         (default LIB_POOL_DEFAULT_SIZE)
+ * @param u32IdleTimeoutMs Idle time before the tools are stopped, 
+ *                         LIB_WAIT_INFINITE to keep them until the process 
+ *                         exits (default LIB_POOL_DEFAULT_IDLE_MS)
+ * @param pstErr           Error information structure for logging any errors
+ * @return                 LIB_OK if success, else LIB_ERR if any error occurred
+ ******************************************************************************/
+LIB_U32 LIB_API ipc_plot_pool_config(LIB_U32 u32Size, LIB_U32 u32IdleTimeoutMs, LIB_ERROR_INFO* pstErr);
+
+/***************************************************************************//**
+ * ipc_plot_concurrency_config
+ *
+ * Limits how many ipc_plot() calls plot at the same time, each with a 
+ * Python tool of its own, so that many threads cannot start more Python 
+ * tools than there are cores. Calls beyond the limit wait for admission in 
+ * the order they arrive, in a queue of u32QueueLength places; u32Policy 
+ * decides what happens to a call finding the queue full. A queue length of
+ * 0 holds no call: with LIB_ADMIT_FAIL_FAST or LIB_ADMIT_DROP_OLDEST every
+ * call beyond the limit fails at once with LIB_ERR_BUSY, with 
+ * LIB_ADMIT_BLOCK it still waits. ipc_plot_async() is subject to the same
+ * limit, sessions and ipc_plot_batch() are not.
+ *
+ * @param u32MaxActive   Calls plotting at the same time, 0 for the number of 
+ *                       cores (default)
+ * @param u32QueueLength Calls waiting for admission, 0 for none (default 
+ *                       LIB_ADMIT_DEFAULT_QUEUE)
+ * @param u32Policy      LIB_ADMIT_BLOCK, LIB_ADMIT_FAIL_FAST or 
+ *                       LIB_ADMIT_DROP_OLDEST (default LIB_ADMIT_BLOCK)
+ * @param pstErr         Error information structure for logging any errors
+ * @return               LIB_OK if success, else LIB_ERR if any error occurred
+ ******************************************************************************/
+LIB_U32 LIB_API ipc_plot_concurrency_config(LIB_U32 u32MaxActive, LIB_U32 u32QueueLength, LIB_U32 u32Policy,
+	LIB_ERROR_INFO* pstErr);
+
+/***************************************************************************//**
+ * ipc_plot_stream_open
+ *
+ * Starts a Python tool showing a live figure of u32ColSize lines. Rows are 
+ * added with ipc_plot_stream_append() into a ring buffer of u32Capacity rows
+ * in shared memory, which the Python tool drains on its own. It redraws the
+ * figure at most u32MaxFps times a second, only when rows were added, and 
+ * replaces a LIVE_<date>_<time>.png image with every frame. The figure shows
+ * the last u32Capacity rows against their row number since the stream was 
+ * opened.
+ *
+ * @param u32ColSize    Number of columns, i.e. values in each row
+ * @param prgszLabels   Label of each column
+ * @param u32Capacity   Rows of the ring buffer, also the rows shown
+ * @param u32MaxFps     Highest frame rate, 0 for LIB_STREAM_DEFAULT_FPS, at
+ *                      most LIB_STREAM_MAX_FPS
+ * @param ppstOutStream Receives the stream handle
+ * @param pstErr        Error information structure for logging any errors
+ * @return              LIB_OK if success, else LIB_ERR if any error occurred
+ ******************************************************************************/
+LIB_U32 LIB_API ipc_plot_stream_open(LIB_U32 u32ColSize, const LIB_CHAR** prgszLabels, LIB_U32 u32Capacity, 
+	LIB_U32 u32MaxFps, LIB_STREAM** ppstOutStream, LIB_ERROR_INFO* pstErr);
+
+/***************************************************************************//**
+ * ipc_plot_stream_append
+ *
+ * Adds rows to a live figure without waiting for the Python tool: the rows
+ * are copied into the ring buffer and published with a single atomic store.
+ * Rows that do not fit, because the Python tool has fallen a whole ring 
+ * behind, are dropped. Only one thread at a time may append to a stream.
+ *
+ * @param pstStream       Stream from ipc_plot_stream_open()
+ * @param prgdRows        u32Rows rows of u32ColSize doubles each, row after row
+ * @param u32Rows         Number of rows
+ * @param pu32OutAppended Receives the number of rows appended, may be NULL
+ * @param pstErr          Error information structure for logging any errors
+ * @return                LIB_OK if success, else LIB_ERR if any error occurred
+ ******************************************************************************/
+LIB_U32 LIB_API ipc_plot_stream_append(LIB_STREAM* pstStream, const LIB_DOUBLE* prgdRows, LIB_U32 u32Rows,
+	LIB_U32* pu32OutAppended, LIB_ERROR_INFO* pstErr);
+
+/***************************************************************************//**
+ * ipc_plot_stream_close
+ *
+ * Waits for the Python tool to draw the rows appended last, then ends it and
+ * frees the stream. The image of the last frame is left in place.
+ *
+ * @param pstStream Stream from ipc_plot_stream_open(), NULL is a no-op
+ * @param pstErr    Error information structure for logging any errors
+ * @return          LIB_OK if success, else LIB_ERR if the Python tool failed
+ *                  to draw the figure
+ ******************************************************************************/
+LIB_U32 LIB_API ipc_plot_stream_close(LIB_STREAM* pstStream, LIB_ERROR_INFO* pstErr);
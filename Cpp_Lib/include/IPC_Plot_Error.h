@@ -28,4 +28,36 @@
 #define LIB_ERR_NOT_FIRST_ERROR_MSG             "An error occurred earlier without logging any error info"
 #define LIB_ERR_NOT_FIRST_ERROR_ACT             "Ensure the error is logged properly"
 
+#define LIB_ERR_POSIX_API_ERR                   0x00070000
+#define LIB_ERR_POSIX_API_ERR_MSG               "Error occurred while calling POSIX API"
+#define LIB_ERR_POSIX_API_ERR_ACT               "errno returned with "
+
+#define LIB_ERR_CLIENT_EXITED                   0x00080000
+#define LIB_ERR_CLIENT_EXITED_MSG               "The Python client exited before reporting its status"
+#define LIB_ERR_CLIENT_EXITED_ACT               "Run the Python client manually to check for import or runtime errors"
+
+#define LIB_ERR_CLIENT_ERROR                    0x00090000
+#define LIB_ERR_CLIENT_ERROR_MSG                "The Python client failed to plot the data"
+#define LIB_ERR_CLIENT_ERROR_ACT                "Check the runtime message for the Python exception"
+
+#define LIB_ERR_PROTOCOL                        0x000A0000
+#define LIB_ERR_PROTOCOL_MSG                    "Unexpected message on the pipe"
+#define LIB_ERR_PROTOCOL_ACT                    "Check the C/C++ library and the Python client are the same version"
+
+#define LIB_ERR_INPUT_INVALID                   0x000B0000
+#define LIB_ERR_INPUT_INVALID_MSG               "An option of the input is out of range"
+#define LIB_ERR_INPUT_INVALID_ACT               "Check the options of the input structure"
+
+#define LIB_ERR_FILE_IO                         0x000C0000
+#define LIB_ERR_FILE_IO_MSG                     "A file could not be opened or written"
+#define LIB_ERR_FILE_IO_ACT                     "Check the path exists and is writable"
+
+#define LIB_ERR_BUSY                            0x000D0000
+#define LIB_ERR_BUSY_MSG                        "Too many plots are waiting for a Python tool"
+#define LIB_ERR_BUSY_ACT                        "Retry later or raise the limits with ipc_plot_concurrency_config()"
+
+#define LIB_ERR_IMAGE_TOO_SMALL                 0x000E0000
+#define LIB_ERR_IMAGE_TOO_SMALL_MSG             "The image buffer is too small for the figure"
+#define LIB_ERR_IMAGE_TOO_SMALL_ACT             "Pass a buffer of LIB_IMAGE::u64Size bytes, or NULL to have the library allocate it"
+
 #endif //_IPC_PLOT_ERROR_H_
@@ -1,23 +1,14 @@
 #include <stdio.h>
-#include <windows.h>
+#include <stdlib.h>
 
-#include "IPC_Plot_Internal.h"
+#include "IPC_Plot_Cache.h"
+#include "IPC_Plot_Protocol.h"
+#include "IPC_Plot_Raster.h"
 
-LIB_INT32 GetWinAPIErrMessage(DWORD dwErrCode, LIB_CHAR* pszOutWinAPIErrorMsg, LIB_ERROR_INFO* pstErr);
-LIB_INT32 ReadWritePipe(LIB_PIPE_INFO* pstPipeInfo, LIB_INPUT* pstInput, LIB_ERROR_INFO* pstErr);
-
-#define PYTHON_PATH ".\\..\\Python\\IPC_Plot.py"
-
-#define __AT__  __FILE__ , __LINE__
-
-#define LOG_ERROR(pstERR_Out, u32CODE_In, pcERRDEF_In, pcERRACTION_In, pcRUNTIME_In)    \
-    if (pstERR_Out->u32ErrCode == 0) \
-    { \
-    	pstERR_Out->u32ErrCode = u32CODE_In;\
-    	sprintf(pstERR_Out->szErrMsg, "%s", pcERRDEF_In);\
-    	sprintf(pstERR_Out->szErrHelp, "%s", pcERRACTION_In);\
-    	snprintf(pstERR_Out->szRuntime, sizeof(pstERR_Out->szRuntime), "%s (%s, %d)", pcRUNTIME_In, __AT__); \
-    }
+static LIB_U32 PlotOneShot(LIB_INPUT* pstInput, LIB_PLOT_STATS* pstOutStats, LIB_ERROR_INFO* pstErr);
+static LIB_U32 PlotInput(LIB_SESSION* pstSession, LIB_INPUT* pstInput, const LIB_HASH* pstCacheKey, LIB_PLOT_STATS* pstOutStats, LIB_ERROR_INFO* pstErr);
+static LIB_U32 PlotRender(LIB_SESSION* pstSession, LIB_BOOLEAN bSpool, LIB_INPUT* pstInput, LIB_PLOT_STATS* pstOutStats, LIB_ERROR_INFO* pstErr);
+static LIB_U32 PlotDraw(LIB_SESSION* pstSession, LIB_BOOLEAN bSpool, LIB_INPUT* pstInput, LIB_U32 u32Flags, LIB_PLOT_STATS* pstStats, LIB_ERROR_INFO* pstErr);
 
 /***************************************************************************//**
  * ipc_plot
@@ -30,6 +21,38 @@ LIB_INT32 ReadWritePipe(LIB_PIPE_INFO* pstPipeInfo, LIB_INPUT* pstInput, LIB_ERR
  * @return         LIB_OK if success, else LIB_ERR if any error occurred
  ******************************************************************************/
 LIB_U32 ipc_plot(LIB_INPUT* pstInput, LIB_ERROR_INFO* pstErr)
+{
+	// Check for null pointers
+	if (pstErr == NULL)
+	{
+		return LIB_ERR;
+	}
+	// The status of a previous successful plot is not an error, let this call log its own
+	if (pstErr->u32ErrCode == LIB_STATUS_DONE)
+	{
+		*pstErr = LIB_ERROR_INFO();
+	}
+	LIB_U64 u64StartUs = StatsNowUs();
+	LIB_PLOT_STATS stStats;
+	LIB_U32 u32Ret = PlotOneShot(pstInput, &stStats, pstErr);
+	StatsCall("ipc_plot", u64StartUs, &stStats, pstErr);
+	if (pstInput != NULL && pstInput->pstStats != NULL)
+	{
+		*pstInput->pstStats = stStats;
+	}
+	return u32Ret;
+}
+
+/***************************************************************************//**
+ * ipc_plot_session_open
+ *
+ * Starts the Python tool and keeps it connected for later plots.
+ *
+ * @param ppstOutSession Receives the session handle
+ * @param pstErr         Error information structure for logging any errors
+ * @return               LIB_OK if success, else LIB_ERR if any error occurred
+ ******************************************************************************/
+LIB_U32 ipc_plot_session_open(LIB_SESSION** ppstOutSession, LIB_ERROR_INFO* pstErr)
 {
 	LIB_CHAR szRuntimeMsg[LIB_MAX_BUFFER_SIZE] = "";
 
@@ -38,370 +61,647 @@ LIB_U32 ipc_plot(LIB_INPUT* pstInput, LIB_ERROR_INFO* pstErr)
 	{
 		return LIB_ERR;
 	}
-	if (pstInput == NULL || pstInput->prgdBuffer == NULL || pstInput->prgszLabels == NULL)
+	// The status of a previous successful call is not an error, let this call log its own
+	if (pstErr->u32ErrCode == LIB_STATUS_DONE)
 	{
-		snprintf(szRuntimeMsg, sizeof(szRuntimeMsg), "Input struct is null pointer");
-		LOG_ERROR(pstErr, LIB_ERR_INPUT_PTR_NULL, LIB_ERR_INPUT_PTR_NULL_MSG, LIB_ERR_INPUT_PTR_NULL_ACT, szRuntimeMsg)
-		return LIB_ERR;
+		*pstErr = LIB_ERROR_INFO();
 	}
-
-	// Check for buffer overflow
-	if (pstInput->u32RowSize * pstInput->u32ColSize > LIB_MAX_DATA_SIZE)
+	if (ppstOutSession == NULL)
 	{
-		snprintf(szRuntimeMsg, sizeof(szRuntimeMsg), "Buffer size of %d is larger than maximum of %d", 
-			pstInput->u32RowSize * pstInput->u32ColSize, LIB_MAX_DATA_SIZE);
-		LOG_ERROR(pstErr, LIB_ERR_BUFFER_OVERFLOW, LIB_ERR_BUFFER_OVERFLOW_MSG, LIB_ERR_BUFFER_OVERFLOW_ACT, szRuntimeMsg)
+		snprintf(szRuntimeMsg, sizeof(szRuntimeMsg), "Output session pointer is null pointer");
+		LOG_ERROR(pstErr, LIB_ERR_INPUT_PTR_NULL, LIB_ERR_INPUT_PTR_NULL_MSG, LIB_ERR_INPUT_PTR_NULL_ACT, szRuntimeMsg)
 		return LIB_ERR;
 	}
+	*ppstOutSession = NULL;
 
 	// Check if Python tool is found
-	DWORD dwFileAttribs = GetFileAttributesA(PYTHON_PATH);
-	if (dwFileAttribs == INVALID_FILE_ATTRIBUTES)
+	FILE* pFile = fopen(GetRendererPath(), "r");
+	if (pFile == NULL)
 	{
 		// Python tool not found 
-		snprintf(szRuntimeMsg, sizeof(szRuntimeMsg), "No Python tool in %s", PYTHON_PATH);
+		snprintf(szRuntimeMsg, sizeof(szRuntimeMsg), "No Python tool in %s", GetRendererPath());
 		LOG_ERROR(pstErr, LIB_ERR_CLIENT_NOT_FOUND, LIB_ERR_CLIENT_NOT_FOUND_MSG, LIB_ERR_CLIENT_NOT_FOUND_ACT, szRuntimeMsg)
 		return LIB_ERR;
 	}
+	fclose(pFile);
 
-	// Dereference data in buffer and user labels in char array into structs for named pipe
-	LIB_BUFFER_ST* stDataArray = (LIB_BUFFER_ST*)malloc(LIB_MAX_DATA_SIZE * sizeof(LIB_BUFFER_ST));
-	LIB_LABEL_ST* stLabelArray = (LIB_LABEL_ST*)malloc(pstInput->u32ColSize * sizeof(LIB_LABEL_ST));
-	LIB_U32 u32BufferSize = pstInput->u32RowSize * pstInput->u32ColSize;
-	for (LIB_U32 u32Offset = 0; u32Offset < u32BufferSize; u32Offset++)
+	LIB_SESSION* pstSession = (LIB_SESSION*)calloc(1, sizeof(LIB_SESSION));
+	if (pstSession == NULL)
 	{
-		stDataArray[u32Offset].dData = pstInput->prgdBuffer[u32Offset];
+		snprintf(szRuntimeMsg, sizeof(szRuntimeMsg), "Unable to allocate session");
+		LOG_ERROR(pstErr, LIB_ERR_BUFFER_OVERFLOW, LIB_ERR_BUFFER_OVERFLOW_MSG, LIB_ERR_BUFFER_OVERFLOW_ACT, szRuntimeMsg)
+		return LIB_ERR;
 	}
-
-	for (LIB_U32 u32Offset = 0; u32Offset < pstInput->u32ColSize; u32Offset++)
+	if (RendererOpen(pstSession, pstErr) != LIB_OK)
 	{
-		strncpy(stLabelArray[u32Offset].szLabel, pstInput->prgszLabels[u32Offset],
-			sizeof(stLabelArray[u32Offset].szLabel) - 1);
+		free(pstSession);
+		return LIB_ERR;
 	}
+	*ppstOutSession = pstSession;
+	pstErr->u32ErrCode = LIB_STATUS_DONE;
+	return LIB_OK;
+}
 
-	// Run the Python tool via CreateProcess()
-	LIB_CHAR szCmdLine[LIB_MAX_BUFFER_SIZE] = "python.exe ";
-	strncat(szCmdLine, PYTHON_PATH, LIB_MAX_BUFFER_SIZE - strlen(szCmdLine) - 1);
+/***************************************************************************//**
+ * ipc_plot_session_plot
+ *
+ * Plots data from a buffer with the Python tool of an open session.
+ *
+ * @param pstSession Session from ipc_plot_session_open()
+ * @param pstInput   Input structure including data buffer and labels
+ * @param pstErr     Error information structure for logging any errors
+ * @return           LIB_OK if success, else LIB_ERR if any error occurred
+ ******************************************************************************/
+LIB_U32 ipc_plot_session_plot(LIB_SESSION* pstSession, LIB_INPUT* pstInput, LIB_ERROR_INFO* pstErr)
+{
+	LIB_CHAR szRuntimeMsg[LIB_MAX_BUFFER_SIZE] = "";
 
-	STARTUPINFO si = { sizeof(si) };
-	PROCESS_INFORMATION pi;
+	// Check for null pointers
+	if (pstErr == NULL)
+	{
+		return LIB_ERR;
+	}
+	// The status of a previous successful plot is not an error, let this call log its own
+	if (pstErr->u32ErrCode == LIB_STATUS_DONE)
+	{
+		*pstErr = LIB_ERROR_INFO();
+	}
+	if (pstSession == NULL)
+	{
+		snprintf(szRuntimeMsg, sizeof(szRuntimeMsg), "Session is null pointer");
+		LOG_ERROR(pstErr, LIB_ERR_INPUT_PTR_NULL, LIB_ERR_INPUT_PTR_NULL_MSG, LIB_ERR_INPUT_PTR_NULL_ACT, szRuntimeMsg)
+		return LIB_ERR;
+	}
+	LIB_U64 u64StartUs = StatsNowUs();
+	LIB_PLOT_STATS stStats;
+	LIB_U32 u32Ret = LIB_ERR;
+	if (ValidateInput(pstInput, pstErr) == LIB_OK)
+	{
+		LIB_HASH stCacheKey;
+		LIB_BOOLEAN bCacheKey;
+		LIB_DOUBLE dCacheMs;
+		if (CacheLookup(pstInput, &stCacheKey, &bCacheKey, &dCacheMs, pstErr))
+		{
+			stStats.bCacheHit = LIB_TRUE;
+			u32Ret = (pstErr->u32ErrCode == LIB_STATUS_DONE) ? LIB_OK : LIB_ERR;
+		}
+		else
+		{
+			// The native backend leaves the Python tool of the session idle
+			pstSession->stStats = LIB_PLOT_STATS();
+			u32Ret = PlotInput((pstInput->u32Backend == LIB_BACKEND_NATIVE) ? NULL : pstSession, pstInput,
+				bCacheKey ? &stCacheKey : NULL, &stStats, pstErr);
+		}
+		stStats.dCacheMs = dCacheMs;
+	}
+	StatsCall("ipc_plot_session_plot", u64StartUs, &stStats, pstErr);
+	if (pstInput != NULL && pstInput->pstStats != NULL)
+	{
+		*pstInput->pstStats = stStats;
+	}
+	return u32Ret;
+}
 
-	// memset() to 0
-	ZeroMemory(&si, sizeof(si));
-	ZeroMemory(&pi, sizeof(pi));
+/***************************************************************************//**
+ * ipc_plot_session_close
+ *
+ * Ends the session and waits for the Python tool to exit.
+ *
+ * @param pstSession Session from ipc_plot_session_open()
+ ******************************************************************************/
+void ipc_plot_session_close(LIB_SESSION* pstSession)
+{
+	if (pstSession == NULL)
+	{
+		return;
+	}
+	RendererClose(pstSession);
+	free(pstSession);
+}
 
-	if (!CreateProcess(NULL,   // No module name (use command line)
-		(LPTSTR)szCmdLine,     // Command line (<exename> <arg1> <arg2> etc)
-		NULL,                  // Process handle not inheritable
-		NULL,                  // Thread handle not inheritable
-		TRUE,                  // Set handle inheritance to FALSE
-		0,                     // No creation flags
-		NULL,                  // Use parent's environment block
-		NULL,                  // Use parent's starting directory 
-		&si,                   // Pointer to STARTUPINFO structure
-		&pi)                   // Pointer to PROCESS_INFORMATION structure
-		)
+/***************************************************************************//**
+ * PlotOneShot
+ *
+ * Plots with a ready Python tool from the pool once the call is admitted. 
+ * Without one, a Python tool is started for the plot; it joins the pool 
+ * afterwards if the pool has room, else it is closed again. The native
+ * backend is admitted the same way but needs no Python tool. A hit in the
+ * render cache needs neither admission nor a renderer. With a spool log
+ * open the plot is appended to it instead, bypassing all of these.
+ *
+ * @param pstInput    Input structure including data buffer and labels
+ * @param pstOutStats Receives the timings of every phase, dTotalMs excepted
+ * @param pstErr      Error information structure for logging any errors
+ * @return            LIB_OK if success, else LIB_ERR if any error occurred
+ ******************************************************************************/
+static LIB_U32 PlotOneShot(LIB_INPUT* pstInput, LIB_PLOT_STATS* pstOutStats, LIB_ERROR_INFO* pstErr)
+{
+	if (ValidateInput(pstInput, pstErr) != LIB_OK)
 	{
-		// CreateProcess() error
-		LIB_CHAR szErrHelpString[LIB_MAX_BUFFER_SIZE] = LIB_ERR_WIN_API_ERR_ACT;
-		GetWinAPIErrMessage(GetLastError(), szErrHelpString, pstErr);
-		snprintf(szRuntimeMsg, sizeof(szRuntimeMsg), "Error from the Python tool at %s", PYTHON_PATH);
-		LOG_ERROR(pstErr, LIB_ERR_WIN_API_ERR, LIB_ERR_WIN_API_ERR_MSG, szErrHelpString, szRuntimeMsg)
-		free(stDataArray);
-		free(stLabelArray);
 		return LIB_ERR;
 	}
+	if (SpoolEnabled())
+	{
+		// Rendered later by the replay tool, no image comes back
+		if (pstInput->u32Output != LIB_OUTPUT_FILE)
+		{
+			pstInput->pstImage->u64Size = 0;
+		}
+		return PlotRender(NULL, LIB_TRUE, pstInput, pstOutStats, pstErr);
+	}
+	LIB_HASH stCacheKey;
+	LIB_BOOLEAN bCacheKey;
+	LIB_DOUBLE dCacheMs;
+	if (CacheLookup(pstInput, &stCacheKey, &bCacheKey, &dCacheMs, pstErr))
+	{
+		pstOutStats->dCacheMs = dCacheMs;
+		pstOutStats->bCacheHit = LIB_TRUE;
+		return (pstErr->u32ErrCode == LIB_STATUS_DONE) ? LIB_OK : LIB_ERR;
+	}
+	const LIB_HASH* pstCacheKey = bCacheKey ? &stCacheKey : NULL;
 
-	CloseHandle(pi.hThread);
-
-	LIB_PIPE_INFO stPipeInfo;
-	HANDLE hNamedPipe;
-	DWORD dwszInputBuffer = sizeof(LIB_BUFFER_ST) * LIB_MAX_DATA_SIZE;
-	DWORD dwszOutputBuffer = sizeof(LIB_ERROR_INFO);
-
-	// Get the process ID to create the unique pipe name
-	LIB_CHAR szProcessID[10];
-	sprintf(szProcessID, "%d", GetProcessId(pi.hProcess));
-
-	// Named pipes steps (labelled in numerical order)
-	// 01. CreateNamedPipe() to create the named pipe
-	// The name of the pipe is based on the process ID of the Python tool
-	LIB_CHAR szNamedPipe[64] = "\\\\.\\pipe\\";
-	strcat(szNamedPipe, szProcessID);
-	hNamedPipe = CreateNamedPipe(
-		(LPCSTR)szNamedPipe, // Name of the pipe, unique for each application and client instance
-		// PIPE_ACCESS_DUPLEX: Both server and client processes can read from and write to the pipe
-		// FILE_FLAG_OVERLAPPED: Prevent server from waiting infinitely for a client to connect	
-		PIPE_ACCESS_DUPLEX | FILE_FLAG_OVERLAPPED,
-		// PIPE_TYPE_MESSAGE: The pipe treats the bytes written during each write operation as a message unit. 
-		// PIPE_READMODE_MESSAGE: Data is read from the pipe as a stream of messages
-		// PIPE_WAIT: Blocking mode - wait until client connects to named pipe (default) or timeout
-		PIPE_TYPE_MESSAGE | PIPE_READMODE_MESSAGE | PIPE_WAIT,
-		// Maximum number of instances that can be created for this pipe (from 1 to 255)
-		1,
-		// The non-paged pool (physical memory used by the kernel) is used to create the size of the pipe
-		// Insufficient buffer will just block the write operation until buffer (the non-paged pool) is expanded by OS
-		dwszOutputBuffer,
-		dwszInputBuffer,
-		0, // How long to wait until the named pipe is successfully created. Default value of 50ms
-		NULL // Prevent handle (hNamedPipe) from being inherited
-	);
-
-	if (hNamedPipe == NULL)
-	{
-		CloseHandle(pi.hProcess);
-		free(stDataArray);
-		free(stLabelArray);
-		// Error creating the pipe
-		LIB_CHAR szErrHelpString[LIB_MAX_BUFFER_SIZE] = LIB_ERR_WIN_API_ERR_ACT;
-		GetWinAPIErrMessage(GetLastError(), szErrHelpString, pstErr);
-		snprintf(szRuntimeMsg, sizeof(szRuntimeMsg), "Error from the Python tool at %s", PYTHON_PATH);
-		LOG_ERROR(pstErr, LIB_ERR_WIN_API_ERR, LIB_ERR_WIN_API_ERR_MSG, szErrHelpString, szRuntimeMsg)
+	LIB_U64 u64QueueUs = StatsNowUs();
+	LIB_DOUBLE dQueueMs;
+	if (AdmissionEnter(pstErr) != LIB_OK)
+	{
 		return LIB_ERR;
 	}
+	StatsPhase("queue", u64QueueUs, &dQueueMs);
+	if (pstInput->u32Backend == LIB_BACKEND_NATIVE)
+	{
+		LIB_U32 u32Ret = PlotInput(NULL, pstInput, pstCacheKey, pstOutStats, pstErr);
+		pstOutStats->dQueueMs = dQueueMs;
+		pstOutStats->dCacheMs = dCacheMs;
+		AdmissionLeave();
+		return u32Ret;
+	}
 
-	if (hNamedPipe == INVALID_HANDLE_VALUE && hNamedPipe != NULL)
+	// The start-up timings of a new session are kept for its first plot
+	LIB_BOOLEAN bPooled;
+	LIB_SESSION* pstSession = PoolAcquire(&bPooled);
+	if (pstSession == NULL && ipc_plot_session_open(&pstSession, pstErr) != LIB_OK)
 	{
-		CloseHandle(hNamedPipe);
-		CloseHandle(pi.hProcess);
-		free(stDataArray);
-		free(stLabelArray);
-		// Error creating the pipe
-		LIB_CHAR szErrHelpString[LIB_MAX_BUFFER_SIZE] = LIB_ERR_WIN_API_ERR_ACT;
-		GetWinAPIErrMessage(GetLastError(), szErrHelpString, pstErr);
-		snprintf(szRuntimeMsg, sizeof(szRuntimeMsg), "Error from the Python tool at %s", PYTHON_PATH);
-		LOG_ERROR(pstErr, LIB_ERR_WIN_API_ERR, LIB_ERR_WIN_API_ERR_MSG, szErrHelpString, szRuntimeMsg)
+		if (bPooled)
+		{
+			PoolRelease(NULL, LIB_TRUE);
+		}
+		AdmissionLeave();
 		return LIB_ERR;
 	}
+	// A new session leaves its status, the plot logs its own
+	*pstErr = LIB_ERROR_INFO();
+	LIB_U32 u32Ret = PlotInput(pstSession, pstInput, pstCacheKey, pstOutStats, pstErr);
+	pstOutStats->dQueueMs = dQueueMs;
+	pstOutStats->dCacheMs = dCacheMs;
+	if (bPooled)
+	{
+		PoolRelease(pstSession, (LIB_BOOLEAN)(u32Ret != LIB_OK && IsSessionLost(pstErr->u32ErrCode)));
+		AdmissionLeave();
+		return u32Ret;
+	}
+	LIB_U64 u64CloseUs = StatsNowUs();
+	ipc_plot_session_close(pstSession);
+	StatsPhase("close", u64CloseUs, &pstOutStats->dCloseMs);
+	AdmissionLeave();
+	return u32Ret;
+}
 
-	stPipeInfo.hNamedPipe = hNamedPipe;
-	stPipeInfo.hChildProcess = pi.hProcess;
-	stPipeInfo.pstDataArray = stDataArray;
-	stPipeInfo.pstLabelArray = stLabelArray;
+/***************************************************************************//**
+ * PlotInput
+ *
+ * Renders the input, and keeps its image in the render cache after a miss.
+ * The image to cache must come back in memory, so a file is then rendered
+ * as PNG and saved here instead of by the renderer.
+ *
+ * @param pstSession  Session with a running Python tool, NULL for the native backend
+ * @param pstInput    Validated input structure
+ * @param pstCacheKey Key from CacheLookup() after a miss, NULL if the image is not cached
+ * @param pstOutStats Receives the statistics the session gathered for the plot
+ * @param pstErr      Error information structure for logging any errors
+ * @return            LIB_OK if success, else LIB_ERR if any error occurred
+ ******************************************************************************/
+static LIB_U32 PlotInput(LIB_SESSION* pstSession, LIB_INPUT* pstInput, const LIB_HASH* pstCacheKey, LIB_PLOT_STATS* pstOutStats, LIB_ERROR_INFO* pstErr)
+{
+	if (pstCacheKey == NULL)
+	{
+		return PlotRender(pstSession, LIB_FALSE, pstInput, pstOutStats, pstErr);
+	}
+	LIB_INPUT stRender = *pstInput;
+	LIB_IMAGE stPng;
+	if (pstInput->u32Output == LIB_OUTPUT_FILE)
+	{
+		stRender.u32Output = LIB_OUTPUT_PNG;
+		stRender.pstImage = &stPng;
+	}
+	LIB_U32 u32Ret = PlotRender(pstSession, LIB_FALSE, &stRender, pstOutStats, pstErr);
+	if (u32Ret == LIB_OK)
+	{
+		CacheStore(pstCacheKey, stRender.pstImage);
+	}
+	if (u32Ret == LIB_OK && pstInput->u32Output == LIB_OUTPUT_FILE)
+	{
+		// Rendered fine, a failure to save is the error of the plot now
+		LIB_CHAR szTitle[64];
+		GetImageTitle(szTitle, sizeof(szTitle));
+		*pstErr = LIB_ERROR_INFO();
+		u32Ret = WriteImageFile(szTitle, stPng.pcData, stPng.u64Size, pstErr);
+		if (u32Ret == LIB_OK)
+		{
+			pstErr->u32ErrCode = LIB_STATUS_DONE;
+		}
+	}
+	ipc_plot_image_free(&stPng);
+	return u32Ret;
+}
 
-	while (1)
+/***************************************************************************//**
+ * PlotRender
+ *
+ * Decimates the input if requested and sends it to the Python tool, or
+ * draws it in this process without a session, or appends it to the spool
+ * log. A file is mapped for the duration of the plot.
+ *
+ * @param pstSession  Session with a running Python tool, NULL for the native backend
+ * @param bSpool      LIB_TRUE to append to the spool log, with no session
+ * @param pstInput    Validated input structure
+ * @param pstOutStats Receives the statistics the session gathered for the plot
+ * @param pstErr      Error information structure for logging any errors
+ * @return            LIB_OK if success, else LIB_ERR if any error occurred
+ ******************************************************************************/
+static LIB_U32 PlotRender(LIB_SESSION* pstSession, LIB_BOOLEAN bSpool, LIB_INPUT* pstInput, LIB_PLOT_STATS* pstOutStats, LIB_ERROR_INFO* pstErr)
+{
+	LIB_U32 u32Ret = LIB_ERR;
+	LIB_PLOT_STATS stNativeStats;
+	LIB_PLOT_STATS* pstStats = (pstSession != NULL) ? &pstSession->stStats : &stNativeStats;
+	if (pstInput->pstFile != NULL)
 	{
-		ReadWritePipe(&stPipeInfo, pstInput, pstErr);		
-		if (pstErr->u32ErrCode != 0)
+		// The file is plotted as typed columns of its mapping
+		LIB_FILE_VIEW stView;
+		if (FileViewOpen(pstInput, &stView, pstErr) == LIB_OK)
 		{
-			break;
+			u32Ret = PlotRender(pstSession, bSpool, &stView.stInput, pstOutStats, pstErr);
+			FileViewClose(&stView);
+			return u32Ret;
 		}
+		*pstOutStats = *pstStats;
+		return LIB_ERR;
+	}
+	LIB_U32 u32MaxPoints = (pstInput->u32MaxPoints == 0) ? LIB_DEFAULT_MAX_POINTS : pstInput->u32MaxPoints;
+	if (pstInput->u32Decimation == LIB_DECIMATE_NONE || pstInput->u32RowSize <= u32MaxPoints)
+	{
+		u32Ret = PlotDraw(pstSession, bSpool, pstInput, 0, pstStats, pstErr);
+		*pstOutStats = *pstStats;
+		return u32Ret;
 	}
-	// 07. Free resources (handles) after server is done with the named pipe
-	CloseHandle(pi.hProcess);
-	CloseHandle(hNamedPipe);
-	free(stDataArray);
-	free(stLabelArray);
 
-	if (pstErr->u32ErrCode != 0x0000FFFF)
+	// Only the reduced columns and their X values cross to the Python tool, or are drawn
+	LIB_INPUT stReduced = *pstInput;
+	LIB_U64 u64StartUs = StatsNowUs();
+	if (DecimateInput(pstInput, &stReduced.prgdBuffer, &stReduced.u32RowSize, pstErr) == LIB_OK)
+	{
+		StatsPhase("decimate", u64StartUs, &pstStats->dDecimateMs);
+		stReduced.u32Decimation = LIB_DECIMATE_NONE;
+		stReduced.prgstColumns = NULL;
+		stReduced.pstXColumn = NULL;
+		u32Ret = PlotDraw(pstSession, bSpool, &stReduced, LIB_PLOT_FLAG_XY, pstStats, pstErr);
+		free(stReduced.prgdBuffer);
+	}
+	*pstOutStats = *pstStats;
+	return u32Ret;
+}
+
+/***************************************************************************//**
+ * PlotDraw
+ *
+ * Hands the input, as the Python tool would receive it, to the renderer 
+ * PlotRender() chose
+ *
+ * @param pstSession Session with a running Python tool, NULL for the native backend
+ * @param bSpool     LIB_TRUE to append to the spool log, with no session
+ * @param pstInput   Validated input, not a file
+ * @param u32Flags   LIB_PLOT_FLAG_XY if the buffer holds X and Y columns
+ * @param pstStats   Statistics of the native backend and the spool log
+ * @param pstErr     Error information structure for logging any errors
+ * @return           LIB_OK if success, else LIB_ERR if any error occurred
+ ******************************************************************************/
+static LIB_U32 PlotDraw(LIB_SESSION* pstSession, LIB_BOOLEAN bSpool, LIB_INPUT* pstInput, LIB_U32 u32Flags, LIB_PLOT_STATS* pstStats, LIB_ERROR_INFO* pstErr)
+{
+	if (bSpool)
+	{
+		return SpoolPlot(pstInput, u32Flags, pstStats, pstErr);
+	}
+	return (pstSession != NULL) ? RendererPlot(pstSession, pstInput, u32Flags, pstErr) : RasterPlot(pstInput, u32Flags, pstStats, pstErr);
+}
+
+/***************************************************************************//**
+ * ValidateLayout
+ *
+ * Checks the type and stride of a column in memory or in a file
+ *
+ * @param u32Dtype  LIB_DTYPE_* of the samples
+ * @param u32Stride Bytes from one sample to the next, 0 for packed samples
+ * @param pszName   Column named in the error message
+ * @param pstErr    Error information structure for logging any errors
+ * @return          LIB_OK if success, else LIB_ERR if any error occurred
+ ******************************************************************************/
+static LIB_U32 ValidateLayout(LIB_U32 u32Dtype, LIB_U32 u32Stride, const LIB_CHAR* pszName, LIB_ERROR_INFO* pstErr)
+{
+	LIB_CHAR szRuntimeMsg[LIB_MAX_BUFFER_SIZE] = "";
+
+	if (GetDtypeSize(u32Dtype) == 0)
+	{
+		snprintf(szRuntimeMsg, sizeof(szRuntimeMsg), "Data type %u of %s is not supported", u32Dtype, pszName);
+		LOG_ERROR(pstErr, LIB_ERR_INPUT_INVALID, LIB_ERR_INPUT_INVALID_MSG, LIB_ERR_INPUT_INVALID_ACT, szRuntimeMsg)
+		return LIB_ERR;
+	}
+	// Samples may not overlap, a stride of 0 is the size of a sample
+	if (u32Stride != 0 && u32Stride < GetDtypeSize(u32Dtype))
 	{
+		snprintf(szRuntimeMsg, sizeof(szRuntimeMsg), "Stride of %u bytes of %s is less than a sample of type %u",
+			u32Stride, pszName, u32Dtype);
+		LOG_ERROR(pstErr, LIB_ERR_INPUT_INVALID, LIB_ERR_INPUT_INVALID_MSG, LIB_ERR_INPUT_INVALID_ACT, szRuntimeMsg)
 		return LIB_ERR;
 	}
 	return LIB_OK;
 }
 
 /***************************************************************************//**
- * ReadWritePipe
+ * ValidateColumn
  *
- * Sends and receives data from the named pipe
+ * Checks the descriptor of a typed column or of the X column
  *
- * @param pstPipeInfo  Internal struct including handles and pointer to the 
- *                     array of structs
- * @param pstInput     Input structure for denoting row and col sizes
- * @param pstErr       Error information structure for logging any errors
- * @return             LIB_OK if success, else LIB_ERR if any error occurred
+ * @param pstColumn Column descriptor
+ * @param pszName   Column named in the error message
+ * @param pstErr    Error information structure for logging any errors
+ * @return          LIB_OK if success, else LIB_ERR if any error occurred
  ******************************************************************************/
-LIB_INT32 ReadWritePipe(LIB_PIPE_INFO* pstPipeInfo, LIB_INPUT* pstInput, LIB_ERROR_INFO* pstErr)
+static LIB_U32 ValidateColumn(const LIB_COLUMN* pstColumn, const LIB_CHAR* pszName, LIB_ERROR_INFO* pstErr)
 {
 	LIB_CHAR szRuntimeMsg[LIB_MAX_BUFFER_SIZE] = "";
 
-	DWORD dwErr, dwOverlappedResult, dwResult;
-	// For WriteFile()
-	DWORD dwWriteBufferSizeInput = sizeof(LIB_INPUT);
-	DWORD dwWriteBufferSizeData = sizeof(LIB_BUFFER_ST) * LIB_MAX_DATA_SIZE;
-	DWORD dwWriteBufferSizeLabels = sizeof(LIB_LABEL_ST) * pstInput->u32ColSize;
-	// For ReadFile()
-	DWORD dwReadBufferSize = sizeof(LIB_ERROR_INFO);
-
-	// Struct contains information used in asynchronous (a.k.a. overlapped) input and output
-	// Used to add the event flag to the struct
-	OVERLAPPED stOverlapped = { 0 };
-	// Create event flag to check if client has connected
-	stOverlapped.hEvent = CreateEvent(NULL,  // SECURITY_ATTRIBUTES, cannot be inherited by child processes
-									  TRUE,  // Requires ResetEvent() to manually set the event to non-signalled (wait)
-									  FALSE, // Initial state of event is non-signalled (wait)
-									  NULL); // Name of event object is not set
-
-	// 02. ConnectNamedPipe() to check if the client has connected to the pipe
-	// If not, wait for 10 seconds until timeout
-	if (!ConnectNamedPipe(pstPipeInfo->hNamedPipe, &stOverlapped))
-	{
-		dwErr = GetLastError();
-		if (!(dwErr == ERROR_IO_PENDING || dwErr == ERROR_PIPE_LISTENING))
+	if (pstColumn->pvData == NULL)
+	{
+		snprintf(szRuntimeMsg, sizeof(szRuntimeMsg), "Data of %s is null pointer", pszName);
+		LOG_ERROR(pstErr, LIB_ERR_INPUT_PTR_NULL, LIB_ERR_INPUT_PTR_NULL_MSG, LIB_ERR_INPUT_PTR_NULL_ACT, szRuntimeMsg)
+		return LIB_ERR;
+	}
+	return ValidateLayout(pstColumn->u32Dtype, pstColumn->u32Stride, pszName, pstErr);
+}
+
+/***************************************************************************//**
+ * ValidateFile
+ *
+ * Checks the file input of a plot. Whether the columns lie in the file is 
+ * only known once it is mapped, see FileViewOpen().
+ *
+ * @param pstInput Input structure with pstFile set
+ * @param pstErr   Error information structure for logging any errors
+ * @return         LIB_OK if success, else LIB_ERR if any error occurred
+ ******************************************************************************/
+static LIB_U32 ValidateFile(const LIB_INPUT* pstInput, LIB_ERROR_INFO* pstErr)
+{
+	LIB_CHAR szRuntimeMsg[LIB_MAX_BUFFER_SIZE] = "";
+	const LIB_FILE_INPUT* pstFile = pstInput->pstFile;
+
+	if (pstFile->pszPath == NULL || pstFile->prgstColumns == NULL)
+	{
+		snprintf(szRuntimeMsg, sizeof(szRuntimeMsg), "Path or columns of the file input is null pointer");
+		LOG_ERROR(pstErr, LIB_ERR_INPUT_PTR_NULL, LIB_ERR_INPUT_PTR_NULL_MSG, LIB_ERR_INPUT_PTR_NULL_ACT, szRuntimeMsg)
+		return LIB_ERR;
+	}
+	if (pstInput->prgdBuffer != NULL || pstInput->prgstColumns != NULL || pstInput->pstXColumn != NULL)
+	{
+		snprintf(szRuntimeMsg, sizeof(szRuntimeMsg), "File input %s combined with data in memory", pstFile->pszPath);
+		LOG_ERROR(pstErr, LIB_ERR_INPUT_INVALID, LIB_ERR_INPUT_INVALID_MSG, LIB_ERR_INPUT_INVALID_ACT, szRuntimeMsg)
+		return LIB_ERR;
+	}
+	for (LIB_U32 u32Col = 0; u32Col < pstInput->u32ColSize; u32Col++)
+	{
+		LIB_CHAR szName[32];
+		snprintf(szName, sizeof(szName), "file column %u", u32Col);
+		if (ValidateLayout(pstFile->prgstColumns[u32Col].u32Dtype, pstFile->prgstColumns[u32Col].u32Stride, szName, pstErr) != LIB_OK)
 		{
-			CloseHandle(stOverlapped.hEvent);
-			// Some other error occurred while connecting server to pipe
-			LIB_CHAR szErrHelpString[LIB_MAX_BUFFER_SIZE] = LIB_ERR_WIN_API_ERR_ACT;
-			GetWinAPIErrMessage(GetLastError(), szErrHelpString, pstErr);
-			snprintf(szRuntimeMsg, sizeof(szRuntimeMsg), "ConnectNamedPipe() failed");
-			LOG_ERROR(pstErr, LIB_ERR_WIN_API_ERR, LIB_ERR_WIN_API_ERR_MSG, szErrHelpString, szRuntimeMsg)
 			return LIB_ERR;
 		}
-		// Keep the server pending for 10 seconds, or until client connects within 10 seconds
-		LIB_INT32 nServerWaitTimeMs = 10000; 
-		WaitForSingleObject(stOverlapped.hEvent, nServerWaitTimeMs);
-		// Check if event flag is signalled
-		if (!GetOverlappedResult(pstPipeInfo->hNamedPipe, // The handle to the named pipe
-								 &stOverlapped,           // A pointer to an OVERLAPPED structure
-								 &dwOverlappedResult,     // Not used: Receives the number of bytes that were
-														  // transferred by a read or write operation
-								 FALSE))                  // Allow function to return while server is pending
+	}
+	if (pstFile->pstXColumn != NULL
+		&& ValidateLayout(pstFile->pstXColumn->u32Dtype, pstFile->pstXColumn->u32Stride, "the X column of the file", pstErr) != LIB_OK)
+	{
+		return LIB_ERR;
+	}
+	return LIB_OK;
+}
+
+/***************************************************************************//**
+ * ValidateInput
+ *
+ * Checks the input structure before anything is sent to the Python tool
+ *
+ * @param pstInput Input structure including data buffer and labels
+ * @param pstErr   Error information structure for logging any errors
+ * @return         LIB_OK if success, else LIB_ERR if any error occurred
+ ******************************************************************************/
+LIB_U32 ValidateInput(const LIB_INPUT* pstInput, LIB_ERROR_INFO* pstErr)
+{
+	LIB_CHAR szRuntimeMsg[LIB_MAX_BUFFER_SIZE] = "";
+
+	// Check for null pointers
+	if (pstInput == NULL || (pstInput->prgdBuffer == NULL && pstInput->prgstColumns == NULL && pstInput->pstFile == NULL)
+		|| pstInput->prgszLabels == NULL)
+	{
+		snprintf(szRuntimeMsg, sizeof(szRuntimeMsg), "Input struct is null pointer");
+		LOG_ERROR(pstErr, LIB_ERR_INPUT_PTR_NULL, LIB_ERR_INPUT_PTR_NULL_MSG, LIB_ERR_INPUT_PTR_NULL_ACT, szRuntimeMsg)
+		return LIB_ERR;
+	}
+	if (pstInput->pstFile != NULL && ValidateFile(pstInput, pstErr) != LIB_OK)
+	{
+		return LIB_ERR;
+	}
+
+	// Check the typed columns, each is sent in its own type, and the X column
+	for (LIB_U32 u32Col = 0; pstInput->prgstColumns != NULL && u32Col < pstInput->u32ColSize; u32Col++)
+	{
+		LIB_CHAR szName[32];
+		snprintf(szName, sizeof(szName), "column %u", u32Col);
+		if (ValidateColumn(&pstInput->prgstColumns[u32Col], szName, pstErr) != LIB_OK)
 		{
-			dwErr = GetLastError();
-			if (!(dwErr == ERROR_IO_INCOMPLETE))
-			{
-				CloseHandle(stOverlapped.hEvent);
-				// Some other error occurred while connecting server to pipe
-				LIB_CHAR szErrHelpString[LIB_MAX_BUFFER_SIZE] = LIB_ERR_WIN_API_ERR_ACT;
-				GetWinAPIErrMessage(GetLastError(), szErrHelpString, pstErr);
-				snprintf(szRuntimeMsg, sizeof(szRuntimeMsg), "ConnectNamedPipe() failed");
-				LOG_ERROR(pstErr, LIB_ERR_WIN_API_ERR, LIB_ERR_WIN_API_ERR_MSG, szErrHelpString, szRuntimeMsg)
-				return LIB_ERR;
-			}
-			// Timeout lapsed, terminate process before reporting error
-			TerminateProcess(pstPipeInfo->hChildProcess, 0);
-			CloseHandle(stOverlapped.hEvent);
-			snprintf(szRuntimeMsg, sizeof(szRuntimeMsg), "No response from the Python tool after %d seconds", nServerWaitTimeMs / 1000);
-			LOG_ERROR(pstErr, LIB_ERR_SERVER_TIMEOUT, LIB_ERR_SERVER_TIMEOUT_MSG, LIB_ERR_SERVER_TIMEOUT_ACT, szRuntimeMsg)
 			return LIB_ERR;
 		}
 	}
-
-	// 03(a). WriteFile() to send input struct to Python tool
-	if (!(WriteFile(
-		pstPipeInfo->hNamedPipe, // The handle to the named pipe
-		pstInput,                // A pointer to the buffer that sends the data to the named pipe
-		dwWriteBufferSizeInput,  // The number of bytes to be written to the file 
-		&dwResult,               
-		NULL                     
-	)))
-	{
-		CloseHandle(stOverlapped.hEvent);
-		// Error writing to named pipe
-		LIB_CHAR szErrHelpString[LIB_MAX_BUFFER_SIZE] = LIB_ERR_WIN_API_ERR_ACT;
-		GetWinAPIErrMessage(GetLastError(), szErrHelpString, pstErr);
-		snprintf(szRuntimeMsg, sizeof(szRuntimeMsg), "WriteFile() failed - error writing to pipe");
-		LOG_ERROR(pstErr, LIB_ERR_WIN_API_ERR, LIB_ERR_WIN_API_ERR_MSG, szErrHelpString, szRuntimeMsg)
+	if (pstInput->pstXColumn != NULL && ValidateColumn(pstInput->pstXColumn, "the X column", pstErr) != LIB_OK)
+	{
 		return LIB_ERR;
 	}
 
-	// 03(B). WriteFile() to send data to Python tool
-	if (!(WriteFile(
-		pstPipeInfo->hNamedPipe,   // The handle to the named pipe
-		pstPipeInfo->pstDataArray, // A pointer to the buffer that sends the data to the named pipe
-		dwWriteBufferSizeData,     // The number of bytes to be written to the file 
-		&dwResult,                 
-		NULL                       
-	)))
-	{
-		CloseHandle(stOverlapped.hEvent);
-		// Error writing to named pipe
-		LIB_CHAR szErrHelpString[LIB_MAX_BUFFER_SIZE] = LIB_ERR_WIN_API_ERR_ACT;
-		GetWinAPIErrMessage(GetLastError(), szErrHelpString, pstErr);
-		snprintf(szRuntimeMsg, sizeof(szRuntimeMsg), "WriteFile() failed - error writing to pipe");
-		LOG_ERROR(pstErr, LIB_ERR_WIN_API_ERR, LIB_ERR_WIN_API_ERR_MSG, szErrHelpString, szRuntimeMsg)
+	// Check the size in bytes fits in 64 bits, the data is streamed so there is no other limit
+	if ((LIB_U64)pstInput->u32RowSize * pstInput->u32ColSize > ~0ULL / sizeof(LIB_DOUBLE))
+	{
+		snprintf(szRuntimeMsg, sizeof(szRuntimeMsg), "Buffer size of %u x %u doubles does not fit in 64 bits", 
+			pstInput->u32RowSize, pstInput->u32ColSize);
+		LOG_ERROR(pstErr, LIB_ERR_BUFFER_OVERFLOW, LIB_ERR_BUFFER_OVERFLOW_MSG, LIB_ERR_BUFFER_OVERFLOW_ACT, szRuntimeMsg)
 		return LIB_ERR;
 	}
 
-	// 03(c). WriteFile() to send user labels to Python tool
-	if (!(WriteFile(
-		pstPipeInfo->hNamedPipe,    // The handle to the named pipe
-		pstPipeInfo->pstLabelArray, // A pointer to the buffer that sends the data to the named pipe
-		dwWriteBufferSizeLabels,    // The number of bytes to be written to the file 								   
-		&dwResult,                  
-		NULL                        
-	)))
-	{
-		CloseHandle(stOverlapped.hEvent);
-		// Error writing to named pipe
-		LIB_CHAR szErrHelpString[LIB_MAX_BUFFER_SIZE] = LIB_ERR_WIN_API_ERR_ACT;
-		GetWinAPIErrMessage(GetLastError(), szErrHelpString, pstErr);
-		snprintf(szRuntimeMsg, sizeof(szRuntimeMsg), "WriteFile() failed - error writing to pipe");
-		LOG_ERROR(pstErr, LIB_ERR_WIN_API_ERR, LIB_ERR_WIN_API_ERR_MSG, szErrHelpString, szRuntimeMsg)
+	// Check the decimation options
+	if (pstInput->u32Decimation > LIB_DECIMATE_LTTB || (pstInput->u32MaxPoints != 0 && pstInput->u32MaxPoints < 4))
+	{
+		snprintf(szRuntimeMsg, sizeof(szRuntimeMsg), "Decimation %u to %u points is not supported", 
+			pstInput->u32Decimation, pstInput->u32MaxPoints);
+		LOG_ERROR(pstErr, LIB_ERR_INPUT_INVALID, LIB_ERR_INPUT_INVALID_MSG, LIB_ERR_INPUT_INVALID_ACT, szRuntimeMsg)
 		return LIB_ERR;
 	}
 
-	// 04. FlushFileBuffers() after writing data
-	// FlushFileBuffers() ensure that all bytes or messages written to the pipe are read by the client
-	if (!FlushFileBuffers(pstPipeInfo->hNamedPipe))
+	// Check the renderer and the output
+	if (pstInput->u32Backend > LIB_BACKEND_NATIVE || pstInput->u32Output > LIB_OUTPUT_RGBA
+		|| (pstInput->u32Dpi != 0 && (pstInput->u32Dpi < LIB_MIN_DPI || pstInput->u32Dpi > LIB_MAX_DPI)))
 	{
-		CloseHandle(stOverlapped.hEvent);
-		// Error flushing buffer because client has not finished reading all bytes
-		LIB_CHAR szErrHelpString[LIB_MAX_BUFFER_SIZE] = LIB_ERR_WIN_API_ERR_ACT;
-		GetWinAPIErrMessage(GetLastError(), szErrHelpString, pstErr);
-		snprintf(szRuntimeMsg, sizeof(szRuntimeMsg), "FlushFileBuffer() failed");
-		LOG_ERROR(pstErr, LIB_ERR_WIN_API_ERR, LIB_ERR_WIN_API_ERR_MSG, szErrHelpString, szRuntimeMsg)
+		snprintf(szRuntimeMsg, sizeof(szRuntimeMsg), "Backend %u, output %u at %u dpi is not supported", 
+			pstInput->u32Backend, pstInput->u32Output, pstInput->u32Dpi);
+		LOG_ERROR(pstErr, LIB_ERR_INPUT_INVALID, LIB_ERR_INPUT_INVALID_MSG, LIB_ERR_INPUT_INVALID_ACT, szRuntimeMsg)
 		return LIB_ERR;
 	}
-
-	// 05. ReadFile() to receieve status
-	if (!(ReadFile(
-		pstPipeInfo->hNamedPipe, // The handle to the named pipe
-		pstErr,                  // A pointer to the buffer that receives the data from the named pipe
-		dwReadBufferSize,        // The maximum number of bytes to be read
-		&dwResult,               
-		NULL                     
-	)))
-	{
-		CloseHandle(stOverlapped.hEvent);
-		// Error reading data from client
-		LIB_CHAR szErrHelpString[LIB_MAX_BUFFER_SIZE] = LIB_ERR_WIN_API_ERR_ACT;
-		GetWinAPIErrMessage(GetLastError(), szErrHelpString, pstErr);
-		snprintf(szRuntimeMsg, sizeof(szRuntimeMsg), "ReadFile() failed - error reading from pipe");
-		LOG_ERROR(pstErr, LIB_ERR_WIN_API_ERR, LIB_ERR_WIN_API_ERR_MSG, szErrHelpString, szRuntimeMsg)
+	if (pstInput->u32Output != LIB_OUTPUT_FILE && pstInput->pstImage == NULL)
+	{
+		snprintf(szRuntimeMsg, sizeof(szRuntimeMsg), "Image is null pointer for output %u", pstInput->u32Output);
+		LOG_ERROR(pstErr, LIB_ERR_INPUT_PTR_NULL, LIB_ERR_INPUT_PTR_NULL_MSG, LIB_ERR_INPUT_PTR_NULL_ACT, szRuntimeMsg)
 		return LIB_ERR;
 	}
+	return LIB_OK;
+}
 
-	// 06. DisconnectNamedPipe() after the data is successfully sent
-	// Any unread data in the pipe is discarded, and makes the client's named pipe handle invalid.
-	// The server can use ConnectNamedPipe() to enable the client to connect again to this instance 
-	// of the named pipe.
-	DisconnectNamedPipe(pstPipeInfo->hNamedPipe);
+/***************************************************************************//**
+ * GetDtypeSize
+ *
+ * Size of one sample of a column
+ *
+ * @param u32Dtype One of LIB_DTYPE_*
+ * @return         Size in bytes, 0 if the type is unknown
+ ******************************************************************************/
+LIB_U32 GetDtypeSize(LIB_U32 u32Dtype)
+{
+	switch (u32Dtype)
+	{
+	case LIB_DTYPE_FLOAT64:
+		return sizeof(LIB_DOUBLE);
+	case LIB_DTYPE_FLOAT32:
+		return sizeof(LIB_FLOAT);
+	case LIB_DTYPE_INT16:
+		return sizeof(LIB_INT16);
+	case LIB_DTYPE_INT32:
+		return sizeof(LIB_INT32);
+	default:
+		return 0;
+	}
+}
 
-	CloseHandle(stOverlapped.hEvent);
-	return LIB_OK;
+/***************************************************************************//**
+ * GetColumnStride
+ *
+ * Distance from one sample of a column to the next
+ *
+ * @param pstColumn Validated column descriptor
+ * @return          u32Stride, or the size of a sample for packed samples
+ ******************************************************************************/
+LIB_U64 GetColumnStride(const LIB_COLUMN* pstColumn)
+{
+	return (pstColumn->u32Stride != 0) ? pstColumn->u32Stride : GetDtypeSize(pstColumn->u32Dtype);
 }
 
 /***************************************************************************//**
- * GetWinAPIErrMessage
+ * IsSessionLost
  *
- * Retrives the error message from GetLastError() and logs the message 
- * into the runtime message
+ * Tells whether the Python tool of a session can still be used after a
+ * failed plot. Errors reported by the tool itself and rejected inputs leave
+ * it waiting for the next request; anything else means the connection is gone.
  *
- * @param dwErrCode            Error code generated by GetLastError()
- * @param pszOutWinAPIErrorMsg Runtime message for WinAPI errors
- * @param pstErr               Error information structure for logging any errors
- * @return                     LIB_OK if success, else LIB_ERR if any error 
- *                             occurred
+ * @param u32ErrCode Error code of the failed plot
+ * @return           LIB_TRUE if the session must be reopened
+ ******************************************************************************/
+LIB_BOOLEAN IsSessionLost(LIB_U32 u32ErrCode)
+{
+	switch (u32ErrCode)
+	{
+	case LIB_ERR_CLIENT_ERROR:
+	case LIB_ERR_INPUT_PTR_NULL:
+	case LIB_ERR_INPUT_INVALID:
+	case LIB_ERR_BUFFER_OVERFLOW:
+	case LIB_ERR_IMAGE_TOO_SMALL:
+		return LIB_FALSE;
+	default:
+		return LIB_TRUE;
+	}
+}
+
+/***************************************************************************//**
+ * ImageReserve
+ *
+ * Makes room for an image of the given size: the caller's buffer if it is 
+ * large enough, else the buffer of the library, allocated or grown as needed
+ *
+ * @param pstImage Image of the input, u64Size is set in any case
+ * @param u64Size  Bytes of the image
+ * @param pstErr   Error information structure for logging any errors
+ * @return         LIB_OK if pcData can take u64Size bytes, else LIB_ERR
  ******************************************************************************/
-LIB_INT32 GetWinAPIErrMessage(DWORD dwErrCode, LIB_CHAR* pszOutWinAPIErrorMsg, LIB_ERROR_INFO* pstErr)
+LIB_U32 ImageReserve(LIB_IMAGE* pstImage, LIB_U64 u64Size, LIB_ERROR_INFO* pstErr)
 {
-	LPVOID lpMsgBuf;
-	pstErr = pstErr;
-	FormatMessage(FORMAT_MESSAGE_ALLOCATE_BUFFER |
-				  FORMAT_MESSAGE_FROM_SYSTEM |
-				  FORMAT_MESSAGE_IGNORE_INSERTS,
-				  NULL,
-				  dwErrCode,
-				  MAKELANGID(LANG_NEUTRAL, SUBLANG_DEFAULT),
-				  (LPTSTR)&lpMsgBuf,
-				  0, 
-		          NULL);
-
-
-	LIB_CHAR szErrorCodeBuf[LIB_MAX_BUFFER_SIZE] = "";
-	sprintf(szErrorCodeBuf, "Error %d: ", dwErrCode);
-	strncat(pszOutWinAPIErrorMsg, szErrorCodeBuf, LIB_MAX_BUFFER_SIZE - strlen(pszOutWinAPIErrorMsg) - 1);
-	strncat(pszOutWinAPIErrorMsg, (LIB_CHAR*)lpMsgBuf, LIB_MAX_BUFFER_SIZE - strlen(pszOutWinAPIErrorMsg) - 1);
+	LIB_CHAR szRuntimeMsg[LIB_MAX_BUFFER_SIZE] = "";
+
+	pstImage->u64Size = u64Size;
+	if (u64Size <= pstImage->u64Capacity && pstImage->pcData != NULL)
+	{
+		return LIB_OK;
+	}
+	if (pstImage->pcData != NULL && !pstImage->bAllocated)
+	{
+		snprintf(szRuntimeMsg, sizeof(szRuntimeMsg), "Image of %llu bytes in a buffer of %llu bytes", u64Size, pstImage->u64Capacity);
+		LOG_ERROR(pstErr, LIB_ERR_IMAGE_TOO_SMALL, LIB_ERR_IMAGE_TOO_SMALL_MSG, LIB_ERR_IMAGE_TOO_SMALL_ACT, szRuntimeMsg)
+		return LIB_ERR;
+	}
+	LIB_CHAR* pcData = (LIB_CHAR*)realloc(pstImage->bAllocated ? pstImage->pcData : NULL, (size_t)u64Size + 1);
+	if (pcData == NULL)
+	{
+		snprintf(szRuntimeMsg, sizeof(szRuntimeMsg), "Unable to allocate %llu bytes for the image", u64Size);
+		LOG_ERROR(pstErr, LIB_ERR_BUFFER_OVERFLOW, LIB_ERR_BUFFER_OVERFLOW_MSG, LIB_ERR_BUFFER_OVERFLOW_ACT, szRuntimeMsg)
+		return LIB_ERR;
+	}
+	pstImage->pcData = pcData;
+	pstImage->u64Capacity = u64Size;
+	pstImage->bAllocated = LIB_TRUE;
 	return LIB_OK;
-}
\ No newline at end of file
+}
+
+/***************************************************************************//**
+ * ipc_plot_image_free
+ *
+ * Releases the buffer the library allocated for an image
+ *
+ * @param pstImage Image filled in by a plot, may be NULL
+ ******************************************************************************/
+void ipc_plot_image_free(LIB_IMAGE* pstImage)
+{
+	if (pstImage == NULL)
+	{
+		return;
+	}
+	if (pstImage->bAllocated)
+	{
+		free(pstImage->pcData);
+	}
+	*pstImage = LIB_IMAGE();
+}
+
+/***************************************************************************//**
+ * GetRendererPath
+ *
+ * Path of the script run as the Python tool. LIB_RENDERER_ENV can point to
+ * another script speaking the same protocol, e.g. the stand-in renderer of
+ * the benchmarks.
+ *
+ * @return Path of the script
+ ******************************************************************************/
+const LIB_CHAR* GetRendererPath(void)
+{
+	const LIB_CHAR* pszPath = getenv(LIB_RENDERER_ENV);
+	return (pszPath != NULL && pszPath[0] != '\0') ? pszPath : PYTHON_PATH;
+}
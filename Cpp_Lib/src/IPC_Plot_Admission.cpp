@@ -0,0 +1,253 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+#include "IPC_Plot_Internal.h"
+
+// State of an ipc_plot() call waiting in the admission queue
+#define LIB_TICKET_WAITING  0
+#define LIB_TICKET_ADMITTED 1 //!< Counted in u32Active by the call that admitted it
+#define LIB_TICKET_DROPPED  2 //!< Taken out of the queue for a newer call, LIB_ADMIT_DROP_OLDEST
+
+// Gate in front of ipc_plot(), shared by every thread of the process
+typedef struct LIB_ADMISSION
+{
+	std::mutex mutex;                     //!< Guards the members below
+	std::condition_variable cvChange;     //!< Wakes the waiting calls after a ticket changed state
+	std::deque<LIB_U32*> dqWaiting;       //!< Tickets of the waiting calls, the oldest first
+	LIB_U32 u32Active;                    //!< Calls admitted and not yet left
+	LIB_U32 u32PeakActive;
+	LIB_U32 u32MaxActive;                 //!< Resolved limit, never 0
+	LIB_U32 u32QueueLength;
+	LIB_U32 u32Policy;
+} LIB_ADMISSION;
+
+/***************************************************************************//**
+ * GetMaxActive
+ *
+ * Resolves the concurrency limit of ipc_plot_concurrency_config()
+ *
+ * @param u32MaxActive Requested limit, 0 for the number of cores
+ * @return             Limit of at least 1
+ ******************************************************************************/
+static LIB_U32 GetMaxActive(LIB_U32 u32MaxActive)
+{
+	if (u32MaxActive == 0)
+	{
+		u32MaxActive = std::thread::hardware_concurrency();
+	}
+	return (u32MaxActive == 0) ? 1 : u32MaxActive;
+}
+
+/***************************************************************************//**
+ * CreateAdmission
+ *
+ * Creates the admission gate with the default configuration
+ *
+ * @return The admission gate
+ ******************************************************************************/
+static LIB_ADMISSION* CreateAdmission(void)
+{
+	LIB_ADMISSION* pstAdmission = new LIB_ADMISSION();
+	pstAdmission->u32Active = 0;
+	pstAdmission->u32PeakActive = 0;
+	pstAdmission->u32MaxActive = GetMaxActive(0);
+	pstAdmission->u32QueueLength = LIB_ADMIT_DEFAULT_QUEUE;
+	pstAdmission->u32Policy = LIB_ADMIT_BLOCK;
+	return pstAdmission;
+}
+
+/***************************************************************************//**
+ * GetAdmission
+ *
+ * Returns the admission gate, created on first use. Like the pool it is 
+ * never destroyed, so async workers still running at exit never find it gone.
+ *
+ * @return The admission gate
+ ******************************************************************************/
+static LIB_ADMISSION* GetAdmission(void)
+{
+	static LIB_ADMISSION* s_pstAdmission = CreateAdmission();
+	return s_pstAdmission;
+}
+
+/***************************************************************************//**
+ * AdmitWaiting
+ *
+ * Admits the oldest waiting calls while the limit allows
+ *
+ * @param pstAdmission Admission gate, locked by the caller
+ * @return             LIB_TRUE if a ticket changed state and the waiting
+ *                     calls must be woken
+ ******************************************************************************/
+static LIB_BOOLEAN AdmitWaiting(LIB_ADMISSION* pstAdmission)
+{
+	LIB_BOOLEAN bChanged = LIB_FALSE;
+	while (pstAdmission->u32Active < pstAdmission->u32MaxActive && !pstAdmission->dqWaiting.empty())
+	{
+		*pstAdmission->dqWaiting.front() = LIB_TICKET_ADMITTED;
+		pstAdmission->dqWaiting.pop_front();
+		pstAdmission->u32Active++;
+		bChanged = LIB_TRUE;
+	}
+	if (pstAdmission->u32Active > pstAdmission->u32PeakActive)
+	{
+		pstAdmission->u32PeakActive = pstAdmission->u32Active;
+	}
+	return bChanged;
+}
+
+/***************************************************************************//**
+ * AdmissionEnter
+ *
+ * Admits an ipc_plot() call, waiting in the queue while the concurrency
+ * limit is reached. A call admitted here must end with AdmissionLeave().
+ *
+ * @param pstErr Error information structure for logging any errors
+ * @return       LIB_OK once admitted, else LIB_ERR with LIB_ERR_BUSY
+ ******************************************************************************/
+LIB_U32 AdmissionEnter(LIB_ERROR_INFO* pstErr)
+{
+	LIB_CHAR szRuntimeMsg[LIB_MAX_BUFFER_SIZE] = "";
+	LIB_ADMISSION* pstAdmission = GetAdmission();
+	LIB_U32 u32Ticket = LIB_TICKET_WAITING;
+
+	{
+		std::unique_lock<std::mutex> lock(pstAdmission->mutex);
+		// Calls already waiting go first
+		if (pstAdmission->dqWaiting.empty() && pstAdmission->u32Active < pstAdmission->u32MaxActive)
+		{
+			pstAdmission->u32Active++;
+			AdmitWaiting(pstAdmission);
+			return LIB_OK;
+		}
+
+		// With LIB_ADMIT_BLOCK the calls beyond the queue length wait behind it in the same order.
+		// Dropping makes room for the new call, as many as a queue shortened since needs.
+		if (pstAdmission->u32Policy == LIB_ADMIT_DROP_OLDEST)
+		{
+			LIB_BOOLEAN bDropped = LIB_FALSE;
+			while (!pstAdmission->dqWaiting.empty() && pstAdmission->dqWaiting.size() >= pstAdmission->u32QueueLength)
+			{
+				*pstAdmission->dqWaiting.front() = LIB_TICKET_DROPPED;
+				pstAdmission->dqWaiting.pop_front();
+				bDropped = LIB_TRUE;
+			}
+			if (bDropped)
+			{
+				pstAdmission->cvChange.notify_all();
+			}
+		}
+		if (pstAdmission->dqWaiting.size() >= pstAdmission->u32QueueLength)
+		{
+			// Only a queue of length 0 is still full after dropping, there is no place to give
+			if (pstAdmission->u32Policy != LIB_ADMIT_BLOCK)
+			{
+				snprintf(szRuntimeMsg, sizeof(szRuntimeMsg), "%u plots in progress and %u waiting",
+					pstAdmission->u32Active, (LIB_U32)pstAdmission->dqWaiting.size());
+				lock.unlock();
+				LOG_ERROR(pstErr, LIB_ERR_BUSY, LIB_ERR_BUSY_MSG, LIB_ERR_BUSY_ACT, szRuntimeMsg)
+				return LIB_ERR;
+			}
+		}
+		pstAdmission->dqWaiting.push_back(&u32Ticket);
+		pstAdmission->cvChange.wait(lock, [&u32Ticket] { return u32Ticket != LIB_TICKET_WAITING; });
+	}
+
+	if (u32Ticket == LIB_TICKET_DROPPED)
+	{
+		snprintf(szRuntimeMsg, sizeof(szRuntimeMsg), "Dropped from the admission queue for a newer plot");
+		LOG_ERROR(pstErr, LIB_ERR_BUSY, LIB_ERR_BUSY_MSG, LIB_ERR_BUSY_ACT, szRuntimeMsg)
+		return LIB_ERR;
+	}
+	return LIB_OK;
+}
+
+/***************************************************************************//**
+ * AdmissionLeave
+ *
+ * Ends a call admitted by AdmissionEnter() and admits the next waiting one
+ ******************************************************************************/
+void AdmissionLeave(void)
+{
+	LIB_ADMISSION* pstAdmission = GetAdmission();
+	LIB_BOOLEAN bChanged;
+	{
+		std::lock_guard<std::mutex> lock(pstAdmission->mutex);
+		pstAdmission->u32Active--;
+		bChanged = AdmitWaiting(pstAdmission);
+	}
+	if (bChanged)
+	{
+		pstAdmission->cvChange.notify_all();
+	}
+}
+
+/***************************************************************************//**
+ * AdmissionPeak
+ *
+ * Reads the most calls admitted at the same time, for ipc_plot_get_counters()
+ *
+ * @return Peak number of admitted calls since the process started
+ ******************************************************************************/
+LIB_U32 AdmissionPeak(void)
+{
+	LIB_ADMISSION* pstAdmission = GetAdmission();
+	std::lock_guard<std::mutex> lock(pstAdmission->mutex);
+	return pstAdmission->u32PeakActive;
+}
+
+/***************************************************************************//**
+ * ipc_plot_concurrency_config
+ *
+ * Sets the concurrency limit of ipc_plot() and its admission queue
+ *
+ * @param u32MaxActive   Calls plotting at the same time, 0 for the number of cores
+ * @param u32QueueLength Calls waiting for admission, 0 for none
+ * @param u32Policy      LIB_ADMIT_* policy for a call finding the queue full
+ * @param pstErr         Error information structure for logging any errors
+ * @return               LIB_OK if success, else LIB_ERR if any error occurred
+ ******************************************************************************/
+LIB_U32 ipc_plot_concurrency_config(LIB_U32 u32MaxActive, LIB_U32 u32QueueLength, LIB_U32 u32Policy,
+	LIB_ERROR_INFO* pstErr)
+{
+	LIB_CHAR szRuntimeMsg[LIB_MAX_BUFFER_SIZE] = "";
+
+	// Check for null pointers
+	if (pstErr == NULL)
+	{
+		return LIB_ERR;
+	}
+	// The status of a previous successful call is not an error, let this call log its own
+	if (pstErr->u32ErrCode == LIB_STATUS_DONE)
+	{
+		*pstErr = LIB_ERROR_INFO();
+	}
+	if (u32Policy > LIB_ADMIT_DROP_OLDEST)
+	{
+		snprintf(szRuntimeMsg, sizeof(szRuntimeMsg), "Unknown admission policy %u", u32Policy);
+		LOG_ERROR(pstErr, LIB_ERR_INPUT_INVALID, LIB_ERR_INPUT_INVALID_MSG, LIB_ERR_INPUT_INVALID_ACT, szRuntimeMsg)
+		return LIB_ERR;
+	}
+
+	// Calls in progress are not interrupted by a lower limit, a higher one admits waiting calls at once
+	LIB_ADMISSION* pstAdmission = GetAdmission();
+	LIB_BOOLEAN bChanged;
+	{
+		std::lock_guard<std::mutex> lock(pstAdmission->mutex);
+		pstAdmission->u32MaxActive = GetMaxActive(u32MaxActive);
+		pstAdmission->u32QueueLength = u32QueueLength;
+		pstAdmission->u32Policy = u32Policy;
+		bChanged = AdmitWaiting(pstAdmission);
+	}
+	if (bChanged)
+	{
+		pstAdmission->cvChange.notify_all();
+	}
+	pstErr->u32ErrCode = LIB_STATUS_DONE;
+	return LIB_OK;
+}
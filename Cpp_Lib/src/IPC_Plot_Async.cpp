@@ -0,0 +1,514 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <system_error>
+#include <thread>
+
+#include "IPC_Plot_Internal.h"
+
+// A plot started with ipc_plot_async(), shared by the caller and a worker thread
+struct LIB_PLOT_HANDLE
+{
+	LIB_INPUT stInput;                //!< Input as given, or pointing at the snapshot below
+	LIB_DOUBLE* prgdCopy;             //!< Snapshot of the data from ipc_plot_alloc(), LIB_ASYNC_COPY only
+	const LIB_CHAR** prgszLabelsCopy; //!< Snapshot of the labels, pointers followed by the text in one block
+	LIB_COLUMN* prgstColumnsCopy;     //!< Snapshot of typed columns and the X column, descriptors followed by the samples in one block
+	LIB_FILE_INPUT* pstFileCopy;      //!< Snapshot of the file input, columns and path in one block, the file itself is not copied
+	LIB_PLOT_CALLBACK pfnCallback;
+	void* pvUser;
+	std::mutex mutex;                 //!< Guards the members below
+	std::condition_variable cvDone;
+	LIB_ERROR_INFO stResult;          //!< Error information of ipc_plot(), valid once bDone is set
+	LIB_BOOLEAN bDone;
+	LIB_U32 u32Refs;                  //!< The worker holds one until the callback returns, the caller one until ipc_plot_release()
+	LIB_PLOT_HANDLE* pstNext;         //!< Next queued plot
+};
+
+// Queue of plots waiting for one of the LIB_ASYNC_THREADS workers
+typedef struct LIB_EXECUTOR
+{
+	std::mutex mutex;
+	std::condition_variable cvWork;
+	LIB_PLOT_HANDLE* pstHead;
+	LIB_PLOT_HANDLE* pstTail;
+} LIB_EXECUTOR;
+
+/***************************************************************************//**
+ * ReleaseHandle
+ *
+ * Drops one reference to a handle and frees it with the last one
+ *
+ * @param pstHandle Handle from ipc_plot_async()
+ ******************************************************************************/
+static void ReleaseHandle(LIB_PLOT_HANDLE* pstHandle)
+{
+	LIB_BOOLEAN bLast;
+	{
+		std::lock_guard<std::mutex> lock(pstHandle->mutex);
+		bLast = (LIB_BOOLEAN)(--pstHandle->u32Refs == 0);
+	}
+	if (bLast)
+	{
+		delete pstHandle;
+	}
+}
+
+/***************************************************************************//**
+ * FreeSnapshot
+ *
+ * Releases the copy of the data and labels once the plot has been sent
+ *
+ * @param pstHandle Handle from ipc_plot_async()
+ ******************************************************************************/
+static void FreeSnapshot(LIB_PLOT_HANDLE* pstHandle)
+{
+	ipc_plot_free(pstHandle->prgdCopy);
+	free((void*)pstHandle->prgszLabelsCopy);
+	free(pstHandle->prgstColumnsCopy);
+	free(pstHandle->pstFileCopy);
+	pstHandle->prgdCopy = NULL;
+	pstHandle->prgszLabelsCopy = NULL;
+	pstHandle->prgstColumnsCopy = NULL;
+	pstHandle->pstFileCopy = NULL;
+}
+
+/***************************************************************************//**
+ * WorkerMain
+ *
+ * Worker thread, runs queued plots one at a time for as long as the process
+ * lives
+ *
+ * @param pstExecutor Queue shared by all workers
+ ******************************************************************************/
+static void WorkerMain(LIB_EXECUTOR* pstExecutor)
+{
+	for (;;)
+	{
+		LIB_PLOT_HANDLE* pstHandle;
+		{
+			std::unique_lock<std::mutex> lock(pstExecutor->mutex);
+			pstExecutor->cvWork.wait(lock, [pstExecutor] { return pstExecutor->pstHead != NULL; });
+			pstHandle = pstExecutor->pstHead;
+			pstExecutor->pstHead = pstHandle->pstNext;
+			if (pstExecutor->pstHead == NULL)
+			{
+				pstExecutor->pstTail = NULL;
+			}
+		}
+
+		LIB_ERROR_INFO stResult;
+		ipc_plot(&pstHandle->stInput, &stResult);
+		FreeSnapshot(pstHandle);
+		{
+			std::lock_guard<std::mutex> lock(pstHandle->mutex);
+			pstHandle->stResult = stResult;
+			pstHandle->bDone = LIB_TRUE;
+		}
+		pstHandle->cvDone.notify_all();
+
+		// The handle stays valid during the callback even if the caller has released it
+		if (pstHandle->pfnCallback != NULL)
+		{
+			pstHandle->pfnCallback(pstHandle, &pstHandle->stResult, pstHandle->pvUser);
+		}
+		ReleaseHandle(pstHandle);
+	}
+}
+
+/***************************************************************************//**
+ * StartExecutor
+ *
+ * Creates the queue and starts the worker threads
+ *
+ * @return The executor, or NULL if no thread could be started
+ ******************************************************************************/
+static LIB_EXECUTOR* StartExecutor(void)
+{
+	LIB_EXECUTOR* pstExecutor = new LIB_EXECUTOR();
+	pstExecutor->pstHead = NULL;
+	pstExecutor->pstTail = NULL;
+	LIB_U32 u32Started = 0;
+	for (LIB_U32 u32Thread = 0; u32Thread < LIB_ASYNC_THREADS; u32Thread++)
+	{
+		try
+		{
+			std::thread(WorkerMain, pstExecutor).detach();
+			u32Started++;
+		}
+		catch (const std::system_error&)
+		{
+			break;
+		}
+	}
+	if (u32Started == 0)
+	{
+		delete pstExecutor;
+		return NULL;
+	}
+	return pstExecutor;
+}
+
+/***************************************************************************//**
+ * GetExecutor
+ *
+ * Returns the executor, started on first use. It is never destroyed: joining
+ * threads from a static destructor can deadlock while a DLL is unloaded, and
+ * idle workers simply end with the process.
+ *
+ * @return The executor, or NULL if no thread could be started
+ ******************************************************************************/
+static LIB_EXECUTOR* GetExecutor(void)
+{
+	static LIB_EXECUTOR* s_pstExecutor = StartExecutor();
+	return s_pstExecutor;
+}
+
+/***************************************************************************//**
+ * SnapshotColumns
+ *
+ * Copies typed columns and the X column in their own type, each sample 
+ * block aligned for its type. Strided samples are packed on the way.
+ *
+ * @param pstHandle Handle whose input is replaced by the snapshot
+ * @param pstErr    Error information structure for logging any errors
+ * @return          LIB_OK if success, else LIB_ERR if any error occurred
+ ******************************************************************************/
+static LIB_U32 SnapshotColumns(LIB_PLOT_HANDLE* pstHandle, LIB_ERROR_INFO* pstErr)
+{
+	LIB_CHAR szRuntimeMsg[LIB_MAX_BUFFER_SIZE] = "";
+	LIB_INPUT* pstInput = &pstHandle->stInput;
+	LIB_U32 u32Typed = (pstInput->prgstColumns != NULL) ? pstInput->u32ColSize : 0;
+	LIB_U32 u32Count = u32Typed + ((pstInput->pstXColumn != NULL) ? 1 : 0);
+	size_t szHeadSize = (u32Count * sizeof(LIB_COLUMN) + 7) / 8 * 8;
+	size_t szSize = szHeadSize;
+	for (LIB_U32 u32Col = 0; u32Col < u32Count; u32Col++)
+	{
+		const LIB_COLUMN* pstColumn = (u32Col < u32Typed) ? &pstInput->prgstColumns[u32Col] : pstInput->pstXColumn;
+		szSize += ((size_t)pstInput->u32RowSize * GetDtypeSize(pstColumn->u32Dtype) + 7) / 8 * 8;
+	}
+
+	LIB_CHAR* pcBlock = (LIB_CHAR*)malloc(szSize);
+	if (pcBlock == NULL)
+	{
+		snprintf(szRuntimeMsg, sizeof(szRuntimeMsg), "Unable to copy %zu bytes of columns, use LIB_ASYNC_BORROW", szSize);
+		LOG_ERROR(pstErr, LIB_ERR_BUFFER_OVERFLOW, LIB_ERR_BUFFER_OVERFLOW_MSG, LIB_ERR_BUFFER_OVERFLOW_ACT, szRuntimeMsg)
+		return LIB_ERR;
+	}
+	// The typed columns first, the X column last
+	LIB_COLUMN* prgstColumns = (LIB_COLUMN*)pcBlock;
+	LIB_CHAR* pcData = pcBlock + szHeadSize;
+	for (LIB_U32 u32Col = 0; u32Col < u32Count; u32Col++)
+	{
+		const LIB_COLUMN* pstColumn = (u32Col < u32Typed) ? &pstInput->prgstColumns[u32Col] : pstInput->pstXColumn;
+		size_t szSampleSize = GetDtypeSize(pstColumn->u32Dtype);
+		size_t szColSize = (size_t)pstInput->u32RowSize * szSampleSize;
+		prgstColumns[u32Col] = *pstColumn;
+		if (GetColumnStride(pstColumn) == szSampleSize)
+		{
+			memcpy(pcData, pstColumn->pvData, szColSize);
+		}
+		else
+		{
+			const LIB_CHAR* pcSample = (const LIB_CHAR*)pstColumn->pvData;
+			for (LIB_U32 u32Row = 0; u32Row < pstInput->u32RowSize; u32Row++, pcSample += pstColumn->u32Stride)
+			{
+				memcpy(pcData + (size_t)u32Row * szSampleSize, pcSample, szSampleSize);
+			}
+		}
+		prgstColumns[u32Col].pvData = pcData;
+		prgstColumns[u32Col].u32Stride = 0;
+		pcData += (szColSize + 7) / 8 * 8;
+	}
+	pstHandle->prgstColumnsCopy = prgstColumns;
+	if (pstInput->prgstColumns != NULL)
+	{
+		pstInput->prgstColumns = prgstColumns;
+	}
+	if (pstInput->pstXColumn != NULL)
+	{
+		pstInput->pstXColumn = &prgstColumns[u32Typed];
+	}
+	return LIB_OK;
+}
+
+/***************************************************************************//**
+ * SnapshotFile
+ *
+ * Copies the description of a file input: the path and the layout of its
+ * columns. The file is read when the plot runs, it must not change before.
+ *
+ * @param pstHandle Handle whose input is replaced by the snapshot
+ * @param pstErr    Error information structure for logging any errors
+ * @return          LIB_OK if success, else LIB_ERR if any error occurred
+ ******************************************************************************/
+static LIB_U32 SnapshotFile(LIB_PLOT_HANDLE* pstHandle, LIB_ERROR_INFO* pstErr)
+{
+	LIB_CHAR szRuntimeMsg[LIB_MAX_BUFFER_SIZE] = "";
+	LIB_INPUT* pstInput = &pstHandle->stInput;
+	const LIB_FILE_INPUT* pstFile = pstInput->pstFile;
+	LIB_U32 u32Count = pstInput->u32ColSize + ((pstFile->pstXColumn != NULL) ? 1 : 0);
+	size_t szColumnsSize = u32Count * sizeof(LIB_FILE_COLUMN);
+	size_t szPathSize = strlen(pstFile->pszPath) + 1;
+
+	// The input, the columns with the X column last, then the path
+	LIB_CHAR* pcBlock = (LIB_CHAR*)malloc(sizeof(LIB_FILE_INPUT) + szColumnsSize + szPathSize);
+	if (pcBlock == NULL)
+	{
+		snprintf(szRuntimeMsg, sizeof(szRuntimeMsg), "Unable to copy the file input %s", pstFile->pszPath);
+		LOG_ERROR(pstErr, LIB_ERR_BUFFER_OVERFLOW, LIB_ERR_BUFFER_OVERFLOW_MSG, LIB_ERR_BUFFER_OVERFLOW_ACT, szRuntimeMsg)
+		return LIB_ERR;
+	}
+	LIB_FILE_INPUT* pstFileCopy = (LIB_FILE_INPUT*)pcBlock;
+	LIB_FILE_COLUMN* prgstColumns = (LIB_FILE_COLUMN*)(pcBlock + sizeof(LIB_FILE_INPUT));
+	LIB_CHAR* pszPath = pcBlock + sizeof(LIB_FILE_INPUT) + szColumnsSize;
+	memcpy(prgstColumns, pstFile->prgstColumns, pstInput->u32ColSize * sizeof(LIB_FILE_COLUMN));
+	if (pstFile->pstXColumn != NULL)
+	{
+		prgstColumns[pstInput->u32ColSize] = *pstFile->pstXColumn;
+	}
+	memcpy(pszPath, pstFile->pszPath, szPathSize);
+	pstFileCopy->pszPath = pszPath;
+	pstFileCopy->prgstColumns = prgstColumns;
+	pstFileCopy->pstXColumn = (pstFile->pstXColumn != NULL) ? &prgstColumns[pstInput->u32ColSize] : NULL;
+	pstHandle->pstFileCopy = pstFileCopy;
+	pstInput->pstFile = pstFileCopy;
+	return LIB_OK;
+}
+
+/***************************************************************************//**
+ * TakeSnapshot
+ *
+ * Copies the data and labels of the input so the caller can reuse them as
+ * soon as ipc_plot_async() returns. The data is copied into a buffer from
+ * ipc_plot_alloc(), so this is the only copy made on its way to the Python
+ * tool. Typed columns are copied in their own type, of a file only its
+ * description is.
+ *
+ * @param pstHandle Handle whose input is replaced by the snapshot
+ * @param pstErr    Error information structure for logging any errors
+ * @return          LIB_OK if success, else LIB_ERR if any error occurred
+ ******************************************************************************/
+static LIB_U32 TakeSnapshot(LIB_PLOT_HANDLE* pstHandle, LIB_ERROR_INFO* pstErr)
+{
+	LIB_CHAR szRuntimeMsg[LIB_MAX_BUFFER_SIZE] = "";
+	LIB_INPUT* pstInput = &pstHandle->stInput;
+	LIB_U64 u64Count = (LIB_U64)pstInput->u32RowSize * pstInput->u32ColSize;
+
+	if (pstInput->pstFile != NULL)
+	{
+		if (SnapshotFile(pstHandle, pstErr) != LIB_OK)
+		{
+			return LIB_ERR;
+		}
+	}
+	else if (pstInput->prgstColumns == NULL && u64Count > 0xFFFFFFFFULL)
+	{
+		snprintf(szRuntimeMsg, sizeof(szRuntimeMsg), "Unable to copy %llu doubles, use LIB_ASYNC_BORROW", u64Count);
+		LOG_ERROR(pstErr, LIB_ERR_BUFFER_OVERFLOW, LIB_ERR_BUFFER_OVERFLOW_MSG, LIB_ERR_BUFFER_OVERFLOW_ACT, szRuntimeMsg)
+		return LIB_ERR;
+	}
+	if (pstInput->prgstColumns != NULL || pstInput->pstXColumn != NULL)
+	{
+		if (SnapshotColumns(pstHandle, pstErr) != LIB_OK)
+		{
+			return LIB_ERR;
+		}
+	}
+	// Nothing is read from an empty buffer, its pointer is kept
+	if (pstInput->prgstColumns == NULL && pstInput->pstFile == NULL && u64Count > 0)
+	{
+		if (ipc_plot_alloc((LIB_U32)u64Count, &pstHandle->prgdCopy, pstErr) != LIB_OK)
+		{
+			return LIB_ERR;
+		}
+		// The buffer leaves its status, later errors are logged by this call
+		*pstErr = LIB_ERROR_INFO();
+		memcpy(pstHandle->prgdCopy, pstInput->prgdBuffer, u64Count * sizeof(LIB_DOUBLE));
+		pstInput->prgdBuffer = pstHandle->prgdCopy;
+	}
+
+	// Label pointers followed by the text of every label
+	size_t szTextSize = 0;
+	for (LIB_U32 u32Col = 0; u32Col < pstInput->u32ColSize; u32Col++)
+	{
+		szTextSize += strlen(pstInput->prgszLabels[u32Col]) + 1;
+	}
+	size_t szPointerSize = pstInput->u32ColSize * sizeof(LIB_CHAR*);
+	LIB_CHAR* pcBlock = (LIB_CHAR*)malloc(szPointerSize + szTextSize + 1);
+	if (pcBlock == NULL)
+	{
+		snprintf(szRuntimeMsg, sizeof(szRuntimeMsg), "Unable to copy %u labels", pstInput->u32ColSize);
+		LOG_ERROR(pstErr, LIB_ERR_BUFFER_OVERFLOW, LIB_ERR_BUFFER_OVERFLOW_MSG, LIB_ERR_BUFFER_OVERFLOW_ACT, szRuntimeMsg)
+		return LIB_ERR;
+	}
+	const LIB_CHAR** prgszLabels = (const LIB_CHAR**)pcBlock;
+	LIB_CHAR* pcText = pcBlock + szPointerSize;
+	for (LIB_U32 u32Col = 0; u32Col < pstInput->u32ColSize; u32Col++)
+	{
+		size_t szLength = strlen(pstInput->prgszLabels[u32Col]) + 1;
+		memcpy(pcText, pstInput->prgszLabels[u32Col], szLength);
+		prgszLabels[u32Col] = pcText;
+		pcText += szLength;
+	}
+	pstHandle->prgszLabelsCopy = prgszLabels;
+	pstInput->prgszLabels = prgszLabels;
+	return LIB_OK;
+}
+
+/***************************************************************************//**
+ * ipc_plot_async
+ *
+ * Queues a plot for the worker threads and returns its handle.
+ *
+ * @param pstInput      Input structure including data buffer and labels
+ * @param u32Mode       LIB_ASYNC_COPY or LIB_ASYNC_BORROW
+ * @param pfnCallback   Called with the result once the plot completes, may be NULL
+ * @param pvUser        Passed to pfnCallback
+ * @param ppstOutHandle Receives the handle, may be NULL
+ * @param pstErr        Error information structure for logging any errors
+ * @return              LIB_OK if the plot was started, else LIB_ERR
+ ******************************************************************************/
+LIB_U32 ipc_plot_async(LIB_INPUT* pstInput, LIB_U32 u32Mode, LIB_PLOT_CALLBACK pfnCallback, void* pvUser,
+	LIB_PLOT_HANDLE** ppstOutHandle, LIB_ERROR_INFO* pstErr)
+{
+	LIB_CHAR szRuntimeMsg[LIB_MAX_BUFFER_SIZE] = "";
+
+	// Check for null pointers
+	if (pstErr == NULL)
+	{
+		return LIB_ERR;
+	}
+	// The status of a previous successful plot is not an error, let this call log its own
+	if (pstErr->u32ErrCode == LIB_STATUS_DONE)
+	{
+		*pstErr = LIB_ERROR_INFO();
+	}
+	if (ppstOutHandle != NULL)
+	{
+		*ppstOutHandle = NULL;
+	}
+	if (ValidateInput(pstInput, pstErr) != LIB_OK)
+	{
+		return LIB_ERR;
+	}
+	if (u32Mode != LIB_ASYNC_COPY && u32Mode != LIB_ASYNC_BORROW)
+	{
+		snprintf(szRuntimeMsg, sizeof(szRuntimeMsg), "Unknown buffer mode %u", u32Mode);
+		LOG_ERROR(pstErr, LIB_ERR_INPUT_INVALID, LIB_ERR_INPUT_INVALID_MSG, LIB_ERR_INPUT_INVALID_ACT, szRuntimeMsg)
+		return LIB_ERR;
+	}
+	LIB_EXECUTOR* pstExecutor = GetExecutor();
+	if (pstExecutor == NULL)
+	{
+		snprintf(szRuntimeMsg, sizeof(szRuntimeMsg), "Unable to start the worker threads");
+		LOG_ERROR(pstErr, LIB_ERR_BUFFER_OVERFLOW, LIB_ERR_BUFFER_OVERFLOW_MSG, LIB_ERR_BUFFER_OVERFLOW_ACT, szRuntimeMsg)
+		return LIB_ERR;
+	}
+
+	LIB_PLOT_HANDLE* pstHandle = new LIB_PLOT_HANDLE();
+	pstHandle->stInput = *pstInput;
+	pstHandle->prgdCopy = NULL;
+	pstHandle->prgszLabelsCopy = NULL;
+	pstHandle->prgstColumnsCopy = NULL;
+	pstHandle->pstFileCopy = NULL;
+	pstHandle->pfnCallback = pfnCallback;
+	pstHandle->pvUser = pvUser;
+	pstHandle->bDone = LIB_FALSE;
+	pstHandle->u32Refs = (ppstOutHandle != NULL) ? 2 : 1;
+	pstHandle->pstNext = NULL;
+	if (u32Mode == LIB_ASYNC_COPY && TakeSnapshot(pstHandle, pstErr) != LIB_OK)
+	{
+		FreeSnapshot(pstHandle);
+		delete pstHandle;
+		return LIB_ERR;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(pstExecutor->mutex);
+		if (pstExecutor->pstTail != NULL)
+		{
+			pstExecutor->pstTail->pstNext = pstHandle;
+		}
+		else
+		{
+			pstExecutor->pstHead = pstHandle;
+		}
+		pstExecutor->pstTail = pstHandle;
+	}
+	pstExecutor->cvWork.notify_one();
+
+	if (ppstOutHandle != NULL)
+	{
+		*ppstOutHandle = pstHandle;
+	}
+	return LIB_OK;
+}
+
+/***************************************************************************//**
+ * ipc_plot_wait
+ *
+ * Waits for a plot started with ipc_plot_async() to complete.
+ *
+ * @param pstHandle    Handle from ipc_plot_async()
+ * @param u32TimeoutMs Longest time to wait, 0 to poll, LIB_WAIT_INFINITE to wait until completion
+ * @param pstOutResult Receives the result, may be NULL
+ * @return             LIB_OK if the plot has completed, LIB_ERR if it is still running
+ ******************************************************************************/
+LIB_U32 ipc_plot_wait(LIB_PLOT_HANDLE* pstHandle, LIB_U32 u32TimeoutMs, LIB_ERROR_INFO* pstOutResult)
+{
+	if (pstHandle == NULL)
+	{
+		return LIB_ERR;
+	}
+	std::unique_lock<std::mutex> lock(pstHandle->mutex);
+	if (u32TimeoutMs == LIB_WAIT_INFINITE)
+	{
+		pstHandle->cvDone.wait(lock, [pstHandle] { return pstHandle->bDone == LIB_TRUE; });
+	}
+	else
+	{
+		pstHandle->cvDone.wait_for(lock, std::chrono::milliseconds(u32TimeoutMs), [pstHandle] { return pstHandle->bDone == LIB_TRUE; });
+	}
+	if (!pstHandle->bDone)
+	{
+		return LIB_ERR;
+	}
+	if (pstOutResult != NULL)
+	{
+		*pstOutResult = pstHandle->stResult;
+	}
+	return LIB_OK;
+}
+
+/***************************************************************************//**
+ * ipc_plot_poll
+ *
+ * Checks whether a plot started with ipc_plot_async() has completed.
+ *
+ * @param pstHandle    Handle from ipc_plot_async()
+ * @param pstOutResult Receives the result if the plot has completed, may be NULL
+ * @return             LIB_OK if the plot has completed, LIB_ERR if it is still running
+ ******************************************************************************/
+LIB_U32 ipc_plot_poll(LIB_PLOT_HANDLE* pstHandle, LIB_ERROR_INFO* pstOutResult)
+{
+	return ipc_plot_wait(pstHandle, 0, pstOutResult);
+}
+
+/***************************************************************************//**
+ * ipc_plot_release
+ *
+ * Releases a handle from ipc_plot_async().
+ *
+ * @param pstHandle Handle from ipc_plot_async()
+ ******************************************************************************/
+void ipc_plot_release(LIB_PLOT_HANDLE* pstHandle)
+{
+	if (pstHandle == NULL)
+	{
+		return;
+	}
+	ReleaseHandle(pstHandle);
+}
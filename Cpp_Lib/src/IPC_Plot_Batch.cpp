@@ -0,0 +1,155 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <atomic>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include "IPC_Plot_Internal.h"
+
+// Jobs of one ipc_plot_batch() call, shared by its worker threads
+typedef struct LIB_BATCH
+{
+	LIB_INPUT* prgstInputs;
+	LIB_ERROR_INFO* prgstResults;   //!< One per job, written only by the worker that took the job
+	LIB_U32 u32Count;
+	std::atomic<LIB_U32> u32Next;   //!< Index of the next job to take
+} LIB_BATCH;
+
+/***************************************************************************//**
+ * BatchWorker
+ *
+ * Takes jobs from the batch until none is left. The session is opened with
+ * the first job and reopened after a job that lost it, so one crashed
+ * Python tool only fails the job it was plotting.
+ *
+ * @param pstBatch Jobs shared by all workers
+ ******************************************************************************/
+static void BatchWorker(LIB_BATCH* pstBatch)
+{
+	LIB_SESSION* pstSession = NULL;
+	for (;;)
+	{
+		LIB_U32 u32Job = pstBatch->u32Next.fetch_add(1);
+		if (u32Job >= pstBatch->u32Count)
+		{
+			break;
+		}
+
+		LIB_ERROR_INFO* pstResult = &pstBatch->prgstResults[u32Job];
+		*pstResult = LIB_ERROR_INFO();
+		if (pstSession == NULL && ipc_plot_session_open(&pstSession, pstResult) != LIB_OK)
+		{
+			continue;
+		}
+		if (ipc_plot_session_plot(pstSession, &pstBatch->prgstInputs[u32Job], pstResult) != LIB_OK
+			&& IsSessionLost(pstResult->u32ErrCode))
+		{
+			ipc_plot_session_close(pstSession);
+			pstSession = NULL;
+		}
+	}
+	ipc_plot_session_close(pstSession);
+}
+
+/***************************************************************************//**
+ * ipc_plot_batch
+ *
+ * Plots many inputs across a pool of Python tools.
+ *
+ * @param prgstInputs     Array of u32Count input structures
+ * @param u32Count        Number of jobs
+ * @param u32Workers      Number of Python tools, 0 for the number of cores
+ * @param prgstOutResults Receives the result of each job, may be NULL
+ * @param pstErr          Error information structure for logging any errors
+ * @return                LIB_OK if every job succeeded, else LIB_ERR
+ ******************************************************************************/
+LIB_U32 ipc_plot_batch(LIB_INPUT* prgstInputs, LIB_U32 u32Count, LIB_U32 u32Workers,
+	LIB_ERROR_INFO* prgstOutResults, LIB_ERROR_INFO* pstErr)
+{
+	LIB_CHAR szRuntimeMsg[LIB_MAX_BUFFER_SIZE] = "";
+
+	// Check for null pointers
+	if (pstErr == NULL)
+	{
+		return LIB_ERR;
+	}
+	// The status of a previous successful plot is not an error, let this call log its own
+	if (pstErr->u32ErrCode == LIB_STATUS_DONE)
+	{
+		*pstErr = LIB_ERROR_INFO();
+	}
+	if (prgstInputs == NULL && u32Count > 0)
+	{
+		snprintf(szRuntimeMsg, sizeof(szRuntimeMsg), "Input array is null pointer");
+		LOG_ERROR(pstErr, LIB_ERR_INPUT_PTR_NULL, LIB_ERR_INPUT_PTR_NULL_MSG, LIB_ERR_INPUT_PTR_NULL_ACT, szRuntimeMsg)
+		return LIB_ERR;
+	}
+	if (u32Count == 0)
+	{
+		pstErr->u32ErrCode = LIB_STATUS_DONE;
+		return LIB_OK;
+	}
+
+	// More workers than jobs would only start idle Python tools
+	if (u32Workers == 0)
+	{
+		u32Workers = std::thread::hardware_concurrency();
+	}
+	if (u32Workers == 0)
+	{
+		u32Workers = 1;
+	}
+	if (u32Workers > LIB_BATCH_MAX_WORKERS)
+	{
+		u32Workers = LIB_BATCH_MAX_WORKERS;
+	}
+	if (u32Workers > u32Count)
+	{
+		u32Workers = u32Count;
+	}
+
+	std::vector<LIB_ERROR_INFO> vecResults;
+	LIB_ERROR_INFO* prgstResults = prgstOutResults;
+	if (prgstResults == NULL)
+	{
+		vecResults.resize(u32Count);
+		prgstResults = vecResults.data();
+	}
+	LIB_BATCH stBatch;
+	stBatch.prgstInputs = prgstInputs;
+	stBatch.prgstResults = prgstResults;
+	stBatch.u32Count = u32Count;
+	stBatch.u32Next = 0;
+
+	// The calling thread is the last worker, so a failed thread start only reduces the parallelism
+	std::vector<std::thread> vecThreads;
+	for (LIB_U32 u32Thread = 1; u32Thread < u32Workers; u32Thread++)
+	{
+		try
+		{
+			vecThreads.push_back(std::thread(BatchWorker, &stBatch));
+		}
+		catch (const std::system_error&)
+		{
+			break;
+		}
+	}
+	BatchWorker(&stBatch);
+	for (size_t szThread = 0; szThread < vecThreads.size(); szThread++)
+	{
+		vecThreads[szThread].join();
+	}
+
+	for (LIB_U32 u32Job = 0; u32Job < u32Count; u32Job++)
+	{
+		if (prgstResults[u32Job].u32ErrCode != LIB_STATUS_DONE)
+		{
+			*pstErr = prgstResults[u32Job];
+			return LIB_ERR;
+		}
+	}
+	pstErr->u32ErrCode = LIB_STATUS_DONE;
+	return LIB_OK;
+}
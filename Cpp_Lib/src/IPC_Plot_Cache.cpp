@@ -0,0 +1,516 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "IPC_Plot_Cache.h"
+#include "IPC_Plot_Raster.h"
+
+// SSE2 is part of x86-64, AVX2 is compiled in with a target attribute and only used
+// when the decimation kernels found the CPU supports it, like IPC_Plot_Decimate.cpp
+#if defined(__x86_64__) || defined(_M_X64)
+#    define LIB_HASH_X86
+#    include <immintrin.h>
+#    ifdef _MSC_VER
+#        define LIB_TARGET_AVX2
+#    else
+#        define LIB_TARGET_AVX2 __attribute__((target("avx2")))
+#    endif
+#endif
+
+#define LIB_HASH_BLOCK_STRIPES 32 //!< Stripes between two scrambles of the accumulators, 1 KB
+#define LIB_HASH_PRIME32 0x9E3779B1ULL
+
+// Key of each lane, and the values scrambled into the accumulators after each block
+static const LIB_U64 s_rgu64LaneKey[LIB_HASH_LANES] = {
+	0xBE4BA423396CFEB8ULL, 0x1CAD21F72C81017CULL, 0xDB979083E96DD4DEULL, 0x1F67B3B7A4A44072ULL };
+static const LIB_U64 s_rgu64Scramble[LIB_HASH_LANES] = {
+	0x78E5C0CC4EE679CBULL, 0x2172FFCC7DD05A82ULL, 0x8E2443F7744608B8ULL, 0x4C263A81E69035E0ULL };
+
+/***************************************************************************//**
+ * Hash kernels. Each 64-bit lane adds the product of the low and high halves
+ * of its word xor its key, and the plain word of its neighbour, so no bit of
+ * the input is lost to the product. 32x32 to 64-bit multiplies are what
+ * SSE2 and AVX2 offer, which keeps every instruction set on the same digest.
+ ******************************************************************************/
+static void StripesScalar(LIB_U64* prgu64Acc, const LIB_CHAR* pcData, LIB_U64 u64Stripes)
+{
+	for (LIB_U64 u64Stripe = 0; u64Stripe < u64Stripes; u64Stripe++)
+	{
+		const LIB_CHAR* pcStripe = pcData + u64Stripe * LIB_HASH_STRIPE_SIZE;
+		for (LIB_U32 u32Lane = 0; u32Lane < LIB_HASH_LANES; u32Lane++)
+		{
+			LIB_U64 u64Word;
+			memcpy(&u64Word, pcStripe + u32Lane * sizeof(LIB_U64), sizeof(u64Word));
+			LIB_U64 u64Keyed = u64Word ^ s_rgu64LaneKey[u32Lane];
+			prgu64Acc[u32Lane ^ 1] += u64Word;
+			prgu64Acc[u32Lane] += (u64Keyed & 0xFFFFFFFFULL) * (u64Keyed >> 32);
+		}
+	}
+}
+
+#ifdef LIB_HASH_X86
+static void StripesSse2(LIB_U64* prgu64Acc, const LIB_CHAR* pcData, LIB_U64 u64Stripes)
+{
+	__m128i vAcc0 = _mm_loadu_si128((const __m128i*)prgu64Acc);
+	__m128i vAcc1 = _mm_loadu_si128((const __m128i*)(prgu64Acc + 2));
+	const __m128i vKey0 = _mm_loadu_si128((const __m128i*)s_rgu64LaneKey);
+	const __m128i vKey1 = _mm_loadu_si128((const __m128i*)(s_rgu64LaneKey + 2));
+	for (LIB_U64 u64Stripe = 0; u64Stripe < u64Stripes; u64Stripe++)
+	{
+		const LIB_CHAR* pcStripe = pcData + u64Stripe * LIB_HASH_STRIPE_SIZE;
+		__m128i vData0 = _mm_loadu_si128((const __m128i*)pcStripe);
+		__m128i vData1 = _mm_loadu_si128((const __m128i*)(pcStripe + 16));
+		__m128i vKeyed0 = _mm_xor_si128(vData0, vKey0);
+		__m128i vKeyed1 = _mm_xor_si128(vData1, vKey1);
+		// Swapping the two words of a vector gives each lane the word of its neighbour
+		vAcc0 = _mm_add_epi64(vAcc0, _mm_shuffle_epi32(vData0, _MM_SHUFFLE(1, 0, 3, 2)));
+		vAcc1 = _mm_add_epi64(vAcc1, _mm_shuffle_epi32(vData1, _MM_SHUFFLE(1, 0, 3, 2)));
+		vAcc0 = _mm_add_epi64(vAcc0, _mm_mul_epu32(vKeyed0, _mm_srli_epi64(vKeyed0, 32)));
+		vAcc1 = _mm_add_epi64(vAcc1, _mm_mul_epu32(vKeyed1, _mm_srli_epi64(vKeyed1, 32)));
+	}
+	_mm_storeu_si128((__m128i*)prgu64Acc, vAcc0);
+	_mm_storeu_si128((__m128i*)(prgu64Acc + 2), vAcc1);
+}
+
+LIB_TARGET_AVX2 static void StripesAvx2(LIB_U64* prgu64Acc, const LIB_CHAR* pcData, LIB_U64 u64Stripes)
+{
+	__m256i vAcc = _mm256_loadu_si256((const __m256i*)prgu64Acc);
+	const __m256i vKey = _mm256_loadu_si256((const __m256i*)s_rgu64LaneKey);
+	for (LIB_U64 u64Stripe = 0; u64Stripe < u64Stripes; u64Stripe++)
+	{
+		__m256i vData = _mm256_loadu_si256((const __m256i*)(pcData + u64Stripe * LIB_HASH_STRIPE_SIZE));
+		__m256i vKeyed = _mm256_xor_si256(vData, vKey);
+		// The shuffle stays within each 128-bit half, as the lanes of the SSE2 kernel
+		vAcc = _mm256_add_epi64(vAcc, _mm256_shuffle_epi32(vData, _MM_SHUFFLE(1, 0, 3, 2)));
+		vAcc = _mm256_add_epi64(vAcc, _mm256_mul_epu32(vKeyed, _mm256_srli_epi64(vKeyed, 32)));
+	}
+	_mm256_storeu_si256((__m256i*)prgu64Acc, vAcc);
+}
+#endif // LIB_HASH_X86
+
+static const LIB_HASH_KERNELS s_stScalarHash = { "scalar", StripesScalar };
+#ifdef LIB_HASH_X86
+static const LIB_HASH_KERNELS s_stSse2Hash = { "sse2", StripesSse2 };
+static const LIB_HASH_KERNELS s_stAvx2Hash = { "avx2", StripesAvx2 };
+#endif
+
+/***************************************************************************//**
+ * HashGetKernels
+ *
+ * Looks up the hash kernel of an instruction set
+ *
+ * @param u32Isa LIB_ISA_*, LIB_ISA_AUTO for the best one this CPU supports
+ * @return       The kernel, or NULL if the CPU or the build does not support it
+ ******************************************************************************/
+const LIB_HASH_KERNELS* HashGetKernels(LIB_U32 u32Isa)
+{
+#ifdef LIB_HASH_X86
+	// The decimation kernels have checked the CPU already
+	static const LIB_BOOLEAN s_bHasAvx2 = (DecimateGetKernels(LIB_ISA_AVX2) != NULL) ? LIB_TRUE : LIB_FALSE;
+	switch (u32Isa)
+	{
+	case LIB_ISA_AUTO:
+		return s_bHasAvx2 ? &s_stAvx2Hash : &s_stSse2Hash;
+	case LIB_ISA_SCALAR:
+		return &s_stScalarHash;
+	case LIB_ISA_SSE2:
+		return &s_stSse2Hash;
+	case LIB_ISA_AVX2:
+		return s_bHasAvx2 ? &s_stAvx2Hash : NULL;
+	default:
+		return NULL;
+	}
+#else
+	return (u32Isa == LIB_ISA_AUTO || u32Isa == LIB_ISA_SCALAR) ? &s_stScalarHash : NULL;
+#endif
+}
+
+static inline LIB_U64 RotateLeft(LIB_U64 u64Value, LIB_U32 u32Bits)
+{
+	return (u64Value << u32Bits) | (u64Value >> (64 - u32Bits));
+}
+
+// Final mix of MurmurHash3, every input bit reaches every output bit
+static inline LIB_U64 Avalanche(LIB_U64 u64Value)
+{
+	u64Value ^= u64Value >> 33;
+	u64Value *= 0xFF51AFD7ED558CCDULL;
+	u64Value ^= u64Value >> 33;
+	u64Value *= 0xC4CEB9FE1A85EC53ULL;
+	u64Value ^= u64Value >> 33;
+	return u64Value;
+}
+
+/***************************************************************************//**
+ * HashBytes
+ *
+ * Folds a block of memory into a running digest, so that the data, labels
+ * and options of a plot chain into one key. Whole stripes go through the
+ * kernel, the last partial stripe is padded with zeros and the length is
+ * mixed into the digest to tell the padding apart from real zeros.
+ *
+ * @param pstKernels   Kernel from HashGetKernels()
+ * @param pvData       Bytes to hash
+ * @param u64Size      Number of bytes
+ * @param pstInOutHash Digest so far, all zero to start, receives the new digest
+ ******************************************************************************/
+void HashBytes(const LIB_HASH_KERNELS* pstKernels, const void* pvData, LIB_U64 u64Size, LIB_HASH* pstInOutHash)
+{
+	const LIB_CHAR* pcData = (const LIB_CHAR*)pvData;
+	LIB_U64 rgu64Acc[LIB_HASH_LANES] = {
+		pstInOutHash->u64Low + s_rgu64Scramble[0], pstInOutHash->u64High ^ s_rgu64Scramble[1],
+		pstInOutHash->u64Low ^ s_rgu64Scramble[2], pstInOutHash->u64High + s_rgu64Scramble[3] };
+
+	LIB_U64 u64Stripes = u64Size / LIB_HASH_STRIPE_SIZE;
+	while (u64Stripes > 0)
+	{
+		LIB_U64 u64Block = (u64Stripes < LIB_HASH_BLOCK_STRIPES) ? u64Stripes : LIB_HASH_BLOCK_STRIPES;
+		pstKernels->pfnStripes(rgu64Acc, pcData, u64Block);
+		pcData += u64Block * LIB_HASH_STRIPE_SIZE;
+		u64Stripes -= u64Block;
+		if (u64Block < LIB_HASH_BLOCK_STRIPES)
+		{
+			break;
+		}
+		// Spreads the high bits of each sum down before the next block adds to it
+		for (LIB_U32 u32Lane = 0; u32Lane < LIB_HASH_LANES; u32Lane++)
+		{
+			rgu64Acc[u32Lane] ^= rgu64Acc[u32Lane] >> 47;
+			rgu64Acc[u32Lane] ^= s_rgu64Scramble[u32Lane];
+			rgu64Acc[u32Lane] *= LIB_HASH_PRIME32;
+		}
+	}
+	LIB_U64 u64Tail = u64Size % LIB_HASH_STRIPE_SIZE;
+	if (u64Tail > 0)
+	{
+		LIB_CHAR rgcStripe[LIB_HASH_STRIPE_SIZE] = { 0 };
+		memcpy(rgcStripe, pcData, (size_t)u64Tail);
+		StripesScalar(rgu64Acc, rgcStripe, 1);
+	}
+
+	pstInOutHash->u64Low = Avalanche(rgu64Acc[0] ^ RotateLeft(rgu64Acc[1], 17) ^ RotateLeft(rgu64Acc[2], 31)
+		^ RotateLeft(rgu64Acc[3], 47) ^ (u64Size * 0x9E3779B185EBCA87ULL));
+	pstInOutHash->u64High = Avalanche((rgu64Acc[0] + rgu64Acc[3]) ^ RotateLeft(rgu64Acc[1] + rgu64Acc[2], 29)
+		^ (u64Size + 0xC2B2AE3D27D4EB4FULL) ^ pstInOutHash->u64Low);
+}
+
+/***************************************************************************//**
+ * Render cache
+ ******************************************************************************/
+// Encoded PNG or RGBA pixels of a plot, shared by the cache and the hits copying it out
+typedef struct LIB_CACHE_IMAGE
+{
+	LIB_U32 u32Format;
+	LIB_U32 u32Width;
+	LIB_U32 u32Height;
+	std::vector<LIB_CHAR> vecData;
+} LIB_CACHE_IMAGE;
+
+typedef struct LIB_CACHE_ENTRY
+{
+	LIB_HASH stKey;
+	std::shared_ptr<const LIB_CACHE_IMAGE> pstImage;
+} LIB_CACHE_ENTRY;
+
+typedef std::list<LIB_CACHE_ENTRY> LIB_CACHE_LIST;
+
+struct LIB_HASH_HASHER
+{
+	size_t operator()(const LIB_HASH& stKey) const { return (size_t)stKey.u64Low; }
+};
+struct LIB_HASH_EQUAL
+{
+	bool operator()(const LIB_HASH& stA, const LIB_HASH& stB) const
+	{
+		return stA.u64Low == stB.u64Low && stA.u64High == stB.u64High;
+	}
+};
+
+typedef std::unordered_map<LIB_HASH, LIB_CACHE_LIST::iterator, LIB_HASH_HASHER, LIB_HASH_EQUAL> LIB_CACHE_MAP;
+
+typedef struct LIB_CACHE
+{
+	std::mutex mutex;               //!< Guards the members below
+	LIB_CACHE_LIST lstEntries;      //!< The most recently used first
+	LIB_CACHE_MAP mapEntries;       //!< Position of each key in lstEntries
+	LIB_U32 u32MaxEntries;          //!< 0 while the cache is off
+	LIB_U64 u64MaxBytes;
+	LIB_U64 u64Bytes;               //!< Image bytes held by lstEntries
+	LIB_U64 u64Hits;
+	LIB_U64 u64Misses;
+	LIB_U64 u64Evictions;
+} LIB_CACHE;
+
+static LIB_CACHE s_stCache;
+
+/***************************************************************************//**
+ * EvictEntries
+ *
+ * Drops the least recently used images until the cache is within its limits
+ *
+ * @param pstCache Cache, locked by the caller
+ ******************************************************************************/
+static void EvictEntries(LIB_CACHE* pstCache)
+{
+	while (!pstCache->lstEntries.empty()
+		&& (pstCache->lstEntries.size() > pstCache->u32MaxEntries || pstCache->u64Bytes > pstCache->u64MaxBytes))
+	{
+		const LIB_CACHE_ENTRY& stOldest = pstCache->lstEntries.back();
+		pstCache->u64Bytes -= stOldest.pstImage->vecData.size();
+		pstCache->mapEntries.erase(stOldest.stKey);
+		pstCache->lstEntries.pop_back();
+		pstCache->u64Evictions++;
+	}
+}
+
+/***************************************************************************//**
+ * HashColumn
+ *
+ * Mixes a typed column or the X column into a digest: its type, stride,
+ * scale and offset, then its bytes from the first sample to the end of the
+ * last. Bytes between strided samples are hashed along, a change there can
+ * only cause a miss.
+ *
+ * @param pstKernels   Hash kernel
+ * @param pstColumn    Validated column descriptor
+ * @param u32RowSize   Number of samples
+ * @param pstInOutHash Digest to update
+ ******************************************************************************/
+static void HashColumn(const LIB_HASH_KERNELS* pstKernels, const LIB_COLUMN* pstColumn, LIB_U32 u32RowSize, LIB_HASH* pstInOutHash)
+{
+	LIB_U64 u64Stride = GetColumnStride(pstColumn);
+	const LIB_DOUBLE rgdTransform[] = { pstColumn->dScale, pstColumn->dOffset, (LIB_DOUBLE)pstColumn->u32Dtype, (LIB_DOUBLE)u64Stride };
+	HashBytes(pstKernels, rgdTransform, sizeof(rgdTransform), pstInOutHash);
+	if (u32RowSize > 0)
+	{
+		HashBytes(pstKernels, pstColumn->pvData, (u32RowSize - 1) * u64Stride + GetDtypeSize(pstColumn->u32Dtype), pstInOutHash);
+	}
+}
+
+/***************************************************************************//**
+ * HashInput
+ *
+ * Digest of everything that decides the image of a plot: the options, the
+ * data of every column in its own type, the X column and the labels. A file
+ * and a PNG are the same image.
+ *
+ * @param pstInput   Validated input structure
+ * @param pstOutHash Receives the digest
+ ******************************************************************************/
+static void HashInput(const LIB_INPUT* pstInput, LIB_HASH* pstOutHash)
+{
+	static const LIB_HASH_KERNELS* s_pstKernels = HashGetKernels(LIB_ISA_AUTO);
+	LIB_U32 u32MaxPoints = (pstInput->u32MaxPoints == 0) ? LIB_DEFAULT_MAX_POINTS : pstInput->u32MaxPoints;
+	const LIB_U32 rgu32Options[] = {
+		pstInput->u32ColSize,
+		pstInput->u32RowSize,
+		pstInput->u32Decimation,
+		(pstInput->u32Decimation == LIB_DECIMATE_NONE) ? 0 : u32MaxPoints,
+		pstInput->u32Backend,
+		(pstInput->u32Output == LIB_OUTPUT_RGBA) ? (LIB_U32)LIB_OUTPUT_RGBA : (LIB_U32)LIB_OUTPUT_PNG,
+		(pstInput->u32Dpi == 0) ? LIB_DEFAULT_DPI : pstInput->u32Dpi,
+		(pstInput->prgstColumns != NULL) ? 1U : 0U,
+		(pstInput->pstXColumn != NULL) ? 1U : 0U };
+
+	*pstOutHash = LIB_HASH();
+	HashBytes(s_pstKernels, rgu32Options, sizeof(rgu32Options), pstOutHash);
+	if (pstInput->prgstColumns != NULL)
+	{
+		for (LIB_U32 u32Col = 0; u32Col < pstInput->u32ColSize; u32Col++)
+		{
+			HashColumn(s_pstKernels, &pstInput->prgstColumns[u32Col], pstInput->u32RowSize, pstOutHash);
+		}
+	}
+	else
+	{
+		HashBytes(s_pstKernels, pstInput->prgdBuffer, (LIB_U64)pstInput->u32RowSize * pstInput->u32ColSize * sizeof(LIB_DOUBLE), pstOutHash);
+	}
+	if (pstInput->pstXColumn != NULL)
+	{
+		HashColumn(s_pstKernels, pstInput->pstXColumn, pstInput->u32RowSize, pstOutHash);
+	}
+	for (LIB_U32 u32Col = 0; u32Col < pstInput->u32ColSize; u32Col++)
+	{
+		const LIB_CHAR* pszLabel = (pstInput->prgszLabels[u32Col] != NULL) ? pstInput->prgszLabels[u32Col] : "";
+		HashBytes(s_pstKernels, pszLabel, strlen(pszLabel) + 1, pstOutHash);
+	}
+}
+
+/***************************************************************************//**
+ * CacheLookup
+ *
+ * Hashes the input and returns its image from the cache without a renderer:
+ * copied into the image of the input, or saved as a new file. A file input
+ * is neither looked up nor stored, its hash would read the whole file.
+ *
+ * @param pstInput   Validated input structure
+ * @param pstOutKey  Receives the key of the input
+ * @param pbOutValid Receives LIB_TRUE on a miss with the cache on, the image of the plot is to be stored
+ * @param pdOutMs    Receives the time spent hashing, looking up and delivering a hit
+ * @param pstErr     Result of the plot on a hit, untouched on a miss
+ * @return           LIB_TRUE on a hit, the plot is done
+ ******************************************************************************/
+LIB_BOOLEAN CacheLookup(const LIB_INPUT* pstInput, LIB_HASH* pstOutKey, LIB_BOOLEAN* pbOutValid, LIB_DOUBLE* pdOutMs, LIB_ERROR_INFO* pstErr)
+{
+	*pbOutValid = LIB_FALSE;
+	*pdOutMs = 0.0;
+	if (pstInput->pstFile != NULL)
+	{
+		return LIB_FALSE;
+	}
+	{
+		std::lock_guard<std::mutex> lock(s_stCache.mutex);
+		if (s_stCache.u32MaxEntries == 0)
+		{
+			return LIB_FALSE;
+		}
+	}
+
+	LIB_U64 u64StartUs = StatsNowUs();
+	HashInput(pstInput, pstOutKey);
+	std::shared_ptr<const LIB_CACHE_IMAGE> pstImage;
+	{
+		std::lock_guard<std::mutex> lock(s_stCache.mutex);
+		LIB_CACHE_MAP::iterator itEntry = s_stCache.mapEntries.find(*pstOutKey);
+		if (itEntry != s_stCache.mapEntries.end())
+		{
+			s_stCache.lstEntries.splice(s_stCache.lstEntries.begin(), s_stCache.lstEntries, itEntry->second);
+			pstImage = itEntry->second->pstImage;
+			s_stCache.u64Hits++;
+		}
+		else
+		{
+			s_stCache.u64Misses++;
+		}
+	}
+	if (!pstImage)
+	{
+		StatsPhase("cache", u64StartUs, pdOutMs);
+		*pbOutValid = LIB_TRUE;
+		return LIB_FALSE;
+	}
+
+	// Copied out of the shared image, the cache may drop it meanwhile
+	LIB_U64 u64Size = pstImage->vecData.size();
+	LIB_U32 u32Ret;
+	if (pstInput->u32Output == LIB_OUTPUT_FILE)
+	{
+		LIB_CHAR szTitle[64];
+		GetImageTitle(szTitle, sizeof(szTitle));
+		u32Ret = WriteImageFile(szTitle, pstImage->vecData.data(), u64Size, pstErr);
+	}
+	else
+	{
+		LIB_IMAGE* pstOut = pstInput->pstImage;
+		pstOut->u32Format = pstImage->u32Format;
+		pstOut->u32Width = pstImage->u32Width;
+		pstOut->u32Height = pstImage->u32Height;
+		u32Ret = ImageReserve(pstOut, u64Size, pstErr);
+		if (u32Ret == LIB_OK)
+		{
+			memcpy(pstOut->pcData, pstImage->vecData.data(), (size_t)u64Size);
+		}
+	}
+	if (u32Ret == LIB_OK)
+	{
+		pstErr->u32ErrCode = LIB_STATUS_DONE;
+	}
+	StatsPhase("cache", u64StartUs, pdOutMs);
+	return LIB_TRUE;
+}
+
+/***************************************************************************//**
+ * CacheStore
+ *
+ * Keeps the image of a plot that missed the cache, as the most recently
+ * used. An image larger than the whole cache is not kept.
+ *
+ * @param pstKey   Key from CacheLookup()
+ * @param pstImage PNG or RGBA image of the plot
+ ******************************************************************************/
+void CacheStore(const LIB_HASH* pstKey, const LIB_IMAGE* pstImage)
+{
+	{
+		std::lock_guard<std::mutex> lock(s_stCache.mutex);
+		if (s_stCache.u32MaxEntries == 0 || pstImage->u64Size > s_stCache.u64MaxBytes)
+		{
+			return;
+		}
+	}
+
+	// Copied without the lock, it only guards the index
+	std::shared_ptr<LIB_CACHE_IMAGE> pstCopy = std::make_shared<LIB_CACHE_IMAGE>();
+	pstCopy->u32Format = pstImage->u32Format;
+	pstCopy->u32Width = pstImage->u32Width;
+	pstCopy->u32Height = pstImage->u32Height;
+	pstCopy->vecData.assign(pstImage->pcData, pstImage->pcData + pstImage->u64Size);
+
+	std::lock_guard<std::mutex> lock(s_stCache.mutex);
+	// Another thread may have plotted the same input meanwhile, or the cache been turned off
+	if (s_stCache.u32MaxEntries == 0 || s_stCache.mapEntries.count(*pstKey) != 0)
+	{
+		return;
+	}
+	LIB_CACHE_ENTRY stEntry;
+	stEntry.stKey = *pstKey;
+	stEntry.pstImage = pstCopy;
+	s_stCache.lstEntries.push_front(stEntry);
+	s_stCache.mapEntries[*pstKey] = s_stCache.lstEntries.begin();
+	s_stCache.u64Bytes += pstCopy->vecData.size();
+	EvictEntries(&s_stCache);
+}
+
+/***************************************************************************//**
+ * CacheCounters
+ *
+ * Adds the hit, miss and eviction counts and the current size of the cache
+ * to the process counters
+ *
+ * @param pstOutCounters Counters of ipc_plot_get_counters()
+ ******************************************************************************/
+void CacheCounters(LIB_PLOT_COUNTERS* pstOutCounters)
+{
+	std::lock_guard<std::mutex> lock(s_stCache.mutex);
+	pstOutCounters->u64CacheHits = s_stCache.u64Hits;
+	pstOutCounters->u64CacheMisses = s_stCache.u64Misses;
+	pstOutCounters->u64CacheEvictions = s_stCache.u64Evictions;
+	pstOutCounters->u64CacheEntries = s_stCache.lstEntries.size();
+	pstOutCounters->u64CacheBytes = s_stCache.u64Bytes;
+}
+
+/***************************************************************************//**
+ * ipc_plot_cache_config
+ *
+ * Turns the render cache on or off and sets its limits
+ *
+ * @param u32MaxEntries Most images kept, 0 to turn the cache off and drop them
+ * @param u64MaxBytes   Most image bytes kept, 0 for LIB_CACHE_DEFAULT_BYTES
+ * @param pstErr        Error information structure for logging any errors
+ * @return              LIB_OK if success, else LIB_ERR if any error occurred
+ ******************************************************************************/
+LIB_U32 ipc_plot_cache_config(LIB_U32 u32MaxEntries, LIB_U64 u64MaxBytes, LIB_ERROR_INFO* pstErr)
+{
+	// Check for null pointers
+	if (pstErr == NULL)
+	{
+		return LIB_ERR;
+	}
+	// The status of a previous successful call is not an error, let this call log its own
+	if (pstErr->u32ErrCode == LIB_STATUS_DONE)
+	{
+		*pstErr = LIB_ERROR_INFO();
+	}
+
+	std::lock_guard<std::mutex> lock(s_stCache.mutex);
+	s_stCache.u32MaxEntries = u32MaxEntries;
+	s_stCache.u64MaxBytes = (u64MaxBytes == 0) ? LIB_CACHE_DEFAULT_BYTES : u64MaxBytes;
+	EvictEntries(&s_stCache);
+	pstErr->u32ErrCode = LIB_STATUS_DONE;
+	return LIB_OK;
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "IPC_Plot_Decimate.h"
+
+#define LIB_HASH_STRIPE_SIZE 32 //!< Bytes taken by one step of the hash kernels, one 64-bit word per lane
+#define LIB_HASH_LANES       4
+
+// 128-bit digest of the input of a plot, the key of the render cache
+typedef struct LIB_HASH
+{
+	LIB_U64 u64Low;
+	LIB_U64 u64High;
+} LIB_HASH;
+
+// Hash kernel of one instruction set. All sets give the same digest for the same bytes.
+typedef struct LIB_HASH_KERNELS
+{
+	const LIB_CHAR* pszName;
+	//!< Mixes u64Stripes stripes of LIB_HASH_STRIPE_SIZE bytes into the LIB_HASH_LANES accumulators
+	void (*pfnStripes)(LIB_U64* prgu64Acc, const LIB_CHAR* pcData, LIB_U64 u64Stripes);
+} LIB_HASH_KERNELS;
+
+const LIB_HASH_KERNELS* HashGetKernels(LIB_U32 u32Isa);
+void HashBytes(const LIB_HASH_KERNELS* pstKernels, const void* pvData, LIB_U64 u64Size, LIB_HASH* pstInOutHash);
+
+// Render cache of ipc_plot() and ipc_plot_session_plot(), see ipc_plot_cache_config().
+// CacheLookup() returns LIB_TRUE on a hit, with the image delivered and the result in pstErr.
+// On a miss pstOutKey is valid if the image of the plot is to be passed to CacheStore().
+LIB_BOOLEAN CacheLookup(const LIB_INPUT* pstInput, LIB_HASH* pstOutKey, LIB_BOOLEAN* pbOutValid, LIB_DOUBLE* pdOutMs, LIB_ERROR_INFO* pstErr);
+void CacheStore(const LIB_HASH* pstKey, const LIB_IMAGE* pstImage);
+void CacheCounters(LIB_PLOT_COUNTERS* pstOutCounters);
@@ -0,0 +1,798 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "IPC_Plot_Decimate.h"
+
+// SSE2 is part of x86-64, AVX2 is compiled in with a target attribute and only used
+// after checking the CPU, so the library itself needs no special compiler flags
+#if defined(__x86_64__) || defined(_M_X64)
+#    define LIB_DECIMATE_X86
+#    include <immintrin.h>
+#    ifdef _MSC_VER
+#        include <intrin.h>
+#        define LIB_TARGET_AVX2
+#    else
+#        define LIB_TARGET_AVX2 __attribute__((target("avx2")))
+#    endif
+#endif
+
+/***************************************************************************//**
+ * Scalar kernels, also used for the tail of each bucket by the SIMD kernels
+ ******************************************************************************/
+static void MinMaxScalar(const LIB_DOUBLE* prgdData, LIB_U64 u64Count, LIB_U64* pu64OutMin, LIB_U64* pu64OutMax)
+{
+	LIB_U64 u64Min = 0;
+	LIB_U64 u64Max = 0;
+	for (LIB_U64 u64Index = 1; u64Index < u64Count; u64Index++)
+	{
+		LIB_DOUBLE dValue = prgdData[u64Index];
+		// A NaN so far is replaced by any number, the first NaN is kept if there is none
+		if (dValue < prgdData[u64Min] || (prgdData[u64Min] != prgdData[u64Min] && dValue == dValue))
+		{
+			u64Min = u64Index;
+		}
+		if (dValue > prgdData[u64Max] || (prgdData[u64Max] != prgdData[u64Max] && dValue == dValue))
+		{
+			u64Max = u64Index;
+		}
+	}
+	*pu64OutMin = u64Min;
+	*pu64OutMax = u64Max;
+}
+
+static LIB_DOUBLE SumScalar(const LIB_DOUBLE* prgdData, LIB_U64 u64Count)
+{
+	LIB_DOUBLE dSum = 0.0;
+	for (LIB_U64 u64Index = 0; u64Index < u64Count; u64Index++)
+	{
+		dSum += prgdData[u64Index];
+	}
+	return dSum;
+}
+
+static LIB_U64 MaxAreaScalar(const LIB_DOUBLE* prgdData, LIB_U64 u64Count, LIB_DOUBLE dP, LIB_DOUBLE dQ, LIB_DOUBLE dR)
+{
+	LIB_U64 u64Best = 0;
+	LIB_DOUBLE dBest = -1.0;
+	for (LIB_U64 u64Index = 0; u64Index < u64Count; u64Index++)
+	{
+		LIB_DOUBLE dArea = fabs(dP * prgdData[u64Index] + dQ * (LIB_DOUBLE)u64Index + dR);
+		if (dArea > dBest)
+		{
+			dBest = dArea;
+			u64Best = u64Index;
+		}
+	}
+	return u64Best;
+}
+
+#ifdef LIB_DECIMATE_X86
+
+/***************************************************************************//**
+ * ReduceLanes
+ *
+ * Combines the per-lane results of a SIMD kernel: the lane with the best value
+ * wins, ties go to the smallest index. Lanes holding NaN lose to any number.
+ *
+ * @param prgdValue Best value of each lane
+ * @param prgdIndex Index of the best value of each lane
+ * @param u32Lanes  Number of lanes
+ * @param bMax      LIB_TRUE to look for the largest value, else the smallest
+ * @return          Index of the best value
+ ******************************************************************************/
+static LIB_U64 ReduceLanes(const LIB_DOUBLE* prgdValue, const LIB_DOUBLE* prgdIndex, LIB_U32 u32Lanes, LIB_BOOLEAN bMax)
+{
+	LIB_U32 u32Best = 0;
+	for (LIB_U32 u32Lane = 1; u32Lane < u32Lanes; u32Lane++)
+	{
+		LIB_DOUBLE dValue = prgdValue[u32Lane];
+		LIB_DOUBLE dBest = prgdValue[u32Best];
+		LIB_BOOLEAN bBetter = bMax ? (LIB_BOOLEAN)(dValue > dBest) : (LIB_BOOLEAN)(dValue < dBest);
+		LIB_BOOLEAN bTie = (LIB_BOOLEAN)(dValue == dBest && prgdIndex[u32Lane] < prgdIndex[u32Best]);
+		LIB_BOOLEAN bNaN = (LIB_BOOLEAN)(dBest != dBest && (dValue == dValue || prgdIndex[u32Lane] < prgdIndex[u32Best]));
+		if (bBetter || bTie || bNaN)
+		{
+			u32Best = u32Lane;
+		}
+	}
+	return (LIB_U64)prgdIndex[u32Best];
+}
+
+/***************************************************************************//**
+ * MergeTail
+ *
+ * Folds the samples after the last full vector into a SIMD result
+ ******************************************************************************/
+static void MergeTail(const LIB_DOUBLE* prgdData, LIB_U64 u64Start, LIB_U64 u64Count, LIB_U64* pu64Min, LIB_U64* pu64Max)
+{
+	for (LIB_U64 u64Index = u64Start; u64Index < u64Count; u64Index++)
+	{
+		LIB_DOUBLE dValue = prgdData[u64Index];
+		if (dValue < prgdData[*pu64Min] || (prgdData[*pu64Min] != prgdData[*pu64Min] && dValue == dValue))
+		{
+			*pu64Min = u64Index;
+		}
+		if (dValue > prgdData[*pu64Max] || (prgdData[*pu64Max] != prgdData[*pu64Max] && dValue == dValue))
+		{
+			*pu64Max = u64Index;
+		}
+	}
+}
+
+/***************************************************************************//**
+ * SSE2 kernels, 2 doubles per vector. Indices are tracked as doubles, which
+ * are exact up to 2^53 samples. SSE2 has no blend, so and/andnot/or is used.
+ ******************************************************************************/
+static inline __m128d BlendSse2(__m128d vOld, __m128d vNew, __m128d vMask)
+{
+	return _mm_or_pd(_mm_and_pd(vMask, vNew), _mm_andnot_pd(vMask, vOld));
+}
+
+static void MinMaxSse2(const LIB_DOUBLE* prgdData, LIB_U64 u64Count, LIB_U64* pu64OutMin, LIB_U64* pu64OutMax)
+{
+	if (u64Count < 4)
+	{
+		MinMaxScalar(prgdData, u64Count, pu64OutMin, pu64OutMax);
+		return;
+	}
+	__m128d vMin = _mm_loadu_pd(prgdData);
+	__m128d vMax = vMin;
+	__m128d vIndex = _mm_set_pd(1.0, 0.0);
+	__m128d vMinIndex = vIndex;
+	__m128d vMaxIndex = vIndex;
+	const __m128d vStep = _mm_set1_pd(2.0);
+	LIB_U64 u64Index = 2;
+	for (; u64Index + 2 <= u64Count; u64Index += 2)
+	{
+		__m128d vValue = _mm_loadu_pd(prgdData + u64Index);
+		vIndex = _mm_add_pd(vIndex, vStep);
+		// A NaN so far is replaced by any number, as in MinMaxScalar()
+		__m128d vNumber = _mm_cmpord_pd(vValue, vValue);
+		__m128d vLess = _mm_or_pd(_mm_cmplt_pd(vValue, vMin), _mm_and_pd(_mm_cmpunord_pd(vMin, vMin), vNumber));
+		__m128d vMore = _mm_or_pd(_mm_cmpgt_pd(vValue, vMax), _mm_and_pd(_mm_cmpunord_pd(vMax, vMax), vNumber));
+		vMin = BlendSse2(vMin, vValue, vLess);
+		vMinIndex = BlendSse2(vMinIndex, vIndex, vLess);
+		vMax = BlendSse2(vMax, vValue, vMore);
+		vMaxIndex = BlendSse2(vMaxIndex, vIndex, vMore);
+	}
+	LIB_DOUBLE rgdValue[2], rgdIndex[2];
+	_mm_storeu_pd(rgdValue, vMin);
+	_mm_storeu_pd(rgdIndex, vMinIndex);
+	*pu64OutMin = ReduceLanes(rgdValue, rgdIndex, 2, LIB_FALSE);
+	_mm_storeu_pd(rgdValue, vMax);
+	_mm_storeu_pd(rgdIndex, vMaxIndex);
+	*pu64OutMax = ReduceLanes(rgdValue, rgdIndex, 2, LIB_TRUE);
+	MergeTail(prgdData, u64Index, u64Count, pu64OutMin, pu64OutMax);
+}
+
+static LIB_DOUBLE SumSse2(const LIB_DOUBLE* prgdData, LIB_U64 u64Count)
+{
+	__m128d vSum0 = _mm_setzero_pd();
+	__m128d vSum1 = _mm_setzero_pd();
+	LIB_U64 u64Index = 0;
+	for (; u64Index + 4 <= u64Count; u64Index += 4)
+	{
+		vSum0 = _mm_add_pd(vSum0, _mm_loadu_pd(prgdData + u64Index));
+		vSum1 = _mm_add_pd(vSum1, _mm_loadu_pd(prgdData + u64Index + 2));
+	}
+	LIB_DOUBLE rgdSum[2];
+	_mm_storeu_pd(rgdSum, _mm_add_pd(vSum0, vSum1));
+	return rgdSum[0] + rgdSum[1] + SumScalar(prgdData + u64Index, u64Count - u64Index);
+}
+
+static LIB_U64 MaxAreaSse2(const LIB_DOUBLE* prgdData, LIB_U64 u64Count, LIB_DOUBLE dP, LIB_DOUBLE dQ, LIB_DOUBLE dR)
+{
+	const __m128d vP = _mm_set1_pd(dP);
+	const __m128d vQ = _mm_set1_pd(dQ);
+	const __m128d vR = _mm_set1_pd(dR);
+	const __m128d vAbs = _mm_castsi128_pd(_mm_set1_epi64x(0x7FFFFFFFFFFFFFFFLL));
+	const __m128d vStep = _mm_set1_pd(2.0);
+	__m128d vIndex = _mm_set_pd(1.0, 0.0);
+	__m128d vBest = _mm_set1_pd(-1.0);
+	__m128d vBestIndex = _mm_setzero_pd();
+	LIB_U64 u64Index = 0;
+	for (; u64Index + 2 <= u64Count; u64Index += 2)
+	{
+		__m128d vValue = _mm_loadu_pd(prgdData + u64Index);
+		__m128d vArea = _mm_and_pd(_mm_add_pd(_mm_add_pd(_mm_mul_pd(vP, vValue), _mm_mul_pd(vQ, vIndex)), vR), vAbs);
+		__m128d vMore = _mm_cmpgt_pd(vArea, vBest);
+		vBest = BlendSse2(vBest, vArea, vMore);
+		vBestIndex = BlendSse2(vBestIndex, vIndex, vMore);
+		vIndex = _mm_add_pd(vIndex, vStep);
+	}
+	LIB_DOUBLE rgdValue[2], rgdIndex[2];
+	_mm_storeu_pd(rgdValue, vBest);
+	_mm_storeu_pd(rgdIndex, vBestIndex);
+	LIB_U64 u64Best = ReduceLanes(rgdValue, rgdIndex, 2, LIB_TRUE);
+	LIB_DOUBLE dBest = rgdValue[0] > rgdValue[1] ? rgdValue[0] : rgdValue[1];
+	for (; u64Index < u64Count; u64Index++)
+	{
+		LIB_DOUBLE dArea = fabs(dP * prgdData[u64Index] + dQ * (LIB_DOUBLE)u64Index + dR);
+		if (dArea > dBest)
+		{
+			dBest = dArea;
+			u64Best = u64Index;
+		}
+	}
+	return u64Best;
+}
+
+/***************************************************************************//**
+ * AVX2 kernels, 4 doubles per vector
+ ******************************************************************************/
+LIB_TARGET_AVX2 static void MinMaxAvx2(const LIB_DOUBLE* prgdData, LIB_U64 u64Count, LIB_U64* pu64OutMin, LIB_U64* pu64OutMax)
+{
+	if (u64Count < 8)
+	{
+		MinMaxScalar(prgdData, u64Count, pu64OutMin, pu64OutMax);
+		return;
+	}
+	__m256d vMin = _mm256_loadu_pd(prgdData);
+	__m256d vMax = vMin;
+	__m256d vIndex = _mm256_set_pd(3.0, 2.0, 1.0, 0.0);
+	__m256d vMinIndex = vIndex;
+	__m256d vMaxIndex = vIndex;
+	const __m256d vStep = _mm256_set1_pd(4.0);
+	LIB_U64 u64Index = 4;
+	for (; u64Index + 4 <= u64Count; u64Index += 4)
+	{
+		__m256d vValue = _mm256_loadu_pd(prgdData + u64Index);
+		vIndex = _mm256_add_pd(vIndex, vStep);
+		__m256d vNumber = _mm256_cmp_pd(vValue, vValue, _CMP_ORD_Q);
+		__m256d vLess = _mm256_or_pd(_mm256_cmp_pd(vValue, vMin, _CMP_LT_OQ),
+			_mm256_and_pd(_mm256_cmp_pd(vMin, vMin, _CMP_UNORD_Q), vNumber));
+		__m256d vMore = _mm256_or_pd(_mm256_cmp_pd(vValue, vMax, _CMP_GT_OQ),
+			_mm256_and_pd(_mm256_cmp_pd(vMax, vMax, _CMP_UNORD_Q), vNumber));
+		vMin = _mm256_blendv_pd(vMin, vValue, vLess);
+		vMinIndex = _mm256_blendv_pd(vMinIndex, vIndex, vLess);
+		vMax = _mm256_blendv_pd(vMax, vValue, vMore);
+		vMaxIndex = _mm256_blendv_pd(vMaxIndex, vIndex, vMore);
+	}
+	LIB_DOUBLE rgdValue[4], rgdIndex[4];
+	_mm256_storeu_pd(rgdValue, vMin);
+	_mm256_storeu_pd(rgdIndex, vMinIndex);
+	*pu64OutMin = ReduceLanes(rgdValue, rgdIndex, 4, LIB_FALSE);
+	_mm256_storeu_pd(rgdValue, vMax);
+	_mm256_storeu_pd(rgdIndex, vMaxIndex);
+	*pu64OutMax = ReduceLanes(rgdValue, rgdIndex, 4, LIB_TRUE);
+	MergeTail(prgdData, u64Index, u64Count, pu64OutMin, pu64OutMax);
+}
+
+LIB_TARGET_AVX2 static LIB_DOUBLE SumAvx2(const LIB_DOUBLE* prgdData, LIB_U64 u64Count)
+{
+	__m256d vSum0 = _mm256_setzero_pd();
+	__m256d vSum1 = _mm256_setzero_pd();
+	LIB_U64 u64Index = 0;
+	for (; u64Index + 8 <= u64Count; u64Index += 8)
+	{
+		vSum0 = _mm256_add_pd(vSum0, _mm256_loadu_pd(prgdData + u64Index));
+		vSum1 = _mm256_add_pd(vSum1, _mm256_loadu_pd(prgdData + u64Index + 4));
+	}
+	LIB_DOUBLE rgdSum[4];
+	_mm256_storeu_pd(rgdSum, _mm256_add_pd(vSum0, vSum1));
+	return (rgdSum[0] + rgdSum[1]) + (rgdSum[2] + rgdSum[3]) + SumScalar(prgdData + u64Index, u64Count - u64Index);
+}
+
+LIB_TARGET_AVX2 static LIB_U64 MaxAreaAvx2(const LIB_DOUBLE* prgdData, LIB_U64 u64Count, LIB_DOUBLE dP, LIB_DOUBLE dQ, LIB_DOUBLE dR)
+{
+	const __m256d vP = _mm256_set1_pd(dP);
+	const __m256d vQ = _mm256_set1_pd(dQ);
+	const __m256d vR = _mm256_set1_pd(dR);
+	const __m256d vAbs = _mm256_castsi256_pd(_mm256_set1_epi64x(0x7FFFFFFFFFFFFFFFLL));
+	const __m256d vStep = _mm256_set1_pd(4.0);
+	__m256d vIndex = _mm256_set_pd(3.0, 2.0, 1.0, 0.0);
+	__m256d vBest = _mm256_set1_pd(-1.0);
+	__m256d vBestIndex = _mm256_setzero_pd();
+	LIB_U64 u64Index = 0;
+	for (; u64Index + 4 <= u64Count; u64Index += 4)
+	{
+		__m256d vValue = _mm256_loadu_pd(prgdData + u64Index);
+		__m256d vArea = _mm256_and_pd(_mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(vP, vValue), _mm256_mul_pd(vQ, vIndex)), vR), vAbs);
+		__m256d vMore = _mm256_cmp_pd(vArea, vBest, _CMP_GT_OQ);
+		vBest = _mm256_blendv_pd(vBest, vArea, vMore);
+		vBestIndex = _mm256_blendv_pd(vBestIndex, vIndex, vMore);
+		vIndex = _mm256_add_pd(vIndex, vStep);
+	}
+	LIB_DOUBLE rgdValue[4], rgdIndex[4];
+	_mm256_storeu_pd(rgdValue, vBest);
+	_mm256_storeu_pd(rgdIndex, vBestIndex);
+	LIB_U64 u64Best = ReduceLanes(rgdValue, rgdIndex, 4, LIB_TRUE);
+	LIB_DOUBLE dBest = -1.0;
+	for (LIB_U32 u32Lane = 0; u32Lane < 4; u32Lane++)
+	{
+		dBest = (rgdValue[u32Lane] > dBest) ? rgdValue[u32Lane] : dBest;
+	}
+	for (; u64Index < u64Count; u64Index++)
+	{
+		LIB_DOUBLE dArea = fabs(dP * prgdData[u64Index] + dQ * (LIB_DOUBLE)u64Index + dR);
+		if (dArea > dBest)
+		{
+			dBest = dArea;
+			u64Best = u64Index;
+		}
+	}
+	return u64Best;
+}
+
+/***************************************************************************//**
+ * CpuHasAvx2
+ *
+ * Checks that the CPU supports AVX2 and the OS saves the YMM registers
+ ******************************************************************************/
+static LIB_BOOLEAN CpuHasAvx2(void)
+{
+#ifdef _MSC_VER
+	int rgnInfo[4];
+	__cpuid(rgnInfo, 0);
+	if (rgnInfo[0] < 7)
+	{
+		return LIB_FALSE;
+	}
+	// OSXSAVE and AVX, then XCR0 must have the SSE and AVX state enabled
+	__cpuid(rgnInfo, 1);
+	if ((rgnInfo[2] & (1 << 27)) == 0 || (rgnInfo[2] & (1 << 28)) == 0 || (_xgetbv(0) & 0x6) != 0x6)
+	{
+		return LIB_FALSE;
+	}
+	__cpuidex(rgnInfo, 7, 0);
+	return (rgnInfo[1] & (1 << 5)) ? LIB_TRUE : LIB_FALSE;
+#else
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx2") ? LIB_TRUE : LIB_FALSE;
+#endif
+}
+
+#endif // LIB_DECIMATE_X86
+
+static const LIB_DECIMATE_KERNELS s_stScalarKernels = { "scalar", MinMaxScalar, SumScalar, MaxAreaScalar };
+#ifdef LIB_DECIMATE_X86
+static const LIB_DECIMATE_KERNELS s_stSse2Kernels = { "sse2", MinMaxSse2, SumSse2, MaxAreaSse2 };
+static const LIB_DECIMATE_KERNELS s_stAvx2Kernels = { "avx2", MinMaxAvx2, SumAvx2, MaxAreaAvx2 };
+#endif
+
+/***************************************************************************//**
+ * DecimateGetKernels
+ *
+ * Looks up the kernels of an instruction set
+ *
+ * @param u32Isa LIB_ISA_*, LIB_ISA_AUTO for the best one this CPU supports
+ * @return       The kernels, or NULL if the CPU or the build does not support them
+ ******************************************************************************/
+const LIB_DECIMATE_KERNELS* DecimateGetKernels(LIB_U32 u32Isa)
+{
+#ifdef LIB_DECIMATE_X86
+	// Checked once, the function-local static is initialised thread-safely
+	static const LIB_BOOLEAN s_bHasAvx2 = CpuHasAvx2();
+	switch (u32Isa)
+	{
+	case LIB_ISA_AUTO:
+		return s_bHasAvx2 ? &s_stAvx2Kernels : &s_stSse2Kernels;
+	case LIB_ISA_SCALAR:
+		return &s_stScalarKernels;
+	case LIB_ISA_SSE2:
+		return &s_stSse2Kernels;
+	case LIB_ISA_AVX2:
+		return s_bHasAvx2 ? &s_stAvx2Kernels : NULL;
+	default:
+		return NULL;
+	}
+#else
+	return (u32Isa == LIB_ISA_AUTO || u32Isa == LIB_ISA_SCALAR) ? &s_stScalarKernels : NULL;
+#endif
+}
+
+/***************************************************************************//**
+ * GetMinMaxBucket
+ *
+ * Samples of one bucket of DecimateMinMax()
+ ******************************************************************************/
+static void GetMinMaxBucket(LIB_U64 u64Bucket, LIB_U64 u64Buckets, LIB_U64 u64Count, LIB_U64* pu64OutStart, LIB_U64* pu64OutEnd)
+{
+	*pu64OutStart = u64Bucket * u64Count / u64Buckets;
+	*pu64OutEnd = (u64Bucket + 1) * u64Count / u64Buckets;
+}
+
+/***************************************************************************//**
+ * GetLttbBucket
+ *
+ * Samples of one bucket of DecimateLttb() and the end of the next bucket,
+ * whose average is the third point of the triangles. For the last bucket 
+ * the next bucket is the last sample.
+ ******************************************************************************/
+static void GetLttbBucket(LIB_U64 u64Bucket, LIB_U64 u64Buckets, LIB_U64 u64Count, LIB_DOUBLE dEvery,
+	LIB_U64* pu64OutStart, LIB_U64* pu64OutEnd, LIB_U64* pu64OutNextEnd)
+{
+	LIB_U64 u64End = (LIB_U64)((u64Bucket + 1) * dEvery) + 1;
+	LIB_U64 u64NextEnd = (LIB_U64)((u64Bucket + 2) * dEvery) + 1;
+	*pu64OutStart = (LIB_U64)(u64Bucket * dEvery) + 1;
+	*pu64OutEnd = (u64End > u64Count - 1) ? u64Count - 1 : u64End;
+	*pu64OutNextEnd = (u64NextEnd > u64Count || u64Bucket + 1 == u64Buckets) ? u64Count : u64NextEnd;
+}
+
+/***************************************************************************//**
+ * MinMaxBuckets
+ *
+ * Runs DecimateMinMax() over a range of its buckets, whose samples are all
+ * in a window of the column
+ *
+ * @param pstKernels     Kernels from DecimateGetKernels()
+ * @param prgdWindow     Samples from u64WindowStart on
+ * @param u64WindowStart Index of the first sample of the window in the column
+ * @param u64Count       Number of samples of the column
+ * @param u64Buckets     Number of buckets of the column
+ * @param u64First       First bucket of the range
+ * @param u64Last        Bucket after the range
+ * @param prgdOutX       Receives the sample index of each point of the column
+ * @param prgdOutY       Receives the value of each point of the column
+ ******************************************************************************/
+static void MinMaxBuckets(const LIB_DECIMATE_KERNELS* pstKernels, const LIB_DOUBLE* prgdWindow, LIB_U64 u64WindowStart, LIB_U64 u64Count,
+	LIB_U64 u64Buckets, LIB_U64 u64First, LIB_U64 u64Last, LIB_DOUBLE* prgdOutX, LIB_DOUBLE* prgdOutY)
+{
+	for (LIB_U64 u64Bucket = u64First; u64Bucket < u64Last; u64Bucket++)
+	{
+		LIB_U64 u64Start, u64End;
+		GetMinMaxBucket(u64Bucket, u64Buckets, u64Count, &u64Start, &u64End);
+		const LIB_DOUBLE* prgdData = prgdWindow + (u64Start - u64WindowStart);
+		LIB_U64 u64Min, u64Max;
+		pstKernels->pfnMinMax(prgdData, u64End - u64Start, &u64Min, &u64Max);
+		LIB_U64 u64FirstPoint = (u64Min < u64Max) ? u64Min : u64Max;
+		LIB_U64 u64SecondPoint = (u64Min < u64Max) ? u64Max : u64Min;
+		prgdOutX[2 * u64Bucket] = (LIB_DOUBLE)(u64Start + u64FirstPoint);
+		prgdOutY[2 * u64Bucket] = prgdData[u64FirstPoint];
+		prgdOutX[2 * u64Bucket + 1] = (LIB_DOUBLE)(u64Start + u64SecondPoint);
+		prgdOutY[2 * u64Bucket + 1] = prgdData[u64SecondPoint];
+	}
+}
+
+/***************************************************************************//**
+ * LttbBuckets
+ *
+ * Runs DecimateLttb() over a range of its buckets, whose samples and those
+ * of the bucket after each are all in a window of the column. The point 
+ * kept from the bucket before the range is passed in and the last point 
+ * kept is passed out, so ranges can follow each other.
+ *
+ * @param pstKernels     Kernels from DecimateGetKernels()
+ * @param prgdWindow     Samples from u64WindowStart on
+ * @param u64WindowStart Index of the first sample of the window in the column
+ * @param u64Count       Number of samples of the column
+ * @param u64Buckets     Number of buckets of the column
+ * @param dEvery         Samples per bucket
+ * @param u64First       First bucket of the range
+ * @param u64Last        Bucket after the range
+ * @param pu64Previous   Index of the point kept before the range, receives the last kept
+ * @param pdPreviousY    Value of that point
+ * @param prgdOutX       Receives the sample index of each point of the column
+ * @param prgdOutY       Receives the value of each point of the column
+ ******************************************************************************/
+static void LttbBuckets(const LIB_DECIMATE_KERNELS* pstKernels, const LIB_DOUBLE* prgdWindow, LIB_U64 u64WindowStart, LIB_U64 u64Count,
+	LIB_U64 u64Buckets, LIB_DOUBLE dEvery, LIB_U64 u64First, LIB_U64 u64Last, LIB_U64* pu64Previous, LIB_DOUBLE* pdPreviousY,
+	LIB_DOUBLE* prgdOutX, LIB_DOUBLE* prgdOutY)
+{
+	for (LIB_U64 u64Bucket = u64First; u64Bucket < u64Last; u64Bucket++)
+	{
+		LIB_U64 u64Start, u64End, u64NextEnd;
+		GetLttbBucket(u64Bucket, u64Buckets, u64Count, dEvery, &u64Start, &u64End, &u64NextEnd);
+		LIB_DOUBLE dAvgX = (LIB_DOUBLE)(u64End + u64NextEnd - 1) / 2.0;
+		LIB_DOUBLE dAvgY = pstKernels->pfnSum(prgdWindow + (u64End - u64WindowStart), u64NextEnd - u64End) / (LIB_DOUBLE)(u64NextEnd - u64End);
+
+		// Twice the triangle area with A = previous point, C = next average and B = (x, y)
+		// is |(Ax - Cx) * y + (Cy - Ay) * x - (Ax - Cx) * Ay - Ax * (Cy - Ay)|, x counted from u64Start
+		LIB_DOUBLE dAx = (LIB_DOUBLE)*pu64Previous;
+		LIB_DOUBLE dAy = *pdPreviousY;
+		LIB_DOUBLE dP = dAx - dAvgX;
+		LIB_DOUBLE dQ = dAvgY - dAy;
+		LIB_DOUBLE dR = -dP * dAy - dAx * dQ + dQ * (LIB_DOUBLE)u64Start;
+		*pu64Previous = u64Start + pstKernels->pfnMaxArea(prgdWindow + (u64Start - u64WindowStart), u64End - u64Start, dP, dQ, dR);
+		*pdPreviousY = prgdWindow[*pu64Previous - u64WindowStart];
+
+		prgdOutX[u64Bucket + 1] = (LIB_DOUBLE)*pu64Previous;
+		prgdOutY[u64Bucket + 1] = *pdPreviousY;
+	}
+}
+
+/***************************************************************************//**
+ * DecimateMinMax
+ *
+ * Splits a column into u32MaxPoints / 2 buckets and keeps the smallest and
+ * the largest sample of each, in sample order. The envelope of the signal,
+ * including single-sample spikes, survives at any zoom level of the plot.
+ *
+ * @param pstKernels   Kernels from DecimateGetKernels()
+ * @param prgdData     Samples of one column
+ * @param u64Count     Number of samples, more than u32MaxPoints
+ * @param u32MaxPoints Number of points to keep
+ * @param prgdOutX     Receives the sample index of each point
+ * @param prgdOutY     Receives the value of each point
+ * @return             Number of points written
+ ******************************************************************************/
+LIB_U32 DecimateMinMax(const LIB_DECIMATE_KERNELS* pstKernels, const LIB_DOUBLE* prgdData, LIB_U64 u64Count,
+	LIB_U32 u32MaxPoints, LIB_DOUBLE* prgdOutX, LIB_DOUBLE* prgdOutY)
+{
+	LIB_U64 u64Buckets = u32MaxPoints / 2;
+	MinMaxBuckets(pstKernels, prgdData, 0, u64Count, u64Buckets, 0, u64Buckets, prgdOutX, prgdOutY);
+	return (LIB_U32)(u64Buckets * 2);
+}
+
+/***************************************************************************//**
+ * DecimateLttb
+ *
+ * Largest-Triangle-Three-Buckets (Steinarsson, 2013). Keeps the first and the
+ * last sample and splits the rest into u32MaxPoints - 2 buckets. From each
+ * bucket the sample forming the largest triangle with the point kept from the
+ * previous bucket and the average of the next bucket is kept.
+ *
+ * @param pstKernels   Kernels from DecimateGetKernels()
+ * @param prgdData     Samples of one column
+ * @param u64Count     Number of samples, more than u32MaxPoints
+ * @param u32MaxPoints Number of points to keep, at least 3
+ * @param prgdOutX     Receives the sample index of each point
+ * @param prgdOutY     Receives the value of each point
+ * @return             Number of points written
+ ******************************************************************************/
+LIB_U32 DecimateLttb(const LIB_DECIMATE_KERNELS* pstKernels, const LIB_DOUBLE* prgdData, LIB_U64 u64Count,
+	LIB_U32 u32MaxPoints, LIB_DOUBLE* prgdOutX, LIB_DOUBLE* prgdOutY)
+{
+	LIB_U64 u64Buckets = u32MaxPoints - 2;
+	LIB_DOUBLE dEvery = (LIB_DOUBLE)(u64Count - 2) / (LIB_DOUBLE)u64Buckets;
+	LIB_U64 u64Previous = 0;
+	LIB_DOUBLE dPreviousY = prgdData[0];
+
+	prgdOutX[0] = 0.0;
+	prgdOutY[0] = prgdData[0];
+	LttbBuckets(pstKernels, prgdData, 0, u64Count, u64Buckets, dEvery, 0, u64Buckets, &u64Previous, &dPreviousY, prgdOutX, prgdOutY);
+	prgdOutX[u64Buckets + 1] = (LIB_DOUBLE)(u64Count - 1);
+	prgdOutY[u64Buckets + 1] = prgdData[u64Count - 1];
+	return (LIB_U32)(u64Buckets + 2);
+}
+
+/***************************************************************************//**
+ * ColumnToDouble
+ *
+ * Converts a typed column to doubles with its scale and offset applied, so
+ * that it can be decimated like any other column. Samples are read one 
+ * stride apart and need not be aligned, e.g. members of packed structs.
+ *
+ * @param pstColumn   Typed column, its type has been validated
+ * @param u32RowSize  Number of samples
+ * @param prgdOutData Receives u32RowSize doubles
+ ******************************************************************************/
+void ColumnToDouble(const LIB_COLUMN* pstColumn, LIB_U32 u32RowSize, LIB_DOUBLE* prgdOutData)
+{
+	LIB_DOUBLE dScale = pstColumn->dScale;
+	LIB_DOUBLE dOffset = pstColumn->dOffset;
+	LIB_U64 u64Stride = GetColumnStride(pstColumn);
+	const LIB_CHAR* pcSample = (const LIB_CHAR*)pstColumn->pvData;
+	switch (pstColumn->u32Dtype)
+	{
+	case LIB_DTYPE_FLOAT32:
+		for (LIB_U32 u32Row = 0; u32Row < u32RowSize; u32Row++, pcSample += u64Stride)
+		{
+			LIB_FLOAT fSample;
+			memcpy(&fSample, pcSample, sizeof(fSample));
+			prgdOutData[u32Row] = fSample * dScale + dOffset;
+		}
+		break;
+	case LIB_DTYPE_INT16:
+		for (LIB_U32 u32Row = 0; u32Row < u32RowSize; u32Row++, pcSample += u64Stride)
+		{
+			LIB_INT16 n16Sample;
+			memcpy(&n16Sample, pcSample, sizeof(n16Sample));
+			prgdOutData[u32Row] = n16Sample * dScale + dOffset;
+		}
+		break;
+	case LIB_DTYPE_INT32:
+		for (LIB_U32 u32Row = 0; u32Row < u32RowSize; u32Row++, pcSample += u64Stride)
+		{
+			LIB_INT32 nSample;
+			memcpy(&nSample, pcSample, sizeof(nSample));
+			prgdOutData[u32Row] = nSample * dScale + dOffset;
+		}
+		break;
+	case LIB_DTYPE_FLOAT64:
+	default:
+		for (LIB_U32 u32Row = 0; u32Row < u32RowSize; u32Row++, pcSample += u64Stride)
+		{
+			LIB_DOUBLE dSample;
+			memcpy(&dSample, pcSample, sizeof(dSample));
+			prgdOutData[u32Row] = dSample * dScale + dOffset;
+		}
+		break;
+	}
+}
+
+/***************************************************************************//**
+ * ColumnRangeToDouble
+ *
+ * Converts part of a typed column to doubles, see ColumnToDouble()
+ *
+ * @param pstColumn   Typed column, its type has been validated
+ * @param u64First    Index of the first sample to convert
+ * @param u64Count    Number of samples
+ * @param prgdOutData Receives u64Count doubles
+ ******************************************************************************/
+static void ColumnRangeToDouble(const LIB_COLUMN* pstColumn, LIB_U64 u64First, LIB_U64 u64Count, LIB_DOUBLE* prgdOutData)
+{
+	LIB_COLUMN stRange = *pstColumn;
+	stRange.pvData = (const LIB_CHAR*)pstColumn->pvData + u64First * GetColumnStride(pstColumn);
+	ColumnToDouble(&stRange, (LIB_U32)u64Count, prgdOutData);
+}
+
+/***************************************************************************//**
+ * GetBucketSamples
+ *
+ * Samples that must be at hand to decimate one bucket: the bucket itself for
+ * min/max, and also the next bucket for LTTB
+ ******************************************************************************/
+static void GetBucketSamples(LIB_BOOLEAN bLttb, LIB_U64 u64Bucket, LIB_U64 u64Buckets, LIB_U64 u64Count, LIB_DOUBLE dEvery,
+	LIB_U64* pu64OutStart, LIB_U64* pu64OutEnd)
+{
+	LIB_U64 u64End;
+	if (bLttb)
+	{
+		GetLttbBucket(u64Bucket, u64Buckets, u64Count, dEvery, pu64OutStart, &u64End, pu64OutEnd);
+	}
+	else
+	{
+		GetMinMaxBucket(u64Bucket, u64Buckets, u64Count, pu64OutStart, pu64OutEnd);
+	}
+}
+
+/***************************************************************************//**
+ * DecimateWindowed
+ *
+ * Decimates a typed column like DecimateMinMax() or DecimateLttb(), with the
+ * same result, but converts it to doubles one window at a time. Each window
+ * holds as many whole buckets as fit, so a column is read once, front to 
+ * back, and the memory needed does not depend on its length. This is what 
+ * keeps a plot of a mapped file from reading it all into memory.
+ *
+ * @param pstKernels    Kernels from DecimateGetKernels()
+ * @param pstColumn     Typed column
+ * @param u64Count      Number of samples, more than u32MaxPoints
+ * @param bLttb         LIB_TRUE for LTTB, else min/max
+ * @param u32MaxPoints  Number of points to keep
+ * @param prgdWindow    Room for u64WindowSize doubles
+ * @param u64WindowSize From GetWindowSize(), at least the samples of any bucket
+ * @param prgdOutX      Receives the sample index of each point
+ * @param prgdOutY      Receives the value of each point
+ ******************************************************************************/
+static void DecimateWindowed(const LIB_DECIMATE_KERNELS* pstKernels, const LIB_COLUMN* pstColumn, LIB_U64 u64Count, LIB_BOOLEAN bLttb,
+	LIB_U32 u32MaxPoints, LIB_DOUBLE* prgdWindow, LIB_U64 u64WindowSize, LIB_DOUBLE* prgdOutX, LIB_DOUBLE* prgdOutY)
+{
+	LIB_U64 u64Buckets = bLttb ? u32MaxPoints - 2 : u32MaxPoints / 2;
+	LIB_DOUBLE dEvery = (LIB_DOUBLE)(u64Count - 2) / (LIB_DOUBLE)u64Buckets;
+	LIB_U64 u64Previous = 0;
+	LIB_DOUBLE dPreviousY = 0.0;
+	if (bLttb)
+	{
+		// First and last sample, the buckets lie in between
+		ColumnRangeToDouble(pstColumn, 0, 1, &dPreviousY);
+		prgdOutX[0] = 0.0;
+		prgdOutY[0] = dPreviousY;
+		prgdOutX[u64Buckets + 1] = (LIB_DOUBLE)(u64Count - 1);
+		ColumnRangeToDouble(pstColumn, u64Count - 1, 1, &prgdOutY[u64Buckets + 1]);
+	}
+
+	for (LIB_U64 u64First = 0; u64First < u64Buckets; )
+	{
+		// As many buckets as fit in the window, at least one
+		LIB_U64 u64WindowStart, u64WindowEnd;
+		GetBucketSamples(bLttb, u64First, u64Buckets, u64Count, dEvery, &u64WindowStart, &u64WindowEnd);
+		LIB_U64 u64Last = u64First + 1;
+		for (; u64Last < u64Buckets; u64Last++)
+		{
+			LIB_U64 u64Start, u64End;
+			GetBucketSamples(bLttb, u64Last, u64Buckets, u64Count, dEvery, &u64Start, &u64End);
+			if (u64End - u64WindowStart > u64WindowSize)
+			{
+				break;
+			}
+			u64WindowEnd = u64End;
+		}
+
+		ColumnRangeToDouble(pstColumn, u64WindowStart, u64WindowEnd - u64WindowStart, prgdWindow);
+		if (bLttb)
+		{
+			LttbBuckets(pstKernels, prgdWindow, u64WindowStart, u64Count, u64Buckets, dEvery, u64First, u64Last,
+				&u64Previous, &dPreviousY, prgdOutX, prgdOutY);
+		}
+		else
+		{
+			MinMaxBuckets(pstKernels, prgdWindow, u64WindowStart, u64Count, u64Buckets, u64First, u64Last, prgdOutX, prgdOutY);
+		}
+		u64First = u64Last;
+	}
+}
+
+/***************************************************************************//**
+ * GetWindowSize
+ *
+ * Size of the window of DecimateWindowed(): LIB_DECIMATE_WINDOW samples, or
+ * more if a single bucket needs more
+ *
+ * @param u64Count     Number of samples of each column
+ * @param bLttb        LIB_TRUE for LTTB, else min/max
+ * @param u32MaxPoints Number of points to keep
+ * @return             Samples of the window
+ ******************************************************************************/
+static LIB_U64 GetWindowSize(LIB_U64 u64Count, LIB_BOOLEAN bLttb, LIB_U32 u32MaxPoints)
+{
+	LIB_U64 u64Buckets = bLttb ? u32MaxPoints - 2 : u32MaxPoints / 2;
+	LIB_DOUBLE dEvery = (LIB_DOUBLE)(u64Count - 2) / (LIB_DOUBLE)u64Buckets;
+	LIB_U64 u64WindowSize = (u64Count < LIB_DECIMATE_WINDOW) ? u64Count : LIB_DECIMATE_WINDOW;
+	for (LIB_U64 u64Bucket = 0; u64Bucket < u64Buckets; u64Bucket++)
+	{
+		LIB_U64 u64Start, u64End;
+		GetBucketSamples(bLttb, u64Bucket, u64Buckets, u64Count, dEvery, &u64Start, &u64End);
+		u64WindowSize = (u64End - u64Start > u64WindowSize) ? u64End - u64Start : u64WindowSize;
+	}
+	return u64WindowSize;
+}
+
+/***************************************************************************//**
+ * DecimateInput
+ *
+ * Reduces every column of the input with the method selected by its
+ * u32Decimation. The result holds, per column, the X values (sample indices,
+ * or the values of the X column at them) followed by the Y values, each of
+ * *pu32OutRowSize doubles. Typed columns are converted to doubles a window
+ * at a time, with their scale and offset applied, and only the samples of 
+ * the X column at the points kept are read. The buckets are in samples, an
+ * X column does not move them.
+ *
+ * @param pstInput       Input with more than u32MaxPoints rows
+ * @param pprgdOutXY     Receives the reduced columns, release with free()
+ * @param pu32OutRowSize Receives the number of points per column
+ * @param pstErr         Error information structure for logging any errors
+ * @return               LIB_OK if success, else LIB_ERR if any error occurred
+ ******************************************************************************/
+LIB_U32 DecimateInput(const LIB_INPUT* pstInput, LIB_DOUBLE** pprgdOutXY, LIB_U32* pu32OutRowSize, LIB_ERROR_INFO* pstErr)
+{
+	LIB_CHAR szRuntimeMsg[LIB_MAX_BUFFER_SIZE] = "";
+	LIB_U32 u32MaxPoints = (pstInput->u32MaxPoints == 0) ? LIB_DEFAULT_MAX_POINTS : pstInput->u32MaxPoints;
+	LIB_BOOLEAN bLttb = (LIB_BOOLEAN)(pstInput->u32Decimation == LIB_DECIMATE_LTTB);
+	const LIB_DECIMATE_KERNELS* pstKernels = DecimateGetKernels(LIB_ISA_AUTO);
+
+	// Typed columns share one window, see DecimateWindowed()
+	LIB_U64 u64WindowSize = (pstInput->prgstColumns != NULL) ? GetWindowSize(pstInput->u32RowSize, bLttb, u32MaxPoints) : 0;
+	LIB_U64 u64XYSize = (LIB_U64)pstInput->u32ColSize * 2 * u32MaxPoints;
+	LIB_DOUBLE* prgdXY = (LIB_DOUBLE*)malloc((size_t)(u64XYSize + u64WindowSize) * sizeof(LIB_DOUBLE));
+	if (prgdXY == NULL)
+	{
+		snprintf(szRuntimeMsg, sizeof(szRuntimeMsg), "Unable to allocate %u decimated points and a window of %llu samples", 
+			u32MaxPoints, u64WindowSize);
+		LOG_ERROR(pstErr, LIB_ERR_BUFFER_OVERFLOW, LIB_ERR_BUFFER_OVERFLOW_MSG, LIB_ERR_BUFFER_OVERFLOW_ACT, szRuntimeMsg)
+		return LIB_ERR;
+	}
+	LIB_DOUBLE* prgdWindow = prgdXY + u64XYSize;
+
+	// Min/max keeps two points per bucket
+	LIB_U32 u32OutRowSize = bLttb ? u32MaxPoints : u32MaxPoints / 2 * 2;
+	for (LIB_U32 u32Col = 0; u32Col < pstInput->u32ColSize; u32Col++)
+	{
+		LIB_DOUBLE* prgdX = prgdXY + (LIB_U64)u32Col * 2 * u32OutRowSize;
+		LIB_DOUBLE* prgdY = prgdX + u32OutRowSize;
+		if (pstInput->prgstColumns != NULL)
+		{
+			DecimateWindowed(pstKernels, &pstInput->prgstColumns[u32Col], pstInput->u32RowSize, bLttb, u32MaxPoints,
+				prgdWindow, u64WindowSize, prgdX, prgdY);
+		}
+		else if (bLttb)
+		{
+			DecimateLttb(pstKernels, pstInput->prgdBuffer + (LIB_U64)u32Col * pstInput->u32RowSize, pstInput->u32RowSize, u32MaxPoints, prgdX, prgdY);
+		}
+		else
+		{
+			DecimateMinMax(pstKernels, pstInput->prgdBuffer + (LIB_U64)u32Col * pstInput->u32RowSize, pstInput->u32RowSize, u32MaxPoints, prgdX, prgdY);
+		}
+		for (LIB_U32 u32Point = 0; pstInput->pstXColumn != NULL && u32Point < u32OutRowSize; u32Point++)
+		{
+			ColumnRangeToDouble(pstInput->pstXColumn, (LIB_U64)prgdX[u32Point], 1, &prgdX[u32Point]);
+		}
+	}
+	*pprgdOutXY = prgdXY;
+	*pu32OutRowSize = u32OutRowSize;
+	return LIB_OK;
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "IPC_Plot_Internal.h"
+
+// Instruction sets of the decimation kernels
+#define LIB_ISA_AUTO   0 //!< Best kernels supported by this CPU
+#define LIB_ISA_SCALAR 1
+#define LIB_ISA_SSE2   2
+#define LIB_ISA_AVX2   3
+
+#define LIB_DECIMATE_WINDOW 65536 //!< Samples of a typed column converted to doubles at a time, see DecimateInput()
+
+// Per-bucket building blocks of the decimation algorithms, one set per instruction set.
+// All kernels ignore NaN samples unless a bucket holds nothing else, and report the
+// first index on ties so every set picks the same points.
+typedef struct LIB_DECIMATE_KERNELS
+{
+	const LIB_CHAR* pszName;
+	//!< Indices of the smallest and the largest sample
+	void (*pfnMinMax)(const LIB_DOUBLE* prgdData, LIB_U64 u64Count, LIB_U64* pu64OutMin, LIB_U64* pu64OutMax);
+	//!< Sum of the samples
+	LIB_DOUBLE (*pfnSum)(const LIB_DOUBLE* prgdData, LIB_U64 u64Count);
+	//!< Index of the sample with the largest |dP * y[i] + dQ * i + dR|, twice the LTTB triangle area
+	LIB_U64 (*pfnMaxArea)(const LIB_DOUBLE* prgdData, LIB_U64 u64Count, LIB_DOUBLE dP, LIB_DOUBLE dQ, LIB_DOUBLE dR);
+} LIB_DECIMATE_KERNELS;
+
+const LIB_DECIMATE_KERNELS* DecimateGetKernels(LIB_U32 u32Isa);
+LIB_U32 DecimateMinMax(const LIB_DECIMATE_KERNELS* pstKernels, const LIB_DOUBLE* prgdData, LIB_U64 u64Count,
+	LIB_U32 u32MaxPoints, LIB_DOUBLE* prgdOutX, LIB_DOUBLE* prgdOutY);
+LIB_U32 DecimateLttb(const LIB_DECIMATE_KERNELS* pstKernels, const LIB_DOUBLE* prgdData, LIB_U64 u64Count,
+	LIB_U32 u32MaxPoints, LIB_DOUBLE* prgdOutX, LIB_DOUBLE* prgdOutY);
+LIB_U32 DecimateInput(const LIB_INPUT* pstInput, LIB_DOUBLE** pprgdOutXY, LIB_U32* pu32OutRowSize, LIB_ERROR_INFO* pstErr);
+void ColumnToDouble(const LIB_COLUMN* pstColumn, LIB_U32 u32RowSize, LIB_DOUBLE* prgdOutData);
@@ -0,0 +1,110 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "IPC_Plot_Internal.h"
+
+/***************************************************************************//**
+ * GetFileRows
+ *
+ * Counts the samples of a column that lie wholly inside the file
+ *
+ * @param pstColumn  Validated column in the file
+ * @param u64MapSize Size of the file in bytes
+ * @return           Number of samples, 0 if not even the first fits
+ ******************************************************************************/
+static LIB_U64 GetFileRows(const LIB_FILE_COLUMN* pstColumn, LIB_U64 u64MapSize)
+{
+	LIB_U64 u64SampleSize = GetDtypeSize(pstColumn->u32Dtype);
+	LIB_U64 u64Stride = (pstColumn->u32Stride != 0) ? pstColumn->u32Stride : u64SampleSize;
+	if (pstColumn->u64Offset > u64MapSize || u64MapSize - pstColumn->u64Offset < u64SampleSize)
+	{
+		return 0;
+	}
+	return (u64MapSize - pstColumn->u64Offset - u64SampleSize) / u64Stride + 1;
+}
+
+/***************************************************************************//**
+ * FileViewOpen
+ *
+ * Maps the file of the input and describes its columns as typed columns of
+ * the mapping, so that the file is plotted, decimated and sent like columns
+ * in memory without being read into it. The rows of the input must lie in
+ * the file; with u32RowSize 0 as many rows are plotted as every column has.
+ *
+ * @param pstInput   Validated input with pstFile set
+ * @param pstOutView Receives the mapping and the input to plot, release with FileViewClose()
+ * @param pstErr     Error information structure for logging any errors
+ * @return           LIB_OK if success, else LIB_ERR if any error occurred
+ ******************************************************************************/
+LIB_U32 FileViewOpen(const LIB_INPUT* pstInput, LIB_FILE_VIEW* pstOutView, LIB_ERROR_INFO* pstErr)
+{
+	LIB_CHAR szRuntimeMsg[LIB_MAX_BUFFER_SIZE] = "";
+	const LIB_FILE_INPUT* pstFile = pstInput->pstFile;
+	LIB_U32 u32Count = pstInput->u32ColSize + ((pstFile->pstXColumn != NULL) ? 1 : 0);
+
+	pstOutView->prgstColumns = NULL;
+	if (FileMapOpen(pstFile->pszPath, &pstOutView->stMap, pstErr) != LIB_OK)
+	{
+		return LIB_ERR;
+	}
+	pstOutView->prgstColumns = (LIB_COLUMN*)malloc((size_t)u32Count * sizeof(LIB_COLUMN));
+	if (pstOutView->prgstColumns == NULL && u32Count > 0)
+	{
+		snprintf(szRuntimeMsg, sizeof(szRuntimeMsg), "Unable to allocate %u columns of %s", u32Count, pstFile->pszPath);
+		LOG_ERROR(pstErr, LIB_ERR_BUFFER_OVERFLOW, LIB_ERR_BUFFER_OVERFLOW_MSG, LIB_ERR_BUFFER_OVERFLOW_ACT, szRuntimeMsg)
+		FileViewClose(pstOutView);
+		return LIB_ERR;
+	}
+
+	// The X column goes after the columns, the rows are the fewest any column has
+	const LIB_CHAR* pcBase = (const LIB_CHAR*)pstOutView->stMap.pvBase;
+	LIB_U64 u64MapSize = pstOutView->stMap.u64Size;
+	LIB_U64 u64FileRows = (u32Count > 0) ? ~0ULL : 0;
+	for (LIB_U32 u32Entry = 0; u32Entry < u32Count; u32Entry++)
+	{
+		const LIB_FILE_COLUMN* pstFileColumn = (u32Entry < pstInput->u32ColSize) ? &pstFile->prgstColumns[u32Entry] : pstFile->pstXColumn;
+		LIB_U64 u64Rows = GetFileRows(pstFileColumn, u64MapSize);
+		u64FileRows = (u64Rows < u64FileRows) ? u64Rows : u64FileRows;
+
+		LIB_COLUMN stColumn;
+		stColumn.pvData = pcBase + ((u64Rows > 0) ? pstFileColumn->u64Offset : 0);
+		stColumn.u32Dtype = pstFileColumn->u32Dtype;
+		stColumn.u32Stride = pstFileColumn->u32Stride;
+		stColumn.dScale = pstFileColumn->dScale;
+		stColumn.dOffset = pstFileColumn->dOffset;
+		pstOutView->prgstColumns[u32Entry] = stColumn;
+	}
+	if (u64FileRows > 0xFFFFFFFFULL)
+	{
+		u64FileRows = 0xFFFFFFFFULL;
+	}
+	if (u64FileRows == 0 || u64FileRows < pstInput->u32RowSize)
+	{
+		snprintf(szRuntimeMsg, sizeof(szRuntimeMsg), "%s of %llu bytes holds %llu rows of every column, %u requested",
+			pstFile->pszPath, u64MapSize, u64FileRows, pstInput->u32RowSize);
+		LOG_ERROR(pstErr, LIB_ERR_INPUT_INVALID, LIB_ERR_INPUT_INVALID_MSG, LIB_ERR_INPUT_INVALID_ACT, szRuntimeMsg)
+		FileViewClose(pstOutView);
+		return LIB_ERR;
+	}
+
+	pstOutView->stInput = *pstInput;
+	pstOutView->stInput.u32RowSize = (pstInput->u32RowSize != 0) ? pstInput->u32RowSize : (LIB_U32)u64FileRows;
+	pstOutView->stInput.prgstColumns = pstOutView->prgstColumns;
+	pstOutView->stInput.pstXColumn = (pstFile->pstXColumn != NULL) ? &pstOutView->prgstColumns[pstInput->u32ColSize] : NULL;
+	pstOutView->stInput.pstFile = NULL;
+	return LIB_OK;
+}
+
+/***************************************************************************//**
+ * FileViewClose
+ *
+ * Releases the columns and the mapping of a view
+ *
+ * @param pstView View from FileViewOpen()
+ ******************************************************************************/
+void FileViewClose(LIB_FILE_VIEW* pstView)
+{
+	free(pstView->prgstColumns);
+	pstView->prgstColumns = NULL;
+	FileMapClose(&pstView->stMap);
+}
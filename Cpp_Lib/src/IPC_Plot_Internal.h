@@ -1,21 +1,136 @@
 #pragma once
 
+#ifdef _WIN32
+#    include <windows.h>
+#endif
+
 #include "IPC_Plot.h"
 
-typedef struct LIB_BUFFER_ST
-{
-	LIB_DOUBLE dData;
-} LIB_BUFFER_ST;
+#ifdef _WIN32
+#    define PYTHON_PATH ".\\..\\Python\\IPC_Plot.py"
+#    define LIB_PIPE_BUFFER_SIZE 65536 //!< Size of the named pipe buffers, also the largest single WriteFile()
+#else
+#    define PYTHON_PATH "./../Python/IPC_Plot.py"
+#    define PYTHON_EXE "python3"
+#    define LIB_RENDERER_FD 3 //!< Descriptor number of the socket inside the Python tool
+#endif
 
-typedef struct LIB_LABEL_ST
-{
-	LIB_CHAR szLabel[LIB_MAX_LABEL_SIZE];
-} LIB_LABEL_ST;
+#define LIB_RENDERER_ENV "IPC_PLOT_RENDERER" //!< Environment variable naming another script to run instead of PYTHON_PATH
+#define LIB_STATUS_DONE 0x0000FFFF //!< Status code sent by the Python tool after plotting
+#define LIB_CLOSE_WAIT_MS 5000     //!< Time given to the Python tool to exit after its session is closed
+#define LIB_READY_WAIT_MS 60000    //!< Longest start-up of the Python tool, until its READY frame
+#define LIB_ASYNC_THREADS 4        //!< Worker threads running ipc_plot_async() requests
+#define LIB_BATCH_MAX_WORKERS 64   //!< Upper limit of the Python tools started by ipc_plot_batch()
 
-typedef struct LIB_PIPE_INFO
+#define __AT__  __FILE__ , __LINE__
+
+#define LOG_ERROR(pstERR_Out, u32CODE_In, pcERRDEF_In, pcERRACTION_In, pcRUNTIME_In)    \
+    if (pstERR_Out->u32ErrCode == 0) \
+    { \
+    	pstERR_Out->u32ErrCode = u32CODE_In;\
+    	snprintf(pstERR_Out->szErrMsg, sizeof(pstERR_Out->szErrMsg), "%s", pcERRDEF_In);\
+    	snprintf(pstERR_Out->szErrHelp, sizeof(pstERR_Out->szErrHelp), "%s", pcERRACTION_In);\
+    	snprintf(pstERR_Out->szRuntime, sizeof(pstERR_Out->szRuntime), "%s (%s, %d)", pcRUNTIME_In, __AT__); \
+    }
+
+// A running Python tool and the connection to it
+struct LIB_SESSION
 {
+#ifdef _WIN32
 	HANDLE hNamedPipe;
 	HANDLE hChildProcess;
-	LIB_BUFFER_ST* pstDataArray;
-	LIB_LABEL_ST* pstLabelArray;
-} LIB_PIPE_INFO;
\ No newline at end of file
+#else
+	LIB_INT32 nSocket; //!< Parent end of the socket pair
+	LIB_INT32 nPid;    //!< Process ID of the Python tool
+#endif
+	LIB_PLOT_STATS stStats; //!< Timings and byte counts of the current plot, or of the start-up until the first
+};
+
+#ifdef _WIN32
+#    define LIB_SHM_NAME_SIZE 64
+typedef struct LIB_SHM_INFO
+{
+	HANDLE hMapping;                   //!< Named file mapping backed by the paging file
+	void* pvBase;                      //!< Start of the view in this process
+	LIB_U64 u64Size;                   //!< Size of the view in bytes
+	LIB_CHAR szName[LIB_SHM_NAME_SIZE]; //!< Name the Python tool opens the mapping with
+} LIB_SHM_INFO;
+#else
+typedef struct LIB_SHM_INFO
+{
+	LIB_INT32 nFd;   //!< Descriptor of the shared memory segment
+	void* pvBase;    //!< Start of the mapping in this process
+	LIB_U64 u64Size; //!< Size of the mapping in bytes
+} LIB_SHM_INFO;
+#endif
+
+// Shared memory mapped by this process and the Python tool
+LIB_INT32 SharedMemCreate(LIB_U64 u64Size, LIB_SHM_INFO* pstShm, LIB_ERROR_INFO* pstErr);
+void SharedMemClose(LIB_SHM_INFO* pstShm);
+
+// Whole file mapped read-only. On POSIX the mapping is found by FindSharedMem() like a segment
+// from ipc_plot_alloc(), so the Python tool maps the file itself instead of receiving the samples.
+LIB_INT32 FileMapOpen(const LIB_CHAR* pszPath, LIB_SHM_INFO* pstMap, LIB_ERROR_INFO* pstErr);
+void FileMapClose(LIB_SHM_INFO* pstMap);
+
+// Input of a plot with LIB_FILE_INPUT, the columns in the file as typed columns of its mapping,
+// IPC_Plot_File.cpp
+typedef struct LIB_FILE_VIEW
+{
+	LIB_SHM_INFO stMap;
+	LIB_INPUT stInput;        //!< Input of the caller with the file replaced by typed columns
+	LIB_COLUMN* prgstColumns; //!< u32ColSize columns followed by the X column, if any
+} LIB_FILE_VIEW;
+
+LIB_U32 FileViewOpen(const LIB_INPUT* pstInput, LIB_FILE_VIEW* pstOutView, LIB_ERROR_INFO* pstErr);
+void FileViewClose(LIB_FILE_VIEW* pstView);
+
+#ifndef _WIN32
+LIB_BOOLEAN FindSharedMem(const void* pvData, LIB_U64 u64Size, LIB_INT32* pnOutFd, LIB_U64* pu64Offset);
+LIB_INT32 SocketSendAll(LIB_INT32 nSocket, const void* pvData, LIB_U64 u64Size, LIB_INT32 nFd, LIB_ERROR_INFO* pstErr);
+LIB_INT32 SocketRecvAll(LIB_INT32 nSocket, void* pvData, LIB_U64 u64Size, LIB_ERROR_INFO* pstErr);
+#endif
+
+// Byte stream to the Python tool of a session. nFd is passed along with the first 
+// byte on POSIX and must be -1 on Windows.
+LIB_INT32 TransportSend(LIB_SESSION* pstSession, const void* pvData, LIB_U64 u64Size, LIB_INT32 nFd, LIB_ERROR_INFO* pstErr);
+LIB_INT32 TransportRecv(LIB_SESSION* pstSession, void* pvData, LIB_U64 u64Size, LIB_ERROR_INFO* pstErr);
+
+// Checks of the input shared by the synchronous and asynchronous API
+LIB_U32 ValidateInput(const LIB_INPUT* pstInput, LIB_ERROR_INFO* pstErr);
+LIB_U32 GetDtypeSize(LIB_U32 u32Dtype);
+LIB_U64 GetColumnStride(const LIB_COLUMN* pstColumn);
+LIB_BOOLEAN IsSessionLost(LIB_U32 u32ErrCode);
+
+// Buffer of the image returned with LIB_OUTPUT_PNG or LIB_OUTPUT_RGBA, IPC_Plot.cpp
+LIB_U32 ImageReserve(LIB_IMAGE* pstImage, LIB_U64 u64Size, LIB_ERROR_INFO* pstErr);
+
+// Script run as the Python tool, PYTHON_PATH unless overridden by LIB_RENDERER_ENV
+const LIB_CHAR* GetRendererPath(void);
+
+// Platform specific part of the session API, input has been validated by the caller
+LIB_U32 RendererOpen(LIB_SESSION* pstSession, LIB_ERROR_INFO* pstErr);
+LIB_U32 RendererPlot(LIB_SESSION* pstSession, LIB_INPUT* pstInput, LIB_U32 u32Flags, LIB_ERROR_INFO* pstErr);
+void RendererClose(LIB_SESSION* pstSession);
+LIB_BOOLEAN RendererAlive(LIB_SESSION* pstSession);
+
+// Python tools kept ready for ipc_plot(), IPC_Plot_Pool.cpp. A session taken with pbOutPooled
+// set, or opened by the caller after a NULL with pbOutPooled set, goes back with PoolRelease().
+LIB_SESSION* PoolAcquire(LIB_BOOLEAN* pbOutPooled);
+void PoolRelease(LIB_SESSION* pstSession, LIB_BOOLEAN bLost);
+
+// Concurrency limit and admission queue of ipc_plot(), IPC_Plot_Admission.cpp. A call
+// admitted with LIB_OK ends with AdmissionLeave().
+LIB_U32 AdmissionEnter(LIB_ERROR_INFO* pstErr);
+void AdmissionLeave(void);
+LIB_U32 AdmissionPeak(void);
+
+// Spool log of ipc_plot(), IPC_Plot_Spool.cpp. While SpoolEnabled(), SpoolPlot() appends each
+// request to the log in place of a renderer.
+LIB_BOOLEAN SpoolEnabled(void);
+LIB_U32 SpoolPlot(const LIB_INPUT* pstInput, LIB_U32 u32Flags, LIB_PLOT_STATS* pstStats, LIB_ERROR_INFO* pstErr);
+
+// Timings, counters and trace events of the plots, IPC_Plot_Stats.cpp
+LIB_U64 StatsNowUs(void);
+LIB_U64 StatsPhase(const LIB_CHAR* pszName, LIB_U64 u64StartUs, LIB_DOUBLE* pdOutMs);
+void StatsCall(const LIB_CHAR* pszName, LIB_U64 u64StartUs, LIB_PLOT_STATS* pstStats, const LIB_ERROR_INFO* pstErr);
@@ -0,0 +1,387 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "IPC_Plot_Raster.h"
+
+// Deflate with the fixed Huffman codes of RFC 1951 and matches at distance 1 only, i.e. run-length
+// encoding. After the PNG row filters a plot is mostly runs of zero bytes, which this reduces to
+// about 1/100 of the raw size without the cost of a full LZ77 search.
+#define LIB_DEFLATE_MIN_MATCH 3
+#define LIB_DEFLATE_MAX_MATCH 258
+#define LIB_ADLER_MOD         65521
+#define LIB_ADLER_BLOCK       5552 //!< Bytes summed before the Adler-32 sums can overflow 32 bits
+
+// PNG row filters tried on every row
+#define LIB_PNG_FILTER_SUB 1
+#define LIB_PNG_FILTER_UP  2
+
+// Output of the deflate stream, bits are packed from the least significant one
+typedef struct LIB_BIT_WRITER
+{
+	LIB_CHAR* pcOut;
+	LIB_U64 u64Pos;     //!< Bytes written to pcOut
+	LIB_U64 u64Bits;    //!< Pending bits, u32Count of them
+	LIB_U32 u32Count;
+} LIB_BIT_WRITER;
+
+// Base length and extra bits of the length codes 257 to 285
+static const LIB_U16 s_rgu16LengthBase[29] = {
+	3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+	35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+static const LIB_CHAR s_rgcLengthExtra[29] = {
+	0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+	3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+
+/***************************************************************************//**
+ * CreateCrcTable
+ *
+ * Fills the CRC-32 table of the PNG chunks, polynomial 0xEDB88320
+ *
+ * @param prgu32Table Receives 256 entries
+ * @return            LIB_TRUE
+ ******************************************************************************/
+static LIB_BOOLEAN CreateCrcTable(LIB_U32* prgu32Table)
+{
+	for (LIB_U32 u32Byte = 0; u32Byte < 256; u32Byte++)
+	{
+		LIB_U32 u32Crc = u32Byte;
+		for (LIB_U32 u32Bit = 0; u32Bit < 8; u32Bit++)
+		{
+			u32Crc = (u32Crc & 1) ? 0xEDB88320U ^ (u32Crc >> 1) : u32Crc >> 1;
+		}
+		prgu32Table[u32Byte] = u32Crc;
+	}
+	return LIB_TRUE;
+}
+
+/***************************************************************************//**
+ * GetCrc
+ *
+ * CRC-32 of a chunk type and data, as stored after every PNG chunk
+ *
+ * @param pcData  Bytes to check
+ * @param u64Size Number of bytes
+ * @return        CRC-32
+ ******************************************************************************/
+static LIB_U32 GetCrc(const LIB_CHAR* pcData, LIB_U64 u64Size)
+{
+	static LIB_U32 s_rgu32Table[256];
+	// Filled once, the function-local static is initialised thread-safely
+	static const LIB_BOOLEAN s_bTable = CreateCrcTable(s_rgu32Table);
+	(void)s_bTable;
+
+	LIB_U32 u32Crc = 0xFFFFFFFFU;
+	for (LIB_U64 u64Index = 0; u64Index < u64Size; u64Index++)
+	{
+		u32Crc = s_rgu32Table[(u32Crc ^ (LIB_U32)(unsigned char)pcData[u64Index]) & 0xFF] ^ (u32Crc >> 8);
+	}
+	return u32Crc ^ 0xFFFFFFFFU;
+}
+
+/***************************************************************************//**
+ * AddAdler
+ *
+ * Adds bytes to the Adler-32 sums ending the zlib stream
+ *
+ * @param pcData  Bytes added
+ * @param u64Size Number of bytes
+ * @param pu32S1  Sum of the bytes, updated
+ * @param pu32S2  Sum of the sums, updated
+ ******************************************************************************/
+static void AddAdler(const LIB_CHAR* pcData, LIB_U64 u64Size, LIB_U32* pu32S1, LIB_U32* pu32S2)
+{
+	LIB_U32 u32S1 = *pu32S1;
+	LIB_U32 u32S2 = *pu32S2;
+	while (u64Size > 0)
+	{
+		LIB_U64 u64Block = (u64Size < LIB_ADLER_BLOCK) ? u64Size : LIB_ADLER_BLOCK;
+		for (LIB_U64 u64Index = 0; u64Index < u64Block; u64Index++)
+		{
+			u32S1 += (unsigned char)pcData[u64Index];
+			u32S2 += u32S1;
+		}
+		u32S1 %= LIB_ADLER_MOD;
+		u32S2 %= LIB_ADLER_MOD;
+		pcData += u64Block;
+		u64Size -= u64Block;
+	}
+	*pu32S1 = u32S1;
+	*pu32S2 = u32S2;
+}
+
+static void PutBits(LIB_BIT_WRITER* pstWriter, LIB_U32 u32Value, LIB_U32 u32Count)
+{
+	pstWriter->u64Bits |= (LIB_U64)u32Value << pstWriter->u32Count;
+	pstWriter->u32Count += u32Count;
+	while (pstWriter->u32Count >= 8)
+	{
+		pstWriter->pcOut[pstWriter->u64Pos++] = (LIB_CHAR)(pstWriter->u64Bits & 0xFF);
+		pstWriter->u64Bits >>= 8;
+		pstWriter->u32Count -= 8;
+	}
+}
+
+/***************************************************************************//**
+ * PutCode
+ *
+ * Writes a Huffman code, which unlike the other fields of deflate starts
+ * with its most significant bit
+ *
+ * @param pstWriter Output
+ * @param u32Code   Code
+ * @param u32Length Bits of the code
+ ******************************************************************************/
+static void PutCode(LIB_BIT_WRITER* pstWriter, LIB_U32 u32Code, LIB_U32 u32Length)
+{
+	LIB_U32 u32Reversed = 0;
+	for (LIB_U32 u32Bit = 0; u32Bit < u32Length; u32Bit++)
+	{
+		u32Reversed = (u32Reversed << 1) | ((u32Code >> u32Bit) & 1);
+	}
+	PutBits(pstWriter, u32Reversed, u32Length);
+}
+
+/***************************************************************************//**
+ * PutSymbol
+ *
+ * Writes a literal or length symbol with the fixed Huffman code
+ *
+ * @param pstWriter Output
+ * @param u32Symbol 0 to 287
+ ******************************************************************************/
+static void PutSymbol(LIB_BIT_WRITER* pstWriter, LIB_U32 u32Symbol)
+{
+	if (u32Symbol < 144)
+	{
+		PutCode(pstWriter, 0x30 + u32Symbol, 8);
+	}
+	else if (u32Symbol < 256)
+	{
+		PutCode(pstWriter, 0x190 + u32Symbol - 144, 9);
+	}
+	else if (u32Symbol < 280)
+	{
+		PutCode(pstWriter, u32Symbol - 256, 7);
+	}
+	else
+	{
+		PutCode(pstWriter, 0xC0 + u32Symbol - 280, 8);
+	}
+}
+
+/***************************************************************************//**
+ * PutRun
+ *
+ * Writes a match of the previous byte repeated u32Length times
+ *
+ * @param pstWriter Output
+ * @param u32Length LIB_DEFLATE_MIN_MATCH to LIB_DEFLATE_MAX_MATCH
+ ******************************************************************************/
+static void PutRun(LIB_BIT_WRITER* pstWriter, LIB_U32 u32Length)
+{
+	LIB_U32 u32Code = 0;
+	while (u32Code + 1 < 29 && s_rgu16LengthBase[u32Code + 1] <= u32Length)
+	{
+		u32Code++;
+	}
+	PutSymbol(pstWriter, 257 + u32Code);
+	PutBits(pstWriter, u32Length - s_rgu16LengthBase[u32Code], (LIB_U32)s_rgcLengthExtra[u32Code]);
+	// Distance code 0 is a distance of 1, 5 bits without extra bits
+	PutCode(pstWriter, 0, 5);
+}
+
+/***************************************************************************//**
+ * PutRow
+ *
+ * Compresses one filtered row. Runs may start in the previous row, the
+ * distance is always 1 byte back in the uncompressed stream.
+ *
+ * @param pstWriter Output
+ * @param pcRow     Filter type followed by the filtered pixels
+ * @param u64Size   Bytes of the row
+ * @param pbHasPrev LIB_TRUE once a byte has been written, updated
+ * @param pcPrev    Last byte written, updated
+ ******************************************************************************/
+static void PutRow(LIB_BIT_WRITER* pstWriter, const LIB_CHAR* pcRow, LIB_U64 u64Size, LIB_BOOLEAN* pbHasPrev, LIB_CHAR* pcPrev)
+{
+	LIB_U64 u64Index = 0;
+	while (u64Index < u64Size)
+	{
+		LIB_U32 u32Run = 0;
+		if (*pbHasPrev)
+		{
+			while (u32Run < LIB_DEFLATE_MAX_MATCH && u64Index + u32Run < u64Size && pcRow[u64Index + u32Run] == *pcPrev)
+			{
+				u32Run++;
+			}
+		}
+		if (u32Run >= LIB_DEFLATE_MIN_MATCH)
+		{
+			PutRun(pstWriter, u32Run);
+			u64Index += u32Run;
+			continue;
+		}
+		*pcPrev = pcRow[u64Index++];
+		*pbHasPrev = LIB_TRUE;
+		PutSymbol(pstWriter, (unsigned char)*pcPrev);
+	}
+}
+
+/***************************************************************************//**
+ * FilterRow
+ *
+ * Applies the Sub and Up filters to a row and keeps the one leaving fewer
+ * non-zero bytes, i.e. longer runs for PutRow()
+ *
+ * @param prgu32Row  Pixels of the row
+ * @param prgu32Prev Pixels of the row above, NULL for the first row
+ * @param u32Width   Pixels per row
+ * @param pcSub      Scratch row of 1 + 4 * u32Width bytes
+ * @param pcUp       Scratch row of 1 + 4 * u32Width bytes
+ * @return           pcSub or pcUp, whichever was kept
+ ******************************************************************************/
+static const LIB_CHAR* FilterRow(const LIB_U32* prgu32Row, const LIB_U32* prgu32Prev, LIB_U32 u32Width, LIB_CHAR* pcSub, LIB_CHAR* pcUp)
+{
+	LIB_U64 u64SubCost = 0;
+	LIB_U64 u64UpCost = 0;
+	pcSub[0] = LIB_PNG_FILTER_SUB;
+	pcUp[0] = LIB_PNG_FILTER_UP;
+	for (LIB_U32 u32X = 0; u32X < u32Width; u32X++)
+	{
+		LIB_U32 u32Left = (u32X > 0) ? prgu32Row[u32X - 1] : 0;
+		LIB_U32 u32Above = (prgu32Prev != NULL) ? prgu32Prev[u32X] : 0;
+		for (LIB_U32 u32Byte = 0; u32Byte < 4; u32Byte++)
+		{
+			// Pixels are 0xAABBGGRR, PNG stores R, G, B, A
+			LIB_U32 u32Shift = u32Byte * 8;
+			LIB_U32 u32Value = (prgu32Row[u32X] >> u32Shift) & 0xFF;
+			LIB_CHAR cSub = (LIB_CHAR)((u32Value - (u32Left >> u32Shift)) & 0xFF);
+			LIB_CHAR cUp = (LIB_CHAR)((u32Value - (u32Above >> u32Shift)) & 0xFF);
+			pcSub[1 + u32X * 4 + u32Byte] = cSub;
+			pcUp[1 + u32X * 4 + u32Byte] = cUp;
+			u64SubCost += (cSub != 0);
+			u64UpCost += (cUp != 0);
+		}
+	}
+	return (u64UpCost < u64SubCost) ? pcUp : pcSub;
+}
+
+static void PutU32(LIB_CHAR* pcOut, LIB_U32 u32Value)
+{
+	pcOut[0] = (LIB_CHAR)((u32Value >> 24) & 0xFF);
+	pcOut[1] = (LIB_CHAR)((u32Value >> 16) & 0xFF);
+	pcOut[2] = (LIB_CHAR)((u32Value >> 8) & 0xFF);
+	pcOut[3] = (LIB_CHAR)(u32Value & 0xFF);
+}
+
+/***************************************************************************//**
+ * PutChunk
+ *
+ * Completes a PNG chunk whose data has been written after its length and
+ * type: fills in the length and appends the CRC
+ *
+ * @param pcChunk Start of the chunk
+ * @param u32Size Bytes of the chunk data
+ * @return        Bytes of the whole chunk
+ ******************************************************************************/
+static LIB_U64 PutChunk(LIB_CHAR* pcChunk, LIB_U32 u32Size)
+{
+	PutU32(pcChunk, u32Size);
+	PutU32(pcChunk + 8 + u32Size, GetCrc(pcChunk + 4, 4 + (LIB_U64)u32Size));
+	return 12 + (LIB_U64)u32Size;
+}
+
+/***************************************************************************//**
+ * PngEncode
+ *
+ * Encodes an RGBA image as a PNG file in memory
+ *
+ * @param prgu32Pixels Pixels 0xAABBGGRR, rows from the top
+ * @param u32Width     Pixels per row
+ * @param u32Height    Rows
+ * @param u32Dpi       Resolution stored in the pHYs chunk
+ * @param ppcOutPng    Receives the PNG file, release with free()
+ * @param pu64OutSize  Receives the size of the PNG file
+ * @param pstErr       Error information structure for logging any errors
+ * @return             LIB_OK if success, else LIB_ERR if any error occurred
+ ******************************************************************************/
+LIB_U32 PngEncode(const LIB_U32* prgu32Pixels, LIB_U32 u32Width, LIB_U32 u32Height, LIB_U32 u32Dpi,
+	LIB_CHAR** ppcOutPng, LIB_U64* pu64OutSize, LIB_ERROR_INFO* pstErr)
+{
+	LIB_CHAR szRuntimeMsg[LIB_MAX_BUFFER_SIZE] = "";
+	static const LIB_CHAR s_rgcSignature[8] = { (LIB_CHAR)0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+
+	// Worst case of the fixed codes is 9 bits per byte, plus the headers of the chunks
+	LIB_U64 u64RowSize = 1 + (LIB_U64)u32Width * 4;
+	LIB_U64 u64Bound = 8 + 25 + 21 + 12 + 2 + (u64RowSize * u32Height * 9 + 7) / 8 + 8 + 12;
+	LIB_CHAR* pcPng = (LIB_CHAR*)malloc((size_t)u64Bound);
+	LIB_CHAR* pcRows = (LIB_CHAR*)malloc((size_t)u64RowSize * 2);
+	if (pcPng == NULL || pcRows == NULL)
+	{
+		free(pcPng);
+		free(pcRows);
+		snprintf(szRuntimeMsg, sizeof(szRuntimeMsg), "Unable to allocate %llu bytes for a %u x %u PNG", u64Bound, u32Width, u32Height);
+		LOG_ERROR(pstErr, LIB_ERR_BUFFER_OVERFLOW, LIB_ERR_BUFFER_OVERFLOW_MSG, LIB_ERR_BUFFER_OVERFLOW_ACT, szRuntimeMsg)
+		return LIB_ERR;
+	}
+
+	// 01. Signature, IHDR with 8-bit RGBA and pHYs with the resolution in pixels per metre
+	LIB_U64 u64Pos = 0;
+	memcpy(pcPng, s_rgcSignature, sizeof(s_rgcSignature));
+	u64Pos += sizeof(s_rgcSignature);
+	LIB_CHAR* pcChunk = pcPng + u64Pos;
+	memcpy(pcChunk + 4, "IHDR", 4);
+	PutU32(pcChunk + 8, u32Width);
+	PutU32(pcChunk + 12, u32Height);
+	pcChunk[16] = 8;  // Bit depth
+	pcChunk[17] = 6;  // Colour type RGBA
+	pcChunk[18] = 0;  // Deflate
+	pcChunk[19] = 0;  // Adaptive filtering
+	pcChunk[20] = 0;  // No interlace
+	u64Pos += PutChunk(pcChunk, 13);
+	pcChunk = pcPng + u64Pos;
+	memcpy(pcChunk + 4, "pHYs", 4);
+	LIB_U32 u32PerMetre = (LIB_U32)(u32Dpi / 0.0254 + 0.5);
+	PutU32(pcChunk + 8, u32PerMetre);
+	PutU32(pcChunk + 12, u32PerMetre);
+	pcChunk[16] = 1;  // Unit is the metre
+	u64Pos += PutChunk(pcChunk, 9);
+
+	// 02. IDAT: zlib header, a single fixed Huffman block and the Adler-32 of the filtered rows
+	pcChunk = pcPng + u64Pos;
+	memcpy(pcChunk + 4, "IDAT", 4);
+	LIB_BIT_WRITER stWriter = { pcChunk + 8, 0, 0, 0 };
+	stWriter.pcOut[stWriter.u64Pos++] = 0x78;
+	stWriter.pcOut[stWriter.u64Pos++] = 0x01;
+	PutBits(&stWriter, 1, 1);  // BFINAL
+	PutBits(&stWriter, 1, 2);  // BTYPE fixed Huffman
+	LIB_U32 u32S1 = 1;
+	LIB_U32 u32S2 = 0;
+	LIB_BOOLEAN bHasPrev = LIB_FALSE;
+	LIB_CHAR cPrev = 0;
+	for (LIB_U32 u32Y = 0; u32Y < u32Height; u32Y++)
+	{
+		const LIB_U32* prgu32Row = prgu32Pixels + (LIB_U64)u32Y * u32Width;
+		const LIB_CHAR* pcRow = FilterRow(prgu32Row, (u32Y > 0) ? prgu32Row - u32Width : NULL, u32Width, pcRows, pcRows + u64RowSize);
+		AddAdler(pcRow, u64RowSize, &u32S1, &u32S2);
+		PutRow(&stWriter, pcRow, u64RowSize, &bHasPrev, &cPrev);
+	}
+	PutSymbol(&stWriter, 256);  // End of block
+	if (stWriter.u32Count > 0)
+	{
+		PutBits(&stWriter, 0, 8 - stWriter.u32Count);  // Flush to a byte boundary
+	}
+	PutU32(stWriter.pcOut + stWriter.u64Pos, (u32S2 << 16) | u32S1);
+	stWriter.u64Pos += 4;
+	u64Pos += PutChunk(pcChunk, (LIB_U32)stWriter.u64Pos);
+
+	// 03. IEND
+	pcChunk = pcPng + u64Pos;
+	memcpy(pcChunk + 4, "IEND", 4);
+	u64Pos += PutChunk(pcChunk, 0);
+
+	free(pcRows);
+	*ppcOutPng = pcPng;
+	*pu64OutSize = u64Pos;
+	return LIB_OK;
+}
@@ -0,0 +1,305 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include "IPC_Plot_Internal.h"
+
+// Python tools kept ready for ipc_plot(), shared by every thread of the process
+typedef struct LIB_POOL
+{
+	std::mutex mutex;                  //!< Guards the members below
+	std::condition_variable cvChange;  //!< Wakes the pool thread after a use, a loss or a new configuration
+	std::vector<LIB_SESSION*> vecIdle; //!< Ready sessions, the most recently used last
+	LIB_U32 u32Owned;                  //!< Idle, in use by ipc_plot() or being started, at most u32Size
+	LIB_U32 u32Size;
+	LIB_U32 u32IdleTimeoutMs;
+	LIB_U64 u64LastUseUs;              //!< Last ipc_plot() or ipc_plot_pool_config()
+	LIB_BOOLEAN bRefill;               //!< Pool thread may start Python tools, cleared when one fails to start until the next use
+} LIB_POOL;
+
+/***************************************************************************//**
+ * IsPoolIdle
+ *
+ * Tells whether the pool has gone unused for longer than its idle timeout
+ *
+ * @param pstPool Pool, locked by the caller
+ * @param u64NowUs Current time from StatsNowUs()
+ * @return         LIB_TRUE if the ready Python tools must be stopped
+ ******************************************************************************/
+static LIB_BOOLEAN IsPoolIdle(const LIB_POOL* pstPool, LIB_U64 u64NowUs)
+{
+	if (pstPool->u32IdleTimeoutMs == LIB_WAIT_INFINITE)
+	{
+		return LIB_FALSE;
+	}
+	return (u64NowUs - pstPool->u64LastUseUs >= (LIB_U64)pstPool->u32IdleTimeoutMs * 1000) ? LIB_TRUE : LIB_FALSE;
+}
+
+/***************************************************************************//**
+ * CloseSessions
+ *
+ * Closes sessions taken out of the pool, without holding its lock as each
+ * close waits for a Python tool to exit
+ *
+ * @param vecSessions Sessions to close
+ ******************************************************************************/
+static void CloseSessions(const std::vector<LIB_SESSION*>& vecSessions)
+{
+	for (size_t szSession = 0; szSession < vecSessions.size(); szSession++)
+	{
+		ipc_plot_session_close(vecSessions[szSession]);
+	}
+}
+
+/***************************************************************************//**
+ * PoolMain
+ *
+ * Pool thread, starts Python tools until the pool is full and stops the
+ * ready ones once the pool is idle, for as long as the process lives
+ *
+ * @param pstPool Pool shared with ipc_plot()
+ ******************************************************************************/
+static void PoolMain(LIB_POOL* pstPool)
+{
+	std::unique_lock<std::mutex> lock(pstPool->mutex);
+	for (;;)
+	{
+		LIB_U64 u64NowUs = StatsNowUs();
+		if (IsPoolIdle(pstPool, u64NowUs))
+		{
+			if (!pstPool->vecIdle.empty())
+			{
+				std::vector<LIB_SESSION*> vecClose;
+				vecClose.swap(pstPool->vecIdle);
+				pstPool->u32Owned -= (LIB_U32)vecClose.size();
+				lock.unlock();
+				CloseSessions(vecClose);
+				lock.lock();
+				continue;
+			}
+			pstPool->cvChange.wait(lock);
+			continue;
+		}
+
+		if (pstPool->bRefill && pstPool->u32Owned < pstPool->u32Size)
+		{
+			// The slot is taken before starting so ipc_plot() does not start a tool of its own for it
+			pstPool->u32Owned++;
+			lock.unlock();
+			LIB_SESSION* pstSession = NULL;
+			LIB_ERROR_INFO stErr;
+			ipc_plot_session_open(&pstSession, &stErr);
+			lock.lock();
+			if (pstSession != NULL)
+			{
+				pstPool->vecIdle.insert(pstPool->vecIdle.begin(), pstSession);
+			}
+			else
+			{
+				// Not retried until the next plot, which reports the error itself
+				pstPool->u32Owned--;
+				pstPool->bRefill = LIB_FALSE;
+			}
+			continue;
+		}
+
+		if (pstPool->u32IdleTimeoutMs == LIB_WAIT_INFINITE)
+		{
+			pstPool->cvChange.wait(lock);
+		}
+		else
+		{
+			LIB_U64 u64IdleUs = pstPool->u64LastUseUs + (LIB_U64)pstPool->u32IdleTimeoutMs * 1000;
+			pstPool->cvChange.wait_for(lock, std::chrono::microseconds(u64IdleUs - u64NowUs));
+		}
+	}
+}
+
+/***************************************************************************//**
+ * StartPool
+ *
+ * Creates the pool with the default configuration and starts its thread
+ *
+ * @return The pool, or NULL if the thread could not be started
+ ******************************************************************************/
+static LIB_POOL* StartPool(void)
+{
+	LIB_POOL* pstPool = new LIB_POOL();
+	pstPool->u32Owned = 0;
+	pstPool->u32Size = LIB_POOL_DEFAULT_SIZE;
+	pstPool->u32IdleTimeoutMs = LIB_POOL_DEFAULT_IDLE_MS;
+	pstPool->u64LastUseUs = StatsNowUs();
+	// Set by the first use, which opens the first Python tool itself
+	pstPool->bRefill = LIB_FALSE;
+	try
+	{
+		std::thread(PoolMain, pstPool).detach();
+	}
+	catch (const std::system_error&)
+	{
+		delete pstPool;
+		return NULL;
+	}
+	return pstPool;
+}
+
+/***************************************************************************//**
+ * GetPool
+ *
+ * Returns the pool, started on first use. Like the async executor it is
+ * never destroyed; the ready Python tools see their connection close and
+ * exit together with the process.
+ *
+ * @return The pool, or NULL if its thread could not be started
+ ******************************************************************************/
+static LIB_POOL* GetPool(void)
+{
+	static LIB_POOL* s_pstPool = StartPool();
+	return s_pstPool;
+}
+
+/***************************************************************************//**
+ * PoolAcquire
+ *
+ * Takes a ready session for one plot. Without a ready one, a free slot of
+ * the pool is reserved for the session the caller opens instead.
+ *
+ * @param pbOutPooled Set if the session, or the one the caller opens when
+ *                    NULL is returned, must be given back with PoolRelease()
+ * @return            Ready session with its statistics cleared, or NULL
+ ******************************************************************************/
+LIB_SESSION* PoolAcquire(LIB_BOOLEAN* pbOutPooled)
+{
+	LIB_POOL* pstPool = GetPool();
+	LIB_SESSION* pstSession = NULL;
+	std::vector<LIB_SESSION*> vecLost;
+
+	*pbOutPooled = LIB_FALSE;
+	if (pstPool == NULL)
+	{
+		return NULL;
+	}
+	{
+		std::lock_guard<std::mutex> lock(pstPool->mutex);
+		pstPool->u64LastUseUs = StatsNowUs();
+		pstPool->bRefill = LIB_TRUE;
+		while (pstSession == NULL && !pstPool->vecIdle.empty())
+		{
+			pstSession = pstPool->vecIdle.back();
+			pstPool->vecIdle.pop_back();
+			if (!RendererAlive(pstSession))
+			{
+				vecLost.push_back(pstSession);
+				pstPool->u32Owned--;
+				pstSession = NULL;
+			}
+		}
+		if (pstSession != NULL || pstPool->u32Owned < pstPool->u32Size)
+		{
+			*pbOutPooled = LIB_TRUE;
+			if (pstSession == NULL)
+			{
+				pstPool->u32Owned++;
+			}
+		}
+	}
+	pstPool->cvChange.notify_one();
+
+	CloseSessions(vecLost);
+	if (pstSession != NULL)
+	{
+		pstSession->stStats = LIB_PLOT_STATS();
+	}
+	return pstSession;
+}
+
+/***************************************************************************//**
+ * PoolRelease
+ *
+ * Gives back a session from PoolAcquire(). A lost session, or one beyond a
+ * size lowered in the meantime, is closed and its slot freed.
+ *
+ * @param pstSession Session to give back, NULL if the caller failed to open one
+ * @param bLost      LIB_TRUE if the Python tool can no longer be used
+ ******************************************************************************/
+void PoolRelease(LIB_SESSION* pstSession, LIB_BOOLEAN bLost)
+{
+	LIB_POOL* pstPool = GetPool();
+	{
+		std::lock_guard<std::mutex> lock(pstPool->mutex);
+		pstPool->u64LastUseUs = StatsNowUs();
+		if (pstSession != NULL && !bLost && pstPool->u32Owned <= pstPool->u32Size)
+		{
+			pstPool->vecIdle.push_back(pstSession);
+			return;
+		}
+		pstPool->u32Owned--;
+	}
+	pstPool->cvChange.notify_one();
+	ipc_plot_session_close(pstSession);
+}
+
+/***************************************************************************//**
+ * ipc_plot_pool_config
+ *
+ * Sets how many Python tools the library keeps ready for ipc_plot()
+ *
+ * @param u32Size          Number of Python tools, 0 to LIB_POOL_MAX_SIZE
+ * @param u32IdleTimeoutMs Idle time before the tools are stopped, or LIB_WAIT_INFINITE
+ * @param pstErr           Error information structure for logging any errors
+ * @return                 LIB_OK if success, else LIB_ERR if any error occurred
+ ******************************************************************************/
+LIB_U32 ipc_plot_pool_config(LIB_U32 u32Size, LIB_U32 u32IdleTimeoutMs, LIB_ERROR_INFO* pstErr)
+{
+	LIB_CHAR szRuntimeMsg[LIB_MAX_BUFFER_SIZE] = "";
+
+	// Check for null pointers
+	if (pstErr == NULL)
+	{
+		return LIB_ERR;
+	}
+	// The status of a previous successful call is not an error, let this call log its own
+	if (pstErr->u32ErrCode == LIB_STATUS_DONE)
+	{
+		*pstErr = LIB_ERROR_INFO();
+	}
+	if (u32Size > LIB_POOL_MAX_SIZE)
+	{
+		snprintf(szRuntimeMsg, sizeof(szRuntimeMsg), "Pool of %u Python tools, at most %u are supported", u32Size, LIB_POOL_MAX_SIZE);
+		LOG_ERROR(pstErr, LIB_ERR_INPUT_INVALID, LIB_ERR_INPUT_INVALID_MSG, LIB_ERR_INPUT_INVALID_ACT, szRuntimeMsg)
+		return LIB_ERR;
+	}
+	LIB_POOL* pstPool = GetPool();
+	if (pstPool == NULL)
+	{
+		snprintf(szRuntimeMsg, sizeof(szRuntimeMsg), "Unable to start the pool thread");
+		LOG_ERROR(pstErr, LIB_ERR_BUFFER_OVERFLOW, LIB_ERR_BUFFER_OVERFLOW_MSG, LIB_ERR_BUFFER_OVERFLOW_ACT, szRuntimeMsg)
+		return LIB_ERR;
+	}
+
+	// Ready tools beyond the new size are stopped now, those in use when they come back
+	std::vector<LIB_SESSION*> vecClose;
+	{
+		std::lock_guard<std::mutex> lock(pstPool->mutex);
+		pstPool->u32Size = u32Size;
+		pstPool->u32IdleTimeoutMs = u32IdleTimeoutMs;
+		pstPool->u64LastUseUs = StatsNowUs();
+		pstPool->bRefill = LIB_TRUE;
+		while (pstPool->u32Owned > u32Size && !pstPool->vecIdle.empty())
+		{
+			vecClose.push_back(pstPool->vecIdle.front());
+			pstPool->vecIdle.erase(pstPool->vecIdle.begin());
+			pstPool->u32Owned--;
+		}
+	}
+	pstPool->cvChange.notify_one();
+	CloseSessions(vecClose);
+	pstErr->u32ErrCode = LIB_STATUS_DONE;
+	return LIB_OK;
+}
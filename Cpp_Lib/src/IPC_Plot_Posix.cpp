@@ -0,0 +1,708 @@
+#ifndef _WIN32
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <spawn.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <mutex>
+
+#include "IPC_Plot_Protocol.h"
+
+extern char** environ;
+
+LIB_INT32 GetPosixErrMessage(LIB_INT32 nErrno, LIB_CHAR* pszOutPosixErrorMsg);
+
+#define LOG_POSIX_ERROR(pstERR_Out, pcRUNTIME_In) \
+    { \
+    	LIB_CHAR szErrHelpString[LIB_MAX_BUFFER_SIZE] = LIB_ERR_POSIX_API_ERR_ACT; \
+    	GetPosixErrMessage(errno, szErrHelpString); \
+    	LOG_ERROR(pstERR_Out, LIB_ERR_POSIX_API_ERR, LIB_ERR_POSIX_API_ERR_MSG, szErrHelpString, pcRUNTIME_In) \
+    }
+
+// Segments handed out by ipc_plot_alloc() and files mapped by FileMapOpen(), looked up by address in ipc_plot()
+typedef struct LIB_SHM_NODE
+{
+	LIB_SHM_INFO stShm;
+	struct LIB_SHM_NODE* pstNext;
+} LIB_SHM_NODE;
+
+static LIB_SHM_NODE* s_pstShmList = NULL;
+static std::mutex s_shmListMutex;
+
+/***************************************************************************//**
+ * FindSharedMem
+ *
+ * Checks whether a buffer lies inside a segment from ipc_plot_alloc() or a
+ * file mapped by FileMapOpen(). The descriptor of a matching segment is 
+ * duplicated so it stays valid even if the caller frees the buffer while it
+ * is being sent.
+ *
+ * @param pvData     Start of the buffer
+ * @param u64Size    Size of the buffer in bytes
+ * @param pnOutFd    Duplicated descriptor of the segment
+ * @param pu64Offset Byte offset of the buffer within the segment
+ * @return           LIB_TRUE if the buffer is inside a segment, else LIB_FALSE
+ ******************************************************************************/
+LIB_BOOLEAN FindSharedMem(const void* pvData, LIB_U64 u64Size, LIB_INT32* pnOutFd, LIB_U64* pu64Offset)
+{
+	std::lock_guard<std::mutex> lock(s_shmListMutex);
+	for (LIB_SHM_NODE* pstNode = s_pstShmList; pstNode != NULL; pstNode = pstNode->pstNext)
+	{
+		const LIB_CHAR* pcBase = (const LIB_CHAR*)pstNode->stShm.pvBase;
+		const LIB_CHAR* pcData = (const LIB_CHAR*)pvData;
+		if (pcData >= pcBase && pcData + u64Size <= pcBase + pstNode->stShm.u64Size)
+		{
+			*pnOutFd = fcntl(pstNode->stShm.nFd, F_DUPFD_CLOEXEC, 0);
+			*pu64Offset = (LIB_U64)(pcData - pcBase);
+			return (*pnOutFd < 0) ? LIB_FALSE : LIB_TRUE;
+		}
+	}
+	return LIB_FALSE;
+}
+
+/***************************************************************************//**
+ * UnlinkSharedMem
+ *
+ * Removes a segment or a mapped file from the list searched by 
+ * FindSharedMem(). Its mapping is left to the caller.
+ *
+ * @param pvBase Start of the mapping
+ * @return       The node removed, release with free(), or NULL if not found
+ ******************************************************************************/
+static LIB_SHM_NODE* UnlinkSharedMem(const void* pvBase)
+{
+	std::lock_guard<std::mutex> lock(s_shmListMutex);
+	for (LIB_SHM_NODE** ppstNode = &s_pstShmList; *ppstNode != NULL; ppstNode = &(*ppstNode)->pstNext)
+	{
+		if ((*ppstNode)->stShm.pvBase == pvBase)
+		{
+			LIB_SHM_NODE* pstFound = *ppstNode;
+			*ppstNode = pstFound->pstNext;
+			return pstFound;
+		}
+	}
+	return NULL;
+}
+
+/***************************************************************************//**
+ * RendererOpen
+ *
+ * Runs the Python tool with one end of a socket pair and waits for its READY
+ * frame. The connection is kept open until RendererClose() so that the 
+ * Python tool can plot any number of buffers.
+ *
+ * @param pstSession Session receiving the socket and process ID
+ * @param pstErr     Error information structure for logging any errors
+ * @return           LIB_OK if success, else LIB_ERR if any error occurred
+ ******************************************************************************/
+LIB_U32 RendererOpen(LIB_SESSION* pstSession, LIB_ERROR_INFO* pstErr)
+{
+	LIB_CHAR szRuntimeMsg[LIB_MAX_BUFFER_SIZE] = "";
+	LIB_U64 u64StartUs = StatsNowUs();
+
+	// 01. socketpair() to create the connection, the child end is moved above the fixed
+	// descriptor number so that dup2() in the child always clears FD_CLOEXEC
+	LIB_INT32 rgnSockets[2] = { -1, -1 };
+	if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, rgnSockets) != 0)
+	{
+		snprintf(szRuntimeMsg, sizeof(szRuntimeMsg), "socketpair() failed");
+		LOG_POSIX_ERROR(pstErr, szRuntimeMsg)
+		return LIB_ERR;
+	}
+	LIB_INT32 nChildSocket = fcntl(rgnSockets[1], F_DUPFD_CLOEXEC, LIB_RENDERER_FD + 1);
+	close(rgnSockets[1]);
+
+	// 02. posix_spawnp() to run the Python tool with the socket at LIB_RENDERER_FD
+	LIB_CHAR szFdArg[16];
+	snprintf(szFdArg, sizeof(szFdArg), "%d", LIB_RENDERER_FD);
+	LIB_CHAR* rgszArgv[] = { (LIB_CHAR*)PYTHON_EXE, (LIB_CHAR*)GetRendererPath(), (LIB_CHAR*)"--fd", szFdArg, NULL };
+
+	posix_spawn_file_actions_t stActions;
+	posix_spawn_file_actions_init(&stActions);
+	posix_spawn_file_actions_adddup2(&stActions, nChildSocket, LIB_RENDERER_FD);
+	pid_t nPid = -1;
+	LIB_INT32 nSpawnErr = (nChildSocket < 0) ? errno :
+		posix_spawnp(&nPid, PYTHON_EXE, &stActions, NULL, rgszArgv, environ);
+	posix_spawn_file_actions_destroy(&stActions);
+	if (nChildSocket >= 0)
+	{
+		close(nChildSocket);
+	}
+	if (nSpawnErr != 0)
+	{
+		errno = nSpawnErr;
+		snprintf(szRuntimeMsg, sizeof(szRuntimeMsg), "Error from the Python tool at %s", GetRendererPath());
+		LOG_POSIX_ERROR(pstErr, szRuntimeMsg)
+		close(rgnSockets[0]);
+		return LIB_ERR;
+	}
+
+	pstSession->nSocket = rgnSockets[0];
+	pstSession->nPid = (LIB_INT32)nPid;
+	u64StartUs = StatsPhase("spawn", u64StartUs, &pstSession->stStats.dSpawnMs);
+
+	// The socket is connected already, wait for the Python tool to have imported its modules.
+	// A Python tool that fails to start closes the socket, which ends the wait at once.
+	struct pollfd stPoll = { pstSession->nSocket, POLLIN, 0 };
+	LIB_INT32 nReady;
+	do
+	{
+		nReady = poll(&stPoll, 1, LIB_READY_WAIT_MS);
+	} while (nReady < 0 && errno == EINTR);
+	if (nReady < 0)
+	{
+		snprintf(szRuntimeMsg, sizeof(szRuntimeMsg), "poll() failed - error waiting for the Python tool");
+		LOG_POSIX_ERROR(pstErr, szRuntimeMsg)
+		RendererClose(pstSession);
+		return LIB_ERR;
+	}
+	if (nReady == 0)
+	{
+		snprintf(szRuntimeMsg, sizeof(szRuntimeMsg), "No response from the Python tool after %d seconds", LIB_READY_WAIT_MS / 1000);
+		LOG_ERROR(pstErr, LIB_ERR_SERVER_TIMEOUT, LIB_ERR_SERVER_TIMEOUT_MSG, LIB_ERR_SERVER_TIMEOUT_ACT, szRuntimeMsg)
+		RendererClose(pstSession);
+		return LIB_ERR;
+	}
+	if (ProtocolRecvReady(pstSession, pstErr) != LIB_OK)
+	{
+		RendererClose(pstSession);
+		return LIB_ERR;
+	}
+	StatsPhase("connect", u64StartUs, &pstSession->stStats.dConnectMs);
+	return LIB_OK;
+}
+
+/***************************************************************************//**
+ * RendererPlot
+ *
+ * Sends one buffer to the Python tool of a session and waits for its status.
+ * A buffer from ipc_plot_alloc(), or typed columns all inside one segment or
+ * mapped file, are passed as its descriptor, which the Python tool maps 
+ * directly. Anything else is streamed over the socket in chunks, which 
+ * avoids copying it into a segment of its own.
+ *
+ * @param pstSession Session with the socket and process ID
+ * @param pstInput   Input structure including data buffer and labels
+ * @param u32Flags   LIB_PLOT_FLAG_XY if the buffer holds X and Y columns
+ * @param pstErr     Error information structure for logging any errors
+ * @return           LIB_OK if success, else LIB_ERR if any error occurred
+ ******************************************************************************/
+LIB_U32 RendererPlot(LIB_SESSION* pstSession, LIB_INPUT* pstInput, LIB_U32 u32Flags, LIB_ERROR_INFO* pstErr)
+{
+	LIB_U64 u64DataSize = (LIB_U64)pstInput->u32RowSize * pstInput->u32ColSize * sizeof(LIB_DOUBLE);
+	if (u32Flags & LIB_PLOT_FLAG_XY)
+	{
+		u64DataSize *= 2;
+	}
+
+	// Use the caller's segment if the buffer came from ipc_plot_alloc(), or if the bytes of
+	// every typed column and the X column lie in one segment or mapped file
+	LIB_SHM_INFO stShm = { -1, NULL, 0 };
+	LIB_U64 u64ShmOffset = 0;
+	if (pstInput->prgstColumns == NULL && pstInput->pstXColumn == NULL)
+	{
+		FindSharedMem(pstInput->prgdBuffer, u64DataSize, &stShm.nFd, &u64ShmOffset);
+	}
+	else
+	{
+		const void* pvStart;
+		ProtocolColumnsExtent(pstInput, &pvStart, &u64DataSize);
+		FindSharedMem(pvStart, u64DataSize, &stShm.nFd, &u64ShmOffset);
+	}
+
+	// 03. Send the request with the segment attached, or followed by the data
+	// 04. Receive the image, if returned in memory, and the status written by the Python tool after plotting
+	LIB_U32 u32Ret = LIB_ERR;
+	LIB_U64 u64StartUs = StatsNowUs();
+	if (ProtocolSendPlot(pstSession, pstInput, u32Flags, stShm.nFd, u64ShmOffset, pstErr) == LIB_OK)
+	{
+		u64StartUs = StatsPhase("send", u64StartUs, &pstSession->stStats.dSendMs);
+		if (ProtocolRecvResult(pstSession, pstInput, pstErr) == LIB_OK)
+		{
+			u32Ret = LIB_OK;
+		}
+		StatsPhase("render", u64StartUs, &pstSession->stStats.dRenderMs);
+	}
+
+	// The Python tool has its own mapping by now, or has failed
+	SharedMemClose(&stShm);
+	return u32Ret;
+}
+
+/***************************************************************************//**
+ * RendererClose
+ *
+ * Closes the socket, which ends the request loop of the Python tool, and 
+ * waits for the process to exit
+ *
+ * @param pstSession Session with the socket and process ID
+ ******************************************************************************/
+void RendererClose(LIB_SESSION* pstSession)
+{
+	// 05. Free resources after the Python tool is done with the socket
+	if (pstSession->nSocket >= 0)
+	{
+		close(pstSession->nSocket);
+		pstSession->nSocket = -1;
+	}
+	if (pstSession->nPid > 0)
+	{
+		// Poll for the exit so that a stuck Python tool cannot block the caller forever
+		LIB_U32 u32WaitedMs = 0;
+		while (waitpid((pid_t)pstSession->nPid, NULL, WNOHANG) == 0)
+		{
+			if (u32WaitedMs >= LIB_CLOSE_WAIT_MS)
+			{
+				kill((pid_t)pstSession->nPid, SIGKILL);
+				waitpid((pid_t)pstSession->nPid, NULL, 0);
+				break;
+			}
+			usleep(1000);
+			u32WaitedMs += 1;
+		}
+		pstSession->nPid = 0;
+	}
+}
+
+/***************************************************************************//**
+ * RendererAlive
+ *
+ * Checks an idle session before it is reused. The Python tool never writes 
+ * between requests, so anything readable on the socket is the end of the 
+ * stream left by a Python tool that has exited.
+ *
+ * @param pstSession Session with the socket and process ID
+ * @return           LIB_TRUE if the Python tool is still waiting for requests
+ ******************************************************************************/
+LIB_BOOLEAN RendererAlive(LIB_SESSION* pstSession)
+{
+	struct pollfd stPoll = { pstSession->nSocket, POLLIN, 0 };
+	return (poll(&stPoll, 1, 0) == 0) ? LIB_TRUE : LIB_FALSE;
+}
+
+/***************************************************************************//**
+ * TransportSend
+ *
+ * Writes bytes to the Python tool of a session
+ *
+ * @param pstSession Session with the socket and process ID
+ * @param pvData     Bytes to write
+ * @param u64Size    Number of bytes to write
+ * @param nFd        Descriptor to pass along with the first byte, or -1
+ * @param pstErr     Error information structure for logging any errors
+ * @return           LIB_OK if success, else LIB_ERR if any error occurred
+ ******************************************************************************/
+LIB_INT32 TransportSend(LIB_SESSION* pstSession, const void* pvData, LIB_U64 u64Size, LIB_INT32 nFd, LIB_ERROR_INFO* pstErr)
+{
+	if (SocketSendAll(pstSession->nSocket, pvData, u64Size, nFd, pstErr) != LIB_OK)
+	{
+		return LIB_ERR;
+	}
+	pstSession->stStats.u64BytesSent += u64Size;
+	return LIB_OK;
+}
+
+/***************************************************************************//**
+ * TransportRecv
+ *
+ * Reads exactly the requested number of bytes from the Python tool of a 
+ * session
+ *
+ * @param pstSession Session with the socket and process ID
+ * @param pvData     Buffer receiving the bytes
+ * @param u64Size    Number of bytes to read
+ * @param pstErr     Error information structure for logging any errors
+ * @return           LIB_OK if success, else LIB_ERR if any error occurred
+ ******************************************************************************/
+LIB_INT32 TransportRecv(LIB_SESSION* pstSession, void* pvData, LIB_U64 u64Size, LIB_ERROR_INFO* pstErr)
+{
+	if (SocketRecvAll(pstSession->nSocket, pvData, u64Size, pstErr) != LIB_OK)
+	{
+		return LIB_ERR;
+	}
+	pstSession->stStats.u64BytesReceived += u64Size;
+	return LIB_OK;
+}
+
+/***************************************************************************//**
+ * SharedMemCreate
+ *
+ * Creates an anonymous shared memory segment and maps it into this process.
+ * The segment is only reachable through its descriptor, which is passed to
+ * the Python tool over the socket.
+ *
+ * @param u64Size Size of the segment in bytes
+ * @param pstShm  Receives the descriptor and mapping of the segment
+ * @param pstErr  Error information structure for logging any errors
+ * @return        LIB_OK if success, else LIB_ERR if any error occurred
+ ******************************************************************************/
+LIB_INT32 SharedMemCreate(LIB_U64 u64Size, LIB_SHM_INFO* pstShm, LIB_ERROR_INFO* pstErr)
+{
+	LIB_CHAR szRuntimeMsg[LIB_MAX_BUFFER_SIZE] = "";
+
+	pstShm->pvBase = NULL;
+	pstShm->u64Size = u64Size;
+#ifdef __linux__
+	pstShm->nFd = memfd_create("ipc_plot", MFD_CLOEXEC);
+#else
+	// No memfd, use a named segment and unlink it straight away
+	LIB_CHAR szName[64];
+	static LIB_U32 s_u32Counter = 0;
+	snprintf(szName, sizeof(szName), "/ipc_plot_%d_%u", (LIB_INT32)getpid(), __sync_fetch_and_add(&s_u32Counter, 1));
+	pstShm->nFd = shm_open(szName, O_RDWR | O_CREAT | O_EXCL, 0600);
+	if (pstShm->nFd >= 0)
+	{
+		shm_unlink(szName);
+		fcntl(pstShm->nFd, F_SETFD, FD_CLOEXEC);
+	}
+#endif
+	if (pstShm->nFd < 0)
+	{
+		snprintf(szRuntimeMsg, sizeof(szRuntimeMsg), "Unable to create shared memory segment");
+		LOG_POSIX_ERROR(pstErr, szRuntimeMsg)
+		return LIB_ERR;
+	}
+	if (ftruncate(pstShm->nFd, (off_t)u64Size) != 0)
+	{
+		snprintf(szRuntimeMsg, sizeof(szRuntimeMsg), "ftruncate() failed for %llu bytes", u64Size);
+		LOG_POSIX_ERROR(pstErr, szRuntimeMsg)
+		SharedMemClose(pstShm);
+		return LIB_ERR;
+	}
+	if (u64Size > 0)
+	{
+		void* pvBase = mmap(NULL, u64Size, PROT_READ | PROT_WRITE, MAP_SHARED, pstShm->nFd, 0);
+		if (pvBase == MAP_FAILED)
+		{
+			snprintf(szRuntimeMsg, sizeof(szRuntimeMsg), "mmap() failed for %llu bytes", u64Size);
+			LOG_POSIX_ERROR(pstErr, szRuntimeMsg)
+			SharedMemClose(pstShm);
+			return LIB_ERR;
+		}
+		pstShm->pvBase = pvBase;
+	}
+	return LIB_OK;
+}
+
+/***************************************************************************//**
+ * SharedMemClose
+ *
+ * Unmaps a segment and closes its descriptor. Safe to call on a segment that
+ * was only partly created.
+ *
+ * @param pstShm Segment created by SharedMemCreate()
+ ******************************************************************************/
+void SharedMemClose(LIB_SHM_INFO* pstShm)
+{
+	if (pstShm->pvBase != NULL)
+	{
+		munmap(pstShm->pvBase, pstShm->u64Size);
+		pstShm->pvBase = NULL;
+	}
+	if (pstShm->nFd >= 0)
+	{
+		close(pstShm->nFd);
+		pstShm->nFd = -1;
+	}
+}
+
+/***************************************************************************//**
+ * SocketSendAll
+ *
+ * Writes the whole buffer to a stream socket, optionally passing a
+ * descriptor along with the first byte (SCM_RIGHTS).
+ *
+ * @param nSocket Connected AF_UNIX stream socket
+ * @param pvData  Bytes to write
+ * @param u64Size Number of bytes to write
+ * @param nFd     Descriptor to pass, or -1 for none
+ * @param pstErr  Error information structure for logging any errors
+ * @return        LIB_OK if success, else LIB_ERR if any error occurred
+ ******************************************************************************/
+LIB_INT32 SocketSendAll(LIB_INT32 nSocket, const void* pvData, LIB_U64 u64Size, LIB_INT32 nFd, LIB_ERROR_INFO* pstErr)
+{
+	LIB_CHAR szRuntimeMsg[LIB_MAX_BUFFER_SIZE] = "";
+	const LIB_CHAR* pcData = (const LIB_CHAR*)pvData;
+
+	while (u64Size > 0 || nFd >= 0)
+	{
+		ssize_t nSent;
+		if (nFd >= 0)
+		{
+			struct iovec stIov = { (void*)pcData, (size_t)u64Size };
+			LIB_CHAR rgcControl[CMSG_SPACE(sizeof(LIB_INT32))];
+			memset(rgcControl, 0, sizeof(rgcControl));
+			struct msghdr stMsg;
+			memset(&stMsg, 0, sizeof(stMsg));
+			stMsg.msg_iov = &stIov;
+			stMsg.msg_iovlen = 1;
+			stMsg.msg_control = rgcControl;
+			stMsg.msg_controllen = sizeof(rgcControl);
+			struct cmsghdr* pstCmsg = CMSG_FIRSTHDR(&stMsg);
+			pstCmsg->cmsg_level = SOL_SOCKET;
+			pstCmsg->cmsg_type = SCM_RIGHTS;
+			pstCmsg->cmsg_len = CMSG_LEN(sizeof(LIB_INT32));
+			memcpy(CMSG_DATA(pstCmsg), &nFd, sizeof(LIB_INT32));
+			nSent = sendmsg(nSocket, &stMsg, MSG_NOSIGNAL);
+		}
+		else
+		{
+			nSent = send(nSocket, pcData, (size_t)u64Size, MSG_NOSIGNAL);
+		}
+		if (nSent < 0)
+		{
+			if (errno == EINTR)
+			{
+				continue;
+			}
+			snprintf(szRuntimeMsg, sizeof(szRuntimeMsg), "send() failed - error writing to socket");
+			LOG_POSIX_ERROR(pstErr, szRuntimeMsg)
+			return LIB_ERR;
+		}
+		nFd = -1;
+		pcData += nSent;
+		u64Size -= (LIB_U64)nSent;
+	}
+	return LIB_OK;
+}
+
+/***************************************************************************//**
+ * SocketRecvAll
+ *
+ * Reads exactly the requested number of bytes from a stream socket.
+ *
+ * @param nSocket Connected AF_UNIX stream socket
+ * @param pvData  Buffer receiving the bytes
+ * @param u64Size Number of bytes to read
+ * @param pstErr  Error information structure for logging any errors
+ * @return        LIB_OK if success, else LIB_ERR if any error occurred
+ ******************************************************************************/
+LIB_INT32 SocketRecvAll(LIB_INT32 nSocket, void* pvData, LIB_U64 u64Size, LIB_ERROR_INFO* pstErr)
+{
+	LIB_CHAR szRuntimeMsg[LIB_MAX_BUFFER_SIZE] = "";
+	LIB_CHAR* pcData = (LIB_CHAR*)pvData;
+
+	while (u64Size > 0)
+	{
+		ssize_t nRecv = recv(nSocket, pcData, (size_t)u64Size, 0);
+		if (nRecv < 0)
+		{
+			if (errno == EINTR)
+			{
+				continue;
+			}
+			snprintf(szRuntimeMsg, sizeof(szRuntimeMsg), "recv() failed - error reading from socket");
+			LOG_POSIX_ERROR(pstErr, szRuntimeMsg)
+			return LIB_ERR;
+		}
+		if (nRecv == 0)
+		{
+			// The Python tool closed its end, typically because it raised an exception
+			snprintf(szRuntimeMsg, sizeof(szRuntimeMsg), "Connection closed with %llu bytes outstanding", u64Size);
+			LOG_ERROR(pstErr, LIB_ERR_CLIENT_EXITED, LIB_ERR_CLIENT_EXITED_MSG, LIB_ERR_CLIENT_EXITED_ACT, szRuntimeMsg)
+			return LIB_ERR;
+		}
+		pcData += nRecv;
+		u64Size -= (LIB_U64)nRecv;
+	}
+	return LIB_OK;
+}
+
+/***************************************************************************//**
+ * ipc_plot_alloc
+ *
+ * Allocates a data buffer in a shared memory segment. ipc_plot() recognises
+ * the buffer and passes the segment to the Python tool without copying.
+ *
+ * @param u32Count       Number of doubles in the buffer (columns * rows)
+ * @param pprgdOutBuffer Receives the pointer to the buffer
+ * @param pstErr         Error information structure for logging any errors
+ * @return               LIB_OK if success, else LIB_ERR if any error occurred
+ ******************************************************************************/
+LIB_U32 ipc_plot_alloc(LIB_U32 u32Count, LIB_DOUBLE** pprgdOutBuffer, LIB_ERROR_INFO* pstErr)
+{
+	LIB_CHAR szRuntimeMsg[LIB_MAX_BUFFER_SIZE] = "";
+
+	if (pstErr == NULL)
+	{
+		return LIB_ERR;
+	}
+	// The status of a previous successful call is not an error, let this call log its own
+	if (pstErr->u32ErrCode == LIB_STATUS_DONE)
+	{
+		*pstErr = LIB_ERROR_INFO();
+	}
+	if (pprgdOutBuffer == NULL)
+	{
+		snprintf(szRuntimeMsg, sizeof(szRuntimeMsg), "Output buffer pointer is null pointer");
+		LOG_ERROR(pstErr, LIB_ERR_INPUT_PTR_NULL, LIB_ERR_INPUT_PTR_NULL_MSG, LIB_ERR_INPUT_PTR_NULL_ACT, szRuntimeMsg)
+		return LIB_ERR;
+	}
+	*pprgdOutBuffer = NULL;
+	if (u32Count == 0)
+	{
+		snprintf(szRuntimeMsg, sizeof(szRuntimeMsg), "Buffer of 0 doubles requested");
+		LOG_ERROR(pstErr, LIB_ERR_BUFFER_OVERFLOW, LIB_ERR_BUFFER_OVERFLOW_MSG, LIB_ERR_BUFFER_OVERFLOW_ACT, szRuntimeMsg)
+		return LIB_ERR;
+	}
+
+	LIB_SHM_NODE* pstNode = (LIB_SHM_NODE*)calloc(1, sizeof(LIB_SHM_NODE));
+	if (pstNode == NULL || SharedMemCreate((LIB_U64)u32Count * sizeof(LIB_DOUBLE), &pstNode->stShm, pstErr) != LIB_OK)
+	{
+		free(pstNode);
+		return LIB_ERR;
+	}
+
+	std::lock_guard<std::mutex> lock(s_shmListMutex);
+	pstNode->pstNext = s_pstShmList;
+	s_pstShmList = pstNode;
+	*pprgdOutBuffer = (LIB_DOUBLE*)pstNode->stShm.pvBase;
+	pstErr->u32ErrCode = LIB_STATUS_DONE;
+	return LIB_OK;
+}
+
+/***************************************************************************//**
+ * ipc_plot_free
+ *
+ * Releases a buffer returned by ipc_plot_alloc().
+ *
+ * @param prgdBuffer Buffer returned by ipc_plot_alloc()
+ ******************************************************************************/
+void ipc_plot_free(LIB_DOUBLE* prgdBuffer)
+{
+	LIB_SHM_NODE* pstFound = UnlinkSharedMem(prgdBuffer);
+	if (pstFound != NULL)
+	{
+		SharedMemClose(&pstFound->stShm);
+		free(pstFound);
+	}
+}
+
+/***************************************************************************//**
+ * FileMapOpen
+ *
+ * Maps a whole file read-only and registers the mapping like a segment from
+ * ipc_plot_alloc(), so that columns inside it are passed to the Python tool
+ * as the file descriptor. Pages are only read when a sample on them is, and
+ * being clean file pages the kernel can drop them again under pressure.
+ *
+ * @param pszPath Path of the file
+ * @param pstMap  Receives the descriptor and mapping of the file
+ * @param pstErr  Error information structure for logging any errors
+ * @return        LIB_OK if success, else LIB_ERR if any error occurred
+ ******************************************************************************/
+LIB_INT32 FileMapOpen(const LIB_CHAR* pszPath, LIB_SHM_INFO* pstMap, LIB_ERROR_INFO* pstErr)
+{
+	LIB_CHAR szRuntimeMsg[LIB_MAX_BUFFER_SIZE] = "";
+
+	pstMap->pvBase = NULL;
+	pstMap->u64Size = 0;
+	pstMap->nFd = open(pszPath, O_RDONLY | O_CLOEXEC);
+	struct stat stStat;
+	if (pstMap->nFd < 0 || fstat(pstMap->nFd, &stStat) != 0)
+	{
+		snprintf(szRuntimeMsg, sizeof(szRuntimeMsg), "Unable to open %s - ", pszPath);
+		GetPosixErrMessage(errno, szRuntimeMsg);
+		LOG_ERROR(pstErr, LIB_ERR_FILE_IO, LIB_ERR_FILE_IO_MSG, LIB_ERR_FILE_IO_ACT, szRuntimeMsg)
+		SharedMemClose(pstMap);
+		return LIB_ERR;
+	}
+	if (!S_ISREG(stStat.st_mode) || stStat.st_size == 0)
+	{
+		snprintf(szRuntimeMsg, sizeof(szRuntimeMsg), "%s is empty or not a regular file", pszPath);
+		LOG_ERROR(pstErr, LIB_ERR_FILE_IO, LIB_ERR_FILE_IO_MSG, LIB_ERR_FILE_IO_ACT, szRuntimeMsg)
+		SharedMemClose(pstMap);
+		return LIB_ERR;
+	}
+
+	pstMap->u64Size = (LIB_U64)stStat.st_size;
+	void* pvBase = mmap(NULL, (size_t)pstMap->u64Size, PROT_READ, MAP_SHARED, pstMap->nFd, 0);
+	if (pvBase == MAP_FAILED)
+	{
+		snprintf(szRuntimeMsg, sizeof(szRuntimeMsg), "mmap() failed for %llu bytes of %s", pstMap->u64Size, pszPath);
+		LOG_POSIX_ERROR(pstErr, szRuntimeMsg)
+		SharedMemClose(pstMap);
+		return LIB_ERR;
+	}
+	pstMap->pvBase = pvBase;
+	// Decimation reads each column front to back, read ahead and let go of what was read
+	madvise(pvBase, (size_t)pstMap->u64Size, MADV_SEQUENTIAL);
+
+	LIB_SHM_NODE* pstNode = (LIB_SHM_NODE*)calloc(1, sizeof(LIB_SHM_NODE));
+	if (pstNode == NULL)
+	{
+		snprintf(szRuntimeMsg, sizeof(szRuntimeMsg), "Unable to allocate the mapping of %s", pszPath);
+		LOG_ERROR(pstErr, LIB_ERR_BUFFER_OVERFLOW, LIB_ERR_BUFFER_OVERFLOW_MSG, LIB_ERR_BUFFER_OVERFLOW_ACT, szRuntimeMsg)
+		SharedMemClose(pstMap);
+		return LIB_ERR;
+	}
+	pstNode->stShm = *pstMap;
+	std::lock_guard<std::mutex> lock(s_shmListMutex);
+	pstNode->pstNext = s_pstShmList;
+	s_pstShmList = pstNode;
+	return LIB_OK;
+}
+
+/***************************************************************************//**
+ * FileMapClose
+ *
+ * Unregisters and unmaps a file mapped by FileMapOpen(). The Python tool 
+ * keeps its own mapping of a plot it has been sent.
+ *
+ * @param pstMap Mapping from FileMapOpen()
+ ******************************************************************************/
+void FileMapClose(LIB_SHM_INFO* pstMap)
+{
+	free(UnlinkSharedMem(pstMap->pvBase));
+	SharedMemClose(pstMap);
+}
+
+/***************************************************************************//**
+ * GetErrnoText
+ *
+ * Picks the description out of strerror_r(), which returns it on glibc 
+ * (GNU variant) and fills the buffer elsewhere (XSI variant). Unlike 
+ * strerror() it can be called from several threads at once.
+ *
+ * @param pszText Description returned by the GNU variant
+ * @return        The description
+ ******************************************************************************/
+static inline const LIB_CHAR* GetErrnoText(const LIB_CHAR* pszText, const LIB_CHAR*)
+{
+	return pszText;
+}
+
+static inline const LIB_CHAR* GetErrnoText(LIB_INT32 nRet, const LIB_CHAR* pszBuffer)
+{
+	return (nRet == 0) ? pszBuffer : "Unknown error";
+}
+
+/***************************************************************************//**
+ * GetPosixErrMessage
+ *
+ * Appends the errno value and its description to the runtime message
+ *
+ * @param nErrno              Value of errno after the failed call
+ * @param pszOutPosixErrorMsg Runtime message for POSIX errors
+ * @return                    LIB_OK
+ ******************************************************************************/
+LIB_INT32 GetPosixErrMessage(LIB_INT32 nErrno, LIB_CHAR* pszOutPosixErrorMsg)
+{
+	LIB_CHAR szErrorCodeBuf[LIB_MAX_BUFFER_SIZE] = "";
+	LIB_CHAR szErrnoBuf[LIB_MAX_BUFFER_SIZE] = "";
+	const LIB_CHAR* pszErrno = GetErrnoText(strerror_r(nErrno, szErrnoBuf, sizeof(szErrnoBuf)), szErrnoBuf);
+	snprintf(szErrorCodeBuf, sizeof(szErrorCodeBuf), "Error %d: %s", nErrno, pszErrno);
+	strncat(pszOutPosixErrorMsg, szErrorCodeBuf, LIB_MAX_BUFFER_SIZE - strlen(pszOutPosixErrorMsg) - 1);
+	return LIB_OK;
+}
+
+#endif // !_WIN32
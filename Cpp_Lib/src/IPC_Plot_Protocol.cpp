@@ -0,0 +1,812 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <algorithm>
+
+#include "IPC_Plot_Protocol.h"
+
+// A typed column or the X column where it lies in the caller's memory, see LayoutColumns()
+typedef struct LIB_COLUMN_SPAN
+{
+	LIB_COLUMN stColumn;     //!< Descriptor, made up for a column of prgdBuffer sent with an X column
+	const LIB_CHAR* pcStart; //!< First byte of the first sample
+	LIB_U64 u64Size;         //!< Bytes up to the end of the last sample
+	LIB_U32 u32Entry;        //!< Entry of the COLUMNS frame
+} LIB_COLUMN_SPAN;
+
+/***************************************************************************//**
+ * FrameInit
+ *
+ * Fills in a frame header for the current protocol version
+ *
+ * @param pstHdr    Frame header to fill in
+ * @param u16Type   One of LIB_MSG_*
+ * @param u64Length Number of payload bytes following the header
+ ******************************************************************************/
+static void FrameInit(LIB_FRAME_HDR* pstHdr, LIB_U16 u16Type, LIB_U64 u64Length)
+{
+	pstHdr->u32Magic = LIB_PROTO_MAGIC;
+	pstHdr->u16Version = LIB_PROTO_VERSION;
+	pstHdr->u16Type = u16Type;
+	pstHdr->u64Length = u64Length;
+}
+
+/***************************************************************************//**
+ * GetLabelsSize
+ *
+ * Computes the payload size of a LABELS frame. Labels are sent with their 
+ * real length, not padded to LIB_MAX_LABEL_SIZE.
+ *
+ * @param prgszLabels Label of each column
+ * @param u32ColCount Number of columns
+ * @return            Bytes of the payload
+ ******************************************************************************/
+static LIB_U64 GetLabelsSize(const LIB_CHAR** prgszLabels, LIB_U32 u32ColCount)
+{
+	LIB_U64 u64LabelsSize = 0;
+	for (LIB_U32 u32Col = 0; u32Col < u32ColCount; u32Col++)
+	{
+		size_t szLength = strlen(prgszLabels[u32Col]);
+		u64LabelsSize += sizeof(LIB_U16) + ((szLength > 0xFFFF) ? 0xFFFF : szLength);
+	}
+	return u64LabelsSize;
+}
+
+/***************************************************************************//**
+ * WriteLabels
+ *
+ * Writes a LABELS frame, header and payload
+ *
+ * @param pcWrite     Buffer of sizeof(LIB_FRAME_HDR) + GetLabelsSize() bytes
+ * @param prgszLabels Label of each column
+ * @param u32ColCount Number of columns
+ * @return            End of the frame in the buffer
+ ******************************************************************************/
+static LIB_CHAR* WriteLabels(LIB_CHAR* pcWrite, const LIB_CHAR** prgszLabels, LIB_U32 u32ColCount)
+{
+	LIB_FRAME_HDR stFrame;
+	FrameInit(&stFrame, LIB_MSG_LABELS, GetLabelsSize(prgszLabels, u32ColCount));
+	memcpy(pcWrite, &stFrame, sizeof(stFrame));
+	pcWrite += sizeof(stFrame);
+	for (LIB_U32 u32Col = 0; u32Col < u32ColCount; u32Col++)
+	{
+		size_t szLength = strlen(prgszLabels[u32Col]);
+		LIB_U16 u16Length = (LIB_U16)((szLength > 0xFFFF) ? 0xFFFF : szLength);
+		memcpy(pcWrite, &u16Length, sizeof(u16Length));
+		memcpy(pcWrite + sizeof(u16Length), prgszLabels[u32Col], u16Length);
+		pcWrite += sizeof(u16Length) + u16Length;
+	}
+	return pcWrite;
+}
+
+/***************************************************************************//**
+ * GetErrorDefinition
+ *
+ * Looks up the description and suggested solution of an error code reported
+ * by the Python tool, which only sends the code and the runtime message
+ *
+ * @param u32ErrCode   Error code from the ERROR frame
+ * @param ppszOutMsg   Receives the error description
+ * @param ppszOutHelp  Receives the suggested solution
+ ******************************************************************************/
+static void GetErrorDefinition(LIB_U32 u32ErrCode, const LIB_CHAR** ppszOutMsg, const LIB_CHAR** ppszOutHelp)
+{
+	switch (u32ErrCode)
+	{
+	case LIB_ERR_PROTOCOL:
+		*ppszOutMsg = LIB_ERR_PROTOCOL_MSG;
+		*ppszOutHelp = LIB_ERR_PROTOCOL_ACT;
+		break;
+	case LIB_ERR_CLIENT_ERROR:
+	default:
+		*ppszOutMsg = LIB_ERR_CLIENT_ERROR_MSG;
+		*ppszOutHelp = LIB_ERR_CLIENT_ERROR_ACT;
+		break;
+	}
+}
+
+/***************************************************************************//**
+ * ProtocolRecvReply
+ *
+ * Reads the payload of an ACK or ERROR frame whose header has been received
+ *
+ * @param pstSession Session connected to the Python tool
+ * @param pstFrame   Header of the frame
+ * @param pstErr     Error information structure for logging any errors
+ * @return           LIB_OK if the frame is an ACK with LIB_STATUS_DONE, else LIB_ERR
+ ******************************************************************************/
+LIB_INT32 ProtocolRecvReply(LIB_SESSION* pstSession, const LIB_FRAME_HDR* pstFrame, LIB_ERROR_INFO* pstErr)
+{
+	LIB_CHAR szRuntimeMsg[LIB_MAX_BUFFER_SIZE] = "";
+
+	if (pstFrame->u16Type == LIB_MSG_ACK && pstFrame->u64Length == sizeof(LIB_ACK_PAYLOAD))
+	{
+		LIB_ACK_PAYLOAD stAck;
+		if (TransportRecv(pstSession, &stAck, sizeof(stAck), pstErr) != LIB_OK)
+		{
+			return LIB_ERR;
+		}
+		if (stAck.u32Status == LIB_STATUS_DONE)
+		{
+			pstSession->stStats.dRendererDecodeMs = stAck.dDecodeMs;
+			pstSession->stStats.dRendererPlotMs = stAck.dPlotMs;
+			pstSession->stStats.dRendererSaveMs = stAck.dSaveMs;
+			// Kept in the error structure on success, as callers have always seen it
+			pstErr->u32ErrCode = LIB_STATUS_DONE;
+			return LIB_OK;
+		}
+		snprintf(szRuntimeMsg, sizeof(szRuntimeMsg), "Unknown status 0x%08X from the Python tool", stAck.u32Status);
+		LOG_ERROR(pstErr, LIB_ERR_PROTOCOL, LIB_ERR_PROTOCOL_MSG, LIB_ERR_PROTOCOL_ACT, szRuntimeMsg)
+		return LIB_ERR;
+	}
+
+	if (pstFrame->u16Type == LIB_MSG_ERROR && pstFrame->u64Length >= sizeof(LIB_U32) && pstFrame->u64Length <= LIB_MAX_BUFFER_SIZE * 4)
+	{
+		// Error code followed by the runtime message, not null terminated
+		LIB_CHAR rgcPayload[LIB_MAX_BUFFER_SIZE * 4];
+		if (TransportRecv(pstSession, rgcPayload, pstFrame->u64Length, pstErr) != LIB_OK)
+		{
+			return LIB_ERR;
+		}
+		LIB_U32 u32ErrCode;
+		memcpy(&u32ErrCode, rgcPayload, sizeof(u32ErrCode));
+		const LIB_CHAR* pszMsg;
+		const LIB_CHAR* pszHelp;
+		GetErrorDefinition(u32ErrCode, &pszMsg, &pszHelp);
+		// Truncated to the runtime message buffer
+		LIB_U64 u64TextSize = pstFrame->u64Length - sizeof(u32ErrCode);
+		if (u64TextSize >= sizeof(szRuntimeMsg))
+		{
+			u64TextSize = sizeof(szRuntimeMsg) - 1;
+		}
+		memcpy(szRuntimeMsg, rgcPayload + sizeof(u32ErrCode), u64TextSize);
+		szRuntimeMsg[u64TextSize] = '\0';
+		LOG_ERROR(pstErr, u32ErrCode, pszMsg, pszHelp, szRuntimeMsg)
+		return LIB_ERR;
+	}
+
+	snprintf(szRuntimeMsg, sizeof(szRuntimeMsg), "Frame type %u with %llu bytes, expected a status",
+		pstFrame->u16Type, pstFrame->u64Length);
+	LOG_ERROR(pstErr, LIB_ERR_PROTOCOL, LIB_ERR_PROTOCOL_MSG, LIB_ERR_PROTOCOL_ACT, szRuntimeMsg)
+	return LIB_ERR;
+}
+
+/***************************************************************************//**
+ * RecvCredit
+ *
+ * Waits for the Python tool to return credit for DATA frames it has consumed.
+ * An ERROR frame in place of the credit means the Python tool has given up
+ * on the request.
+ *
+ * @param pstSession   Session connected to the Python tool
+ * @param pu32InFlight Number of DATA frames not yet credited, decremented
+ * @param pstErr       Error information structure for logging any errors
+ * @return             LIB_OK if success, else LIB_ERR if any error occurred
+ ******************************************************************************/
+static LIB_INT32 RecvCredit(LIB_SESSION* pstSession, LIB_U32* pu32InFlight, LIB_ERROR_INFO* pstErr)
+{
+	LIB_CHAR szRuntimeMsg[LIB_MAX_BUFFER_SIZE] = "";
+	LIB_FRAME_HDR stFrame;
+
+	if (ProtocolRecvFrame(pstSession, &stFrame, pstErr) != LIB_OK)
+	{
+		return LIB_ERR;
+	}
+	if (stFrame.u16Type == LIB_MSG_ERROR)
+	{
+		ProtocolRecvReply(pstSession, &stFrame, pstErr);
+		return LIB_ERR;
+	}
+	if (stFrame.u16Type != LIB_MSG_CREDIT || stFrame.u64Length != sizeof(LIB_U32))
+	{
+		snprintf(szRuntimeMsg, sizeof(szRuntimeMsg), "Frame type %u with %llu bytes, expected a credit",
+			stFrame.u16Type, stFrame.u64Length);
+		LOG_ERROR(pstErr, LIB_ERR_PROTOCOL, LIB_ERR_PROTOCOL_MSG, LIB_ERR_PROTOCOL_ACT, szRuntimeMsg)
+		return LIB_ERR;
+	}
+
+	LIB_U32 u32Credit = 0;
+	if (TransportRecv(pstSession, &u32Credit, sizeof(u32Credit), pstErr) != LIB_OK)
+	{
+		return LIB_ERR;
+	}
+	if (u32Credit == 0 || u32Credit > *pu32InFlight)
+	{
+		snprintf(szRuntimeMsg, sizeof(szRuntimeMsg), "Credit for %u chunks with %u in flight", u32Credit, *pu32InFlight);
+		LOG_ERROR(pstErr, LIB_ERR_PROTOCOL, LIB_ERR_PROTOCOL_MSG, LIB_ERR_PROTOCOL_ACT, szRuntimeMsg)
+		return LIB_ERR;
+	}
+	*pu32InFlight -= u32Credit;
+	return LIB_OK;
+}
+
+/***************************************************************************//**
+ * SendStream
+ *
+ * Streams the data in DATA frames of at most LIB_STREAM_CHUNK_SIZE bytes,
+ * gathered straight from the caller's buffers. At most LIB_STREAM_WINDOW 
+ * frames are sent ahead of the Python tool, so the memory held by the 
+ * transport and by the Python tool is bounded by the window and not by the 
+ * buffer size.
+ *
+ * @param pstSession  Session connected to the Python tool
+ * @param prgstSegs   Pieces of the payload in the order they are sent
+ * @param u32SegCount Number of pieces
+ * @param pstErr      Error information structure for logging any errors
+ * @return            LIB_OK if success, else LIB_ERR if any error occurred
+ ******************************************************************************/
+static LIB_INT32 SendStream(LIB_SESSION* pstSession, const LIB_STREAM_SEG* prgstSegs, LIB_U32 u32SegCount, LIB_ERROR_INFO* pstErr)
+{
+	LIB_U32 u32InFlight = 0;
+	LIB_U64 u64Size = 0;
+	for (LIB_U32 u32Seg = 0; u32Seg < u32SegCount; u32Seg++)
+	{
+		u64Size += prgstSegs[u32Seg].u64Size;
+	}
+
+	LIB_U64 u64Sent = 0;
+	LIB_U32 u32Seg = 0;
+	LIB_U64 u64SegSent = 0;
+	while (u64Sent < u64Size)
+	{
+		// Flow control, wait for the Python tool to catch up
+		if (u32InFlight == LIB_STREAM_WINDOW && RecvCredit(pstSession, &u32InFlight, pstErr) != LIB_OK)
+		{
+			return LIB_ERR;
+		}
+
+		LIB_U64 u64Chunk = u64Size - u64Sent;
+		if (u64Chunk > LIB_STREAM_CHUNK_SIZE)
+		{
+			u64Chunk = LIB_STREAM_CHUNK_SIZE;
+		}
+		LIB_FRAME_HDR stFrame;
+		FrameInit(&stFrame, LIB_MSG_DATA, u64Chunk);
+		if (TransportSend(pstSession, &stFrame, sizeof(stFrame), -1, pstErr) != LIB_OK)
+		{
+			return LIB_ERR;
+		}
+		// A frame may span the end of one piece and the start of the next
+		for (LIB_U64 u64Left = u64Chunk; u64Left > 0; )
+		{
+			LIB_U64 u64Part = prgstSegs[u32Seg].u64Size - u64SegSent;
+			if (u64Part > u64Left)
+			{
+				u64Part = u64Left;
+			}
+			if (u64Part > 0 && TransportSend(pstSession, prgstSegs[u32Seg].pcData + u64SegSent, u64Part, -1, pstErr) != LIB_OK)
+			{
+				return LIB_ERR;
+			}
+			u64Left -= u64Part;
+			u64SegSent += u64Part;
+			if (u64SegSent == prgstSegs[u32Seg].u64Size)
+			{
+				u32Seg++;
+				u64SegSent = 0;
+			}
+		}
+		u64Sent += u64Chunk;
+		u32InFlight++;
+	}
+
+	// Collect the remaining credit so the next frame read is the status
+	while (u32InFlight > 0)
+	{
+		if (RecvCredit(pstSession, &u32InFlight, pstErr) != LIB_OK)
+		{
+			return LIB_ERR;
+		}
+	}
+	return LIB_OK;
+}
+
+/***************************************************************************//**
+ * GetColumnSpan
+ *
+ * Describes where the samples of one entry of the COLUMNS frame lie
+ *
+ * @param pstInput   Validated input with typed columns or an X column
+ * @param u32Entry   Entry of the COLUMNS frame, the X column first if any
+ * @param pstOutSpan Receives the column and its bytes
+ ******************************************************************************/
+static void GetColumnSpan(const LIB_INPUT* pstInput, LIB_U32 u32Entry, LIB_COLUMN_SPAN* pstOutSpan)
+{
+	LIB_U32 u32RowSize = pstInput->u32RowSize;
+	LIB_U32 u32First = (pstInput->pstXColumn != NULL) ? 1 : 0;
+	if (u32Entry < u32First)
+	{
+		pstOutSpan->stColumn = *pstInput->pstXColumn;
+	}
+	else if (pstInput->prgstColumns != NULL)
+	{
+		pstOutSpan->stColumn = pstInput->prgstColumns[u32Entry - u32First];
+	}
+	else
+	{
+		pstOutSpan->stColumn = LIB_COLUMN();
+		pstOutSpan->stColumn.pvData = pstInput->prgdBuffer + (LIB_U64)(u32Entry - u32First) * u32RowSize;
+		pstOutSpan->stColumn.u32Dtype = LIB_DTYPE_FLOAT64;
+	}
+	pstOutSpan->pcStart = (const LIB_CHAR*)pstOutSpan->stColumn.pvData;
+	pstOutSpan->u64Size = (u32RowSize > 0)
+		? (u32RowSize - 1) * GetColumnStride(&pstOutSpan->stColumn) + GetDtypeSize(pstOutSpan->stColumn.u32Dtype) : 0;
+	pstOutSpan->u32Entry = u32Entry;
+}
+
+/***************************************************************************//**
+ * ProtocolColumnsExtent
+ *
+ * Finds the bytes from the first sample of any typed column or the X column
+ * to the end of the last, which is the payload when they are all passed in
+ * one shared memory segment
+ *
+ * @param pstInput    Validated input with typed columns or an X column
+ * @param ppvOutStart Receives the lowest address of a sample
+ * @param pu64OutSize Receives the bytes up to the end of the highest sample
+ ******************************************************************************/
+void ProtocolColumnsExtent(const LIB_INPUT* pstInput, const void** ppvOutStart, LIB_U64* pu64OutSize)
+{
+	LIB_U32 u32EntryCount = pstInput->u32ColSize + ((pstInput->pstXColumn != NULL) ? 1 : 0);
+	size_t szStart = 0;
+	size_t szEnd = 0;
+	for (LIB_U32 u32Entry = 0; u32Entry < u32EntryCount; u32Entry++)
+	{
+		LIB_COLUMN_SPAN stSpan;
+		GetColumnSpan(pstInput, u32Entry, &stSpan);
+		if (u32Entry == 0 || (size_t)stSpan.pcStart < szStart)
+		{
+			szStart = (size_t)stSpan.pcStart;
+		}
+		if ((size_t)stSpan.pcStart + stSpan.u64Size > szEnd)
+		{
+			szEnd = (size_t)stSpan.pcStart + stSpan.u64Size;
+		}
+	}
+	*ppvOutStart = (const void*)szStart;
+	*pu64OutSize = szEnd - szStart;
+}
+
+static bool SpanStartsBefore(const LIB_COLUMN_SPAN& stLeft, const LIB_COLUMN_SPAN& stRight)
+{
+	return (size_t)stLeft.pcStart < (size_t)stRight.pcStart;
+}
+
+/***************************************************************************//**
+ * LayoutColumns
+ *
+ * Lays out the payload of typed columns, the X column first if any, and
+ * writes their COLUMNS entries. The columns are sorted by address and those
+ * whose bytes overlap, e.g. members of one array of structs, become a single
+ * block sent once from the caller's memory with the stride of each column.
+ * Each block is followed by its padding to LIB_COLUMN_ALIGN bytes. For a
+ * payload in shared memory all columns form one block, gaps included, which
+ * is not padded.
+ *
+ * @param pstInput        Validated input with typed columns or an X column
+ * @param bOneBlock       LIB_TRUE if the payload is the extent of the columns in shared memory
+ * @param prgstSpans      Room for u32SpanCount spans
+ * @param u32SpanCount    Entries of the COLUMNS frame
+ * @param pcEntries       Receives the u32SpanCount LIB_COLUMN_HDR entries
+ * @param prgstSegs       Receives the payload pieces, room for 2 * u32SpanCount
+ * @param pu32OutSegCount Receives the number of payload pieces
+ * @return                Bytes of the payload
+ ******************************************************************************/
+static LIB_U64 LayoutColumns(const LIB_INPUT* pstInput, LIB_BOOLEAN bOneBlock, LIB_COLUMN_SPAN* prgstSpans, LIB_U32 u32SpanCount, 
+	LIB_CHAR* pcEntries, LIB_STREAM_SEG* prgstSegs, LIB_U32* pu32OutSegCount)
+{
+	static const LIB_CHAR s_rgcPadding[LIB_COLUMN_ALIGN] = { 0 };
+	for (LIB_U32 u32Entry = 0; u32Entry < u32SpanCount; u32Entry++)
+	{
+		GetColumnSpan(pstInput, u32Entry, &prgstSpans[u32Entry]);
+	}
+	std::sort(prgstSpans, prgstSpans + u32SpanCount, SpanStartsBefore);
+
+	// One pass over the sorted spans, one past the end to close the last block
+	LIB_U64 u64DataSize = 0;
+	LIB_U64 u64BlockOffset = 0;
+	LIB_U32 u32SegCount = 0;
+	LIB_STREAM_SEG* pstBlock = NULL;
+	for (LIB_U32 u32Span = 0; u32Span <= u32SpanCount; u32Span++)
+	{
+		const LIB_COLUMN_SPAN* pstSpan = (u32Span < u32SpanCount) ? &prgstSpans[u32Span] : NULL;
+		size_t szBlockEnd = (pstBlock != NULL) ? (size_t)pstBlock->pcData + (size_t)pstBlock->u64Size : 0;
+		if (pstBlock != NULL && (pstSpan == NULL || (!bOneBlock && (size_t)pstSpan->pcStart >= szBlockEnd)))
+		{
+			u64DataSize = u64BlockOffset + pstBlock->u64Size;
+			LIB_U64 u64PadSize = bOneBlock ? 0 : (LIB_COLUMN_ALIGN - u64DataSize % LIB_COLUMN_ALIGN) % LIB_COLUMN_ALIGN;
+			prgstSegs[u32SegCount].pcData = s_rgcPadding;
+			prgstSegs[u32SegCount].u64Size = u64PadSize;
+			u32SegCount++;
+			u64DataSize += u64PadSize;
+			pstBlock = NULL;
+		}
+		if (pstSpan == NULL)
+		{
+			break;
+		}
+		if (pstBlock == NULL)
+		{
+			pstBlock = &prgstSegs[u32SegCount++];
+			pstBlock->pcData = pstSpan->pcStart;
+			pstBlock->u64Size = pstSpan->u64Size;
+			u64BlockOffset = u64DataSize;
+		}
+		else if ((size_t)pstSpan->pcStart + pstSpan->u64Size > szBlockEnd)
+		{
+			pstBlock->u64Size = (size_t)pstSpan->pcStart + pstSpan->u64Size - (size_t)pstBlock->pcData;
+		}
+
+		LIB_COLUMN_HDR stColumn;
+		stColumn.u32Dtype = pstSpan->stColumn.u32Dtype;
+		stColumn.u32Stride = (LIB_U32)GetColumnStride(&pstSpan->stColumn);
+		stColumn.dScale = pstSpan->stColumn.dScale;
+		stColumn.dOffset = pstSpan->stColumn.dOffset;
+		stColumn.u64Offset = u64BlockOffset + ((size_t)pstSpan->pcStart - (size_t)pstBlock->pcData);
+		memcpy(pcEntries + (LIB_U64)pstSpan->u32Entry * sizeof(stColumn), &stColumn, sizeof(stColumn));
+	}
+	*pu32OutSegCount = u32SegCount;
+	return u64DataSize;
+}
+
+/***************************************************************************//**
+ * ProtocolBuildPlot
+ *
+ * Lays out a plot request: the PLOT, LABELS and (for typed columns or an X
+ * column) COLUMNS frames in one buffer, and the pieces of the payload in
+ * the caller's buffers. Typed columns keep their own type and layout, see
+ * LayoutColumns(). The PLOT header is complete but for LIB_PLOT_FLAG_SHM 
+ * and u64ShmOffset, which the caller sets when the payload is not sent in
+ * DATA frames.
+ *
+ * @param pstInput   Input structure including data buffer and labels
+ * @param u32Flags   LIB_PLOT_FLAG_XY if the buffer holds X and Y columns
+ * @param bOneBlock  LIB_TRUE if typed columns are passed as their extent in shared memory
+ * @param pstOutPlot Receives the request, release with ProtocolFreePlot()
+ * @param pstErr     Error information structure for logging any errors
+ * @return           LIB_OK if success, else LIB_ERR if any error occurred
+ ******************************************************************************/
+LIB_INT32 ProtocolBuildPlot(const LIB_INPUT* pstInput, LIB_U32 u32Flags, LIB_BOOLEAN bOneBlock, LIB_PLOT_REQUEST* pstOutPlot, LIB_ERROR_INFO* pstErr)
+{
+	LIB_CHAR szRuntimeMsg[LIB_MAX_BUFFER_SIZE] = "";
+	LIB_U32 u32ColCount = pstInput->u32ColSize;
+	LIB_BOOLEAN bTyped = (LIB_BOOLEAN)(pstInput->prgstColumns != NULL || pstInput->pstXColumn != NULL);
+	LIB_U32 u32EntryCount = 0;
+	LIB_U64 u64DataSize = 0;
+	if (!bTyped)
+	{
+		u64DataSize = (LIB_U64)pstInput->u32RowSize * u32ColCount * sizeof(LIB_DOUBLE);
+		if (u32Flags & LIB_PLOT_FLAG_XY)
+		{
+			u64DataSize *= 2;
+		}
+	}
+	else
+	{
+		u32Flags |= LIB_PLOT_FLAG_COLUMNS | ((pstInput->pstXColumn != NULL) ? LIB_PLOT_FLAG_X : 0);
+		u32EntryCount = u32ColCount + ((pstInput->pstXColumn != NULL) ? 1 : 0);
+	}
+
+	LIB_U64 u64LabelsSize = GetLabelsSize(pstInput->prgszLabels, u32ColCount);
+	LIB_U64 u64ColumnsSize = bTyped ? sizeof(LIB_FRAME_HDR) + (LIB_U64)u32EntryCount * sizeof(LIB_COLUMN_HDR) : 0;
+
+	// The request, the payload pieces and the spans of the typed columns
+	LIB_U64 u64HeadSize = sizeof(LIB_FRAME_HDR) + sizeof(LIB_PLOT_HDR) + sizeof(LIB_FRAME_HDR) + u64LabelsSize + u64ColumnsSize;
+	LIB_U32 u32SegCount = bTyped ? 2 * u32EntryCount : 1;
+	LIB_U64 u64SegsOffset = (u64HeadSize + 7) / 8 * 8;
+	LIB_U64 u64SpansOffset = u64SegsOffset + u32SegCount * sizeof(LIB_STREAM_SEG);
+	LIB_CHAR* pcHead = (LIB_CHAR*)malloc(u64SpansOffset + u32EntryCount * sizeof(LIB_COLUMN_SPAN));
+	if (pcHead == NULL)
+	{
+		snprintf(szRuntimeMsg, sizeof(szRuntimeMsg), "Unable to allocate %llu bytes for the request", u64HeadSize);
+		LOG_ERROR(pstErr, LIB_ERR_BUFFER_OVERFLOW, LIB_ERR_BUFFER_OVERFLOW_MSG, LIB_ERR_BUFFER_OVERFLOW_ACT, szRuntimeMsg)
+		return LIB_ERR;
+	}
+	LIB_STREAM_SEG* prgstSegs = (LIB_STREAM_SEG*)(pcHead + u64SegsOffset);
+	if (!bTyped)
+	{
+		prgstSegs[0].pcData = (const LIB_CHAR*)pstInput->prgdBuffer;
+		prgstSegs[0].u64Size = u64DataSize;
+	}
+
+	// PLOT frame, its payload size is only known once the columns are laid out below
+	LIB_CHAR* pcWrite = pcHead;
+	LIB_FRAME_HDR stFrame;
+	FrameInit(&stFrame, LIB_MSG_PLOT, sizeof(LIB_PLOT_HDR));
+	memcpy(pcWrite, &stFrame, sizeof(stFrame));
+	pcWrite += sizeof(stFrame);
+	LIB_PLOT_HDR* pstPlot = (LIB_PLOT_HDR*)pcWrite;
+	pcWrite += sizeof(LIB_PLOT_HDR);
+
+	pcWrite = WriteLabels(pcWrite, pstInput->prgszLabels, u32ColCount);
+
+	// COLUMNS frame, the X column first
+	if (bTyped)
+	{
+		FrameInit(&stFrame, LIB_MSG_COLUMNS, u64ColumnsSize - sizeof(LIB_FRAME_HDR));
+		memcpy(pcWrite, &stFrame, sizeof(stFrame));
+		pcWrite += sizeof(stFrame);
+		LIB_COLUMN_SPAN* prgstSpans = (LIB_COLUMN_SPAN*)(pcHead + u64SpansOffset);
+		u64DataSize = LayoutColumns(pstInput, bOneBlock, prgstSpans, u32EntryCount, pcWrite, prgstSegs, &u32SegCount);
+	}
+
+	pstPlot->u32ColSize = u32ColCount;
+	pstPlot->u32RowSize = pstInput->u32RowSize;
+	pstPlot->u32Dtype = LIB_DTYPE_FLOAT64;
+	pstPlot->u32Flags = u32Flags;
+	pstPlot->u64PayloadSize = u64DataSize;
+	pstPlot->u64ShmOffset = 0;
+	pstPlot->u32Output = pstInput->u32Output;
+	pstPlot->u32Dpi = (pstInput->u32Dpi != 0) ? pstInput->u32Dpi : LIB_DEFAULT_DPI;
+
+	pstOutPlot->pcHead = pcHead;
+	pstOutPlot->u64HeadSize = u64HeadSize;
+	pstOutPlot->pstPlot = pstPlot;
+	pstOutPlot->prgstSegs = prgstSegs;
+	pstOutPlot->u32SegCount = u32SegCount;
+	return LIB_OK;
+}
+
+/***************************************************************************//**
+ * ProtocolFreePlot
+ *
+ * Releases a request from ProtocolBuildPlot()
+ *
+ * @param pstPlot Request to release
+ ******************************************************************************/
+void ProtocolFreePlot(LIB_PLOT_REQUEST* pstPlot)
+{
+	free(pstPlot->pcHead);
+	pstPlot->pcHead = NULL;
+}
+
+/***************************************************************************//**
+ * ProtocolSendPlot
+ *
+ * Sends a plot request from ProtocolBuildPlot(), the frames in a single 
+ * write, then the data streamed from the caller's buffers unless the data
+ * is in a shared memory segment. Typed columns in a segment are passed as
+ * their extent, u64ShmOffset is that of ProtocolColumnsExtent().
+ * Returns once the Python tool has consumed every chunk.
+ *
+ * @param pstSession   Session connected to the Python tool
+ * @param pstInput     Input structure including data buffer and labels
+ * @param u32Flags     LIB_PLOT_FLAG_XY if the buffer holds X and Y columns
+ * @param nShmFd       Segment holding the data, or -1 to stream DATA frames
+ * @param u64ShmOffset Byte offset of the data within the segment
+ * @param pstErr       Error information structure for logging any errors
+ * @return             LIB_OK if success, else LIB_ERR if any error occurred
+ ******************************************************************************/
+LIB_INT32 ProtocolSendPlot(LIB_SESSION* pstSession, const LIB_INPUT* pstInput, LIB_U32 u32Flags, LIB_INT32 nShmFd, LIB_U64 u64ShmOffset, LIB_ERROR_INFO* pstErr)
+{
+	LIB_PLOT_REQUEST stRequest;
+	if (ProtocolBuildPlot(pstInput, u32Flags, (LIB_BOOLEAN)(nShmFd >= 0), &stRequest, pstErr) != LIB_OK)
+	{
+		return LIB_ERR;
+	}
+	if (nShmFd >= 0)
+	{
+		stRequest.pstPlot->u32Flags |= LIB_PLOT_FLAG_SHM;
+		stRequest.pstPlot->u64ShmOffset = u64ShmOffset;
+	}
+
+	LIB_INT32 nRet = TransportSend(pstSession, stRequest.pcHead, stRequest.u64HeadSize, nShmFd, pstErr);
+	if (nRet == LIB_OK && nShmFd < 0)
+	{
+		nRet = SendStream(pstSession, stRequest.prgstSegs, stRequest.u32SegCount, pstErr);
+	}
+	ProtocolFreePlot(&stRequest);
+	return nRet;
+}
+
+/***************************************************************************//**
+ * ProtocolRecvFrame
+ *
+ * Reads a frame header and checks it belongs to this protocol version. The
+ * caller reads or discards the payload.
+ *
+ * @param pstSession Session connected to the Python tool
+ * @param pstOutHdr  Receives the frame header
+ * @param pstErr     Error information structure for logging any errors
+ * @return           LIB_OK if success, else LIB_ERR if any error occurred
+ ******************************************************************************/
+LIB_INT32 ProtocolRecvFrame(LIB_SESSION* pstSession, LIB_FRAME_HDR* pstOutHdr, LIB_ERROR_INFO* pstErr)
+{
+	LIB_CHAR szRuntimeMsg[LIB_MAX_BUFFER_SIZE] = "";
+
+	if (TransportRecv(pstSession, pstOutHdr, sizeof(*pstOutHdr), pstErr) != LIB_OK)
+	{
+		return LIB_ERR;
+	}
+	if (pstOutHdr->u32Magic != LIB_PROTO_MAGIC || pstOutHdr->u16Version != LIB_PROTO_VERSION)
+	{
+		snprintf(szRuntimeMsg, sizeof(szRuntimeMsg), "Frame with magic 0x%08X version %u, expected 0x%08X version %u",
+			pstOutHdr->u32Magic, pstOutHdr->u16Version, LIB_PROTO_MAGIC, LIB_PROTO_VERSION);
+		LOG_ERROR(pstErr, LIB_ERR_PROTOCOL, LIB_ERR_PROTOCOL_MSG, LIB_ERR_PROTOCOL_ACT, szRuntimeMsg)
+		return LIB_ERR;
+	}
+	return LIB_OK;
+}
+
+/***************************************************************************//**
+ * ProtocolRecvStatus
+ *
+ * Waits for the Python tool to answer a request. An ACK frame carries only
+ * the status code and the timings of the Python tool, error text is only 
+ * sent in an ERROR frame on failure.
+ *
+ * @param pstSession Session connected to the Python tool
+ * @param pstErr     Error information structure for logging any errors
+ * @return           LIB_OK if success, else LIB_ERR if any error occurred
+ ******************************************************************************/
+LIB_INT32 ProtocolRecvStatus(LIB_SESSION* pstSession, LIB_ERROR_INFO* pstErr)
+{
+	LIB_FRAME_HDR stFrame;
+
+	if (ProtocolRecvFrame(pstSession, &stFrame, pstErr) != LIB_OK)
+	{
+		return LIB_ERR;
+	}
+	return ProtocolRecvReply(pstSession, &stFrame, pstErr);
+}
+
+/***************************************************************************//**
+ * ProtocolRecvResult
+ *
+ * Waits for the answer to a plot request. Unless the figure is saved as a 
+ * file, an IMAGE frame comes first and is read straight into the image of 
+ * the input. An image that does not fit the caller's buffer is read and 
+ * dropped so that the session stays usable, and its size is returned.
+ *
+ * @param pstSession Session connected to the Python tool
+ * @param pstInput   Input of the request, with the output and the image
+ * @param pstErr     Error information structure for logging any errors
+ * @return           LIB_OK if success, else LIB_ERR if any error occurred
+ ******************************************************************************/
+LIB_INT32 ProtocolRecvResult(LIB_SESSION* pstSession, const LIB_INPUT* pstInput, LIB_ERROR_INFO* pstErr)
+{
+	LIB_CHAR szRuntimeMsg[LIB_MAX_BUFFER_SIZE] = "";
+	LIB_FRAME_HDR stFrame;
+
+	if (pstInput->u32Output == LIB_OUTPUT_FILE)
+	{
+		return ProtocolRecvStatus(pstSession, pstErr);
+	}
+	if (ProtocolRecvFrame(pstSession, &stFrame, pstErr) != LIB_OK)
+	{
+		return LIB_ERR;
+	}
+	// No image if the Python tool failed to plot, only its ERROR frame
+	if (stFrame.u16Type == LIB_MSG_ERROR)
+	{
+		ProtocolRecvReply(pstSession, &stFrame, pstErr);
+		return LIB_ERR;
+	}
+	LIB_IMAGE_HDR stImage;
+	if (stFrame.u16Type != LIB_MSG_IMAGE || stFrame.u64Length < sizeof(stImage)
+		|| TransportRecv(pstSession, &stImage, sizeof(stImage), pstErr) != LIB_OK
+		|| stImage.u64Size != stFrame.u64Length - sizeof(stImage) || stImage.u32Format != pstInput->u32Output)
+	{
+		snprintf(szRuntimeMsg, sizeof(szRuntimeMsg), "Frame type %u with %llu bytes, expected an image in format %u",
+			stFrame.u16Type, stFrame.u64Length, pstInput->u32Output);
+		LOG_ERROR(pstErr, LIB_ERR_PROTOCOL, LIB_ERR_PROTOCOL_MSG, LIB_ERR_PROTOCOL_ACT, szRuntimeMsg)
+		return LIB_ERR;
+	}
+
+	LIB_IMAGE* pstOut = pstInput->pstImage;
+	pstOut->u32Format = stImage.u32Format;
+	pstOut->u32Width = stImage.u32Width;
+	pstOut->u32Height = stImage.u32Height;
+	LIB_ERROR_INFO stReserveErr;
+	if (ImageReserve(pstOut, stImage.u64Size, &stReserveErr) == LIB_OK)
+	{
+		if (TransportRecv(pstSession, pstOut->pcData, stImage.u64Size, pstErr) != LIB_OK)
+		{
+			return LIB_ERR;
+		}
+		return ProtocolRecvStatus(pstSession, pstErr);
+	}
+
+	// Drained in pieces, the status that follows is still read
+	LIB_CHAR rgcDiscard[65536];
+	for (LIB_U64 u64Left = stImage.u64Size; u64Left > 0; )
+	{
+		LIB_U64 u64Part = (u64Left < sizeof(rgcDiscard)) ? u64Left : sizeof(rgcDiscard);
+		if (TransportRecv(pstSession, rgcDiscard, u64Part, pstErr) != LIB_OK)
+		{
+			return LIB_ERR;
+		}
+		u64Left -= u64Part;
+	}
+	if (ProtocolRecvStatus(pstSession, pstErr) != LIB_OK)
+	{
+		return LIB_ERR;
+	}
+	*pstErr = stReserveErr;
+	return LIB_ERR;
+}
+
+/***************************************************************************//**
+ * ProtocolRecvReady
+ *
+ * Reads the READY frame the Python tool sends once after start-up, so that
+ * a session is only handed out when its first plot no longer pays for 
+ * starting Python and importing Matplotlib
+ *
+ * @param pstSession Session connected to the Python tool
+ * @param pstErr     Error information structure for logging any errors
+ * @return           LIB_OK if success, else LIB_ERR if any error occurred
+ ******************************************************************************/
+LIB_INT32 ProtocolRecvReady(LIB_SESSION* pstSession, LIB_ERROR_INFO* pstErr)
+{
+	LIB_CHAR szRuntimeMsg[LIB_MAX_BUFFER_SIZE] = "";
+	LIB_FRAME_HDR stFrame;
+
+	if (ProtocolRecvFrame(pstSession, &stFrame, pstErr) != LIB_OK)
+	{
+		return LIB_ERR;
+	}
+	if (stFrame.u16Type != LIB_MSG_READY || stFrame.u64Length != sizeof(LIB_U32))
+	{
+		snprintf(szRuntimeMsg, sizeof(szRuntimeMsg), "Frame type %u with %llu bytes, expected the ready message",
+			stFrame.u16Type, stFrame.u64Length);
+		LOG_ERROR(pstErr, LIB_ERR_PROTOCOL, LIB_ERR_PROTOCOL_MSG, LIB_ERR_PROTOCOL_ACT, szRuntimeMsg)
+		return LIB_ERR;
+	}
+	LIB_U32 u32Pid = 0;
+	return TransportRecv(pstSession, &u32Pid, sizeof(u32Pid), pstErr);
+}
+
+/***************************************************************************//**
+ * ProtocolSendStream
+ *
+ * Sends the STREAM and LABELS frames opening a live figure. The ring buffer 
+ * is passed along with the first byte on POSIX, or named in the header on 
+ * Windows.
+ *
+ * @param pstSession  Session connected to the Python tool
+ * @param pstStream   Header of the stream
+ * @param prgszLabels Label of each column
+ * @param nShmFd      Segment of the ring buffer, or -1 on Windows
+ * @param pstErr      Error information structure for logging any errors
+ * @return            LIB_OK if success, else LIB_ERR if any error occurred
+ ******************************************************************************/
+LIB_INT32 ProtocolSendStream(LIB_SESSION* pstSession, const LIB_STREAM_HDR* pstStream, const LIB_CHAR** prgszLabels, LIB_INT32 nShmFd, LIB_ERROR_INFO* pstErr)
+{
+	LIB_CHAR szRuntimeMsg[LIB_MAX_BUFFER_SIZE] = "";
+	LIB_U64 u64Size = sizeof(LIB_FRAME_HDR) + sizeof(LIB_STREAM_HDR) + sizeof(LIB_FRAME_HDR) + GetLabelsSize(prgszLabels, pstStream->u32ColSize);
+	LIB_CHAR* pcHead = (LIB_CHAR*)malloc(u64Size);
+	if (pcHead == NULL)
+	{
+		snprintf(szRuntimeMsg, sizeof(szRuntimeMsg), "Unable to allocate %llu bytes for the request", u64Size);
+		LOG_ERROR(pstErr, LIB_ERR_BUFFER_OVERFLOW, LIB_ERR_BUFFER_OVERFLOW_MSG, LIB_ERR_BUFFER_OVERFLOW_ACT, szRuntimeMsg)
+		return LIB_ERR;
+	}
+
+	LIB_FRAME_HDR stFrame;
+	FrameInit(&stFrame, LIB_MSG_STREAM, sizeof(LIB_STREAM_HDR));
+	memcpy(pcHead, &stFrame, sizeof(stFrame));
+	memcpy(pcHead + sizeof(stFrame), pstStream, sizeof(LIB_STREAM_HDR));
+	WriteLabels(pcHead + sizeof(stFrame) + sizeof(LIB_STREAM_HDR), prgszLabels, pstStream->u32ColSize);
+
+	LIB_INT32 nRet = TransportSend(pstSession, pcHead, u64Size, nShmFd, pstErr);
+	free(pcHead);
+	return nRet;
+}
+
+/***************************************************************************//**
+ * ProtocolSendFrame
+ *
+ * Sends a frame without payload
+ *
+ * @param pstSession Session connected to the Python tool
+ * @param u16Type    One of LIB_MSG_*
+ * @param pstErr     Error information structure for logging any errors
+ * @return           LIB_OK if success, else LIB_ERR if any error occurred
+ ******************************************************************************/
+LIB_INT32 ProtocolSendFrame(LIB_SESSION* pstSession, LIB_U16 u16Type, LIB_ERROR_INFO* pstErr)
+{
+	LIB_FRAME_HDR stFrame;
+	FrameInit(&stFrame, u16Type, 0);
+	return TransportSend(pstSession, &stFrame, sizeof(stFrame), -1, pstErr);
+}
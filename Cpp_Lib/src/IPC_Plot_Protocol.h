@@ -0,0 +1,202 @@
+#pragma once
+
+#include <atomic>
+
+#include "IPC_Plot_Internal.h"
+
+// Wire protocol between the library and the Python tool (IPC_Plot_Protocol.py).
+// Every message is a frame: a fixed header followed by u64Length bytes of payload.
+// All fields are in host byte order, both ends always run on the same machine.
+
+#define LIB_PROTO_MAGIC   0x50435049 //!< "IPCP"
+#define LIB_PROTO_VERSION 9
+
+// Streaming of data not in shared memory: the payload is split into DATA frames of at most
+// LIB_STREAM_CHUNK_SIZE bytes, and at most LIB_STREAM_WINDOW of them are sent before the
+// Python tool returns a CREDIT frame, so neither side buffers more than the window
+#define LIB_STREAM_CHUNK_SIZE (1ULL << 20)
+#define LIB_STREAM_WINDOW     4
+
+// Frame types
+#define LIB_MSG_PLOT    1 //!< LIB_PLOT_HDR, followed by a LABELS frame and the DATA frames
+#define LIB_MSG_LABELS  2 //!< Per column: LIB_U16 length followed by the label bytes
+#define LIB_MSG_DATA    3 //!< Next chunk of the column-major data, LIB_STREAM_CHUNK_SIZE bytes or less
+#define LIB_MSG_ACK     4 //!< LIB_ACK_PAYLOAD, status code and timings of the Python tool
+#define LIB_MSG_ERROR   5 //!< LIB_U32 error code followed by the runtime message text
+#define LIB_MSG_CREDIT  6 //!< LIB_U32 number of DATA frames consumed by the Python tool
+#define LIB_MSG_COLUMNS 7 //!< One LIB_COLUMN_HDR per column, sent after the LABELS frame with LIB_PLOT_FLAG_COLUMNS
+#define LIB_MSG_READY   8 //!< LIB_U32 process ID, sent once by the Python tool when it has imported its modules
+#define LIB_MSG_STREAM  9 //!< LIB_STREAM_HDR, followed by a LABELS frame, opens a live figure on a ring in shared memory
+#define LIB_MSG_STREAM_END 10 //!< No payload, the Python tool draws the last rows of the ring and answers the stream
+#define LIB_MSG_IMAGE   11 //!< LIB_IMAGE_HDR followed by the image bytes, sent before the ACK unless the output is a file
+
+// Flags of LIB_PLOT_HDR
+#define LIB_PLOT_FLAG_SHM     0x00000001 //!< Data is in the shared memory segment or file passed with the PLOT frame, no DATA frames
+#define LIB_PLOT_FLAG_XY      0x00000002 //!< Each column is preceded by a column of its X values (sample indices)
+#define LIB_PLOT_FLAG_COLUMNS 0x00000004 //!< Typed columns described by a COLUMNS frame, u32Dtype is not used
+#define LIB_PLOT_FLAG_X       0x00000008 //!< With LIB_PLOT_FLAG_COLUMNS, the first entry of the COLUMNS frame holds the X values of every column
+
+// Typed columns are sent as they lie in the caller's memory: columns whose bytes overlap, e.g.
+// members of the same array of structs, share one block of the payload. Each block is padded
+// so that the next starts on a multiple of this. With LIB_PLOT_FLAG_SHM the payload is the
+// bytes of the segment from the first column to the end of the last, not padded.
+#define LIB_COLUMN_ALIGN 8
+
+typedef struct LIB_FRAME_HDR
+{
+	LIB_U32 u32Magic;   //!< LIB_PROTO_MAGIC
+	LIB_U16 u16Version; //!< LIB_PROTO_VERSION
+	LIB_U16 u16Type;    //!< One of LIB_MSG_*
+	LIB_U64 u64Length;  //!< Number of payload bytes after the header
+} LIB_FRAME_HDR;
+
+typedef struct LIB_PLOT_HDR
+{
+	LIB_U32 u32ColSize;     //!< Number of columns for plotting
+	LIB_U32 u32RowSize;     //!< Number of rows of data each column
+	LIB_U32 u32Dtype;       //!< LIB_DTYPE_* of every value, LIB_DTYPE_FLOAT64 unless typed columns are sent
+	LIB_U32 u32Flags;       //!< LIB_PLOT_FLAG_*
+	LIB_U64 u64PayloadSize; //!< Number of data bytes
+	LIB_U64 u64ShmOffset;   //!< Byte offset of the data in the segment with LIB_PLOT_FLAG_SHM
+	LIB_U32 u32Output;      //!< LIB_OUTPUT_*
+	LIB_U32 u32Dpi;         //!< Resolution of the figure, never 0
+} LIB_PLOT_HDR;
+
+typedef struct LIB_IMAGE_HDR
+{
+	LIB_U32 u32Format;  //!< LIB_OUTPUT_PNG or LIB_OUTPUT_RGBA, as requested
+	LIB_U32 u32Width;   //!< Pixels
+	LIB_U32 u32Height;
+	LIB_U32 u32Reserved;
+	LIB_U64 u64Size;    //!< Bytes of the image following the header, the rest of the frame
+} LIB_IMAGE_HDR;
+
+typedef struct LIB_COLUMN_HDR
+{
+	LIB_U32 u32Dtype;   //!< LIB_DTYPE_* of the samples
+	LIB_U32 u32Stride;  //!< Bytes from one sample to the next in the payload, at least the size of a sample
+	LIB_DOUBLE dScale;  //!< Plotted value is sample * dScale + dOffset
+	LIB_DOUBLE dOffset;
+	LIB_U64 u64Offset;  //!< Byte offset of the first sample in the payload
+} LIB_COLUMN_HDR;
+
+typedef struct LIB_STREAM_HDR
+{
+	LIB_U32 u32ColSize;  //!< Values in each row
+	LIB_U32 u32MaxFps;   //!< Highest frame rate of the live figure
+	LIB_U64 u64Capacity; //!< Rows of the ring, also the rows shown
+	LIB_U64 u64ShmSize;  //!< Bytes of the shared memory, LIB_RING_HDR followed by the rows
+	LIB_CHAR szShmName[64]; //!< Name of the file mapping on Windows, empty when the segment is passed with the frame
+} LIB_STREAM_HDR;
+
+#define LIB_RING_MAGIC 0x474E4952 //!< "RING"
+
+// Start of the shared memory of a live stream, followed by u64Capacity rows of u32ColSize doubles.
+// Single producer (the library) and single consumer (the Python tool): the head and the tail count 
+// rows since the stream was opened, each is written by one side only and sits on its own cache line.
+// The rows are written before the head is released, the Python tool reads the head before the rows.
+typedef struct LIB_RING_HDR
+{
+	LIB_U32 u32Magic;              //!< LIB_RING_MAGIC
+	LIB_U32 u32ColSize;
+	LIB_U64 u64Capacity;
+	LIB_U64 u64Dropped;            //!< Rows not appended because the ring was full, written by the library
+	LIB_CHAR rgcPad0[40];
+	std::atomic<LIB_U64> u64Head;  //!< Rows appended, written by the library
+	LIB_CHAR rgcPad1[56];
+	std::atomic<LIB_U64> u64Tail;  //!< Rows consumed, written by the Python tool
+	LIB_CHAR rgcPad2[56];
+} LIB_RING_HDR;
+
+typedef struct LIB_ACK_PAYLOAD
+{
+	LIB_U32 u32Status;    //!< LIB_STATUS_DONE
+	LIB_U32 u32Reserved;
+	LIB_DOUBLE dDecodeMs; //!< Receiving and decoding the data, from the PLOT frame to the NumPy columns
+	LIB_DOUBLE dPlotMs;   //!< Creating the figure
+	LIB_DOUBLE dSaveMs;   //!< savefig()
+} LIB_ACK_PAYLOAD;
+
+// Spool log of ipc_plot_spool_config(), read by IPC_Plot_Replay.py. The log starts with a
+// LIB_SPOOL_FILE_HDR and is a sequence of records, each a LIB_SPOOL_RECORD_HDR followed by
+// u64Length bytes, so that the next record is found without reading the body. Records start
+// on a multiple of LIB_SPOOL_ALIGN bytes. All fields are in the byte order of the machine
+// that wrote the log, which the magic number of the file header tells.
+#define LIB_SPOOL_MAGIC        0x4C4F5053 //!< "SPOL"
+#define LIB_SPOOL_VERSION      1
+#define LIB_SPOOL_RECORD_MAGIC 0x44524352 //!< "RCRD"
+#define LIB_SPOOL_TAIL_MAGIC   0x4C494154 //!< "TAIL"
+#define LIB_SPOOL_ALIGN        8
+
+// Record types
+#define LIB_SPOOL_PLOT  1 //!< Frames of a plot request as ProtocolBuildPlot() lays them out, padded, then the payload
+#define LIB_SPOOL_INDEX 2 //!< LIB_SPOOL_INDEX_HDR, u64Count LIB_SPOOL_INDEX_ENTRY and a LIB_SPOOL_TAIL
+
+typedef struct LIB_SPOOL_FILE_HDR
+{
+	LIB_U32 u32Magic;        //!< LIB_SPOOL_MAGIC
+	LIB_U16 u16Version;      //!< LIB_SPOOL_VERSION, layout of the log
+	LIB_U16 u16ProtoVersion; //!< LIB_PROTO_VERSION of the frames in the records
+	LIB_U64 u64CreatedUs;    //!< Wall clock time the log was created, microseconds since 1970
+} LIB_SPOOL_FILE_HDR;
+
+// The PLOT frame of a plot record has LIB_PLOT_FLAG_SHM set: the payload is not in DATA frames
+// but follows the frames in the record, u64ShmOffset bytes from the start of the record.
+typedef struct LIB_SPOOL_RECORD_HDR
+{
+	LIB_U32 u32Magic;  //!< LIB_SPOOL_RECORD_MAGIC
+	LIB_U32 u32Type;   //!< LIB_SPOOL_PLOT or LIB_SPOOL_INDEX
+	LIB_U64 u64Length; //!< Bytes of the record after this header, a multiple of LIB_SPOOL_ALIGN
+	LIB_U64 u64TimeUs; //!< Wall clock time of the ipc_plot() call or of the index, microseconds since 1970
+} LIB_SPOOL_RECORD_HDR;
+
+// An index record lists the plot records written since the previous index, which it links to.
+// The log of a closed or flushed spool ends with an index record, whose tail is then the last
+// bytes of the file: the whole index is found from the end without reading any plot.
+typedef struct LIB_SPOOL_INDEX_HDR
+{
+	LIB_U64 u64Previous; //!< Offset of the previous index record, 0 for none
+	LIB_U64 u64Count;    //!< Entries that follow
+} LIB_SPOOL_INDEX_HDR;
+
+typedef struct LIB_SPOOL_INDEX_ENTRY
+{
+	LIB_U64 u64Offset;   //!< Offset of the plot record in the log
+	LIB_U64 u64TimeUs;   //!< Same as in its record header
+} LIB_SPOOL_INDEX_ENTRY;
+
+typedef struct LIB_SPOOL_TAIL
+{
+	LIB_U64 u64Index;    //!< Offset of the index record this tail ends
+	LIB_U32 u32Magic;    //!< LIB_SPOOL_TAIL_MAGIC
+	LIB_U32 u32Reserved;
+} LIB_SPOOL_TAIL;
+
+// A piece of the payload, DATA frames are gathered from the caller's buffers without copying
+typedef struct LIB_STREAM_SEG
+{
+	const LIB_CHAR* pcData;
+	LIB_U64 u64Size;
+} LIB_STREAM_SEG;
+
+// Plot request laid out by ProtocolBuildPlot(), sent by ProtocolSendPlot() or spooled
+typedef struct LIB_PLOT_REQUEST
+{
+	LIB_CHAR* pcHead;          //!< PLOT, LABELS and COLUMNS frames
+	LIB_U64 u64HeadSize;       //!< Bytes of the frames at pcHead
+	LIB_PLOT_HDR* pstPlot;     //!< Payload of the PLOT frame within pcHead
+	const LIB_STREAM_SEG* prgstSegs; //!< Pieces of the payload, pstPlot->u64PayloadSize bytes in all
+	LIB_U32 u32SegCount;
+} LIB_PLOT_REQUEST;
+
+LIB_INT32 ProtocolBuildPlot(const LIB_INPUT* pstInput, LIB_U32 u32Flags, LIB_BOOLEAN bOneBlock, LIB_PLOT_REQUEST* pstOutPlot, LIB_ERROR_INFO* pstErr);
+void ProtocolFreePlot(LIB_PLOT_REQUEST* pstPlot);
+void ProtocolColumnsExtent(const LIB_INPUT* pstInput, const void** ppvOutStart, LIB_U64* pu64OutSize);
+LIB_INT32 ProtocolSendPlot(LIB_SESSION* pstSession, const LIB_INPUT* pstInput, LIB_U32 u32Flags, LIB_INT32 nShmFd, LIB_U64 u64ShmOffset, LIB_ERROR_INFO* pstErr);
+LIB_INT32 ProtocolRecvFrame(LIB_SESSION* pstSession, LIB_FRAME_HDR* pstOutHdr, LIB_ERROR_INFO* pstErr);
+LIB_INT32 ProtocolRecvReply(LIB_SESSION* pstSession, const LIB_FRAME_HDR* pstFrame, LIB_ERROR_INFO* pstErr);
+LIB_INT32 ProtocolRecvStatus(LIB_SESSION* pstSession, LIB_ERROR_INFO* pstErr);
+LIB_INT32 ProtocolRecvResult(LIB_SESSION* pstSession, const LIB_INPUT* pstInput, LIB_ERROR_INFO* pstErr);
+LIB_INT32 ProtocolRecvReady(LIB_SESSION* pstSession, LIB_ERROR_INFO* pstErr);
+LIB_INT32 ProtocolSendStream(LIB_SESSION* pstSession, const LIB_STREAM_HDR* pstStream, const LIB_CHAR** prgszLabels, LIB_INT32 nShmFd, LIB_ERROR_INFO* pstErr);
+LIB_INT32 ProtocolSendFrame(LIB_SESSION* pstSession, LIB_U16 u16Type, LIB_ERROR_INFO* pstErr);
@@ -0,0 +1,1038 @@
+#include <errno.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "IPC_Plot_Decimate.h"
+#include "IPC_Plot_Protocol.h"
+#include "IPC_Plot_Raster.h"
+
+// Layout of _plot() in IPC_Plot.py: subplots_adjust(left=0.10, right=0.975) and the default
+// top and bottom of Matplotlib, as fractions of the figure
+#define LIB_AXES_LEFT   0.10
+#define LIB_AXES_RIGHT  0.975
+#define LIB_AXES_TOP    0.88
+#define LIB_AXES_BOTTOM 0.11
+
+// Sizes of the Matplotlib defaults in points, scaled to pixels with the dpi
+#define LIB_LINE_WIDTH_PT   1.5
+#define LIB_DOT_SIZE_PT     3.0  //!< Diameter of the "." marker
+#define LIB_THIN_WIDTH_PT   0.8  //!< Grid lines, spines and ticks
+#define LIB_MAJOR_TICK_PT   3.5
+#define LIB_MINOR_TICK_PT   2.0
+#define LIB_TICK_PAD_PT     3.5
+#define LIB_LABEL_PAD_PT    4.0
+#define LIB_TITLE_PAD_PT    6.0
+#define LIB_LEGEND_FONT_PT  8.0  //!< Unit of the legend paddings below
+#define LIB_LEGEND_PAD      0.4  //!< Border padding of the legend, in legend font sizes
+#define LIB_LEGEND_HANDLE   2.0  //!< Length of the line in front of each label
+#define LIB_LEGEND_TEXT_PAD 0.8
+#define LIB_LEGEND_SPACING  0.5
+#define LIB_LEGEND_MARGIN   0.5  //!< Between the legend and the axes
+#define LIB_LEGEND_ALPHA    205  //!< Opacity of the legend background out of 256, framealpha 0.8
+#define LIB_AXIS_MARGIN     0.05 //!< Data margin on each side of an axis
+#define LIB_MAX_TICKS       9    //!< Intervals between major ticks at most
+
+// Dash patterns of the grid, '--' for major and ':' for minor, in line widths
+#define LIB_DASH_ON   3.7
+#define LIB_DASH_OFF  1.6
+#define LIB_DOT_ON    1.0
+#define LIB_DOT_OFF   1.65
+
+#define LIB_RGB(r, g, b) ((LIB_U32)(r) | ((LIB_U32)(g) << 8) | ((LIB_U32)(b) << 16) | 0xFF000000U)
+#define LIB_COLOR_WHITE LIB_RGB(0xFF, 0xFF, 0xFF)
+#define LIB_COLOR_BLACK LIB_RGB(0x00, 0x00, 0x00)
+#define LIB_COLOR_GRID  LIB_RGB(0xCC, 0xCC, 0xCC)
+
+// Default colour cycle of Matplotlib ("tab10")
+static const LIB_U32 s_rgu32Colors[] = {
+	LIB_RGB(0x1F, 0x77, 0xB4), LIB_RGB(0xFF, 0x7F, 0x0E), LIB_RGB(0x2C, 0xA0, 0x2C), LIB_RGB(0xD6, 0x27, 0x28),
+	LIB_RGB(0x94, 0x67, 0xBD), LIB_RGB(0x8C, 0x56, 0x4B), LIB_RGB(0xE3, 0x77, 0xC2), LIB_RGB(0x7F, 0x7F, 0x7F),
+	LIB_RGB(0xBC, 0xBD, 0x22), LIB_RGB(0x17, 0xBE, 0xCF) };
+
+// Bitmap font: DejaVu Sans, the default font of Matplotlib, rendered at 13 pixels without
+// anti-aliasing for the characters 32 to 126. Bit x of a row is column x of the glyph.
+#define LIB_FONT_FIRST    32
+#define LIB_FONT_COUNT    95
+#define LIB_FONT_HEIGHT   14
+#define LIB_FONT_BASELINE 11 //!< Rows above the baseline
+#define LIB_FONT_DPI      100 //!< Resolution the font is drawn at without scaling
+
+static const LIB_U16 s_rgu16Glyphs[LIB_FONT_COUNT][LIB_FONT_HEIGHT] = {
+	{ 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000 }, // space
+	{ 0x0000, 0x0000, 0x0004, 0x0004, 0x0004, 0x0004, 0x0004, 0x0004, 0x0000, 0x0004, 0x0004, 0x0000, 0x0000, 0x0000 }, // !
+	{ 0x0000, 0x0000, 0x000A, 0x000A, 0x000A, 0x000A, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000 }, // "
+	{ 0x0000, 0x0120, 0x0090, 0x0090, 0x03FC, 0x0090, 0x0048, 0x01FE, 0x0048, 0x0048, 0x002C, 0x0000, 0x0000, 0x0000 }, // #
+	{ 0x0000, 0x0000, 0x0010, 0x007C, 0x0092, 0x0012, 0x001C, 0x00F0, 0x0090, 0x0092, 0x007C, 0x0010, 0x0010, 0x0000 }, // $
+	{ 0x0000, 0x0000, 0x0106, 0x0089, 0x0049, 0x0049, 0x0326, 0x0490, 0x0490, 0x0488, 0x0304, 0x0000, 0x0000, 0x0000 }, // %
+	{ 0x0000, 0x0000, 0x0038, 0x0044, 0x0004, 0x0008, 0x0214, 0x0222, 0x0142, 0x0186, 0x027C, 0x0000, 0x0000, 0x0000 }, // &
+	{ 0x0000, 0x0000, 0x0002, 0x0002, 0x0002, 0x0002, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000 }, // quote
+	{ 0x000C, 0x0004, 0x0004, 0x0002, 0x0002, 0x0002, 0x0002, 0x0002, 0x0002, 0x0004, 0x0004, 0x0008, 0x0000, 0x0000 }, // (
+	{ 0x0002, 0x0004, 0x0004, 0x0008, 0x0008, 0x0008, 0x0008, 0x0008, 0x0008, 0x0004, 0x0004, 0x0002, 0x0000, 0x0000 }, // )
+	{ 0x0000, 0x0000, 0x0008, 0x0049, 0x003E, 0x001C, 0x006B, 0x0008, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000 }, // *
+	{ 0x0000, 0x0000, 0x0020, 0x0020, 0x0020, 0x0020, 0x03FE, 0x0020, 0x0020, 0x0020, 0x0020, 0x0000, 0x0000, 0x0000 }, // +
+	{ 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0004, 0x0004, 0x0002, 0x0000, 0x0000 }, // ,
+	{ 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x000E, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000 }, // -
+	{ 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0004, 0x0004, 0x0000, 0x0000, 0x0000 }, // .
+	{ 0x0000, 0x0000, 0x0008, 0x0008, 0x0004, 0x0004, 0x0004, 0x0006, 0x0002, 0x0002, 0x0002, 0x0001, 0x0001, 0x0000 }, // /
+	{ 0x0000, 0x0000, 0x003C, 0x0024, 0x0042, 0x0042, 0x0042, 0x0042, 0x0042, 0x0024, 0x003C, 0x0000, 0x0000, 0x0000 }, // 0
+	{ 0x0000, 0x0000, 0x001C, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x007C, 0x0000, 0x0000, 0x0000 }, // 1
+	{ 0x0000, 0x0000, 0x003C, 0x0062, 0x0040, 0x0040, 0x0020, 0x0010, 0x0008, 0x0004, 0x007E, 0x0000, 0x0000, 0x0000 }, // 2
+	{ 0x0000, 0x0000, 0x003C, 0x0042, 0x0040, 0x0040, 0x0038, 0x0040, 0x0040, 0x0042, 0x003C, 0x0000, 0x0000, 0x0000 }, // 3
+	{ 0x0000, 0x0000, 0x0030, 0x0028, 0x0028, 0x0024, 0x0024, 0x0022, 0x007E, 0x0020, 0x0020, 0x0000, 0x0000, 0x0000 }, // 4
+	{ 0x0000, 0x0000, 0x003E, 0x0002, 0x0002, 0x003E, 0x0060, 0x0040, 0x0040, 0x0062, 0x003C, 0x0000, 0x0000, 0x0000 }, // 5
+	{ 0x0000, 0x0000, 0x0038, 0x0044, 0x0002, 0x003A, 0x0066, 0x0042, 0x0042, 0x0064, 0x003C, 0x0000, 0x0000, 0x0000 }, // 6
+	{ 0x0000, 0x0000, 0x007E, 0x0040, 0x0020, 0x0020, 0x0010, 0x0010, 0x0008, 0x0008, 0x0004, 0x0000, 0x0000, 0x0000 }, // 7
+	{ 0x0000, 0x0000, 0x003C, 0x0042, 0x0042, 0x0042, 0x003C, 0x0042, 0x0042, 0x0042, 0x003C, 0x0000, 0x0000, 0x0000 }, // 8
+	{ 0x0000, 0x0000, 0x003C, 0x0026, 0x0042, 0x0042, 0x0066, 0x005C, 0x0040, 0x0022, 0x001C, 0x0000, 0x0000, 0x0000 }, // 9
+	{ 0x0000, 0x0000, 0x0000, 0x0000, 0x0004, 0x0004, 0x0000, 0x0000, 0x0000, 0x0004, 0x0004, 0x0000, 0x0000, 0x0000 }, // :
+	{ 0x0000, 0x0000, 0x0000, 0x0000, 0x0004, 0x0004, 0x0000, 0x0000, 0x0000, 0x0004, 0x0004, 0x0002, 0x0000, 0x0000 }, // ;
+	{ 0x0000, 0x0000, 0x0000, 0x0100, 0x00E0, 0x001C, 0x0002, 0x001C, 0x00E0, 0x0100, 0x0000, 0x0000, 0x0000, 0x0000 }, // <
+	{ 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x01FE, 0x0000, 0x0000, 0x01FE, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000 }, // =
+	{ 0x0000, 0x0000, 0x0000, 0x0002, 0x001C, 0x00E0, 0x0100, 0x00E0, 0x001C, 0x0002, 0x0000, 0x0000, 0x0000, 0x0000 }, // >
+	{ 0x0000, 0x0000, 0x001C, 0x0022, 0x0020, 0x0010, 0x0008, 0x0008, 0x0000, 0x0008, 0x0008, 0x0000, 0x0000, 0x0000 }, // ?
+	{ 0x0000, 0x0000, 0x01F0, 0x0608, 0x0404, 0x09E2, 0x0912, 0x0912, 0x0512, 0x03E2, 0x0004, 0x0208, 0x01F0, 0x0000 }, // @
+	{ 0x0000, 0x0000, 0x0010, 0x0028, 0x0028, 0x0044, 0x0044, 0x00FE, 0x0082, 0x0082, 0x0101, 0x0000, 0x0000, 0x0000 }, // A
+	{ 0x0000, 0x0000, 0x007E, 0x0082, 0x0082, 0x0082, 0x007E, 0x0082, 0x0082, 0x0082, 0x007E, 0x0000, 0x0000, 0x0000 }, // B
+	{ 0x0000, 0x0000, 0x0078, 0x0084, 0x0002, 0x0002, 0x0002, 0x0002, 0x0002, 0x0084, 0x0078, 0x0000, 0x0000, 0x0000 }, // C
+	{ 0x0000, 0x0000, 0x007E, 0x00C2, 0x0102, 0x0102, 0x0102, 0x0102, 0x0102, 0x00C2, 0x007E, 0x0000, 0x0000, 0x0000 }, // D
+	{ 0x0000, 0x0000, 0x007E, 0x0002, 0x0002, 0x0002, 0x007E, 0x0002, 0x0002, 0x0002, 0x007E, 0x0000, 0x0000, 0x0000 }, // E
+	{ 0x0000, 0x0000, 0x003E, 0x0002, 0x0002, 0x0002, 0x003E, 0x0002, 0x0002, 0x0002, 0x0002, 0x0000, 0x0000, 0x0000 }, // F
+	{ 0x0000, 0x0000, 0x00F8, 0x0104, 0x0002, 0x0002, 0x01C2, 0x0102, 0x0102, 0x0104, 0x00F8, 0x0000, 0x0000, 0x0000 }, // G
+	{ 0x0000, 0x0000, 0x0102, 0x0102, 0x0102, 0x0102, 0x01FE, 0x0102, 0x0102, 0x0102, 0x0102, 0x0000, 0x0000, 0x0000 }, // H
+	{ 0x0000, 0x0000, 0x0002, 0x0002, 0x0002, 0x0002, 0x0002, 0x0002, 0x0002, 0x0002, 0x0002, 0x0000, 0x0000, 0x0000 }, // I
+	{ 0x0000, 0x0000, 0x0002, 0x0002, 0x0002, 0x0002, 0x0002, 0x0002, 0x0002, 0x0002, 0x0002, 0x0002, 0x0002, 0x0001 }, // J
+	{ 0x0000, 0x0000, 0x0042, 0x0022, 0x0012, 0x000A, 0x0006, 0x000A, 0x0012, 0x0022, 0x0042, 0x0000, 0x0000, 0x0000 }, // K
+	{ 0x0000, 0x0000, 0x0002, 0x0002, 0x0002, 0x0002, 0x0002, 0x0002, 0x0002, 0x0002, 0x007E, 0x0000, 0x0000, 0x0000 }, // L
+	{ 0x0000, 0x0000, 0x0306, 0x0306, 0x028A, 0x028A, 0x0252, 0x0252, 0x0222, 0x0202, 0x0202, 0x0000, 0x0000, 0x0000 }, // M
+	{ 0x0000, 0x0000, 0x0106, 0x0106, 0x010A, 0x0112, 0x0132, 0x0122, 0x0142, 0x0182, 0x0182, 0x0000, 0x0000, 0x0000 }, // N
+	{ 0x0000, 0x0000, 0x0078, 0x0084, 0x0102, 0x0102, 0x0102, 0x0102, 0x0102, 0x0084, 0x0078, 0x0000, 0x0000, 0x0000 }, // O
+	{ 0x0000, 0x0000, 0x003E, 0x0062, 0x0042, 0x0042, 0x0062, 0x003E, 0x0002, 0x0002, 0x0002, 0x0000, 0x0000, 0x0000 }, // P
+	{ 0x0000, 0x0000, 0x0078, 0x0084, 0x0102, 0x0102, 0x0102, 0x0102, 0x0102, 0x0084, 0x0078, 0x0040, 0x0080, 0x0000 }, // Q
+	{ 0x0000, 0x0000, 0x003E, 0x0042, 0x0042, 0x0042, 0x003E, 0x0022, 0x0042, 0x0042, 0x0082, 0x0000, 0x0000, 0x0000 }, // R
+	{ 0x0000, 0x0000, 0x007C, 0x0086, 0x0002, 0x0006, 0x007C, 0x00C0, 0x0080, 0x00C2, 0x007C, 0x0000, 0x0000, 0x0000 }, // S
+	{ 0x0000, 0x0000, 0x007F, 0x0008, 0x0008, 0x0008, 0x0008, 0x0008, 0x0008, 0x0008, 0x0008, 0x0000, 0x0000, 0x0000 }, // T
+	{ 0x0000, 0x0000, 0x0102, 0x0102, 0x0102, 0x0102, 0x0102, 0x0102, 0x0102, 0x0186, 0x0078, 0x0000, 0x0000, 0x0000 }, // U
+	{ 0x0000, 0x0000, 0x0080, 0x0080, 0x0041, 0x0041, 0x0022, 0x0022, 0x0014, 0x0014, 0x0008, 0x0000, 0x0000, 0x0000 }, // V
+	{ 0x0000, 0x0000, 0x0210, 0x0210, 0x0111, 0x0129, 0x0129, 0x00AA, 0x00AA, 0x0044, 0x0044, 0x0000, 0x0000, 0x0000 }, // W
+	{ 0x0000, 0x0000, 0x00C3, 0x0042, 0x0024, 0x0018, 0x0018, 0x0018, 0x0024, 0x0042, 0x00C3, 0x0000, 0x0000, 0x0000 }, // X
+	{ 0x0000, 0x0000, 0x0041, 0x0022, 0x0022, 0x0014, 0x0014, 0x0008, 0x0008, 0x0008, 0x0008, 0x0000, 0x0000, 0x0000 }, // Y
+	{ 0x0000, 0x0000, 0x01FE, 0x0080, 0x0040, 0x0020, 0x0020, 0x0010, 0x0008, 0x0004, 0x01FE, 0x0000, 0x0000, 0x0000 }, // Z
+	{ 0x0000, 0x000E, 0x0002, 0x0002, 0x0002, 0x0002, 0x0002, 0x0002, 0x0002, 0x0002, 0x0002, 0x0002, 0x000E, 0x0000 }, // [
+	{ 0x0000, 0x0000, 0x0001, 0x0001, 0x0002, 0x0002, 0x0002, 0x0006, 0x0004, 0x0004, 0x0004, 0x0008, 0x0008, 0x0000 }, // backslash
+	{ 0x0000, 0x000E, 0x0008, 0x0008, 0x0008, 0x0008, 0x0008, 0x0008, 0x0008, 0x0008, 0x0008, 0x0008, 0x000E, 0x0000 }, // ]
+	{ 0x0000, 0x0000, 0x0030, 0x0078, 0x00CC, 0x0186, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000 }, // ^
+	{ 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x007F }, // _
+	{ 0x0000, 0x0004, 0x0008, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000 }, // `
+	{ 0x0000, 0x0000, 0x0000, 0x0000, 0x003C, 0x0042, 0x0040, 0x007C, 0x0042, 0x0062, 0x005C, 0x0000, 0x0000, 0x0000 }, // a
+	{ 0x0002, 0x0002, 0x0002, 0x0002, 0x003E, 0x0066, 0x0042, 0x0042, 0x0042, 0x0066, 0x003E, 0x0000, 0x0000, 0x0000 }, // b
+	{ 0x0000, 0x0000, 0x0000, 0x0000, 0x001C, 0x0026, 0x0002, 0x0002, 0x0002, 0x0026, 0x001C, 0x0000, 0x0000, 0x0000 }, // c
+	{ 0x0040, 0x0040, 0x0040, 0x0040, 0x007C, 0x0066, 0x0042, 0x0042, 0x0042, 0x0066, 0x007C, 0x0000, 0x0000, 0x0000 }, // d
+	{ 0x0000, 0x0000, 0x0000, 0x0000, 0x003C, 0x0066, 0x0042, 0x007E, 0x0002, 0x0046, 0x003C, 0x0000, 0x0000, 0x0000 }, // e
+	{ 0x000C, 0x0002, 0x0002, 0x0002, 0x000F, 0x0002, 0x0002, 0x0002, 0x0002, 0x0002, 0x0002, 0x0000, 0x0000, 0x0000 }, // f
+	{ 0x0000, 0x0000, 0x0000, 0x0000, 0x007C, 0x0066, 0x0042, 0x0042, 0x0042, 0x0066, 0x007C, 0x0040, 0x0064, 0x0038 }, // g
+	{ 0x0002, 0x0002, 0x0002, 0x0002, 0x003A, 0x0046, 0x0042, 0x0042, 0x0042, 0x0042, 0x0042, 0x0000, 0x0000, 0x0000 }, // h
+	{ 0x0000, 0x0002, 0x0000, 0x0000, 0x0002, 0x0002, 0x0002, 0x0002, 0x0002, 0x0002, 0x0002, 0x0000, 0x0000, 0x0000 }, // i
+	{ 0x0000, 0x0002, 0x0000, 0x0000, 0x0002, 0x0002, 0x0002, 0x0002, 0x0002, 0x0002, 0x0002, 0x0002, 0x0002, 0x0003 }, // j
+	{ 0x0002, 0x0002, 0x0002, 0x0002, 0x0022, 0x0012, 0x000A, 0x0006, 0x000A, 0x0012, 0x0022, 0x0000, 0x0000, 0x0000 }, // k
+	{ 0x0002, 0x0002, 0x0002, 0x0002, 0x0002, 0x0002, 0x0002, 0x0002, 0x0002, 0x0002, 0x0002, 0x0000, 0x0000, 0x0000 }, // l
+	{ 0x0000, 0x0000, 0x0000, 0x0000, 0x073A, 0x08C6, 0x0842, 0x0842, 0x0842, 0x0842, 0x0842, 0x0000, 0x0000, 0x0000 }, // m
+	{ 0x0000, 0x0000, 0x0000, 0x0000, 0x003A, 0x0046, 0x0042, 0x0042, 0x0042, 0x0042, 0x0042, 0x0000, 0x0000, 0x0000 }, // n
+	{ 0x0000, 0x0000, 0x0000, 0x0000, 0x003C, 0x0066, 0x0042, 0x0042, 0x0042, 0x0066, 0x003C, 0x0000, 0x0000, 0x0000 }, // o
+	{ 0x0000, 0x0000, 0x0000, 0x0000, 0x003E, 0x0066, 0x0042, 0x0042, 0x0042, 0x0066, 0x003E, 0x0002, 0x0002, 0x0002 }, // p
+	{ 0x0000, 0x0000, 0x0000, 0x0000, 0x007C, 0x0066, 0x0042, 0x0042, 0x0042, 0x0066, 0x007C, 0x0040, 0x0040, 0x0040 }, // q
+	{ 0x0000, 0x0000, 0x0000, 0x0000, 0x001A, 0x0006, 0x0002, 0x0002, 0x0002, 0x0002, 0x0002, 0x0000, 0x0000, 0x0000 }, // r
+	{ 0x0000, 0x0000, 0x0000, 0x0000, 0x001C, 0x0022, 0x0002, 0x001C, 0x0020, 0x0022, 0x001C, 0x0000, 0x0000, 0x0000 }, // s
+	{ 0x0000, 0x0000, 0x0002, 0x0002, 0x000F, 0x0002, 0x0002, 0x0002, 0x0002, 0x0002, 0x000E, 0x0000, 0x0000, 0x0000 }, // t
+	{ 0x0000, 0x0000, 0x0000, 0x0000, 0x0042, 0x0042, 0x0042, 0x0042, 0x0042, 0x0062, 0x005C, 0x0000, 0x0000, 0x0000 }, // u
+	{ 0x0000, 0x0000, 0x0000, 0x0000, 0x0020, 0x0020, 0x0011, 0x0011, 0x000A, 0x000A, 0x0004, 0x0000, 0x0000, 0x0000 }, // v
+	{ 0x0000, 0x0000, 0x0000, 0x0000, 0x0111, 0x0111, 0x0092, 0x00AA, 0x00AA, 0x0044, 0x0044, 0x0000, 0x0000, 0x0000 }, // w
+	{ 0x0000, 0x0000, 0x0000, 0x0000, 0x0041, 0x0022, 0x0014, 0x0008, 0x0014, 0x0022, 0x0041, 0x0000, 0x0000, 0x0000 }, // x
+	{ 0x0000, 0x0000, 0x0000, 0x0000, 0x0041, 0x0022, 0x0022, 0x0014, 0x0014, 0x0008, 0x0008, 0x0004, 0x0004, 0x0003 }, // y
+	{ 0x0000, 0x0000, 0x0000, 0x0000, 0x003E, 0x0020, 0x0010, 0x0008, 0x0004, 0x0002, 0x003E, 0x0000, 0x0000, 0x0000 }, // z
+	{ 0x0000, 0x0070, 0x0010, 0x0010, 0x0010, 0x0010, 0x000C, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0060, 0x0000 }, // {
+	{ 0x0000, 0x0004, 0x0004, 0x0004, 0x0004, 0x0004, 0x0004, 0x0004, 0x0004, 0x0004, 0x0004, 0x0004, 0x0004, 0x0004 }, // |
+	{ 0x0000, 0x001C, 0x0010, 0x0010, 0x0010, 0x0010, 0x0060, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x000C, 0x0000 }, // }
+	{ 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x011C, 0x00E2, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000 }, // ~
+};
+
+// Advance of each glyph in pixels
+static const LIB_CHAR s_rgcAdvance[LIB_FONT_COUNT] = {
+	4, 5, 6, 11, 8, 12, 10, 4, 5, 5, 7, 11, 4, 5, 4, 4,
+	8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 4, 4, 11, 11, 11, 7,
+	13, 9, 9, 9, 10, 8, 7, 10, 10, 4, 4, 9, 7, 11, 10, 10,
+	8, 10, 9, 8, 8, 10, 9, 13, 9, 8, 9, 5, 4, 5, 11, 7,
+	7, 8, 8, 7, 8, 8, 5, 8, 8, 4, 4, 8, 4, 13, 8, 8,
+	8, 8, 5, 7, 5, 8, 8, 11, 8, 8, 7, 8, 4, 8, 11
+};
+
+// RGBA image being drawn, with the rectangle drawing is clipped to
+typedef struct LIB_CANVAS
+{
+	LIB_U32* prgu32Pixels;  //!< 0xAABBGGRR, rows from the top
+	LIB_INT32 nWidth;
+	LIB_INT32 nHeight;
+	LIB_INT32 nClipLeft;    //!< Clip rectangle, right and bottom excluded
+	LIB_INT32 nClipTop;
+	LIB_INT32 nClipRight;
+	LIB_INT32 nClipBottom;
+	LIB_DOUBLE dPxPerPt;    //!< dpi / 72
+	LIB_INT32 nFontScale;   //!< Pixels per font pixel
+} LIB_CANVAS;
+
+// Data limits and ticks of one axis, mapped onto pixels
+typedef struct LIB_AXIS
+{
+	LIB_DOUBLE dMin;
+	LIB_DOUBLE dMax;
+	LIB_DOUBLE dStep;       //!< Between major ticks
+	LIB_U32 u32MinorDivs;   //!< Minor intervals per major interval
+	LIB_INT32 nDecimals;    //!< Of the tick labels, -1 for %g
+	LIB_DOUBLE dPxMin;      //!< Pixel of dMin, the bottom of the Y axis
+	LIB_DOUBLE dPxMax;      //!< Pixel of dMax
+} LIB_AXIS;
+
+// One line of the figure, X NULL for the row number
+typedef struct LIB_SERIES
+{
+	const LIB_DOUBLE* prgdX;
+	const LIB_DOUBLE* prgdY;
+} LIB_SERIES;
+
+static void SetClip(LIB_CANVAS* pstCanvas, LIB_INT32 nLeft, LIB_INT32 nTop, LIB_INT32 nRight, LIB_INT32 nBottom)
+{
+	pstCanvas->nClipLeft = (nLeft > 0) ? nLeft : 0;
+	pstCanvas->nClipTop = (nTop > 0) ? nTop : 0;
+	pstCanvas->nClipRight = (nRight < pstCanvas->nWidth) ? nRight : pstCanvas->nWidth;
+	pstCanvas->nClipBottom = (nBottom < pstCanvas->nHeight) ? nBottom : pstCanvas->nHeight;
+}
+
+static LIB_INT32 ToPixels(const LIB_CANVAS* pstCanvas, LIB_DOUBLE dPoints)
+{
+	LIB_INT32 nPixels = (LIB_INT32)(dPoints * pstCanvas->dPxPerPt + 0.5);
+	return (nPixels > 0) ? nPixels : 1;
+}
+
+/***************************************************************************//**
+ * FillRect
+ *
+ * Fills a rectangle, clipped, with a colour blended over the pixels
+ *
+ * @param pstCanvas Image
+ * @param nLeft     Left column
+ * @param nTop      Top row
+ * @param nRight    Right column, excluded
+ * @param nBottom   Bottom row, excluded
+ * @param u32Color  0xAABBGGRR, the alpha is ignored
+ * @param u32Alpha  Opacity out of 256, 256 replaces the pixels
+ ******************************************************************************/
+static void FillRect(LIB_CANVAS* pstCanvas, LIB_INT32 nLeft, LIB_INT32 nTop, LIB_INT32 nRight, LIB_INT32 nBottom,
+	LIB_U32 u32Color, LIB_U32 u32Alpha)
+{
+	nLeft = (nLeft > pstCanvas->nClipLeft) ? nLeft : pstCanvas->nClipLeft;
+	nTop = (nTop > pstCanvas->nClipTop) ? nTop : pstCanvas->nClipTop;
+	nRight = (nRight < pstCanvas->nClipRight) ? nRight : pstCanvas->nClipRight;
+	nBottom = (nBottom < pstCanvas->nClipBottom) ? nBottom : pstCanvas->nClipBottom;
+	for (LIB_INT32 nY = nTop; nY < nBottom; nY++)
+	{
+		LIB_U32* prgu32Row = pstCanvas->prgu32Pixels + (LIB_U64)nY * pstCanvas->nWidth;
+		for (LIB_INT32 nX = nLeft; nX < nRight; nX++)
+		{
+			if (u32Alpha >= 256)
+			{
+				prgu32Row[nX] = u32Color;
+				continue;
+			}
+			// Per channel, the image stays opaque
+			LIB_U32 u32Old = prgu32Row[nX];
+			LIB_U32 u32New = 0xFF000000U;
+			for (LIB_U32 u32Shift = 0; u32Shift < 24; u32Shift += 8)
+			{
+				LIB_U32 u32A = (u32Old >> u32Shift) & 0xFF;
+				LIB_U32 u32B = (u32Color >> u32Shift) & 0xFF;
+				u32New |= ((u32A * (256 - u32Alpha) + u32B * u32Alpha) >> 8) << u32Shift;
+			}
+			prgu32Row[nX] = u32New;
+		}
+	}
+}
+
+/***************************************************************************//**
+ * DrawDashed
+ *
+ * Draws a horizontal or vertical line with a dash pattern
+ *
+ * @param pstCanvas Image
+ * @param bVertical LIB_TRUE for a vertical line
+ * @param nAt       Row of a horizontal line, column of a vertical one
+ * @param nFrom     First pixel along the line
+ * @param nTo       Last pixel along the line, excluded
+ * @param nWidth    Thickness in pixels
+ * @param dOn       Dash length in pixels, 0 for a solid line
+ * @param dOff      Gap length in pixels
+ * @param u32Color  Colour of the line
+ ******************************************************************************/
+static void DrawDashed(LIB_CANVAS* pstCanvas, LIB_BOOLEAN bVertical, LIB_INT32 nAt, LIB_INT32 nFrom, LIB_INT32 nTo,
+	LIB_INT32 nWidth, LIB_DOUBLE dOn, LIB_DOUBLE dOff, LIB_U32 u32Color)
+{
+	LIB_INT32 nSide = nAt - nWidth / 2;
+	LIB_DOUBLE dPeriod = dOn + dOff;
+	for (LIB_DOUBLE dStart = nFrom; dStart < nTo; dStart += (dOn > 0.0) ? dPeriod : nTo - nFrom)
+	{
+		LIB_INT32 nStart = (LIB_INT32)(dStart + 0.5);
+		LIB_INT32 nEnd = (dOn > 0.0) ? (LIB_INT32)(dStart + dOn + 0.5) : nTo;
+		nEnd = (nEnd < nTo) ? nEnd : nTo;
+		if (nEnd <= nStart)
+		{
+			nEnd = nStart + 1;
+		}
+		if (bVertical)
+		{
+			FillRect(pstCanvas, nSide, nStart, nSide + nWidth, nEnd, u32Color, 256);
+		}
+		else
+		{
+			FillRect(pstCanvas, nStart, nSide, nEnd, nSide + nWidth, u32Color, 256);
+		}
+	}
+}
+
+/***************************************************************************//**
+ * ClipSegment
+ *
+ * Clips a segment to a rectangle (Liang-Barsky), so that segments far
+ * outside the axes are not walked pixel by pixel
+ *
+ * @param prgdSegment X0, Y0, X1, Y1, updated
+ * @param prgdRect    Left, top, right, bottom
+ * @return            LIB_FALSE if nothing of the segment is left
+ ******************************************************************************/
+static LIB_BOOLEAN ClipSegment(LIB_DOUBLE* prgdSegment, const LIB_DOUBLE* prgdRect)
+{
+	LIB_DOUBLE dDx = prgdSegment[2] - prgdSegment[0];
+	LIB_DOUBLE dDy = prgdSegment[3] - prgdSegment[1];
+	LIB_DOUBLE rgdP[4] = { -dDx, dDx, -dDy, dDy };
+	LIB_DOUBLE rgdQ[4] = { prgdSegment[0] - prgdRect[0], prgdRect[2] - prgdSegment[0],
+		prgdSegment[1] - prgdRect[1], prgdRect[3] - prgdSegment[1] };
+	LIB_DOUBLE dT0 = 0.0;
+	LIB_DOUBLE dT1 = 1.0;
+	for (LIB_U32 u32Edge = 0; u32Edge < 4; u32Edge++)
+	{
+		if (rgdP[u32Edge] == 0.0)
+		{
+			if (rgdQ[u32Edge] < 0.0)
+			{
+				return LIB_FALSE;
+			}
+			continue;
+		}
+		LIB_DOUBLE dT = rgdQ[u32Edge] / rgdP[u32Edge];
+		if (rgdP[u32Edge] < 0.0)
+		{
+			dT0 = (dT > dT0) ? dT : dT0;
+		}
+		else
+		{
+			dT1 = (dT < dT1) ? dT : dT1;
+		}
+		if (dT0 > dT1)
+		{
+			return LIB_FALSE;
+		}
+	}
+	prgdSegment[2] = prgdSegment[0] + dDx * dT1;
+	prgdSegment[3] = prgdSegment[1] + dDy * dT1;
+	prgdSegment[0] += dDx * dT0;
+	prgdSegment[1] += dDy * dT0;
+	return LIB_TRUE;
+}
+
+/***************************************************************************//**
+ * DrawSegment
+ *
+ * Draws a thick line segment with a square pen, one pen step per pixel
+ * along its longer direction
+ *
+ * @param pstCanvas Image, clipped to the axes
+ * @param prgdPoint X0, Y0, X1, Y1 in pixels
+ * @param nWidth    Pen size in pixels
+ * @param u32Color  Colour of the line
+ ******************************************************************************/
+static void DrawSegment(LIB_CANVAS* pstCanvas, const LIB_DOUBLE* prgdPoint, LIB_INT32 nWidth, LIB_U32 u32Color)
+{
+	LIB_DOUBLE rgdSegment[4] = { prgdPoint[0], prgdPoint[1], prgdPoint[2], prgdPoint[3] };
+	LIB_DOUBLE rgdRect[4] = { (LIB_DOUBLE)pstCanvas->nClipLeft - nWidth, (LIB_DOUBLE)pstCanvas->nClipTop - nWidth,
+		(LIB_DOUBLE)pstCanvas->nClipRight + nWidth, (LIB_DOUBLE)pstCanvas->nClipBottom + nWidth };
+	if (!ClipSegment(rgdSegment, rgdRect))
+	{
+		return;
+	}
+	LIB_DOUBLE dDx = rgdSegment[2] - rgdSegment[0];
+	LIB_DOUBLE dDy = rgdSegment[3] - rgdSegment[1];
+	LIB_DOUBLE dLength = (fabs(dDx) > fabs(dDy)) ? fabs(dDx) : fabs(dDy);
+	LIB_INT32 nSteps = (LIB_INT32)ceil(dLength);
+	LIB_DOUBLE dHalf = nWidth * 0.5;
+	for (LIB_INT32 nStep = 0; nStep <= nSteps; nStep++)
+	{
+		LIB_DOUBLE dT = (nSteps > 0) ? (LIB_DOUBLE)nStep / nSteps : 0.0;
+		LIB_INT32 nX = (LIB_INT32)floor(rgdSegment[0] + dDx * dT - dHalf + 0.5);
+		LIB_INT32 nY = (LIB_INT32)floor(rgdSegment[1] + dDy * dT - dHalf + 0.5);
+		FillRect(pstCanvas, nX, nY, nX + nWidth, nY + nWidth, u32Color, 256);
+	}
+}
+
+static void DrawDot(LIB_CANVAS* pstCanvas, LIB_DOUBLE dX, LIB_DOUBLE dY, LIB_DOUBLE dRadius, LIB_U32 u32Color)
+{
+	LIB_INT32 nTop = (LIB_INT32)floor(dY - dRadius);
+	LIB_INT32 nBottom = (LIB_INT32)ceil(dY + dRadius);
+	for (LIB_INT32 nY = nTop; nY <= nBottom; nY++)
+	{
+		LIB_DOUBLE dRow = nY + 0.5 - dY;
+		LIB_DOUBLE dSpan = dRadius * dRadius - dRow * dRow;
+		if (dSpan < 0.0)
+		{
+			continue;
+		}
+		dSpan = sqrt(dSpan);
+		FillRect(pstCanvas, (LIB_INT32)floor(dX - dSpan + 0.5), nY, (LIB_INT32)floor(dX + dSpan + 0.5), nY + 1, u32Color, 256);
+	}
+}
+
+static LIB_INT32 GetGlyph(LIB_CHAR cChar)
+{
+	LIB_INT32 nGlyph = (unsigned char)cChar - LIB_FONT_FIRST;
+	return (nGlyph >= 0 && nGlyph < LIB_FONT_COUNT) ? nGlyph : '?' - LIB_FONT_FIRST;
+}
+
+static LIB_INT32 TextWidth(const LIB_CANVAS* pstCanvas, const LIB_CHAR* pszText)
+{
+	LIB_INT32 nWidth = 0;
+	for (const LIB_CHAR* pcChar = pszText; *pcChar != '\0'; pcChar++)
+	{
+		nWidth += s_rgcAdvance[GetGlyph(*pcChar)];
+	}
+	return nWidth * pstCanvas->nFontScale;
+}
+
+static LIB_INT32 TextHeight(const LIB_CANVAS* pstCanvas)
+{
+	return LIB_FONT_HEIGHT * pstCanvas->nFontScale;
+}
+
+/***************************************************************************//**
+ * DrawText
+ *
+ * Draws a line of text with the bitmap font, each font pixel scaled to a
+ * square of nFontScale pixels. Characters outside ASCII are drawn as '?'.
+ *
+ * @param pstCanvas Image
+ * @param nLeft     Left of the first glyph
+ * @param nTop      Top of the glyphs, the baseline is LIB_FONT_BASELINE rows below
+ * @param pszText   Text to draw
+ * @param u32Color  Colour of the text
+ ******************************************************************************/
+static void DrawText(LIB_CANVAS* pstCanvas, LIB_INT32 nLeft, LIB_INT32 nTop, const LIB_CHAR* pszText, LIB_U32 u32Color)
+{
+	LIB_INT32 nScale = pstCanvas->nFontScale;
+	for (const LIB_CHAR* pcChar = pszText; *pcChar != '\0'; pcChar++)
+	{
+		LIB_INT32 nGlyph = GetGlyph(*pcChar);
+		for (LIB_INT32 nRow = 0; nRow < LIB_FONT_HEIGHT; nRow++)
+		{
+			LIB_U32 u32Bits = s_rgu16Glyphs[nGlyph][nRow];
+			for (LIB_INT32 nCol = 0; u32Bits != 0; nCol++, u32Bits >>= 1)
+			{
+				if (u32Bits & 1)
+				{
+					LIB_INT32 nX = nLeft + nCol * nScale;
+					LIB_INT32 nY = nTop + nRow * nScale;
+					FillRect(pstCanvas, nX, nY, nX + nScale, nY + nScale, u32Color, 256);
+				}
+			}
+		}
+		nLeft += s_rgcAdvance[nGlyph] * nScale;
+	}
+}
+
+/***************************************************************************//**
+ * SetupAxis
+ *
+ * Sets the limits of an axis from its data, with the margins and the tick
+ * steps (1, 2, 2.5 or 5 times a power of 10) of the Matplotlib defaults
+ *
+ * @param dLow     Smallest finite value, or NaN without data
+ * @param dHigh    Largest finite value
+ * @param dPxMin   Pixel of the low end of the axis
+ * @param dPxMax   Pixel of the high end of the axis
+ * @param pstAxis  Receives the axis
+ ******************************************************************************/
+static void SetupAxis(LIB_DOUBLE dLow, LIB_DOUBLE dHigh, LIB_DOUBLE dPxMin, LIB_DOUBLE dPxMax, LIB_AXIS* pstAxis)
+{
+	static const LIB_DOUBLE s_rgdMantissas[] = { 1.0, 2.0, 2.5, 5.0, 10.0 };
+
+	if (!(dLow <= dHigh))
+	{
+		// No data, the empty axes of Matplotlib
+		dLow = 0.0;
+		dHigh = 1.0;
+	}
+	else
+	{
+		if (dHigh - dLow <= 1e-12 * ((fabs(dLow) > fabs(dHigh)) ? fabs(dLow) : fabs(dHigh)))
+		{
+			// A single value is widened by 5% of itself, or to +/-0.05 around 0
+			LIB_DOUBLE dWiden = (dHigh == 0.0) ? 0.05 : 0.05 * fabs(dHigh);
+			dLow -= dWiden;
+			dHigh += dWiden;
+		}
+		LIB_DOUBLE dMargin = (dHigh - dLow) * LIB_AXIS_MARGIN;
+		dLow -= dMargin;
+		dHigh += dMargin;
+	}
+	pstAxis->dMin = dLow;
+	pstAxis->dMax = dHigh;
+	pstAxis->dPxMin = dPxMin;
+	pstAxis->dPxMax = dPxMax;
+
+	LIB_DOUBLE dRaw = (dHigh - dLow) / LIB_MAX_TICKS;
+	LIB_DOUBLE dMagnitude = pow(10.0, floor(log10(dRaw)));
+	LIB_DOUBLE dMantissa = 10.0;
+	for (LIB_U32 u32Index = 0; u32Index < sizeof(s_rgdMantissas) / sizeof(s_rgdMantissas[0]); u32Index++)
+	{
+		if (s_rgdMantissas[u32Index] * dMagnitude >= dRaw * (1.0 - 1e-9))
+		{
+			dMantissa = s_rgdMantissas[u32Index];
+			break;
+		}
+	}
+	pstAxis->dStep = dMantissa * dMagnitude;
+	pstAxis->u32MinorDivs = (dMantissa == 2.0 || dMantissa == 2.5) ? 4 : 5;
+
+	// Enough decimals to tell the ticks apart, 2.5 needs one more than its power of 10
+	LIB_INT32 nExponent = (LIB_INT32)floor(log10(pstAxis->dStep) + 1e-9);
+	LIB_INT32 nDecimals = -nExponent + ((dMantissa == 2.5) ? 1 : 0);
+	pstAxis->nDecimals = (nDecimals > 0) ? nDecimals : 0;
+	LIB_DOUBLE dLargest = (fabs(dLow) > fabs(dHigh)) ? fabs(dLow) : fabs(dHigh);
+	if (dLargest >= 1e6 || pstAxis->nDecimals > 6)
+	{
+		pstAxis->nDecimals = -1;
+	}
+}
+
+static LIB_DOUBLE AxisToPixel(const LIB_AXIS* pstAxis, LIB_DOUBLE dValue)
+{
+	return pstAxis->dPxMin + (dValue - pstAxis->dMin) / (pstAxis->dMax - pstAxis->dMin) * (pstAxis->dPxMax - pstAxis->dPxMin);
+}
+
+static void FormatTick(const LIB_AXIS* pstAxis, LIB_DOUBLE dValue, LIB_CHAR* pszOut, size_t szSize)
+{
+	// No "-0" for a tick at 0 reached by accumulated rounding
+	if (fabs(dValue) < pstAxis->dStep * 1e-9)
+	{
+		dValue = 0.0;
+	}
+	if (pstAxis->nDecimals < 0)
+	{
+		snprintf(pszOut, szSize, "%g", dValue);
+	}
+	else
+	{
+		snprintf(pszOut, szSize, "%.*f", pstAxis->nDecimals, dValue);
+	}
+}
+
+/***************************************************************************//**
+ * DrawTicks
+ *
+ * Draws the grid, or the tick marks and labels, of an axis. Ticks are
+ * counted in minor steps from 0 so major and minor ticks never drift apart.
+ *
+ * @param pstCanvas  Image
+ * @param pstAxis    Axis to draw
+ * @param bVertical  LIB_TRUE for the Y axis, whose ticks are horizontal lines
+ * @param prgnFrame  Left, top, right and bottom of the axes in pixels
+ * @param bGrid      LIB_TRUE to draw the grid across the axes, else the ticks outside
+ ******************************************************************************/
+static void DrawTicks(LIB_CANVAS* pstCanvas, const LIB_AXIS* pstAxis, LIB_BOOLEAN bVertical, const LIB_INT32* prgnFrame, LIB_BOOLEAN bGrid)
+{
+	LIB_DOUBLE dMinor = pstAxis->dStep / pstAxis->u32MinorDivs;
+	LIB_DOUBLE dFirst = ceil(pstAxis->dMin / dMinor - 1e-9);
+	LIB_DOUBLE dLast = floor(pstAxis->dMax / dMinor + 1e-9);
+	LIB_INT32 nThin = ToPixels(pstCanvas, LIB_THIN_WIDTH_PT);
+	LIB_INT32 nMajorTick = ToPixels(pstCanvas, LIB_MAJOR_TICK_PT);
+	LIB_INT32 nMinorTick = ToPixels(pstCanvas, LIB_MINOR_TICK_PT);
+	LIB_INT32 nPad = ToPixels(pstCanvas, LIB_TICK_PAD_PT);
+	LIB_CHAR szLabel[64];
+
+	// Whole numbers of minor steps, exact in a double
+	for (LIB_DOUBLE dTick = dFirst; dTick <= dLast; dTick += 1.0)
+	{
+		LIB_BOOLEAN bMajor = (LIB_BOOLEAN)(fmod(dTick, (LIB_DOUBLE)pstAxis->u32MinorDivs) == 0.0);
+		LIB_DOUBLE dValue = dTick * dMinor;
+		LIB_INT32 nAt = (LIB_INT32)floor(AxisToPixel(pstAxis, dValue) + 0.5);
+		if (bGrid)
+		{
+			LIB_DOUBLE dOn = (bMajor ? LIB_DASH_ON : LIB_DOT_ON) * LIB_THIN_WIDTH_PT * pstCanvas->dPxPerPt;
+			LIB_DOUBLE dOff = (bMajor ? LIB_DASH_OFF : LIB_DOT_OFF) * LIB_THIN_WIDTH_PT * pstCanvas->dPxPerPt;
+			if (bVertical)
+			{
+				DrawDashed(pstCanvas, LIB_FALSE, nAt, prgnFrame[0], prgnFrame[2], nThin, dOn, dOff, LIB_COLOR_GRID);
+			}
+			else
+			{
+				DrawDashed(pstCanvas, LIB_TRUE, nAt, prgnFrame[1], prgnFrame[3], nThin, dOn, dOff, LIB_COLOR_GRID);
+			}
+			continue;
+		}
+
+		LIB_INT32 nLength = bMajor ? nMajorTick : nMinorTick;
+		if (bVertical)
+		{
+			DrawDashed(pstCanvas, LIB_FALSE, nAt, prgnFrame[0] - nLength, prgnFrame[0], nThin, 0.0, 0.0, LIB_COLOR_BLACK);
+		}
+		else
+		{
+			DrawDashed(pstCanvas, LIB_TRUE, nAt, prgnFrame[3], prgnFrame[3] + nLength, nThin, 0.0, 0.0, LIB_COLOR_BLACK);
+		}
+		if (!bMajor)
+		{
+			continue;
+		}
+		FormatTick(pstAxis, dValue, szLabel, sizeof(szLabel));
+		LIB_INT32 nWidth = TextWidth(pstCanvas, szLabel);
+		if (bVertical)
+		{
+			DrawText(pstCanvas, prgnFrame[0] - nMajorTick - nPad - nWidth, nAt - TextHeight(pstCanvas) / 2, szLabel, LIB_COLOR_BLACK);
+		}
+		else
+		{
+			DrawText(pstCanvas, nAt - nWidth / 2, prgnFrame[3] + nMajorTick + nPad, szLabel, LIB_COLOR_BLACK);
+		}
+	}
+}
+
+/***************************************************************************//**
+ * GetSeriesX
+ *
+ * X value of a point, the row number when the series has no X values
+ *
+ * @param pstSeries Line of the figure
+ * @param u32Row    Row of the point
+ * @return          X value
+ ******************************************************************************/
+static LIB_DOUBLE GetSeriesX(const LIB_SERIES* pstSeries, LIB_U32 u32Row)
+{
+	return (pstSeries->prgdX != NULL) ? pstSeries->prgdX[u32Row] : (LIB_DOUBLE)u32Row;
+}
+
+/***************************************************************************//**
+ * CountInside
+ *
+ * Counts the points of all lines falling in a rectangle, the badness of a
+ * legend position as in loc="best" of Matplotlib
+ *
+ * @param prgstSeries Lines of the figure
+ * @param u32ColSize  Number of lines
+ * @param u32RowSize  Points per line
+ * @param pstX        X axis
+ * @param pstY        Y axis
+ * @param prgnRect    Left, top, right and bottom in pixels
+ * @return            Number of points inside
+ ******************************************************************************/
+static LIB_U64 CountInside(const LIB_SERIES* prgstSeries, LIB_U32 u32ColSize, LIB_U32 u32RowSize,
+	const LIB_AXIS* pstX, const LIB_AXIS* pstY, const LIB_INT32* prgnRect)
+{
+	LIB_U64 u64Count = 0;
+	for (LIB_U32 u32Col = 0; u32Col < u32ColSize; u32Col++)
+	{
+		for (LIB_U32 u32Row = 0; u32Row < u32RowSize; u32Row++)
+		{
+			LIB_DOUBLE dX = AxisToPixel(pstX, GetSeriesX(&prgstSeries[u32Col], u32Row));
+			LIB_DOUBLE dY = AxisToPixel(pstY, prgstSeries[u32Col].prgdY[u32Row]);
+			u64Count += (dX >= prgnRect[0] && dX < prgnRect[2] && dY >= prgnRect[1] && dY < prgnRect[3]);
+		}
+	}
+	return u64Count;
+}
+
+/***************************************************************************//**
+ * DrawLegend
+ *
+ * Draws the legend in the corner of the axes hiding the fewest points,
+ * upper right first on ties
+ *
+ * @param pstCanvas   Image
+ * @param pstInput    Input with the labels
+ * @param prgstSeries Lines of the figure
+ * @param u32RowSize  Points per line
+ * @param pstX        X axis
+ * @param pstY        Y axis
+ * @param prgnFrame   Left, top, right and bottom of the axes in pixels
+ ******************************************************************************/
+static void DrawLegend(LIB_CANVAS* pstCanvas, const LIB_INPUT* pstInput, const LIB_SERIES* prgstSeries, LIB_U32 u32RowSize,
+	const LIB_AXIS* pstX, const LIB_AXIS* pstY, const LIB_INT32* prgnFrame)
+{
+	LIB_DOUBLE dEm = LIB_LEGEND_FONT_PT * pstCanvas->dPxPerPt;
+	LIB_INT32 nPad = (LIB_INT32)(LIB_LEGEND_PAD * dEm + 0.5);
+	LIB_INT32 nHandle = (LIB_INT32)(LIB_LEGEND_HANDLE * dEm + 0.5);
+	LIB_INT32 nTextPad = (LIB_INT32)(LIB_LEGEND_TEXT_PAD * dEm + 0.5);
+	LIB_INT32 nSpacing = (LIB_INT32)(LIB_LEGEND_SPACING * dEm + 0.5);
+	LIB_INT32 nMargin = (LIB_INT32)(LIB_LEGEND_MARGIN * dEm + 0.5);
+	LIB_INT32 nTextHeight = TextHeight(pstCanvas);
+
+	LIB_INT32 nTextWidth = 0;
+	for (LIB_U32 u32Col = 0; u32Col < pstInput->u32ColSize; u32Col++)
+	{
+		LIB_INT32 nWidth = TextWidth(pstCanvas, pstInput->prgszLabels[u32Col]);
+		nTextWidth = (nWidth > nTextWidth) ? nWidth : nTextWidth;
+	}
+	LIB_INT32 nWidth = 2 * nPad + nHandle + nTextPad + nTextWidth;
+	LIB_INT32 nHeight = 2 * nPad + (LIB_INT32)pstInput->u32ColSize * (nTextHeight + nSpacing) - nSpacing;
+
+	// Upper right, upper left, lower left, lower right
+	LIB_INT32 rgnLeft[4] = { prgnFrame[2] - nMargin - nWidth, prgnFrame[0] + nMargin, prgnFrame[0] + nMargin, prgnFrame[2] - nMargin - nWidth };
+	LIB_INT32 rgnTop[4] = { prgnFrame[1] + nMargin, prgnFrame[1] + nMargin, prgnFrame[3] - nMargin - nHeight, prgnFrame[3] - nMargin - nHeight };
+	LIB_U32 u32Best = 0;
+	LIB_U64 u64BestCount = ~0ULL;
+	for (LIB_U32 u32Corner = 0; u32Corner < 4 && u64BestCount > 0; u32Corner++)
+	{
+		LIB_INT32 rgnRect[4] = { rgnLeft[u32Corner], rgnTop[u32Corner], rgnLeft[u32Corner] + nWidth, rgnTop[u32Corner] + nHeight };
+		LIB_U64 u64Count = CountInside(prgstSeries, pstInput->u32ColSize, u32RowSize, pstX, pstY, rgnRect);
+		if (u64Count < u64BestCount)
+		{
+			u32Best = u32Corner;
+			u64BestCount = u64Count;
+		}
+	}
+
+	LIB_INT32 nLeft = rgnLeft[u32Best];
+	LIB_INT32 nTop = rgnTop[u32Best];
+	LIB_INT32 nThin = ToPixels(pstCanvas, LIB_THIN_WIDTH_PT);
+	FillRect(pstCanvas, nLeft, nTop, nLeft + nWidth, nTop + nHeight, LIB_COLOR_WHITE, LIB_LEGEND_ALPHA);
+	DrawDashed(pstCanvas, LIB_FALSE, nTop, nLeft, nLeft + nWidth, nThin, 0.0, 0.0, LIB_COLOR_GRID);
+	DrawDashed(pstCanvas, LIB_FALSE, nTop + nHeight, nLeft, nLeft + nWidth, nThin, 0.0, 0.0, LIB_COLOR_GRID);
+	DrawDashed(pstCanvas, LIB_TRUE, nLeft, nTop, nTop + nHeight, nThin, 0.0, 0.0, LIB_COLOR_GRID);
+	DrawDashed(pstCanvas, LIB_TRUE, nLeft + nWidth, nTop, nTop + nHeight, nThin, 0.0, 0.0, LIB_COLOR_GRID);
+
+	LIB_INT32 nLineWidth = ToPixels(pstCanvas, LIB_LINE_WIDTH_PT);
+	LIB_DOUBLE dDotRadius = LIB_DOT_SIZE_PT * pstCanvas->dPxPerPt * 0.5;
+	for (LIB_U32 u32Col = 0; u32Col < pstInput->u32ColSize; u32Col++)
+	{
+		LIB_U32 u32Color = s_rgu32Colors[u32Col % (sizeof(s_rgu32Colors) / sizeof(s_rgu32Colors[0]))];
+		LIB_INT32 nEntryTop = nTop + nPad + (LIB_INT32)u32Col * (nTextHeight + nSpacing);
+		LIB_DOUBLE dMiddle = nEntryTop + nTextHeight * 0.5;
+		LIB_DOUBLE rgdHandle[4] = { (LIB_DOUBLE)(nLeft + nPad), dMiddle, (LIB_DOUBLE)(nLeft + nPad + nHandle), dMiddle };
+		DrawSegment(pstCanvas, rgdHandle, nLineWidth, u32Color);
+		DrawDot(pstCanvas, nLeft + nPad + nHandle * 0.5, dMiddle, dDotRadius, u32Color);
+		DrawText(pstCanvas, nLeft + nPad + nHandle + nTextPad, nEntryTop, pstInput->prgszLabels[u32Col], LIB_COLOR_BLACK);
+	}
+}
+
+/***************************************************************************//**
+ * DrawFigure
+ *
+ * Draws the figure of _plot() in IPC_Plot.py: one line with dot markers per
+ * column, the major and minor grid, the legend, "Samples" below the X axis
+ * and the title
+ *
+ * @param pstCanvas   Image, cleared to white
+ * @param pstInput    Input with the labels
+ * @param prgstSeries Lines of the figure
+ * @param u32RowSize  Points per line
+ * @param pszTitle    Title of the figure
+ ******************************************************************************/
+static void DrawFigure(LIB_CANVAS* pstCanvas, const LIB_INPUT* pstInput, const LIB_SERIES* prgstSeries, LIB_U32 u32RowSize,
+	const LIB_CHAR* pszTitle)
+{
+	LIB_INT32 rgnFrame[4] = {
+		(LIB_INT32)(LIB_AXES_LEFT * pstCanvas->nWidth + 0.5), (LIB_INT32)((1.0 - LIB_AXES_TOP) * pstCanvas->nHeight + 0.5),
+		(LIB_INT32)(LIB_AXES_RIGHT * pstCanvas->nWidth + 0.5), (LIB_INT32)((1.0 - LIB_AXES_BOTTOM) * pstCanvas->nHeight + 0.5) };
+
+	// 01. Limits of the finite points, NaN and infinities break the lines as in Matplotlib
+	LIB_DOUBLE rgdLimits[4] = { NAN, NAN, NAN, NAN };
+	for (LIB_U32 u32Col = 0; u32Col < pstInput->u32ColSize; u32Col++)
+	{
+		for (LIB_U32 u32Row = 0; u32Row < u32RowSize; u32Row++)
+		{
+			LIB_DOUBLE dX = GetSeriesX(&prgstSeries[u32Col], u32Row);
+			LIB_DOUBLE dY = prgstSeries[u32Col].prgdY[u32Row];
+			if (!isfinite(dX) || !isfinite(dY))
+			{
+				continue;
+			}
+			// Comparisons with NaN are false, the first point sets the limits
+			rgdLimits[0] = (dX >= rgdLimits[0]) ? rgdLimits[0] : dX;
+			rgdLimits[1] = (dX <= rgdLimits[1]) ? rgdLimits[1] : dX;
+			rgdLimits[2] = (dY >= rgdLimits[2]) ? rgdLimits[2] : dY;
+			rgdLimits[3] = (dY <= rgdLimits[3]) ? rgdLimits[3] : dY;
+		}
+	}
+	LIB_AXIS stX;
+	LIB_AXIS stY;
+	SetupAxis(rgdLimits[0], rgdLimits[1], rgnFrame[0], rgnFrame[2], &stX);
+	SetupAxis(rgdLimits[2], rgdLimits[3], rgnFrame[3], rgnFrame[1], &stY);
+
+	// 02. Grid and lines, clipped to the axes
+	SetClip(pstCanvas, rgnFrame[0], rgnFrame[1], rgnFrame[2], rgnFrame[3]);
+	DrawTicks(pstCanvas, &stX, LIB_FALSE, rgnFrame, LIB_TRUE);
+	DrawTicks(pstCanvas, &stY, LIB_TRUE, rgnFrame, LIB_TRUE);
+	LIB_INT32 nLineWidth = ToPixels(pstCanvas, LIB_LINE_WIDTH_PT);
+	LIB_DOUBLE dDotRadius = LIB_DOT_SIZE_PT * pstCanvas->dPxPerPt * 0.5;
+	for (LIB_U32 u32Col = 0; u32Col < pstInput->u32ColSize; u32Col++)
+	{
+		LIB_U32 u32Color = s_rgu32Colors[u32Col % (sizeof(s_rgu32Colors) / sizeof(s_rgu32Colors[0]))];
+		LIB_BOOLEAN bHasPrev = LIB_FALSE;
+		LIB_DOUBLE rgdSegment[4];
+		for (LIB_U32 u32Row = 0; u32Row < u32RowSize; u32Row++)
+		{
+			LIB_DOUBLE dX = GetSeriesX(&prgstSeries[u32Col], u32Row);
+			LIB_DOUBLE dY = prgstSeries[u32Col].prgdY[u32Row];
+			if (!isfinite(dX) || !isfinite(dY))
+			{
+				bHasPrev = LIB_FALSE;
+				continue;
+			}
+			rgdSegment[2] = AxisToPixel(&stX, dX);
+			rgdSegment[3] = AxisToPixel(&stY, dY);
+			if (bHasPrev)
+			{
+				DrawSegment(pstCanvas, rgdSegment, nLineWidth, u32Color);
+			}
+			rgdSegment[0] = rgdSegment[2];
+			rgdSegment[1] = rgdSegment[3];
+			bHasPrev = LIB_TRUE;
+		}
+		// Markers go over the line, as Matplotlib draws them after it
+		for (LIB_U32 u32Row = 0; u32Row < u32RowSize; u32Row++)
+		{
+			LIB_DOUBLE dX = GetSeriesX(&prgstSeries[u32Col], u32Row);
+			LIB_DOUBLE dY = prgstSeries[u32Col].prgdY[u32Row];
+			if (isfinite(dX) && isfinite(dY))
+			{
+				DrawDot(pstCanvas, AxisToPixel(&stX, dX), AxisToPixel(&stY, dY), dDotRadius, u32Color);
+			}
+		}
+	}
+
+	// 03. Spines, ticks and texts around the axes
+	SetClip(pstCanvas, 0, 0, pstCanvas->nWidth, pstCanvas->nHeight);
+	LIB_INT32 nThin = ToPixels(pstCanvas, LIB_THIN_WIDTH_PT);
+	DrawDashed(pstCanvas, LIB_FALSE, rgnFrame[1], rgnFrame[0] - nThin / 2, rgnFrame[2] + nThin / 2 + 1, nThin, 0.0, 0.0, LIB_COLOR_BLACK);
+	DrawDashed(pstCanvas, LIB_FALSE, rgnFrame[3], rgnFrame[0] - nThin / 2, rgnFrame[2] + nThin / 2 + 1, nThin, 0.0, 0.0, LIB_COLOR_BLACK);
+	DrawDashed(pstCanvas, LIB_TRUE, rgnFrame[0], rgnFrame[1], rgnFrame[3], nThin, 0.0, 0.0, LIB_COLOR_BLACK);
+	DrawDashed(pstCanvas, LIB_TRUE, rgnFrame[2], rgnFrame[1], rgnFrame[3], nThin, 0.0, 0.0, LIB_COLOR_BLACK);
+	DrawTicks(pstCanvas, &stX, LIB_FALSE, rgnFrame, LIB_FALSE);
+	DrawTicks(pstCanvas, &stY, LIB_TRUE, rgnFrame, LIB_FALSE);
+
+	LIB_INT32 nTextHeight = TextHeight(pstCanvas);
+	LIB_INT32 nLabelTop = rgnFrame[3] + ToPixels(pstCanvas, LIB_MAJOR_TICK_PT) + ToPixels(pstCanvas, LIB_TICK_PAD_PT) + nTextHeight
+		+ ToPixels(pstCanvas, LIB_LABEL_PAD_PT);
+	LIB_INT32 nCenter = (rgnFrame[0] + rgnFrame[2]) / 2;
+	DrawText(pstCanvas, nCenter - TextWidth(pstCanvas, "Samples") / 2, nLabelTop, "Samples", LIB_COLOR_BLACK);
+	DrawText(pstCanvas, nCenter - TextWidth(pstCanvas, pszTitle) / 2, rgnFrame[1] - ToPixels(pstCanvas, LIB_TITLE_PAD_PT) - nTextHeight,
+		pszTitle, LIB_COLOR_BLACK);
+
+	// 04. Legend over everything else
+	DrawLegend(pstCanvas, pstInput, prgstSeries, u32RowSize, &stX, &stY, rgnFrame);
+}
+
+/***************************************************************************//**
+ * GetImageTitle
+ *
+ * Title of the figure, from the local date and time like _plot() in 
+ * IPC_Plot.py
+ *
+ * @param pszOut Receives IMG_<date>_<time>
+ * @param szSize Size of pszOut
+ ******************************************************************************/
+void GetImageTitle(LIB_CHAR* pszOut, size_t szSize)
+{
+	time_t tNow = time(NULL);
+	struct tm stNow;
+#ifdef _WIN32
+	localtime_s(&stNow, &tNow);
+#else
+	localtime_r(&tNow, &stNow);
+#endif
+	strftime(pszOut, szSize, "IMG_%Y%m%d_%HH%MM%SS", &stNow);
+}
+
+/***************************************************************************//**
+ * WriteImageFile
+ *
+ * Saves a PNG image as <title>.png in the working directory. The file is 
+ * created exclusively, so a plot finishing in the same second as another 
+ * one, or as a Python tool, saves as <title>_1.png, <title>_2.png, ... 
+ * instead of overwriting it.
+ *
+ * @param pszTitle   Title of the figure
+ * @param pcPng      PNG image
+ * @param u64PngSize Bytes of the image
+ * @param pstErr     Error information structure for logging any errors
+ * @return           LIB_OK if success, else LIB_ERR if any error occurred
+ ******************************************************************************/
+LIB_U32 WriteImageFile(const LIB_CHAR* pszTitle, const LIB_CHAR* pcPng, LIB_U64 u64PngSize, LIB_ERROR_INFO* pstErr)
+{
+	LIB_CHAR szRuntimeMsg[LIB_MAX_BUFFER_SIZE] = "";
+	LIB_CHAR szName[96];
+	FILE* pFile = NULL;
+
+	snprintf(szName, sizeof(szName), "%s.png", pszTitle);
+	for (LIB_U32 u32Suffix = 1; (pFile = fopen(szName, "wbx")) == NULL && errno == EEXIST; u32Suffix++)
+	{
+		snprintf(szName, sizeof(szName), "%s_%u.png", pszTitle, u32Suffix);
+	}
+	LIB_U32 u32Ret = LIB_OK;
+	if (pFile == NULL || fwrite(pcPng, 1, (size_t)u64PngSize, pFile) != u64PngSize)
+	{
+		snprintf(szRuntimeMsg, sizeof(szRuntimeMsg), "Unable to write %llu bytes to %s", u64PngSize, szName);
+		LOG_ERROR(pstErr, LIB_ERR_FILE_IO, LIB_ERR_FILE_IO_MSG, LIB_ERR_FILE_IO_ACT, szRuntimeMsg)
+		u32Ret = LIB_ERR;
+	}
+	if (pFile != NULL && fclose(pFile) != 0 && u32Ret == LIB_OK)
+	{
+		snprintf(szRuntimeMsg, sizeof(szRuntimeMsg), "Unable to close %s", szName);
+		LOG_ERROR(pstErr, LIB_ERR_FILE_IO, LIB_ERR_FILE_IO_MSG, LIB_ERR_FILE_IO_ACT, szRuntimeMsg)
+		u32Ret = LIB_ERR;
+	}
+	return u32Ret;
+}
+
+/***************************************************************************//**
+ * RasterPlot
+ *
+ * Plots the input in this process instead of the Python tool: draws the
+ * figure into an RGBA image, encodes it as PNG and saves it in the current
+ * directory as IPC_Plot.py does, or returns the PNG or the pixels in the
+ * image of the input
+ *
+ * @param pstInput Validated input structure, reduced by the caller if decimated
+ * @param u32Flags LIB_PLOT_FLAG_XY if each column is preceded by its X values,
+ *                 else the X column of the input or the row number
+ * @param pstStats Receives the draw and encode times as the renderer times
+ * @param pstErr   Error information structure for logging any errors
+ * @return         LIB_OK if success, else LIB_ERR if any error occurred
+ ******************************************************************************/
+LIB_U32 RasterPlot(const LIB_INPUT* pstInput, LIB_U32 u32Flags, LIB_PLOT_STATS* pstStats, LIB_ERROR_INFO* pstErr)
+{
+	LIB_CHAR szRuntimeMsg[LIB_MAX_BUFFER_SIZE] = "";
+	LIB_U32 u32RowSize = pstInput->u32RowSize;
+	LIB_U64 u64StartUs = StatsNowUs();
+
+	// 01. One line per column, typed columns and the X column are converted to doubles first
+	LIB_CANVAS stCanvas;
+	LIB_U32 u32Dpi = (pstInput->u32Dpi != 0) ? pstInput->u32Dpi : LIB_DEFAULT_DPI;
+	stCanvas.nWidth = (LIB_INT32)(LIB_RASTER_WIDTH_IN * u32Dpi + 0.5);
+	stCanvas.nHeight = (LIB_INT32)(LIB_RASTER_HEIGHT_IN * u32Dpi + 0.5);
+	stCanvas.dPxPerPt = u32Dpi / 72.0;
+	stCanvas.nFontScale = (LIB_INT32)((u32Dpi + LIB_FONT_DPI / 2) / LIB_FONT_DPI);
+	stCanvas.nFontScale = (stCanvas.nFontScale > 0) ? stCanvas.nFontScale : 1;
+	LIB_SERIES* prgstSeries = (LIB_SERIES*)calloc(pstInput->u32ColSize + 1, sizeof(LIB_SERIES));
+	LIB_DOUBLE* prgdConverted = NULL;
+	LIB_U32 u32Converted = ((pstInput->prgstColumns != NULL) ? pstInput->u32ColSize : 0) + ((pstInput->pstXColumn != NULL) ? 1 : 0);
+	if (u32Converted > 0)
+	{
+		prgdConverted = (LIB_DOUBLE*)malloc((size_t)u32Converted * u32RowSize * sizeof(LIB_DOUBLE) + 1);
+	}
+	stCanvas.prgu32Pixels = (LIB_U32*)malloc((size_t)stCanvas.nWidth * stCanvas.nHeight * sizeof(LIB_U32));
+	if (prgstSeries == NULL || (u32Converted > 0 && prgdConverted == NULL) || stCanvas.prgu32Pixels == NULL)
+	{
+		free(prgstSeries);
+		free(prgdConverted);
+		free(stCanvas.prgu32Pixels);
+		snprintf(szRuntimeMsg, sizeof(szRuntimeMsg), "Unable to allocate a %d x %d image for %u x %u points",
+			stCanvas.nWidth, stCanvas.nHeight, pstInput->u32ColSize, u32RowSize);
+		LOG_ERROR(pstErr, LIB_ERR_BUFFER_OVERFLOW, LIB_ERR_BUFFER_OVERFLOW_MSG, LIB_ERR_BUFFER_OVERFLOW_ACT, szRuntimeMsg)
+		return LIB_ERR;
+	}
+	// The X column is shared by every line and converted after the typed columns
+	const LIB_DOUBLE* prgdXValues = NULL;
+	if (pstInput->pstXColumn != NULL)
+	{
+		LIB_DOUBLE* prgdX = prgdConverted + (LIB_U64)(u32Converted - 1) * u32RowSize;
+		ColumnToDouble(pstInput->pstXColumn, u32RowSize, prgdX);
+		prgdXValues = prgdX;
+	}
+	for (LIB_U32 u32Col = 0; u32Col < pstInput->u32ColSize; u32Col++)
+	{
+		LIB_U64 u64Offset = (LIB_U64)u32Col * u32RowSize;
+		prgstSeries[u32Col].prgdX = prgdXValues;
+		if (pstInput->prgstColumns != NULL)
+		{
+			ColumnToDouble(&pstInput->prgstColumns[u32Col], u32RowSize, prgdConverted + u64Offset);
+			prgstSeries[u32Col].prgdY = prgdConverted + u64Offset;
+		}
+		else if (u32Flags & LIB_PLOT_FLAG_XY)
+		{
+			// X values followed by Y values, see DecimateInput()
+			prgstSeries[u32Col].prgdX = pstInput->prgdBuffer + 2 * u64Offset;
+			prgstSeries[u32Col].prgdY = pstInput->prgdBuffer + 2 * u64Offset + u32RowSize;
+		}
+		else
+		{
+			prgstSeries[u32Col].prgdY = pstInput->prgdBuffer + u64Offset;
+		}
+	}
+
+	// 02. Figure on a white background
+	for (LIB_U64 u64Pixel = 0; u64Pixel < (LIB_U64)stCanvas.nWidth * stCanvas.nHeight; u64Pixel++)
+	{
+		stCanvas.prgu32Pixels[u64Pixel] = LIB_COLOR_WHITE;
+	}
+	LIB_CHAR szTitle[64];
+	GetImageTitle(szTitle, sizeof(szTitle));
+	DrawFigure(&stCanvas, pstInput, prgstSeries, u32RowSize, szTitle);
+	free(prgstSeries);
+	free(prgdConverted);
+	u64StartUs = StatsPhase("draw", u64StartUs, &pstStats->dRendererPlotMs);
+
+	// 03. Pixels as they are, or a PNG image returned or written in one go
+	LIB_U32 u32Ret = LIB_OK;
+	LIB_IMAGE* pstImage = pstInput->pstImage;
+	if (pstInput->u32Output == LIB_OUTPUT_RGBA)
+	{
+		// 0xAABBGGRR pixels are R, G, B, A bytes on the little-endian platforms of the library
+		LIB_U64 u64Size = (LIB_U64)stCanvas.nWidth * stCanvas.nHeight * sizeof(LIB_U32);
+		u32Ret = ImageReserve(pstImage, u64Size, pstErr);
+		if (u32Ret == LIB_OK)
+		{
+			memcpy(pstImage->pcData, stCanvas.prgu32Pixels, (size_t)u64Size);
+		}
+	}
+	else
+	{
+		LIB_CHAR* pcPng = NULL;
+		LIB_U64 u64PngSize = 0;
+		u32Ret = PngEncode(stCanvas.prgu32Pixels, (LIB_U32)stCanvas.nWidth, (LIB_U32)stCanvas.nHeight, u32Dpi,
+			&pcPng, &u64PngSize, pstErr);
+		if (u32Ret == LIB_OK && pstInput->u32Output == LIB_OUTPUT_PNG)
+		{
+			u32Ret = ImageReserve(pstImage, u64PngSize, pstErr);
+			if (u32Ret == LIB_OK)
+			{
+				memcpy(pstImage->pcData, pcPng, (size_t)u64PngSize);
+			}
+		}
+		else if (u32Ret == LIB_OK)
+		{
+			u32Ret = WriteImageFile(szTitle, pcPng, u64PngSize, pstErr);
+		}
+		free(pcPng);
+	}
+	if (pstInput->u32Output != LIB_OUTPUT_FILE)
+	{
+		pstImage->u32Format = pstInput->u32Output;
+		pstImage->u32Width = (LIB_U32)stCanvas.nWidth;
+		pstImage->u32Height = (LIB_U32)stCanvas.nHeight;
+	}
+	free(stCanvas.prgu32Pixels);
+	StatsPhase("encode", u64StartUs, &pstStats->dRendererSaveMs);
+	if (u32Ret != LIB_OK)
+	{
+		return LIB_ERR;
+	}
+	pstStats->dRenderMs = pstStats->dRendererPlotMs + pstStats->dRendererSaveMs;
+	pstErr->u32ErrCode = LIB_STATUS_DONE;
+	return LIB_OK;
+}
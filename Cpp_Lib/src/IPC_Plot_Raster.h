@@ -0,0 +1,20 @@
+#pragma once
+
+#include "IPC_Plot_Internal.h"
+
+// Figure of the native backend, same size as the figure of IPC_Plot.py, at LIB_INPUT::u32Dpi
+#define LIB_RASTER_WIDTH_IN  6.4 //!< Default figure size of Matplotlib in inches
+#define LIB_RASTER_HEIGHT_IN 4.8
+
+// Draws the figure of _plot() in IPC_Plot.py in this process and saves it as a PNG file,
+// IPC_Plot_Raster.cpp. The input has been validated, u32Flags is LIB_PLOT_FLAG_XY after decimation.
+LIB_U32 RasterPlot(const LIB_INPUT* pstInput, LIB_U32 u32Flags, LIB_PLOT_STATS* pstStats, LIB_ERROR_INFO* pstErr);
+
+// Name of an image file, IMG_<date>_<time>.png in the working directory with a _1, _2... suffix
+// if taken, IPC_Plot_Raster.cpp. Also used to save the images of the render cache.
+void GetImageTitle(LIB_CHAR* pszOut, size_t szSize);
+LIB_U32 WriteImageFile(const LIB_CHAR* pszTitle, const LIB_CHAR* pcPng, LIB_U64 u64PngSize, LIB_ERROR_INFO* pstErr);
+
+// PNG encoder of the native backend, IPC_Plot_Png.cpp. Pixels are 0xAABBGGRR.
+LIB_U32 PngEncode(const LIB_U32* prgu32Pixels, LIB_U32 u32Width, LIB_U32 u32Height, LIB_U32 u32Dpi,
+	LIB_CHAR** ppcOutPng, LIB_U64* pu64OutSize, LIB_ERROR_INFO* pstErr);
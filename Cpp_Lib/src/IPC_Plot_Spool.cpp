@@ -0,0 +1,799 @@
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#    include <io.h>
+#    define LIB_FSEEK _fseeki64
+#    define LIB_FTELL _ftelli64
+#else
+#    include <unistd.h>
+#    define LIB_FSEEK fseeko
+#    define LIB_FTELL ftello
+#endif
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include "IPC_Plot_Protocol.h"
+
+#define LIB_SPOOL_FLUSH_MS    1000  //!< Longest time a record waits in memory before the writer thread takes it
+#define LIB_SPOOL_INDEX_PLOTS 65536 //!< Plot records after which an index record is appended without a flush
+#define LIB_SPOOL_MAX_PATH    512   //!< Characters of the path of the log, which error messages quote
+
+// Spool log of ipc_plot(), shared by every thread of the process. Records are copied into the
+// fill buffer under the lock; the writer thread writes the other buffer to the file meanwhile,
+// and the two are swapped when the fill buffer is full or has waited LIB_SPOOL_FLUSH_MS.
+typedef struct LIB_SPOOL
+{
+	std::mutex mutex;                  //!< Guards the members below
+	std::condition_variable cvWrite;   //!< Wakes the writer thread when a buffer is handed to it or a record waits
+	std::condition_variable cvWritten; //!< Wakes the callers waiting for the writer thread to be done with its buffer or for a close
+	FILE* pFile;                       //!< Open log, NULL when spooling is off
+	LIB_BOOLEAN bClosing;              //!< pFile is being closed by CloseLog(), which lets go of the lock while it waits
+	LIB_CHAR szPath[LIB_SPOOL_MAX_PATH];
+	LIB_CHAR* pcFill;                  //!< Records appended since the last hand-over
+	LIB_U64 u64FillSize;
+	LIB_U64 u64FillCapacity;
+	LIB_CHAR* pcWrite;                 //!< Records being written by the writer thread
+	LIB_U64 u64WriteSize;
+	LIB_U64 u64WriteCapacity;
+	LIB_BOOLEAN bWriting;              //!< pcWrite is handed to the writer thread
+	LIB_U64 u64BufferSize;             //!< Bytes of each buffer, more only for a larger record
+	LIB_U64 u64FillUs;                 //!< Time the first record went into the empty fill buffer
+	LIB_U64 u64End;                    //!< Offset in the log of the end of the fill buffer, where the next record goes
+	LIB_U64 u64LastIndex;              //!< Offset of the last index record, 0 for none
+	LIB_BOOLEAN bIndexed;              //!< The log ends with an index record, as far as it is appended
+	std::vector<LIB_SPOOL_INDEX_ENTRY> vecEntries; //!< Plot records since the last index record
+	LIB_ERROR_INFO stWriteErr;         //!< First failure to write, fails every later plot until the log is closed
+} LIB_SPOOL;
+
+static std::atomic<LIB_BOOLEAN> s_bSpoolOpen(LIB_FALSE);
+
+/***************************************************************************//**
+ * GetWallUs
+ *
+ * Reads the wall clock kept in the log, which unlike StatsNowUs() means
+ * something on another machine
+ *
+ * @return Microseconds since 1970
+ ******************************************************************************/
+static LIB_U64 GetWallUs(void)
+{
+	return (LIB_U64)std::chrono::duration_cast<std::chrono::microseconds>(
+		std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+static LIB_U64 AlignSpool(LIB_U64 u64Size)
+{
+	return (u64Size + LIB_SPOOL_ALIGN - 1) / LIB_SPOOL_ALIGN * LIB_SPOOL_ALIGN;
+}
+
+/***************************************************************************//**
+ * HandOver
+ *
+ * Gives the fill buffer to the writer thread and takes its empty buffer in
+ * exchange
+ *
+ * @param pstSpool Spool, locked by the caller, with the writer thread idle
+ ******************************************************************************/
+static void HandOver(LIB_SPOOL* pstSpool)
+{
+	LIB_CHAR* pcEmpty = pstSpool->pcWrite;
+	LIB_U64 u64EmptyCapacity = pstSpool->u64WriteCapacity;
+	pstSpool->pcWrite = pstSpool->pcFill;
+	pstSpool->u64WriteSize = pstSpool->u64FillSize;
+	pstSpool->u64WriteCapacity = pstSpool->u64FillCapacity;
+	pstSpool->pcFill = pcEmpty;
+	pstSpool->u64FillSize = 0;
+	pstSpool->u64FillCapacity = u64EmptyCapacity;
+	pstSpool->bWriting = LIB_TRUE;
+	pstSpool->cvWrite.notify_one();
+}
+
+/***************************************************************************//**
+ * WaitWritten
+ *
+ * Waits until the writer thread is done with the buffer handed to it
+ *
+ * @param pstSpool Spool
+ * @param lock     Lock of the spool, held
+ ******************************************************************************/
+static void WaitWritten(LIB_SPOOL* pstSpool, std::unique_lock<std::mutex>& lock)
+{
+	while (pstSpool->bWriting)
+	{
+		pstSpool->cvWritten.wait(lock);
+	}
+}
+
+/***************************************************************************//**
+ * WaitClosed
+ *
+ * Waits until a close of the log by another call is complete, after which
+ * the log may be closed or already open again
+ *
+ * @param pstSpool Spool
+ * @param lock     Lock of the spool, held
+ ******************************************************************************/
+static void WaitClosed(LIB_SPOOL* pstSpool, std::unique_lock<std::mutex>& lock)
+{
+	while (pstSpool->bClosing)
+	{
+		pstSpool->cvWritten.wait(lock);
+	}
+}
+
+/***************************************************************************//**
+ * SpoolMain
+ *
+ * Writer thread, writes each buffer handed over to the log, and hands over
+ * the fill buffer itself once its first record has waited
+ * LIB_SPOOL_FLUSH_MS, for as long as the process lives
+ *
+ * @param pstSpool Spool shared with ipc_plot()
+ ******************************************************************************/
+static void SpoolMain(LIB_SPOOL* pstSpool)
+{
+	std::unique_lock<std::mutex> lock(pstSpool->mutex);
+	for (;;)
+	{
+		if (!pstSpool->bWriting)
+		{
+			if (pstSpool->pFile == NULL || pstSpool->u64FillSize == 0)
+			{
+				pstSpool->cvWrite.wait(lock);
+				continue;
+			}
+			LIB_U64 u64DueUs = pstSpool->u64FillUs + (LIB_U64)LIB_SPOOL_FLUSH_MS * 1000;
+			LIB_U64 u64NowUs = StatsNowUs();
+			if (u64NowUs < u64DueUs)
+			{
+				pstSpool->cvWrite.wait_for(lock, std::chrono::microseconds(u64DueUs - u64NowUs));
+				continue;
+			}
+			HandOver(pstSpool);
+		}
+
+		// The log is not closed while a buffer is handed over, see CloseLog()
+		FILE* pFile = pstSpool->pFile;
+		const LIB_CHAR* pcWrite = pstSpool->pcWrite;
+		LIB_U64 u64WriteSize = pstSpool->u64WriteSize;
+		lock.unlock();
+		LIB_BOOLEAN bWritten = (LIB_BOOLEAN)(fwrite(pcWrite, 1, (size_t)u64WriteSize, pFile) == u64WriteSize && fflush(pFile) == 0);
+		LIB_INT32 nErrno = errno;
+		lock.lock();
+		if (!bWritten)
+		{
+			LIB_CHAR szRuntimeMsg[LIB_MAX_BUFFER_SIZE] = "";
+			snprintf(szRuntimeMsg, sizeof(szRuntimeMsg), "Unable to write %llu bytes to the spool log %s - %s",
+				u64WriteSize, pstSpool->szPath, strerror(nErrno));
+			LOG_ERROR((&pstSpool->stWriteErr), LIB_ERR_FILE_IO, LIB_ERR_FILE_IO_MSG, LIB_ERR_FILE_IO_ACT, szRuntimeMsg)
+		}
+		pstSpool->u64WriteSize = 0;
+		pstSpool->bWriting = LIB_FALSE;
+		pstSpool->cvWritten.notify_all();
+	}
+}
+
+/***************************************************************************//**
+ * StartSpool
+ *
+ * Creates the spool, with no log open, and starts its writer thread
+ *
+ * @return The spool, or NULL if the thread could not be started
+ ******************************************************************************/
+static LIB_SPOOL* StartSpool(void)
+{
+	LIB_SPOOL* pstSpool = new LIB_SPOOL();
+	pstSpool->pFile = NULL;
+	pstSpool->bClosing = LIB_FALSE;
+	pstSpool->pcFill = NULL;
+	pstSpool->u64FillSize = 0;
+	pstSpool->u64FillCapacity = 0;
+	pstSpool->pcWrite = NULL;
+	pstSpool->u64WriteSize = 0;
+	pstSpool->u64WriteCapacity = 0;
+	pstSpool->bWriting = LIB_FALSE;
+	try
+	{
+		std::thread(SpoolMain, pstSpool).detach();
+	}
+	catch (const std::system_error&)
+	{
+		delete pstSpool;
+		return NULL;
+	}
+	return pstSpool;
+}
+
+/***************************************************************************//**
+ * GetSpool
+ *
+ * Returns the spool, started on first use. Like the pool it is never
+ * destroyed, a log still open at exit loses the records not yet written.
+ *
+ * @return The spool, or NULL if its thread could not be started
+ ******************************************************************************/
+static LIB_SPOOL* GetSpool(void)
+{
+	static LIB_SPOOL* s_pstSpool = StartSpool();
+	return s_pstSpool;
+}
+
+/***************************************************************************//**
+ * ReserveRecord
+ *
+ * Makes room for a record at the end of the fill buffer. A full buffer is
+ * first handed to the writer thread, waiting for it to finish the previous
+ * one, so a caller outrunning the disk is held back here. A record larger
+ * than a buffer grows the buffer.
+ *
+ * @param pstSpool     Spool
+ * @param lock         Lock of the spool, held
+ * @param u64Size      Bytes of the record, header included
+ * @param ppcOutRecord Receives where to copy the record
+ * @param pstErr       Error information structure for logging any errors
+ * @return             Offset of the record in the log, 0 if any error occurred
+ ******************************************************************************/
+static LIB_U64 ReserveRecord(LIB_SPOOL* pstSpool, std::unique_lock<std::mutex>& lock, LIB_U64 u64Size, LIB_CHAR** ppcOutRecord, LIB_ERROR_INFO* pstErr)
+{
+	LIB_CHAR szRuntimeMsg[LIB_MAX_BUFFER_SIZE] = "";
+
+	if (pstSpool->u64FillSize > 0 && pstSpool->u64FillSize + u64Size > pstSpool->u64BufferSize)
+	{
+		WaitWritten(pstSpool, lock);
+		if (pstSpool->u64FillSize > 0)
+		{
+			HandOver(pstSpool);
+		}
+	}
+	// The lock was let go while waiting
+	if (pstSpool->pFile == NULL)
+	{
+		snprintf(szRuntimeMsg, sizeof(szRuntimeMsg), "The spool log was closed before the record was appended");
+		LOG_ERROR(pstErr, LIB_ERR_FILE_IO, LIB_ERR_FILE_IO_MSG, LIB_ERR_FILE_IO_ACT, szRuntimeMsg)
+		return 0;
+	}
+	if (pstSpool->stWriteErr.u32ErrCode != 0)
+	{
+		*pstErr = pstSpool->stWriteErr;
+		return 0;
+	}
+	if (pstSpool->u64FillSize + u64Size > pstSpool->u64FillCapacity)
+	{
+		LIB_U64 u64Capacity = pstSpool->u64FillSize + u64Size;
+		u64Capacity = (u64Capacity > pstSpool->u64BufferSize) ? u64Capacity : pstSpool->u64BufferSize;
+		LIB_CHAR* pcFill = (LIB_CHAR*)realloc(pstSpool->pcFill, (size_t)u64Capacity);
+		if (pcFill == NULL)
+		{
+			snprintf(szRuntimeMsg, sizeof(szRuntimeMsg), "Unable to allocate %llu bytes for the spool log", u64Capacity);
+			LOG_ERROR(pstErr, LIB_ERR_BUFFER_OVERFLOW, LIB_ERR_BUFFER_OVERFLOW_MSG, LIB_ERR_BUFFER_OVERFLOW_ACT, szRuntimeMsg)
+			return 0;
+		}
+		pstSpool->pcFill = pcFill;
+		pstSpool->u64FillCapacity = u64Capacity;
+	}
+	if (pstSpool->u64FillSize == 0)
+	{
+		pstSpool->u64FillUs = StatsNowUs();
+		pstSpool->cvWrite.notify_one();
+	}
+	*ppcOutRecord = pstSpool->pcFill + pstSpool->u64FillSize;
+	LIB_U64 u64Offset = pstSpool->u64End;
+	pstSpool->u64FillSize += u64Size;
+	pstSpool->u64End += u64Size;
+	return u64Offset;
+}
+
+/***************************************************************************//**
+ * AppendIndex
+ *
+ * Appends an index record of the plot records since the previous one,
+ * ending with the tail that points back at it
+ *
+ * @param pstSpool Spool with a log open
+ * @param lock     Lock of the spool, held
+ * @param pstErr   Error information structure for logging any errors
+ * @return         LIB_OK if success, else LIB_ERR if any error occurred
+ ******************************************************************************/
+static LIB_U32 AppendIndex(LIB_SPOOL* pstSpool, std::unique_lock<std::mutex>& lock, LIB_ERROR_INFO* pstErr)
+{
+	LIB_U64 u64EntriesSize = (LIB_U64)pstSpool->vecEntries.size() * sizeof(LIB_SPOOL_INDEX_ENTRY);
+	LIB_SPOOL_RECORD_HDR stRecord;
+	stRecord.u32Magic = LIB_SPOOL_RECORD_MAGIC;
+	stRecord.u32Type = LIB_SPOOL_INDEX;
+	stRecord.u64Length = sizeof(LIB_SPOOL_INDEX_HDR) + u64EntriesSize + sizeof(LIB_SPOOL_TAIL);
+	stRecord.u64TimeUs = GetWallUs();
+
+	LIB_CHAR* pcRecord = NULL;
+	LIB_U64 u64Offset = ReserveRecord(pstSpool, lock, sizeof(stRecord) + stRecord.u64Length, &pcRecord, pstErr);
+	if (u64Offset == 0)
+	{
+		return LIB_ERR;
+	}
+	LIB_SPOOL_INDEX_HDR stIndex;
+	stIndex.u64Previous = pstSpool->u64LastIndex;
+	stIndex.u64Count = pstSpool->vecEntries.size();
+	LIB_SPOOL_TAIL stTail;
+	stTail.u64Index = u64Offset;
+	stTail.u32Magic = LIB_SPOOL_TAIL_MAGIC;
+	stTail.u32Reserved = 0;
+	memcpy(pcRecord, &stRecord, sizeof(stRecord));
+	pcRecord += sizeof(stRecord);
+	memcpy(pcRecord, &stIndex, sizeof(stIndex));
+	pcRecord += sizeof(stIndex);
+	if (u64EntriesSize > 0)
+	{
+		memcpy(pcRecord, pstSpool->vecEntries.data(), (size_t)u64EntriesSize);
+	}
+	memcpy(pcRecord + u64EntriesSize, &stTail, sizeof(stTail));
+
+	pstSpool->vecEntries.clear();
+	pstSpool->u64LastIndex = u64Offset;
+	pstSpool->bIndexed = LIB_TRUE;
+	return LIB_OK;
+}
+
+/***************************************************************************//**
+ * FlushLog
+ *
+ * Appends an index record unless the log already ends with one, and waits
+ * until every record is written to the file
+ *
+ * @param pstSpool Spool with a log open
+ * @param lock     Lock of the spool, held
+ * @param pstErr   Error information structure for logging any errors
+ * @return         LIB_OK if success, else LIB_ERR if any error occurred
+ ******************************************************************************/
+static LIB_U32 FlushLog(LIB_SPOOL* pstSpool, std::unique_lock<std::mutex>& lock, LIB_ERROR_INFO* pstErr)
+{
+	if (!pstSpool->bIndexed && AppendIndex(pstSpool, lock, pstErr) != LIB_OK)
+	{
+		return LIB_ERR;
+	}
+	WaitWritten(pstSpool, lock);
+	if (pstSpool->u64FillSize > 0)
+	{
+		HandOver(pstSpool);
+		WaitWritten(pstSpool, lock);
+	}
+	if (pstSpool->stWriteErr.u32ErrCode != 0)
+	{
+		*pstErr = pstSpool->stWriteErr;
+		return LIB_ERR;
+	}
+	return LIB_OK;
+}
+
+/***************************************************************************//**
+ * CloseLog
+ *
+ * Flushes and closes the open log and frees the buffers. Spooling is off
+ * afterwards even if the last records could not be written. Other calls
+ * configuring the spool wait with WaitClosed() until the close is complete.
+ *
+ * @param pstSpool Spool with a log open
+ * @param lock     Lock of the spool, held
+ * @param pstErr   Error information structure for logging any errors
+ * @return         LIB_OK if success, else LIB_ERR if any error occurred
+ ******************************************************************************/
+static LIB_U32 CloseLog(LIB_SPOOL* pstSpool, std::unique_lock<std::mutex>& lock, LIB_ERROR_INFO* pstErr)
+{
+	LIB_CHAR szRuntimeMsg[LIB_MAX_BUFFER_SIZE] = "";
+
+	s_bSpoolOpen.store(LIB_FALSE);
+	pstSpool->bClosing = LIB_TRUE;
+	// Plots that found the log open may still append while the lock is let go, flushed as well
+	LIB_U32 u32Ret;
+	do
+	{
+		u32Ret = FlushLog(pstSpool, lock, pstErr);
+	} while (u32Ret == LIB_OK && (!pstSpool->bIndexed || pstSpool->u64FillSize > 0));
+	// Nothing is handed over any more, unless the index could not be appended
+	WaitWritten(pstSpool, lock);
+	if (fclose(pstSpool->pFile) != 0 && u32Ret == LIB_OK)
+	{
+		snprintf(szRuntimeMsg, sizeof(szRuntimeMsg), "Unable to close the spool log %s", pstSpool->szPath);
+		LOG_ERROR(pstErr, LIB_ERR_FILE_IO, LIB_ERR_FILE_IO_MSG, LIB_ERR_FILE_IO_ACT, szRuntimeMsg)
+		u32Ret = LIB_ERR;
+	}
+	pstSpool->pFile = NULL;
+	free(pstSpool->pcFill);
+	free(pstSpool->pcWrite);
+	pstSpool->pcFill = NULL;
+	pstSpool->pcWrite = NULL;
+	pstSpool->u64FillSize = 0;
+	pstSpool->u64FillCapacity = 0;
+	pstSpool->u64WriteCapacity = 0;
+	pstSpool->vecEntries.clear();
+	pstSpool->bClosing = LIB_FALSE;
+	pstSpool->cvWritten.notify_all();
+	return u32Ret;
+}
+
+/***************************************************************************//**
+ * ReadAt
+ *
+ * Reads bytes of the log at an offset
+ *
+ * @param pFile    Log
+ * @param u64Offset Offset of the bytes
+ * @param pvOut    Receives the bytes
+ * @param szSize   Number of bytes
+ * @return         LIB_TRUE if all bytes were read
+ ******************************************************************************/
+static LIB_BOOLEAN ReadAt(FILE* pFile, LIB_U64 u64Offset, void* pvOut, size_t szSize)
+{
+	return (LIB_BOOLEAN)(LIB_FSEEK(pFile, (long long)u64Offset, SEEK_SET) == 0 && fread(pvOut, 1, szSize, pFile) == szSize);
+}
+
+/***************************************************************************//**
+ * RecoverLog
+ *
+ * Finds where to append to an existing log. A log that was closed or
+ * flushed last ends with the tail of an index record. Otherwise, e.g. after
+ * a crash, the record headers are walked from the start: the plot records
+ * after the last index record are indexed by the next one, and the bytes
+ * of a record written only in part are cut off.
+ *
+ * @param pstSpool  Spool with pFile open for update and szPath set
+ * @param u64Size   Bytes of the file, at least a file header
+ * @param pstErr    Error information structure for logging any errors
+ * @return          LIB_OK if success, else LIB_ERR if any error occurred
+ ******************************************************************************/
+static LIB_U32 RecoverLog(LIB_SPOOL* pstSpool, LIB_U64 u64Size, LIB_ERROR_INFO* pstErr)
+{
+	LIB_CHAR szRuntimeMsg[LIB_MAX_BUFFER_SIZE] = "";
+	FILE* pFile = pstSpool->pFile;
+
+	LIB_SPOOL_FILE_HDR stFileHdr;
+	if (!ReadAt(pFile, 0, &stFileHdr, sizeof(stFileHdr)) || stFileHdr.u32Magic != LIB_SPOOL_MAGIC)
+	{
+		snprintf(szRuntimeMsg, sizeof(szRuntimeMsg), "%s is not a spool log", pstSpool->szPath);
+		LOG_ERROR(pstErr, LIB_ERR_FILE_IO, LIB_ERR_FILE_IO_MSG, LIB_ERR_FILE_IO_ACT, szRuntimeMsg)
+		return LIB_ERR;
+	}
+	if (stFileHdr.u16Version != LIB_SPOOL_VERSION || stFileHdr.u16ProtoVersion != LIB_PROTO_VERSION)
+	{
+		snprintf(szRuntimeMsg, sizeof(szRuntimeMsg), "Spool log %s has version %u with protocol %u, this library appends version %u with protocol %u",
+			pstSpool->szPath, stFileHdr.u16Version, stFileHdr.u16ProtoVersion, LIB_SPOOL_VERSION, LIB_PROTO_VERSION);
+		LOG_ERROR(pstErr, LIB_ERR_PROTOCOL, LIB_ERR_PROTOCOL_MSG, LIB_ERR_PROTOCOL_ACT, szRuntimeMsg)
+		return LIB_ERR;
+	}
+
+	LIB_SPOOL_TAIL stTail;
+	LIB_SPOOL_RECORD_HDR stRecord;
+	if (u64Size >= sizeof(stFileHdr) + sizeof(stRecord) + sizeof(stTail)
+		&& ReadAt(pFile, u64Size - sizeof(stTail), &stTail, sizeof(stTail)) && stTail.u32Magic == LIB_SPOOL_TAIL_MAGIC
+		&& stTail.u64Index >= sizeof(stFileHdr) && stTail.u64Index < u64Size
+		&& ReadAt(pFile, stTail.u64Index, &stRecord, sizeof(stRecord)) && stRecord.u32Magic == LIB_SPOOL_RECORD_MAGIC
+		&& stRecord.u32Type == LIB_SPOOL_INDEX && stTail.u64Index + sizeof(stRecord) + stRecord.u64Length == u64Size)
+	{
+		pstSpool->u64End = u64Size;
+		pstSpool->u64LastIndex = stTail.u64Index;
+		pstSpool->bIndexed = LIB_TRUE;
+		return LIB_OK;
+	}
+
+	LIB_U64 u64Offset = sizeof(stFileHdr);
+	pstSpool->bIndexed = LIB_FALSE;
+	while (u64Size - u64Offset >= sizeof(stRecord) && ReadAt(pFile, u64Offset, &stRecord, sizeof(stRecord))
+		&& stRecord.u32Magic == LIB_SPOOL_RECORD_MAGIC && stRecord.u64Length % LIB_SPOOL_ALIGN == 0
+		&& stRecord.u64Length <= u64Size - u64Offset - sizeof(stRecord))
+	{
+		if (stRecord.u32Type == LIB_SPOOL_INDEX)
+		{
+			pstSpool->vecEntries.clear();
+			pstSpool->u64LastIndex = u64Offset;
+			pstSpool->bIndexed = LIB_TRUE;
+		}
+		else
+		{
+			LIB_SPOOL_INDEX_ENTRY stEntry;
+			stEntry.u64Offset = u64Offset;
+			stEntry.u64TimeUs = stRecord.u64TimeUs;
+			pstSpool->vecEntries.push_back(stEntry);
+			pstSpool->bIndexed = LIB_FALSE;
+		}
+		u64Offset += sizeof(stRecord) + stRecord.u64Length;
+	}
+	if (u64Offset < u64Size)
+	{
+		fflush(pFile);
+#ifdef _WIN32
+		LIB_BOOLEAN bCut = (LIB_BOOLEAN)(_chsize_s(_fileno(pFile), (long long)u64Offset) == 0);
+#else
+		LIB_BOOLEAN bCut = (LIB_BOOLEAN)(ftruncate(fileno(pFile), (off_t)u64Offset) == 0);
+#endif
+		if (!bCut)
+		{
+			snprintf(szRuntimeMsg, sizeof(szRuntimeMsg), "Unable to cut the spool log %s to its %llu bytes of whole records - %s",
+				pstSpool->szPath, u64Offset, strerror(errno));
+			LOG_ERROR(pstErr, LIB_ERR_FILE_IO, LIB_ERR_FILE_IO_MSG, LIB_ERR_FILE_IO_ACT, szRuntimeMsg)
+			return LIB_ERR;
+		}
+	}
+	pstSpool->u64End = u64Offset;
+	return LIB_OK;
+}
+
+/***************************************************************************//**
+ * OpenLog
+ *
+ * Opens the log to append to, creating it with its file header if it does
+ * not exist or is empty
+ *
+ * @param pstSpool      Spool without a log open
+ * @param pszPath       Path of the log
+ * @param u64BufferSize Bytes of each buffer
+ * @param pstErr        Error information structure for logging any errors
+ * @return              LIB_OK if success, else LIB_ERR if any error occurred
+ ******************************************************************************/
+static LIB_U32 OpenLog(LIB_SPOOL* pstSpool, const LIB_CHAR* pszPath, LIB_U64 u64BufferSize, LIB_ERROR_INFO* pstErr)
+{
+	LIB_CHAR szRuntimeMsg[LIB_MAX_BUFFER_SIZE] = "";
+
+	snprintf(pstSpool->szPath, sizeof(pstSpool->szPath), "%s", pszPath);
+	FILE* pFile = fopen(pszPath, "r+b");
+	if (pFile == NULL && errno == ENOENT)
+	{
+		pFile = fopen(pszPath, "w+b");
+	}
+	if (pFile == NULL)
+	{
+		snprintf(szRuntimeMsg, sizeof(szRuntimeMsg), "Unable to open the spool log %s - %s", pstSpool->szPath, strerror(errno));
+		LOG_ERROR(pstErr, LIB_ERR_FILE_IO, LIB_ERR_FILE_IO_MSG, LIB_ERR_FILE_IO_ACT, szRuntimeMsg)
+		return LIB_ERR;
+	}
+	// Written through the buffers of the spool only
+	setvbuf(pFile, NULL, _IONBF, 0);
+	pstSpool->pFile = pFile;
+	pstSpool->u64LastIndex = 0;
+	pstSpool->vecEntries.clear();
+	pstSpool->stWriteErr = LIB_ERROR_INFO();
+
+	LIB_U32 u32Ret = LIB_OK;
+	LIB_U64 u64Size = (LIB_FSEEK(pFile, 0, SEEK_END) == 0) ? (LIB_U64)LIB_FTELL(pFile) : 0;
+	if (u64Size == 0)
+	{
+		LIB_SPOOL_FILE_HDR stFileHdr;
+		stFileHdr.u32Magic = LIB_SPOOL_MAGIC;
+		stFileHdr.u16Version = LIB_SPOOL_VERSION;
+		stFileHdr.u16ProtoVersion = LIB_PROTO_VERSION;
+		stFileHdr.u64CreatedUs = GetWallUs();
+		if (fwrite(&stFileHdr, 1, sizeof(stFileHdr), pFile) != sizeof(stFileHdr))
+		{
+			snprintf(szRuntimeMsg, sizeof(szRuntimeMsg), "Unable to write the header of the spool log %s - %s", pstSpool->szPath, strerror(errno));
+			LOG_ERROR(pstErr, LIB_ERR_FILE_IO, LIB_ERR_FILE_IO_MSG, LIB_ERR_FILE_IO_ACT, szRuntimeMsg)
+			u32Ret = LIB_ERR;
+		}
+		pstSpool->u64End = sizeof(stFileHdr);
+		pstSpool->bIndexed = LIB_FALSE;
+	}
+	else
+	{
+		u32Ret = RecoverLog(pstSpool, u64Size, pstErr);
+	}
+	// Appended from the end of the last whole record
+	if (u32Ret == LIB_OK && LIB_FSEEK(pFile, (long long)pstSpool->u64End, SEEK_SET) != 0)
+	{
+		snprintf(szRuntimeMsg, sizeof(szRuntimeMsg), "Unable to seek to offset %llu of the spool log %s", pstSpool->u64End, pstSpool->szPath);
+		LOG_ERROR(pstErr, LIB_ERR_FILE_IO, LIB_ERR_FILE_IO_MSG, LIB_ERR_FILE_IO_ACT, szRuntimeMsg)
+		u32Ret = LIB_ERR;
+	}
+	if (u32Ret != LIB_OK)
+	{
+		fclose(pFile);
+		pstSpool->pFile = NULL;
+		pstSpool->vecEntries.clear();
+		return LIB_ERR;
+	}
+	pstSpool->u64BufferSize = u64BufferSize;
+	s_bSpoolOpen.store(LIB_TRUE);
+	return LIB_OK;
+}
+
+/***************************************************************************//**
+ * SpoolEnabled
+ *
+ * Tells whether ipc_plot() appends its requests to a spool log, without
+ * taking the lock of the spool
+ *
+ * @return LIB_TRUE if a log is open
+ ******************************************************************************/
+LIB_BOOLEAN SpoolEnabled(void)
+{
+	return s_bSpoolOpen.load();
+}
+
+/***************************************************************************//**
+ * SpoolPlot
+ *
+ * Appends a plot request to the spool log instead of rendering it: the
+ * frames the Python tool would receive, padded to LIB_SPOOL_ALIGN, then the
+ * payload copied from the caller's buffers. Nothing is written here, the
+ * record is copied into the fill buffer of the writer thread.
+ *
+ * @param pstInput Validated input, not a file
+ * @param u32Flags LIB_PLOT_FLAG_XY if the buffer holds X and Y columns
+ * @param pstStats Receives the time taken as dSendMs
+ * @param pstErr   Error information structure for logging any errors
+ * @return         LIB_OK if success, else LIB_ERR if any error occurred
+ ******************************************************************************/
+LIB_U32 SpoolPlot(const LIB_INPUT* pstInput, LIB_U32 u32Flags, LIB_PLOT_STATS* pstStats, LIB_ERROR_INFO* pstErr)
+{
+	LIB_CHAR szRuntimeMsg[LIB_MAX_BUFFER_SIZE] = "";
+	LIB_U64 u64StartUs = StatsNowUs();
+	LIB_SPOOL* pstSpool = GetSpool();
+	if (pstSpool == NULL)
+	{
+		snprintf(szRuntimeMsg, sizeof(szRuntimeMsg), "Unable to start the spool thread");
+		LOG_ERROR(pstErr, LIB_ERR_BUFFER_OVERFLOW, LIB_ERR_BUFFER_OVERFLOW_MSG, LIB_ERR_BUFFER_OVERFLOW_ACT, szRuntimeMsg)
+		return LIB_ERR;
+	}
+	LIB_PLOT_REQUEST stRequest;
+	if (ProtocolBuildPlot(pstInput, u32Flags, LIB_FALSE, &stRequest, pstErr) != LIB_OK)
+	{
+		return LIB_ERR;
+	}
+
+	// The payload follows the frames in the record
+	LIB_U64 u64FramesSize = AlignSpool(stRequest.u64HeadSize);
+	LIB_U64 u64DataSize = stRequest.pstPlot->u64PayloadSize;
+	stRequest.pstPlot->u32Flags |= LIB_PLOT_FLAG_SHM;
+	stRequest.pstPlot->u64ShmOffset = sizeof(LIB_SPOOL_RECORD_HDR) + u64FramesSize;
+	LIB_SPOOL_RECORD_HDR stRecord;
+	stRecord.u32Magic = LIB_SPOOL_RECORD_MAGIC;
+	stRecord.u32Type = LIB_SPOOL_PLOT;
+	stRecord.u64Length = u64FramesSize + AlignSpool(u64DataSize);
+	stRecord.u64TimeUs = GetWallUs();
+
+	LIB_U32 u32Ret = LIB_ERR;
+	{
+		std::unique_lock<std::mutex> lock(pstSpool->mutex);
+		LIB_CHAR* pcRecord = NULL;
+		LIB_U64 u64Offset = ReserveRecord(pstSpool, lock, sizeof(stRecord) + stRecord.u64Length, &pcRecord, pstErr);
+		if (u64Offset != 0)
+		{
+			LIB_CHAR* pcEnd = pcRecord + sizeof(stRecord) + stRecord.u64Length;
+			memcpy(pcRecord, &stRecord, sizeof(stRecord));
+			pcRecord += sizeof(stRecord);
+			memcpy(pcRecord, stRequest.pcHead, (size_t)stRequest.u64HeadSize);
+			memset(pcRecord + stRequest.u64HeadSize, 0, (size_t)(u64FramesSize - stRequest.u64HeadSize));
+			pcRecord += u64FramesSize;
+			for (LIB_U32 u32Seg = 0; u32Seg < stRequest.u32SegCount; u32Seg++)
+			{
+				memcpy(pcRecord, stRequest.prgstSegs[u32Seg].pcData, (size_t)stRequest.prgstSegs[u32Seg].u64Size);
+				pcRecord += stRequest.prgstSegs[u32Seg].u64Size;
+			}
+			memset(pcRecord, 0, (size_t)(pcEnd - pcRecord));
+
+			LIB_SPOOL_INDEX_ENTRY stEntry;
+			stEntry.u64Offset = u64Offset;
+			stEntry.u64TimeUs = stRecord.u64TimeUs;
+			pstSpool->vecEntries.push_back(stEntry);
+			pstSpool->bIndexed = LIB_FALSE;
+			u32Ret = LIB_OK;
+			// Bounds the index held in memory, the plot is in the log whether or not this succeeds
+			if (pstSpool->vecEntries.size() >= LIB_SPOOL_INDEX_PLOTS)
+			{
+				LIB_ERROR_INFO stIndexErr;
+				AppendIndex(pstSpool, lock, &stIndexErr);
+			}
+		}
+	}
+	ProtocolFreePlot(&stRequest);
+	StatsPhase("spool", u64StartUs, &pstStats->dSendMs);
+	if (u32Ret == LIB_OK)
+	{
+		pstErr->u32ErrCode = LIB_STATUS_DONE;
+	}
+	return u32Ret;
+}
+
+/***************************************************************************//**
+ * ipc_plot_spool_config
+ *
+ * Opens, switches or closes the spool log of ipc_plot()
+ *
+ * @param pszPath       Log to append to, NULL to close the open log
+ * @param u64BufferSize Bytes of each of the two buffers, 0 for LIB_SPOOL_DEFAULT_BUFFER
+ * @param pstErr        Error information structure for logging any errors
+ * @return              LIB_OK if success, else LIB_ERR if any error occurred
+ ******************************************************************************/
+LIB_U32 ipc_plot_spool_config(const LIB_CHAR* pszPath, LIB_U64 u64BufferSize, LIB_ERROR_INFO* pstErr)
+{
+	LIB_CHAR szRuntimeMsg[LIB_MAX_BUFFER_SIZE] = "";
+
+	// Check for null pointers
+	if (pstErr == NULL)
+	{
+		return LIB_ERR;
+	}
+	// The status of a previous successful call is not an error, let this call log its own
+	if (pstErr->u32ErrCode == LIB_STATUS_DONE)
+	{
+		*pstErr = LIB_ERROR_INFO();
+	}
+	if (pszPath != NULL && strlen(pszPath) >= LIB_SPOOL_MAX_PATH)
+	{
+		snprintf(szRuntimeMsg, sizeof(szRuntimeMsg), "Path of the spool log has %u characters, at most %u are supported",
+			(LIB_U32)strlen(pszPath), LIB_SPOOL_MAX_PATH - 1);
+		LOG_ERROR(pstErr, LIB_ERR_INPUT_INVALID, LIB_ERR_INPUT_INVALID_MSG, LIB_ERR_INPUT_INVALID_ACT, szRuntimeMsg)
+		return LIB_ERR;
+	}
+	LIB_SPOOL* pstSpool = GetSpool();
+	if (pstSpool == NULL)
+	{
+		snprintf(szRuntimeMsg, sizeof(szRuntimeMsg), "Unable to start the spool thread");
+		LOG_ERROR(pstErr, LIB_ERR_BUFFER_OVERFLOW, LIB_ERR_BUFFER_OVERFLOW_MSG, LIB_ERR_BUFFER_OVERFLOW_ACT, szRuntimeMsg)
+		return LIB_ERR;
+	}
+
+	// The log open so far is closed even if the new one fails to open. A close by another call is
+	// complete first, this call acts on the log it leaves.
+	std::unique_lock<std::mutex> lock(pstSpool->mutex);
+	WaitClosed(pstSpool, lock);
+	if (pstSpool->pFile != NULL && CloseLog(pstSpool, lock, pstErr) != LIB_OK)
+	{
+		return LIB_ERR;
+	}
+	if (pszPath != NULL && OpenLog(pstSpool, pszPath, (u64BufferSize != 0) ? u64BufferSize : LIB_SPOOL_DEFAULT_BUFFER, pstErr) != LIB_OK)
+	{
+		return LIB_ERR;
+	}
+	pstErr->u32ErrCode = LIB_STATUS_DONE;
+	return LIB_OK;
+}
+
+/***************************************************************************//**
+ * ipc_plot_spool_flush
+ *
+ * Indexes the plots spooled so far and writes them to the log
+ *
+ * @param pstErr Error information structure for logging any errors
+ * @return       LIB_OK if success, else LIB_ERR if any error occurred
+ ******************************************************************************/
+LIB_U32 ipc_plot_spool_flush(LIB_ERROR_INFO* pstErr)
+{
+	LIB_CHAR szRuntimeMsg[LIB_MAX_BUFFER_SIZE] = "";
+
+	// Check for null pointers
+	if (pstErr == NULL)
+	{
+		return LIB_ERR;
+	}
+	// The status of a previous successful call is not an error, let this call log its own
+	if (pstErr->u32ErrCode == LIB_STATUS_DONE)
+	{
+		*pstErr = LIB_ERROR_INFO();
+	}
+	LIB_SPOOL* pstSpool = GetSpool();
+	if (pstSpool == NULL)
+	{
+		snprintf(szRuntimeMsg, sizeof(szRuntimeMsg), "Unable to start the spool thread");
+		LOG_ERROR(pstErr, LIB_ERR_BUFFER_OVERFLOW, LIB_ERR_BUFFER_OVERFLOW_MSG, LIB_ERR_BUFFER_OVERFLOW_ACT, szRuntimeMsg)
+		return LIB_ERR;
+	}
+	std::unique_lock<std::mutex> lock(pstSpool->mutex);
+	WaitClosed(pstSpool, lock);
+	if (pstSpool->pFile == NULL)
+	{
+		snprintf(szRuntimeMsg, sizeof(szRuntimeMsg), "No spool log is open, see ipc_plot_spool_config()");
+		LOG_ERROR(pstErr, LIB_ERR_INPUT_INVALID, LIB_ERR_INPUT_INVALID_MSG, LIB_ERR_INPUT_INVALID_ACT, szRuntimeMsg)
+		return LIB_ERR;
+	}
+	if (FlushLog(pstSpool, lock, pstErr) != LIB_OK)
+	{
+		return LIB_ERR;
+	}
+	pstErr->u32ErrCode = LIB_STATUS_DONE;
+	return LIB_OK;
+}
@@ -0,0 +1,273 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifdef _WIN32
+#    include <process.h>
+#    define LIB_GETPID _getpid
+#else
+#    include <unistd.h>
+#    define LIB_GETPID getpid
+#endif
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <vector>
+
+#include "IPC_Plot_Cache.h"
+
+// One complete ("X") event of the Chrome trace-event format
+typedef struct LIB_TRACE_EVENT
+{
+	const LIB_CHAR* pszName;  //!< Phase or API name, always a string literal
+	LIB_U64 u64StartUs;
+	LIB_U64 u64DurationUs;
+	LIB_U32 u32Thread;        //!< Small number of the calling thread, see GetThreadNumber()
+	LIB_BOOLEAN bCall;        //!< Whole API call, stStats and u32ErrCode are written as arguments
+	LIB_U32 u32ErrCode;
+	LIB_PLOT_STATS stStats;
+} LIB_TRACE_EVENT;
+
+static std::atomic<LIB_U64> s_u64Calls(0);
+static std::atomic<LIB_U64> s_u64Failures(0);
+static std::atomic<LIB_U64> s_u64Timeouts(0);
+static std::atomic<LIB_U64> s_u64Rejected(0);
+static std::atomic<LIB_U64> s_u64BytesSent(0);
+static std::atomic<LIB_U64> s_u64BytesReceived(0);
+
+static std::atomic<bool> s_bTraceEnabled(false);
+static std::mutex s_traceMutex;                   //!< Guards s_vecTrace
+static std::vector<LIB_TRACE_EVENT> s_vecTrace;
+
+/***************************************************************************//**
+ * GetThreadNumber
+ *
+ * Numbers the threads in the order they first record an event, which keeps
+ * the rows of the trace viewer short and stable between runs
+ *
+ * @return Number of the calling thread, starting at 1
+ ******************************************************************************/
+static LIB_U32 GetThreadNumber(void)
+{
+	static std::atomic<LIB_U32> s_u32NextThread(1);
+	static thread_local LIB_U32 s_u32Thread = 0;
+	if (s_u32Thread == 0)
+	{
+		s_u32Thread = s_u32NextThread.fetch_add(1);
+	}
+	return s_u32Thread;
+}
+
+/***************************************************************************//**
+ * TraceAdd
+ *
+ * Records an event if tracing is enabled. Recording stops once the buffer
+ * is full so a forgotten trace cannot grow without bound.
+ *
+ * @param pstEvent Event to record, the thread number is filled in here
+ ******************************************************************************/
+static void TraceAdd(LIB_TRACE_EVENT* pstEvent)
+{
+	if (!s_bTraceEnabled.load(std::memory_order_relaxed))
+	{
+		return;
+	}
+	pstEvent->u32Thread = GetThreadNumber();
+	std::lock_guard<std::mutex> lock(s_traceMutex);
+	if (s_vecTrace.size() >= LIB_TRACE_MAX_EVENTS)
+	{
+		s_bTraceEnabled = false;
+		return;
+	}
+	s_vecTrace.push_back(*pstEvent);
+}
+
+/***************************************************************************//**
+ * StatsNowUs
+ *
+ * Reads the monotonic clock used for every timing of the library
+ *
+ * @return Microseconds since an arbitrary start
+ ******************************************************************************/
+LIB_U64 StatsNowUs(void)
+{
+	return (LIB_U64)std::chrono::duration_cast<std::chrono::microseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/***************************************************************************//**
+ * StatsPhase
+ *
+ * Ends a phase of a plot: stores its duration and records it as a trace
+ * event. Returns the end time so that the next phase can start from it.
+ *
+ * @param pszName     Name of the phase, a string literal
+ * @param u64StartUs  Start of the phase from StatsNowUs()
+ * @param pdOutMs     Receives the duration in milliseconds
+ * @return            End of the phase
+ ******************************************************************************/
+LIB_U64 StatsPhase(const LIB_CHAR* pszName, LIB_U64 u64StartUs, LIB_DOUBLE* pdOutMs)
+{
+	LIB_U64 u64EndUs = StatsNowUs();
+	*pdOutMs = (LIB_DOUBLE)(u64EndUs - u64StartUs) * 1e-3;
+
+	LIB_TRACE_EVENT stEvent = LIB_TRACE_EVENT();
+	stEvent.pszName = pszName;
+	stEvent.u64StartUs = u64StartUs;
+	stEvent.u64DurationUs = u64EndUs - u64StartUs;
+	TraceAdd(&stEvent);
+	return u64EndUs;
+}
+
+/***************************************************************************//**
+ * StatsCall
+ *
+ * Ends an API call: stores its total time, adds it to the process-wide
+ * counters and records it as a trace event with its statistics
+ *
+ * @param pszName    Name of the API function
+ * @param u64StartUs Start of the call from StatsNowUs()
+ * @param pstStats   Statistics of the call, dTotalMs is filled in here
+ * @param pstErr     Result of the call
+ ******************************************************************************/
+void StatsCall(const LIB_CHAR* pszName, LIB_U64 u64StartUs, LIB_PLOT_STATS* pstStats, const LIB_ERROR_INFO* pstErr)
+{
+	LIB_U64 u64EndUs = StatsNowUs();
+	pstStats->dTotalMs = (LIB_DOUBLE)(u64EndUs - u64StartUs) * 1e-3;
+
+	s_u64Calls++;
+	if (pstErr->u32ErrCode != LIB_STATUS_DONE)
+	{
+		s_u64Failures++;
+	}
+	if (pstErr->u32ErrCode == LIB_ERR_SERVER_TIMEOUT)
+	{
+		s_u64Timeouts++;
+	}
+	if (pstErr->u32ErrCode == LIB_ERR_BUSY)
+	{
+		s_u64Rejected++;
+	}
+	s_u64BytesSent += pstStats->u64BytesSent;
+	s_u64BytesReceived += pstStats->u64BytesReceived;
+
+	LIB_TRACE_EVENT stEvent = LIB_TRACE_EVENT();
+	stEvent.pszName = pszName;
+	stEvent.u64StartUs = u64StartUs;
+	stEvent.u64DurationUs = u64EndUs - u64StartUs;
+	stEvent.bCall = LIB_TRUE;
+	stEvent.u32ErrCode = pstErr->u32ErrCode;
+	stEvent.stStats = *pstStats;
+	TraceAdd(&stEvent);
+}
+
+/***************************************************************************//**
+ * ipc_plot_get_counters
+ *
+ * Reads the totals of every plot made by the process since it started
+ *
+ * @param pstOutCounters Receives the counters
+ ******************************************************************************/
+void ipc_plot_get_counters(LIB_PLOT_COUNTERS* pstOutCounters)
+{
+	if (pstOutCounters == NULL)
+	{
+		return;
+	}
+	pstOutCounters->u64Calls = s_u64Calls;
+	pstOutCounters->u64Failures = s_u64Failures;
+	pstOutCounters->u64Timeouts = s_u64Timeouts;
+	pstOutCounters->u64Rejected = s_u64Rejected;
+	pstOutCounters->u64BytesSent = s_u64BytesSent;
+	pstOutCounters->u64BytesReceived = s_u64BytesReceived;
+	pstOutCounters->u64PeakActive = AdmissionPeak();
+	CacheCounters(pstOutCounters);
+}
+
+/***************************************************************************//**
+ * ipc_plot_trace_enable
+ *
+ * Starts or stops recording the phases of every plot as trace events
+ *
+ * @param bEnable LIB_TRUE to record, LIB_FALSE to stop
+ ******************************************************************************/
+void ipc_plot_trace_enable(LIB_BOOLEAN bEnable)
+{
+	std::lock_guard<std::mutex> lock(s_traceMutex);
+	s_bTraceEnabled = (bEnable == LIB_TRUE);
+}
+
+/***************************************************************************//**
+ * ipc_plot_trace_dump
+ *
+ * Writes the recorded events to a file in the Chrome trace-event JSON
+ * format and clears the buffer
+ *
+ * @param pszPath Path of the JSON file
+ * @param pstErr  Error information structure for logging any errors
+ * @return        LIB_OK if success, else LIB_ERR if any error occurred
+ ******************************************************************************/
+LIB_U32 ipc_plot_trace_dump(const LIB_CHAR* pszPath, LIB_ERROR_INFO* pstErr)
+{
+	LIB_CHAR szRuntimeMsg[LIB_MAX_BUFFER_SIZE] = "";
+
+	// Check for null pointers
+	if (pstErr == NULL)
+	{
+		return LIB_ERR;
+	}
+	// The status of a previous successful call is not an error, let this call log its own
+	if (pstErr->u32ErrCode == LIB_STATUS_DONE)
+	{
+		*pstErr = LIB_ERROR_INFO();
+	}
+	if (pszPath == NULL)
+	{
+		snprintf(szRuntimeMsg, sizeof(szRuntimeMsg), "Trace file path is null pointer");
+		LOG_ERROR(pstErr, LIB_ERR_INPUT_PTR_NULL, LIB_ERR_INPUT_PTR_NULL_MSG, LIB_ERR_INPUT_PTR_NULL_ACT, szRuntimeMsg)
+		return LIB_ERR;
+	}
+
+	// Take the events so plots can keep recording while the file is written
+	std::vector<LIB_TRACE_EVENT> vecTrace;
+	{
+		std::lock_guard<std::mutex> lock(s_traceMutex);
+		vecTrace.swap(s_vecTrace);
+	}
+
+	FILE* pFile = fopen(pszPath, "w");
+	if (pFile == NULL)
+	{
+		snprintf(szRuntimeMsg, sizeof(szRuntimeMsg), "Unable to create trace file %s", pszPath);
+		LOG_ERROR(pstErr, LIB_ERR_FILE_IO, LIB_ERR_FILE_IO_MSG, LIB_ERR_FILE_IO_ACT, szRuntimeMsg)
+		return LIB_ERR;
+	}
+
+	LIB_INT32 nPid = (LIB_INT32)LIB_GETPID();
+	fprintf(pFile, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+	for (size_t szEvent = 0; szEvent < vecTrace.size(); szEvent++)
+	{
+		const LIB_TRACE_EVENT* pstEvent = &vecTrace[szEvent];
+		fprintf(pFile, "%s{\"name\":\"%s\",\"cat\":\"ipc_plot\",\"ph\":\"X\",\"ts\":%llu,\"dur\":%llu,\"pid\":%d,\"tid\":%u",
+			(szEvent == 0) ? "" : ",\n", pstEvent->pszName, pstEvent->u64StartUs, pstEvent->u64DurationUs, nPid, pstEvent->u32Thread);
+		if (pstEvent->bCall)
+		{
+			const LIB_PLOT_STATS* pstStats = &pstEvent->stStats;
+			fprintf(pFile, ",\"args\":{\"status\":\"0x%08X\",\"bytes_sent\":%llu,\"bytes_received\":%llu,"
+				"\"renderer_decode_ms\":%.3f,\"renderer_plot_ms\":%.3f,\"renderer_save_ms\":%.3f,\"cache_hit\":%s}",
+				pstEvent->u32ErrCode, pstStats->u64BytesSent, pstStats->u64BytesReceived,
+				pstStats->dRendererDecodeMs, pstStats->dRendererPlotMs, pstStats->dRendererSaveMs,
+				pstStats->bCacheHit ? "true" : "false");
+		}
+		fprintf(pFile, "}");
+	}
+	fprintf(pFile, "\n]}\n");
+	if (fclose(pFile) != 0)
+	{
+		snprintf(szRuntimeMsg, sizeof(szRuntimeMsg), "Unable to write trace file %s", pszPath);
+		LOG_ERROR(pstErr, LIB_ERR_FILE_IO, LIB_ERR_FILE_IO_MSG, LIB_ERR_FILE_IO_ACT, szRuntimeMsg)
+		return LIB_ERR;
+	}
+	pstErr->u32ErrCode = LIB_STATUS_DONE;
+	return LIB_OK;
+}
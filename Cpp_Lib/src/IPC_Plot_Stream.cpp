@@ -0,0 +1,252 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <new>
+
+#include "IPC_Plot_Protocol.h"
+
+// A live figure: its Python tool and the ring buffer both processes map
+struct LIB_STREAM
+{
+	LIB_SESSION* pstSession;  //!< Python tool drawing the figure, owned by the stream
+	LIB_SHM_INFO stShm;       //!< LIB_RING_HDR followed by the rows
+	LIB_RING_HDR* pstRing;
+	LIB_DOUBLE* prgdRows;     //!< u64Capacity rows of u32ColSize doubles
+	LIB_U32 u32ColSize;
+	LIB_U64 u64Capacity;
+};
+
+/***************************************************************************//**
+ * StreamFree
+ *
+ * Ends the Python tool of a stream, if any, and frees the ring buffer and
+ * the stream itself
+ *
+ * @param pstStream Stream, possibly only partly opened
+ ******************************************************************************/
+static void StreamFree(LIB_STREAM* pstStream)
+{
+	ipc_plot_session_close(pstStream->pstSession);
+	SharedMemClose(&pstStream->stShm);
+	free(pstStream);
+}
+
+/***************************************************************************//**
+ * ipc_plot_stream_open
+ *
+ * Creates the ring buffer, starts a Python tool and hands it the ring. The
+ * Python tool answers once it has mapped the ring and created the figure.
+ *
+ * @param u32ColSize    Number of columns, i.e. values in each row
+ * @param prgszLabels   Label of each column
+ * @param u32Capacity   Rows of the ring buffer, also the rows shown
+ * @param u32MaxFps     Highest frame rate, 0 for LIB_STREAM_DEFAULT_FPS
+ * @param ppstOutStream Receives the stream handle
+ * @param pstErr        Error information structure for logging any errors
+ * @return              LIB_OK if success, else LIB_ERR if any error occurred
+ ******************************************************************************/
+LIB_U32 ipc_plot_stream_open(LIB_U32 u32ColSize, const LIB_CHAR** prgszLabels, LIB_U32 u32Capacity,
+	LIB_U32 u32MaxFps, LIB_STREAM** ppstOutStream, LIB_ERROR_INFO* pstErr)
+{
+	LIB_CHAR szRuntimeMsg[LIB_MAX_BUFFER_SIZE] = "";
+
+	// Check for null pointers
+	if (pstErr == NULL)
+	{
+		return LIB_ERR;
+	}
+	// The status of a previous successful call is not an error, let this call log its own
+	if (pstErr->u32ErrCode == LIB_STATUS_DONE)
+	{
+		*pstErr = LIB_ERROR_INFO();
+	}
+	if (ppstOutStream == NULL || prgszLabels == NULL)
+	{
+		snprintf(szRuntimeMsg, sizeof(szRuntimeMsg), "Output stream pointer or labels is null pointer");
+		LOG_ERROR(pstErr, LIB_ERR_INPUT_PTR_NULL, LIB_ERR_INPUT_PTR_NULL_MSG, LIB_ERR_INPUT_PTR_NULL_ACT, szRuntimeMsg)
+		return LIB_ERR;
+	}
+	*ppstOutStream = NULL;
+	for (LIB_U32 u32Col = 0; u32Col < u32ColSize; u32Col++)
+	{
+		if (prgszLabels[u32Col] == NULL)
+		{
+			snprintf(szRuntimeMsg, sizeof(szRuntimeMsg), "Label of column %u is null pointer", u32Col);
+			LOG_ERROR(pstErr, LIB_ERR_INPUT_PTR_NULL, LIB_ERR_INPUT_PTR_NULL_MSG, LIB_ERR_INPUT_PTR_NULL_ACT, szRuntimeMsg)
+			return LIB_ERR;
+		}
+	}
+	if (u32MaxFps == 0)
+	{
+		u32MaxFps = LIB_STREAM_DEFAULT_FPS;
+	}
+	if (u32ColSize == 0 || u32Capacity < 2 || u32MaxFps > LIB_STREAM_MAX_FPS)
+	{
+		snprintf(szRuntimeMsg, sizeof(szRuntimeMsg), "Stream of %u columns, %u rows at %u fps, expected at least 1 column, 2 rows and at most %u fps",
+			u32ColSize, u32Capacity, u32MaxFps, LIB_STREAM_MAX_FPS);
+		LOG_ERROR(pstErr, LIB_ERR_INPUT_INVALID, LIB_ERR_INPUT_INVALID_MSG, LIB_ERR_INPUT_INVALID_ACT, szRuntimeMsg)
+		return LIB_ERR;
+	}
+
+	LIB_STREAM* pstStream = (LIB_STREAM*)calloc(1, sizeof(LIB_STREAM));
+	if (pstStream == NULL)
+	{
+		snprintf(szRuntimeMsg, sizeof(szRuntimeMsg), "Unable to allocate stream");
+		LOG_ERROR(pstErr, LIB_ERR_BUFFER_OVERFLOW, LIB_ERR_BUFFER_OVERFLOW_MSG, LIB_ERR_BUFFER_OVERFLOW_ACT, szRuntimeMsg)
+		return LIB_ERR;
+	}
+	pstStream->u32ColSize = u32ColSize;
+	pstStream->u64Capacity = u32Capacity;
+
+	// 01. Ring buffer in shared memory, the header is constructed in place for its atomics
+	LIB_U64 u64ShmSize = sizeof(LIB_RING_HDR) + (LIB_U64)u32Capacity * u32ColSize * sizeof(LIB_DOUBLE);
+	if (SharedMemCreate(u64ShmSize, &pstStream->stShm, pstErr) != LIB_OK)
+	{
+		free(pstStream);
+		return LIB_ERR;
+	}
+	pstStream->pstRing = new (pstStream->stShm.pvBase) LIB_RING_HDR();
+	pstStream->pstRing->u32Magic = LIB_RING_MAGIC;
+	pstStream->pstRing->u32ColSize = u32ColSize;
+	pstStream->pstRing->u64Capacity = u32Capacity;
+	pstStream->pstRing->u64Dropped = 0;
+	pstStream->pstRing->u64Head = 0;
+	pstStream->pstRing->u64Tail = 0;
+	pstStream->prgdRows = (LIB_DOUBLE*)(pstStream->pstRing + 1);
+
+	// 02. Python tool of the stream, not taken from the pool as it stays busy until the stream is closed
+	if (ipc_plot_session_open(&pstStream->pstSession, pstErr) != LIB_OK)
+	{
+		StreamFree(pstStream);
+		return LIB_ERR;
+	}
+	// The session leaves its status, later errors are logged by this call
+	*pstErr = LIB_ERROR_INFO();
+
+	// 03. STREAM frame with the ring, answered once the Python tool has mapped it
+	LIB_STREAM_HDR stHdr;
+	memset(&stHdr, 0, sizeof(stHdr));
+	stHdr.u32ColSize = u32ColSize;
+	stHdr.u32MaxFps = u32MaxFps;
+	stHdr.u64Capacity = u32Capacity;
+	stHdr.u64ShmSize = u64ShmSize;
+#ifdef _WIN32
+	snprintf(stHdr.szShmName, sizeof(stHdr.szShmName), "%s", pstStream->stShm.szName);
+	LIB_INT32 nShmFd = -1;
+#else
+	LIB_INT32 nShmFd = pstStream->stShm.nFd;
+#endif
+	if (ProtocolSendStream(pstStream->pstSession, &stHdr, prgszLabels, nShmFd, pstErr) != LIB_OK
+		|| ProtocolRecvStatus(pstStream->pstSession, pstErr) != LIB_OK)
+	{
+		StreamFree(pstStream);
+		return LIB_ERR;
+	}
+	*ppstOutStream = pstStream;
+	return LIB_OK;
+}
+
+/***************************************************************************//**
+ * ipc_plot_stream_append
+ *
+ * Copies rows into the free part of the ring and publishes them by moving
+ * the head. Never waits: rows beyond the free space are dropped.
+ *
+ * @param pstStream       Stream from ipc_plot_stream_open()
+ * @param prgdRows        u32Rows rows of u32ColSize doubles each
+ * @param u32Rows         Number of rows
+ * @param pu32OutAppended Receives the number of rows appended, may be NULL
+ * @param pstErr          Error information structure for logging any errors
+ * @return                LIB_OK if success, else LIB_ERR if any error occurred
+ ******************************************************************************/
+LIB_U32 ipc_plot_stream_append(LIB_STREAM* pstStream, const LIB_DOUBLE* prgdRows, LIB_U32 u32Rows,
+	LIB_U32* pu32OutAppended, LIB_ERROR_INFO* pstErr)
+{
+	LIB_CHAR szRuntimeMsg[LIB_MAX_BUFFER_SIZE] = "";
+
+	// Check for null pointers
+	if (pstErr == NULL)
+	{
+		return LIB_ERR;
+	}
+	// The status of a previous successful call is not an error, let this call log its own
+	if (pstErr->u32ErrCode == LIB_STATUS_DONE)
+	{
+		*pstErr = LIB_ERROR_INFO();
+	}
+	if (pstStream == NULL || (prgdRows == NULL && u32Rows > 0))
+	{
+		snprintf(szRuntimeMsg, sizeof(szRuntimeMsg), "Stream or rows is null pointer");
+		LOG_ERROR(pstErr, LIB_ERR_INPUT_PTR_NULL, LIB_ERR_INPUT_PTR_NULL_MSG, LIB_ERR_INPUT_PTR_NULL_ACT, szRuntimeMsg)
+		return LIB_ERR;
+	}
+
+	// Only this thread moves the head, the tail is released by the Python tool after reading its rows
+	LIB_RING_HDR* pstRing = pstStream->pstRing;
+	LIB_U64 u64Head = pstRing->u64Head.load(std::memory_order_relaxed);
+	LIB_U64 u64Tail = pstRing->u64Tail.load(std::memory_order_acquire);
+	LIB_U64 u64Free = pstStream->u64Capacity - (u64Head - u64Tail);
+	LIB_U64 u64Count = (u32Rows < u64Free) ? u32Rows : u64Free;
+
+	// At most two copies, the second one after wrapping around the end of the ring
+	LIB_U64 u64RowSize = (LIB_U64)pstStream->u32ColSize * sizeof(LIB_DOUBLE);
+	LIB_U64 u64Slot = u64Head % pstStream->u64Capacity;
+	LIB_U64 u64First = pstStream->u64Capacity - u64Slot;
+	if (u64First > u64Count)
+	{
+		u64First = u64Count;
+	}
+	memcpy((LIB_CHAR*)pstStream->prgdRows + u64Slot * u64RowSize, prgdRows, (size_t)(u64First * u64RowSize));
+	memcpy(pstStream->prgdRows, (const LIB_CHAR*)prgdRows + u64First * u64RowSize, (size_t)((u64Count - u64First) * u64RowSize));
+	pstRing->u64Dropped += u32Rows - u64Count;
+	pstRing->u64Head.store(u64Head + u64Count, std::memory_order_release);
+
+	if (pu32OutAppended != NULL)
+	{
+		*pu32OutAppended = (LIB_U32)u64Count;
+	}
+	pstErr->u32ErrCode = LIB_STATUS_DONE;
+	return LIB_OK;
+}
+
+/***************************************************************************//**
+ * ipc_plot_stream_close
+ *
+ * Sends the end of the stream, waits for the Python tool to draw the last
+ * rows and frees the stream
+ *
+ * @param pstStream Stream from ipc_plot_stream_open(), NULL is a no-op
+ * @param pstErr    Error information structure for logging any errors
+ * @return          LIB_OK if success, else LIB_ERR if any error occurred
+ ******************************************************************************/
+LIB_U32 ipc_plot_stream_close(LIB_STREAM* pstStream, LIB_ERROR_INFO* pstErr)
+{
+	// Check for null pointers
+	if (pstErr == NULL)
+	{
+		if (pstStream != NULL)
+		{
+			StreamFree(pstStream);
+		}
+		return LIB_ERR;
+	}
+	// The status of a previous successful call is not an error, let this call log its own
+	if (pstErr->u32ErrCode == LIB_STATUS_DONE)
+	{
+		*pstErr = LIB_ERROR_INFO();
+	}
+	if (pstStream == NULL)
+	{
+		pstErr->u32ErrCode = LIB_STATUS_DONE;
+		return LIB_OK;
+	}
+
+	LIB_U32 u32Ret = LIB_ERR;
+	if (ProtocolSendFrame(pstStream->pstSession, LIB_MSG_STREAM_END, pstErr) == LIB_OK
+		&& ProtocolRecvStatus(pstStream->pstSession, pstErr) == LIB_OK)
+	{
+		u32Ret = LIB_OK;
+	}
+	StreamFree(pstStream);
+	return u32Ret;
+}
@@ -0,0 +1,596 @@
+#ifdef _WIN32
+
+#include <stdio.h>
+#include <windows.h>
+
+#include "IPC_Plot_Protocol.h"
+
+LIB_INT32 GetWinAPIErrMessage(DWORD dwErrCode, LIB_CHAR* pszOutWinAPIErrorMsg, LIB_ERROR_INFO* pstErr);
+LIB_INT32 ConnectPipe(LIB_SESSION* pstSession, LIB_ERROR_INFO* pstErr);
+
+#define LOG_WIN_API_ERROR(pstERR_Out, pcRUNTIME_In) \
+    { \
+    	LIB_CHAR szErrHelpString[LIB_MAX_BUFFER_SIZE] = LIB_ERR_WIN_API_ERR_ACT; \
+    	GetWinAPIErrMessage(GetLastError(), szErrHelpString, pstERR_Out); \
+    	LOG_ERROR(pstERR_Out, LIB_ERR_WIN_API_ERR, LIB_ERR_WIN_API_ERR_MSG, szErrHelpString, pcRUNTIME_In) \
+    }
+
+/***************************************************************************//**
+ * RendererOpen
+ *
+ * Creates a named pipe, runs the Python tool with its name and waits for the
+ * Python tool to connect and send its READY frame. The connection is kept 
+ * open until RendererClose() so that the Python tool can plot any number of 
+ * buffers.
+ *
+ * @param pstSession Session receiving the pipe and process handles
+ * @param pstErr     Error information structure for logging any errors
+ * @return           LIB_OK if success, else LIB_ERR if any error occurred
+ ******************************************************************************/
+LIB_U32 RendererOpen(LIB_SESSION* pstSession, LIB_ERROR_INFO* pstErr)
+{
+	static volatile LONG s_lPipeCount = 0;
+	LIB_CHAR szRuntimeMsg[LIB_MAX_BUFFER_SIZE] = "";
+	LIB_U64 u64StartUs = StatsNowUs();
+
+	HANDLE hNamedPipe;
+	DWORD dwszInputBuffer = LIB_PIPE_BUFFER_SIZE;
+	DWORD dwszOutputBuffer = LIB_PIPE_BUFFER_SIZE;
+
+	// Named pipes steps (labelled in numerical order)
+	// 01. CreateNamedPipe() to create the named pipe before the Python tool starts, so it never has to retry
+	// The name of the pipe is unique for each application and session, and passed to the Python tool
+	LIB_CHAR szNamedPipe[64];
+	snprintf(szNamedPipe, sizeof(szNamedPipe), "\\\\.\\pipe\\IPC_Plot_%lu_%ld", GetCurrentProcessId(), InterlockedIncrement(&s_lPipeCount));
+	hNamedPipe = CreateNamedPipe(
+		(LPCSTR)szNamedPipe, // Name of the pipe, unique for each application and client instance
+		// PIPE_ACCESS_DUPLEX: Both server and client processes can read from and write to the pipe
+		// FILE_FLAG_OVERLAPPED: Prevent server from waiting infinitely for a client to connect	
+		PIPE_ACCESS_DUPLEX | FILE_FLAG_OVERLAPPED,
+		// PIPE_TYPE_BYTE: The pipe is a byte stream, messages are framed by IPC_Plot_Protocol.h
+		// PIPE_READMODE_BYTE: Data is read from the pipe as a stream of bytes
+		// PIPE_WAIT: Blocking mode - wait until client connects to named pipe (default) or timeout
+		PIPE_TYPE_BYTE | PIPE_READMODE_BYTE | PIPE_WAIT,
+		// Maximum number of instances that can be created for this pipe (from 1 to 255)
+		1,
+		// The non-paged pool (physical memory used by the kernel) is used to create the size of the pipe
+		// Insufficient buffer will just block the write operation until buffer (the non-paged pool) is expanded by OS
+		dwszOutputBuffer,
+		dwszInputBuffer,
+		0, // How long to wait until the named pipe is successfully created. Default value of 50ms
+		NULL // Prevent handle (hNamedPipe) from being inherited
+	);
+
+	if (hNamedPipe == NULL || hNamedPipe == INVALID_HANDLE_VALUE)
+	{
+		// Error creating the pipe
+		snprintf(szRuntimeMsg, sizeof(szRuntimeMsg), "CreateNamedPipe() failed for %s", szNamedPipe);
+		LOG_WIN_API_ERROR(pstErr, szRuntimeMsg)
+		return LIB_ERR;
+	}
+
+	// 02. Run the Python tool via CreateProcess()
+	LIB_CHAR szCmdLine[LIB_MAX_BUFFER_SIZE];
+	snprintf(szCmdLine, sizeof(szCmdLine), "python.exe %s --pipe %s", GetRendererPath(), szNamedPipe);
+
+	STARTUPINFO si = { sizeof(si) };
+	PROCESS_INFORMATION pi;
+
+	// memset() to 0
+	ZeroMemory(&si, sizeof(si));
+	ZeroMemory(&pi, sizeof(pi));
+
+	if (!CreateProcess(NULL,   // No module name (use command line)
+		(LPTSTR)szCmdLine,     // Command line (<exename> <arg1> <arg2> etc)
+		NULL,                  // Process handle not inheritable
+		NULL,                  // Thread handle not inheritable
+		FALSE,                 // The pipe is opened by name, another thread's handles must not leak into the child
+		0,                     // No creation flags
+		NULL,                  // Use parent's environment block
+		NULL,                  // Use parent's starting directory 
+		&si,                   // Pointer to STARTUPINFO structure
+		&pi)                   // Pointer to PROCESS_INFORMATION structure
+		)
+	{
+		// CreateProcess() error
+		snprintf(szRuntimeMsg, sizeof(szRuntimeMsg), "Error from the Python tool at %s", GetRendererPath());
+		LOG_WIN_API_ERROR(pstErr, szRuntimeMsg)
+		CloseHandle(hNamedPipe);
+		return LIB_ERR;
+	}
+
+	CloseHandle(pi.hThread);
+	pstSession->hNamedPipe = hNamedPipe;
+	pstSession->hChildProcess = pi.hProcess;
+	u64StartUs = StatsPhase("spawn", u64StartUs, &pstSession->stStats.dSpawnMs);
+
+	// 03. Wait once for the Python tool to connect and be ready, it stays connected for the whole session
+	if (ConnectPipe(pstSession, pstErr) != LIB_OK || ProtocolRecvReady(pstSession, pstErr) != LIB_OK)
+	{
+		RendererClose(pstSession);
+		return LIB_ERR;
+	}
+	StatsPhase("connect", u64StartUs, &pstSession->stStats.dConnectMs);
+	return LIB_OK;
+}
+
+/***************************************************************************//**
+ * ConnectPipe
+ *
+ * Waits for the Python tool to connect to the named pipe, which it does as 
+ * soon as its modules are imported. The wait ends early if the Python tool 
+ * exits instead, e.g. on an import error.
+ *
+ * @param pstSession Session with the pipe and process handles
+ * @param pstErr     Error information structure for logging any errors
+ * @return           LIB_OK if success, else LIB_ERR if any error occurred
+ ******************************************************************************/
+LIB_INT32 ConnectPipe(LIB_SESSION* pstSession, LIB_ERROR_INFO* pstErr)
+{
+	LIB_CHAR szRuntimeMsg[LIB_MAX_BUFFER_SIZE] = "";
+
+	DWORD dwErr, dwOverlappedResult;
+
+	// Struct contains information used in asynchronous (a.k.a. overlapped) input and output
+	// Used to add the event flag to the struct
+	OVERLAPPED stOverlapped = { 0 };
+	// Create event flag to check if client has connected
+	stOverlapped.hEvent = CreateEvent(NULL,  // SECURITY_ATTRIBUTES, cannot be inherited by child processes
+									  TRUE,  // Requires ResetEvent() to manually set the event to non-signalled (wait)
+									  FALSE, // Initial state of event is non-signalled (wait)
+									  NULL); // Name of event object is not set
+
+	// ConnectNamedPipe() to check if the client has connected to the pipe
+	// If not, wait until it connects, exits or LIB_READY_WAIT_MS lapses
+	if (!ConnectNamedPipe(pstSession->hNamedPipe, &stOverlapped))
+	{
+		dwErr = GetLastError();
+		if (dwErr == ERROR_PIPE_CONNECTED)
+		{
+			// Client connected between CreateNamedPipe() and ConnectNamedPipe()
+			CloseHandle(stOverlapped.hEvent);
+			return LIB_OK;
+		}
+		if (!(dwErr == ERROR_IO_PENDING || dwErr == ERROR_PIPE_LISTENING))
+		{
+			CloseHandle(stOverlapped.hEvent);
+			// Some other error occurred while connecting server to pipe
+			snprintf(szRuntimeMsg, sizeof(szRuntimeMsg), "ConnectNamedPipe() failed");
+			LOG_WIN_API_ERROR(pstErr, szRuntimeMsg)
+			return LIB_ERR;
+		}
+		HANDLE rghWait[2] = { stOverlapped.hEvent, pstSession->hChildProcess };
+		DWORD dwWait = WaitForMultipleObjects(2, rghWait, FALSE, LIB_READY_WAIT_MS);
+		if (dwWait != WAIT_OBJECT_0)
+		{
+			// Cancel the pending connect before reporting error
+			CancelIo(pstSession->hNamedPipe);
+			GetOverlappedResult(pstSession->hNamedPipe, &stOverlapped, &dwOverlappedResult, TRUE);
+			CloseHandle(stOverlapped.hEvent);
+			if (dwWait == WAIT_OBJECT_0 + 1)
+			{
+				snprintf(szRuntimeMsg, sizeof(szRuntimeMsg), "Python tool at %s exited before connecting", GetRendererPath());
+				LOG_ERROR(pstErr, LIB_ERR_CLIENT_EXITED, LIB_ERR_CLIENT_EXITED_MSG, LIB_ERR_CLIENT_EXITED_ACT, szRuntimeMsg)
+				return LIB_ERR;
+			}
+			snprintf(szRuntimeMsg, sizeof(szRuntimeMsg), "No response from the Python tool after %d seconds", LIB_READY_WAIT_MS / 1000);
+			LOG_ERROR(pstErr, LIB_ERR_SERVER_TIMEOUT, LIB_ERR_SERVER_TIMEOUT_MSG, LIB_ERR_SERVER_TIMEOUT_ACT, szRuntimeMsg)
+			return LIB_ERR;
+		}
+		// Check the connect succeeded now that the event is signalled
+		if (!GetOverlappedResult(pstSession->hNamedPipe, // The handle to the named pipe
+								 &stOverlapped,          // A pointer to an OVERLAPPED structure
+								 &dwOverlappedResult,    // Not used: Receives the number of bytes that were
+														 // transferred by a read or write operation
+								 FALSE))                 // The event is signalled, the result is final
+		{
+			CloseHandle(stOverlapped.hEvent);
+			// Some other error occurred while connecting server to pipe
+			snprintf(szRuntimeMsg, sizeof(szRuntimeMsg), "ConnectNamedPipe() failed");
+			LOG_WIN_API_ERROR(pstErr, szRuntimeMsg)
+			return LIB_ERR;
+		}
+	}
+
+	CloseHandle(stOverlapped.hEvent);
+	return LIB_OK;
+}
+
+/***************************************************************************//**
+ * RendererPlot
+ *
+ * Sends one buffer to the connected Python tool and waits for its status.
+ * The data is written straight from the caller's buffer.
+ *
+ * @param pstSession Session with the pipe and process handles
+ * @param pstInput   Input structure including data buffer and labels
+ * @param u32Flags   LIB_PLOT_FLAG_XY if the buffer holds X and Y columns
+ * @param pstErr     Error information structure for logging any errors
+ * @return           LIB_OK if success, else LIB_ERR if any error occurred
+ ******************************************************************************/
+LIB_U32 RendererPlot(LIB_SESSION* pstSession, LIB_INPUT* pstInput, LIB_U32 u32Flags, LIB_ERROR_INFO* pstErr)
+{
+	LIB_CHAR szRuntimeMsg[LIB_MAX_BUFFER_SIZE] = "";
+	LIB_U64 u64StartUs = StatsNowUs();
+
+	// 04. WriteFile() to send the request frames to Python tool
+	if (ProtocolSendPlot(pstSession, pstInput, u32Flags, -1, 0, pstErr) != LIB_OK)
+	{
+		return LIB_ERR;
+	}
+
+	// 05. FlushFileBuffers() after writing data
+	// FlushFileBuffers() ensure that all bytes or messages written to the pipe are read by the client
+	if (!FlushFileBuffers(pstSession->hNamedPipe))
+	{
+		// Error flushing buffer because client has not finished reading all bytes
+		snprintf(szRuntimeMsg, sizeof(szRuntimeMsg), "FlushFileBuffer() failed");
+		LOG_WIN_API_ERROR(pstErr, szRuntimeMsg)
+		return LIB_ERR;
+	}
+	u64StartUs = StatsPhase("send", u64StartUs, &pstSession->stStats.dSendMs);
+
+	// 06. ReadFile() to receieve the image, if returned in memory, and the status
+	LIB_U32 u32Ret = (ProtocolRecvResult(pstSession, pstInput, pstErr) == LIB_OK) ? LIB_OK : LIB_ERR;
+	StatsPhase("render", u64StartUs, &pstSession->stStats.dRenderMs);
+	return u32Ret;
+}
+
+/***************************************************************************//**
+ * RendererAlive
+ *
+ * Checks an idle session before it is reused
+ *
+ * @param pstSession Session with the pipe and process handles
+ * @return           LIB_TRUE if the Python tool is still running
+ ******************************************************************************/
+LIB_BOOLEAN RendererAlive(LIB_SESSION* pstSession)
+{
+	return (WaitForSingleObject(pstSession->hChildProcess, 0) == WAIT_TIMEOUT) ? LIB_TRUE : LIB_FALSE;
+}
+
+/***************************************************************************//**
+ * TransportSend
+ *
+ * Writes bytes to the named pipe of a session
+ *
+ * @param pstSession Session with the pipe and process handles
+ * @param pvData     Bytes to write
+ * @param u64Size    Number of bytes to write
+ * @param nFd        Not used on Windows, must be -1
+ * @param pstErr     Error information structure for logging any errors
+ * @return           LIB_OK if success, else LIB_ERR if any error occurred
+ ******************************************************************************/
+LIB_INT32 TransportSend(LIB_SESSION* pstSession, const void* pvData, LIB_U64 u64Size, LIB_INT32 nFd, LIB_ERROR_INFO* pstErr)
+{
+	LIB_CHAR szRuntimeMsg[LIB_MAX_BUFFER_SIZE] = "";
+	const LIB_CHAR* pcData = (const LIB_CHAR*)pvData;
+	DWORD dwResult;
+
+	(void)nFd;
+	while (u64Size > 0)
+	{
+		// WriteFile() takes at most a DWORD of bytes per call
+		DWORD dwChunk = (u64Size > LIB_PIPE_BUFFER_SIZE) ? LIB_PIPE_BUFFER_SIZE : (DWORD)u64Size;
+		if (!WriteFile(
+			pstSession->hNamedPipe, // The handle to the named pipe
+			pcData,                 // A pointer to the buffer that sends the data to the named pipe
+			dwChunk,                // The number of bytes to be written to the file 
+			&dwResult,
+			NULL))
+		{
+			// Error writing to named pipe
+			snprintf(szRuntimeMsg, sizeof(szRuntimeMsg), "WriteFile() failed - error writing to pipe");
+			LOG_WIN_API_ERROR(pstErr, szRuntimeMsg)
+			return LIB_ERR;
+		}
+		pcData += dwResult;
+		u64Size -= dwResult;
+		pstSession->stStats.u64BytesSent += dwResult;
+	}
+	return LIB_OK;
+}
+
+/***************************************************************************//**
+ * TransportRecv
+ *
+ * Reads exactly the requested number of bytes from the named pipe of a 
+ * session
+ *
+ * @param pstSession Session with the pipe and process handles
+ * @param pvData     Buffer receiving the bytes
+ * @param u64Size    Number of bytes to read
+ * @param pstErr     Error information structure for logging any errors
+ * @return           LIB_OK if success, else LIB_ERR if any error occurred
+ ******************************************************************************/
+LIB_INT32 TransportRecv(LIB_SESSION* pstSession, void* pvData, LIB_U64 u64Size, LIB_ERROR_INFO* pstErr)
+{
+	LIB_CHAR szRuntimeMsg[LIB_MAX_BUFFER_SIZE] = "";
+	LIB_CHAR* pcData = (LIB_CHAR*)pvData;
+	DWORD dwResult;
+
+	while (u64Size > 0)
+	{
+		DWORD dwChunk = (u64Size > LIB_PIPE_BUFFER_SIZE) ? LIB_PIPE_BUFFER_SIZE : (DWORD)u64Size;
+		if (!ReadFile(
+			pstSession->hNamedPipe, // The handle to the named pipe
+			pcData,                 // A pointer to the buffer that receives the data from the named pipe
+			dwChunk,                // The maximum number of bytes to be read
+			&dwResult,
+			NULL))
+		{
+			if (GetLastError() == ERROR_BROKEN_PIPE)
+			{
+				// The Python tool closed its end, typically because it raised an exception
+				snprintf(szRuntimeMsg, sizeof(szRuntimeMsg), "Pipe closed with %llu bytes outstanding", u64Size);
+				LOG_ERROR(pstErr, LIB_ERR_CLIENT_EXITED, LIB_ERR_CLIENT_EXITED_MSG, LIB_ERR_CLIENT_EXITED_ACT, szRuntimeMsg)
+				return LIB_ERR;
+			}
+			// Error reading data from client
+			snprintf(szRuntimeMsg, sizeof(szRuntimeMsg), "ReadFile() failed - error reading from pipe");
+			LOG_WIN_API_ERROR(pstErr, szRuntimeMsg)
+			return LIB_ERR;
+		}
+		pcData += dwResult;
+		u64Size -= dwResult;
+		pstSession->stStats.u64BytesReceived += dwResult;
+	}
+	return LIB_OK;
+}
+
+/***************************************************************************//**
+ * RendererClose
+ *
+ * Disconnects the named pipe, which ends the request loop of the Python 
+ * tool, and waits for the process to exit
+ *
+ * @param pstSession Session with the pipe and process handles
+ ******************************************************************************/
+void RendererClose(LIB_SESSION* pstSession)
+{
+	// 07. DisconnectNamedPipe() after all data is sent
+	// Any unread data in the pipe is discarded, and makes the client's named pipe handle invalid.
+	if (pstSession->hNamedPipe != NULL)
+	{
+		DisconnectNamedPipe(pstSession->hNamedPipe);
+		CloseHandle(pstSession->hNamedPipe);
+		pstSession->hNamedPipe = NULL;
+	}
+	// 08. Free resources (handles) after the Python tool has exited
+	if (pstSession->hChildProcess != NULL)
+	{
+		if (WaitForSingleObject(pstSession->hChildProcess, LIB_CLOSE_WAIT_MS) != WAIT_OBJECT_0)
+		{
+			TerminateProcess(pstSession->hChildProcess, 0);
+		}
+		CloseHandle(pstSession->hChildProcess);
+		pstSession->hChildProcess = NULL;
+	}
+}
+
+/***************************************************************************//**
+ * GetWinAPIErrMessage
+ *
+ * Retrives the error message from GetLastError() and logs the message 
+ * into the runtime message
+ *
+ * @param dwErrCode            Error code generated by GetLastError()
+ * @param pszOutWinAPIErrorMsg Runtime message for WinAPI errors
+ * @param pstErr               Error information structure for logging any errors
+ * @return                     LIB_OK if success, else LIB_ERR if any error 
+ *                             occurred
+ ******************************************************************************/
+LIB_INT32 GetWinAPIErrMessage(DWORD dwErrCode, LIB_CHAR* pszOutWinAPIErrorMsg, LIB_ERROR_INFO* pstErr)
+{
+	LPVOID lpMsgBuf;
+	pstErr = pstErr;
+	FormatMessage(FORMAT_MESSAGE_ALLOCATE_BUFFER |
+				  FORMAT_MESSAGE_FROM_SYSTEM |
+				  FORMAT_MESSAGE_IGNORE_INSERTS,
+				  NULL,
+				  dwErrCode,
+				  MAKELANGID(LANG_NEUTRAL, SUBLANG_DEFAULT),
+				  (LPTSTR)&lpMsgBuf,
+				  0, 
+		          NULL);
+
+
+	LIB_CHAR szErrorCodeBuf[LIB_MAX_BUFFER_SIZE] = "";
+	sprintf(szErrorCodeBuf, "Error %d: ", dwErrCode);
+	strncat(pszOutWinAPIErrorMsg, szErrorCodeBuf, LIB_MAX_BUFFER_SIZE - strlen(pszOutWinAPIErrorMsg) - 1);
+	strncat(pszOutWinAPIErrorMsg, (LIB_CHAR*)lpMsgBuf, LIB_MAX_BUFFER_SIZE - strlen(pszOutWinAPIErrorMsg) - 1);
+	return LIB_OK;
+}
+
+/***************************************************************************//**
+ * SharedMemCreate
+ *
+ * Creates a named file mapping backed by the paging file and maps a view of
+ * it into this process. The Python tool opens the same mapping by its name,
+ * which is unique to this process.
+ *
+ * @param u64Size Size of the mapping in bytes
+ * @param pstShm  Receives the handle, view and name of the mapping
+ * @param pstErr  Error information structure for logging any errors
+ * @return        LIB_OK if success, else LIB_ERR if any error occurred
+ ******************************************************************************/
+LIB_INT32 SharedMemCreate(LIB_U64 u64Size, LIB_SHM_INFO* pstShm, LIB_ERROR_INFO* pstErr)
+{
+	static volatile LONG s_lShmCount = 0;
+	LIB_CHAR szRuntimeMsg[LIB_MAX_BUFFER_SIZE] = "";
+
+	pstShm->pvBase = NULL;
+	pstShm->u64Size = u64Size;
+	snprintf(pstShm->szName, sizeof(pstShm->szName), "Local\\IPC_Plot_%lu_%ld", GetCurrentProcessId(), InterlockedIncrement(&s_lShmCount));
+	pstShm->hMapping = CreateFileMapping(INVALID_HANDLE_VALUE, // Backed by the paging file
+		NULL,                                                  // Handle cannot be inherited
+		PAGE_READWRITE,
+		(DWORD)(u64Size >> 32),
+		(DWORD)(u64Size & 0xFFFFFFFF),
+		pstShm->szName);
+	if (pstShm->hMapping == NULL)
+	{
+		snprintf(szRuntimeMsg, sizeof(szRuntimeMsg), "CreateFileMapping() failed for %llu bytes", u64Size);
+		LOG_WIN_API_ERROR(pstErr, szRuntimeMsg)
+		return LIB_ERR;
+	}
+	pstShm->pvBase = MapViewOfFile(pstShm->hMapping, FILE_MAP_ALL_ACCESS, 0, 0, (SIZE_T)u64Size);
+	if (pstShm->pvBase == NULL)
+	{
+		snprintf(szRuntimeMsg, sizeof(szRuntimeMsg), "MapViewOfFile() failed for %llu bytes", u64Size);
+		LOG_WIN_API_ERROR(pstErr, szRuntimeMsg)
+		SharedMemClose(pstShm);
+		return LIB_ERR;
+	}
+	return LIB_OK;
+}
+
+/***************************************************************************//**
+ * SharedMemClose
+ *
+ * Unmaps the view and closes the mapping handle. Safe to call on a mapping
+ * that was only partly created.
+ *
+ * @param pstShm Mapping created by SharedMemCreate()
+ ******************************************************************************/
+void SharedMemClose(LIB_SHM_INFO* pstShm)
+{
+	if (pstShm->pvBase != NULL)
+	{
+		UnmapViewOfFile(pstShm->pvBase);
+		pstShm->pvBase = NULL;
+	}
+	if (pstShm->hMapping != NULL)
+	{
+		CloseHandle(pstShm->hMapping);
+		pstShm->hMapping = NULL;
+	}
+}
+
+/***************************************************************************//**
+ * FileMapOpen
+ *
+ * Maps a whole file read-only. Pages are only read when a sample on them is.
+ * The named pipe always copies the data, so the mapping has no name and is
+ * not passed to the Python tool.
+ *
+ * @param pszPath Path of the file
+ * @param pstMap  Receives the handle and view of the mapping
+ * @param pstErr  Error information structure for logging any errors
+ * @return        LIB_OK if success, else LIB_ERR if any error occurred
+ ******************************************************************************/
+LIB_INT32 FileMapOpen(const LIB_CHAR* pszPath, LIB_SHM_INFO* pstMap, LIB_ERROR_INFO* pstErr)
+{
+	LIB_CHAR szRuntimeMsg[LIB_MAX_BUFFER_SIZE] = "";
+
+	pstMap->hMapping = NULL;
+	pstMap->pvBase = NULL;
+	pstMap->u64Size = 0;
+	pstMap->szName[0] = '\0';
+	HANDLE hFile = CreateFileA(pszPath, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	LARGE_INTEGER liSize;
+	if (hFile == INVALID_HANDLE_VALUE || !GetFileSizeEx(hFile, &liSize))
+	{
+		snprintf(szRuntimeMsg, sizeof(szRuntimeMsg), "Unable to open %s - error %lu", pszPath, GetLastError());
+		LOG_ERROR(pstErr, LIB_ERR_FILE_IO, LIB_ERR_FILE_IO_MSG, LIB_ERR_FILE_IO_ACT, szRuntimeMsg)
+		if (hFile != INVALID_HANDLE_VALUE)
+		{
+			CloseHandle(hFile);
+		}
+		return LIB_ERR;
+	}
+	if (liSize.QuadPart == 0)
+	{
+		snprintf(szRuntimeMsg, sizeof(szRuntimeMsg), "%s is empty", pszPath);
+		LOG_ERROR(pstErr, LIB_ERR_FILE_IO, LIB_ERR_FILE_IO_MSG, LIB_ERR_FILE_IO_ACT, szRuntimeMsg)
+		CloseHandle(hFile);
+		return LIB_ERR;
+	}
+
+	// The mapping keeps the file open, its handle is not needed any more
+	pstMap->u64Size = (LIB_U64)liSize.QuadPart;
+	pstMap->hMapping = CreateFileMapping(hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+	CloseHandle(hFile);
+	if (pstMap->hMapping == NULL)
+	{
+		snprintf(szRuntimeMsg, sizeof(szRuntimeMsg), "CreateFileMapping() failed for %s", pszPath);
+		LOG_WIN_API_ERROR(pstErr, szRuntimeMsg)
+		return LIB_ERR;
+	}
+	pstMap->pvBase = MapViewOfFile(pstMap->hMapping, FILE_MAP_READ, 0, 0, 0);
+	if (pstMap->pvBase == NULL)
+	{
+		snprintf(szRuntimeMsg, sizeof(szRuntimeMsg), "MapViewOfFile() failed for %llu bytes of %s", pstMap->u64Size, pszPath);
+		LOG_WIN_API_ERROR(pstErr, szRuntimeMsg)
+		SharedMemClose(pstMap);
+		return LIB_ERR;
+	}
+	return LIB_OK;
+}
+
+/***************************************************************************//**
+ * FileMapClose
+ *
+ * Unmaps a file mapped by FileMapOpen()
+ *
+ * @param pstMap Mapping from FileMapOpen()
+ ******************************************************************************/
+void FileMapClose(LIB_SHM_INFO* pstMap)
+{
+	SharedMemClose(pstMap);
+}
+
+/***************************************************************************//**
+ * ipc_plot_alloc
+ *
+ * Allocates a data buffer for ipc_plot(). The named pipe always copies the
+ * data, so this is plain heap memory on Windows.
+ *
+ * @param u32Count       Number of doubles in the buffer (columns * rows)
+ * @param pprgdOutBuffer Receives the pointer to the buffer
+ * @param pstErr         Error information structure for logging any errors
+ * @return               LIB_OK if success, else LIB_ERR if any error occurred
+ ******************************************************************************/
+LIB_U32 ipc_plot_alloc(LIB_U32 u32Count, LIB_DOUBLE** pprgdOutBuffer, LIB_ERROR_INFO* pstErr)
+{
+	LIB_CHAR szRuntimeMsg[LIB_MAX_BUFFER_SIZE] = "";
+
+	if (pstErr == NULL)
+	{
+		return LIB_ERR;
+	}
+	// The status of a previous successful call is not an error, let this call log its own
+	if (pstErr->u32ErrCode == LIB_STATUS_DONE)
+	{
+		*pstErr = LIB_ERROR_INFO();
+	}
+	if (pprgdOutBuffer == NULL)
+	{
+		snprintf(szRuntimeMsg, sizeof(szRuntimeMsg), "Output buffer pointer is null pointer");
+		LOG_ERROR(pstErr, LIB_ERR_INPUT_PTR_NULL, LIB_ERR_INPUT_PTR_NULL_MSG, LIB_ERR_INPUT_PTR_NULL_ACT, szRuntimeMsg)
+		return LIB_ERR;
+	}
+	*pprgdOutBuffer = (LIB_DOUBLE*)calloc(u32Count, sizeof(LIB_DOUBLE));
+	if (*pprgdOutBuffer == NULL)
+	{
+		snprintf(szRuntimeMsg, sizeof(szRuntimeMsg), "Unable to allocate %u doubles", u32Count);
+		LOG_ERROR(pstErr, LIB_ERR_BUFFER_OVERFLOW, LIB_ERR_BUFFER_OVERFLOW_MSG, LIB_ERR_BUFFER_OVERFLOW_ACT, szRuntimeMsg)
+		return LIB_ERR;
+	}
+	pstErr->u32ErrCode = LIB_STATUS_DONE;
+	return LIB_OK;
+}
+
+/***************************************************************************//**
+ * ipc_plot_free
+ *
+ * Releases a buffer returned by ipc_plot_alloc().
+ *
+ * @param prgdBuffer Buffer returned by ipc_plot_alloc()
+ ******************************************************************************/
+void ipc_plot_free(LIB_DOUBLE* prgdBuffer)
+{
+	free(prgdBuffer);
+}
+
+#endif // _WIN32
@@ -5,8 +5,17 @@ Summary
 -------
 Entry point of the Python tool.
 
-Retrieves data from the named pipe for plotting and then saves figure as an 
-image file before updating C/C++ application success status.
+Retrieves data from the named pipe (or the socket and shared memory on POSIX)
+for plotting and then saves figure as an image file, or sends the PNG or RGBA
+image back when the request asks for it in memory, before updating C/C++ 
+application success status. The tool keeps serving requests until the C/C++
+application closes its session, so Python and Matplotlib are only started
+once per session.
+
+A live stream keeps one figure for its whole life: the rows appended by the
+C/C++ application are drained from the ring buffer and the same lines are
+updated and saved at most nMaxFps times per second, each image replacing the
+previous one at once so a viewer never sees a partly written file.
 
 NOTE: This script should be executed from the C/C++ library instead of 
 running it directly because of the named pipe feature
@@ -14,16 +23,25 @@ running it directly because of the named pipe feature
 """
 
 # Standard libraries
+import io
 import os
+import struct
+import time
 from datetime import datetime
 
 # Third-party library imports
 import matplotlib.pyplot as plt
 import numpy as np
 
-import IPC_Plot_Pipe as pipe
+import IPC_Plot_Protocol as proto
+
+# Named pipes on Windows, socket and shared memory everywhere else
+if os.name == "nt":
+    import IPC_Plot_Pipe as pipe
+else:
+    import IPC_Plot_Socket as pipe
 
-def _processData(nColSize, nRowSize, lstData):
+def _processData(nColSize, nRowSize, aData):
     """
     Split data into columns for plotting. All columns must have an equal
     number of rows (data points).
@@ -37,31 +55,74 @@ def _processData(nColSize, nRowSize, lstData):
     nRowSize : int
         Number of rows of data for each column.
 
-    lstData : list
-        The data buffer containing doubles only
+    aData : numpy array
+        The data buffer containing doubles only, one column after the other
 
     Returns
     -------
     aaData : numpy 2D array
-        A Numpy 2D array of the data buffer, stored column-wise. 
+        A Numpy 2D array of the data buffer, stored column-wise. It is a 
+        view of aData, no data is copied.
+
+    """
+
+    # The buffer is column-major, a Fortran-order reshape puts each column in aaData[:, i]
+    return np.asarray(aData, dtype=np.double).reshape((nRowSize, nColSize), order="F")
+
+def _shapeData(nColSize, nRowSize, aData, nXMode):
+    """
+    Split the data of a plot request into its Y columns and their X values.
+
+    Parameters
+    ----------
+    nColSize, nRowSize, aData, nXMode
+        As returned by proto.readPlot()
+
+    Returns
+    -------
+    aaData : numpy 2D array
+        Y values, stored column-wise
+
+    aaXData : numpy 2D array or None
+        X values of each column, None to use the row number
+
+    """
+    if nXMode == proto.X_PER_COLUMN:
+        # X and Y columns alternate
+        aaData = _processData(nColSize * 2, nRowSize, aData)
+        return aaData[:, 1::2], aaData[:, 0::2]
+    if nXMode == proto.X_SHARED:
+        # One X column first, seen by every column without a copy
+        aaData = _processData(nColSize + 1, nRowSize, aData)
+        return aaData[:, 1:], np.broadcast_to(aaData[:, :1], (nRowSize, nColSize))
+    return _processData(nColSize, nRowSize, aData), None
 
+def _openImageFile(szTitle):
     """
+    Create the image file named after the figure title, adding a "_1", "_2"...
+    suffix when a plot made in the same second already took the name.
+
+    Returns
+    -------
+    fileImage : file object
+        Image file opened for writing, created by this call
 
-    # Create the empty numpy 2D array
-    aaData = np.empty((nRowSize, 0), dtype=np.double)
-    lstTempList = []
-    for i in range(nColSize):
-        # Slice the list by column and append to numpy 2D array
-        lstTempList = lstData[ i * nRowSize : ( i + 1 ) * nRowSize]
-        aColData = np.array(lstTempList)[:, None]
-        aaData = np.concatenate((aaData, aColData), axis=1)
-    return aaData
-
-def _saveImage(aaData, lstGraphLabels):
+    """
+    szImageName = szTitle + ".png"
+    nSuffix = 0
+    while True:
+        try:
+            nFd = os.open(szImageName, os.O_WRONLY | os.O_CREAT | os.O_EXCL | getattr(os, "O_BINARY", 0))
+            return os.fdopen(nFd, "wb")
+        except FileExistsError:
+            nSuffix += 1
+            szImageName = "%s_%d.png" % (szTitle, nSuffix)
+
+def _saveImage(aaData, lstGraphLabels, aaXData=None, nOutput=proto.LIB_OUTPUT_FILE, nDpi=proto.LIB_DEFAULT_DPI, dtTitle=None):
     """
     Creates an image of the graph figure from the numpy 2D array and 
-    saves image file in the same directory as this script. 
-    Default image format is *.png
+    saves image file in the same directory as this script, or keeps
+    the encoded PNG or the RGBA pixels in memory for the C/C++ application.
 
     Parameters
     ---------- 
@@ -71,13 +132,56 @@ def _saveImage(aaData, lstGraphLabels):
     lstGraphLabels : list
         A list of user labels to be displayed on the legend of the 
         figure
+
+    aaXData : numpy 2D array or None
+        X values of each column, same shape as aaData, e.g. timestamps
+        or the sample index kept by decimation. None to use the row
+        number.
+
+    nOutput : int
+        proto.LIB_OUTPUT_FILE, proto.LIB_OUTPUT_PNG or proto.LIB_OUTPUT_RGBA
+
+    nDpi : int
+        Resolution of the image, Matplotlib's own default is 100
+
+    dtTitle : datetime or None
+        Time the figure and the image file are named after, None for now
+
+    Returns
+    -------
+    dPlotMs, dSaveMs : float
+        Time in milliseconds spent creating the figure and saving it
+
+    tupleImage : tuple or None
+        (nWidth, nHeight, abImage) of an image kept in memory, None once
+        written to a file
         
     """
-    szImageName = _plot(aaData, lstGraphLabels)
-    # Increase dpi for higher resolution images, default dpi is 100     
-    plt.savefig(szImageName, dpi=200)
+    dStart = time.perf_counter()
+    szTitle = _plot(aaData, lstGraphLabels, aaXData, dtTitle)
+    fig = plt.gcf()
+    dPlotted = time.perf_counter()
+    tupleImage = None
+    if nOutput == proto.LIB_OUTPUT_FILE:
+        with _openImageFile(szTitle) as fileImage:
+            fig.savefig(fileImage, format="png", dpi=nDpi)
+    elif nOutput == proto.LIB_OUTPUT_PNG:
+        bufImage = io.BytesIO()
+        fig.savefig(bufImage, format="png", dpi=nDpi)
+        abImage = bufImage.getbuffer()
+        # Width and height are the first fields of the IHDR chunk, right after the signature
+        nWidth, nHeight = struct.unpack(">II", abImage[16:24])
+        tupleImage = (nWidth, nHeight, abImage)
+    else:
+        # The pixels of the Agg canvas are sent as they are, without encoding
+        fig.set_dpi(nDpi)
+        fig.canvas.draw()
+        mvRgba = memoryview(fig.canvas.buffer_rgba())
+        nHeight, nWidth = mvRgba.shape[0], mvRgba.shape[1]
+        tupleImage = (nWidth, nHeight, mvRgba.cast("B"))
+    return (dPlotted - dStart) * 1e3, (time.perf_counter() - dPlotted) * 1e3, tupleImage
 
-def _plot(aaData, lstGraphLabels):
+def _plot(aaData, lstGraphLabels, aaXData=None, dtTitle=None):
     """
     Creates the Matplotlib objects such as the Figure, Axes and lines
     for all columns in the data buffer
@@ -91,6 +195,13 @@ def _plot(aaData, lstGraphLabels):
         A list of user labels to be displayed on the legend of the 
         figure
 
+    aaXData : numpy 2D array or None
+        X values of each column, same shape as aaData. None to use
+        the row number.
+
+    dtTitle : datetime or None
+        Time shown in the title, None for now
+
     Returns
     -------
     szTitle : string
@@ -103,14 +214,17 @@ def _plot(aaData, lstGraphLabels):
     plt.subplots_adjust(left=0.10, right=0.975)
 
     # Auto-generate x-axis based on the number of rows in dataset
-    lstXValues = np.arange(0, aaData.shape[0]).tolist()
+    aXValues = np.arange(0, aaData.shape[0])
 
     # Iterate all columns in dataset
     for i in range(aaData.shape[1]):
         # NumPy syntax: dataset[<start row>,<start col>:<end row>,<end col>]
-        lstColPlot = aaData[:, i]
-        ax.plot(lstXValues,
-                lstColPlot,
+        aColPlot = aaData[:, i]
+        if aaXData is not None:
+            # Decimated columns keep the sample index, or the X value, of each point
+            aXValues = aaXData[:, i]
+        ax.plot(aXValues,
+                aColPlot,
                 marker="."  # Display each data point as a dot
         ) 
 
@@ -120,8 +234,8 @@ def _plot(aaData, lstGraphLabels):
 
     # Set x-axis label
     ax.set_xlabel("Samples")
-    # Set graph title based on current date and time
-    szTitle = datetime.now().strftime("IMG_%Y%m%d_%HH%MM%SS")
+    # Set graph title based on current date and time, or the time the plot was spooled
+    szTitle = (dtTitle if dtTitle is not None else datetime.now()).strftime("IMG_%Y%m%d_%HH%MM%SS")
     ax.set_title(szTitle)
 
     # Enable grid on figure
@@ -130,17 +244,147 @@ def _plot(aaData, lstGraphLabels):
     ax.grid(which='minor', color='#CCCCCC', linestyle=':')
     return szTitle
 
+# Longest wait for the end of a live stream between two looks at its ring buffer
+LIVE_POLL_S = 0.02
+
+# Resolution of the images of a live stream, lower than _saveImage() as they are saved repeatedly
+LIVE_DPI = 100
+
+def _runStream(stream):
+    """
+    Serve a live stream until the C/C++ application ends it. The figure and
+    its lines are created once, each frame only replaces the data of the
+    lines with set_data() and saves the figure.
+
+    Parameters
+    ----------
+    stream : proto.LiveStream
+        Stream opened by the C/C++ application
+
+    """
+    dStart = time.perf_counter()
+    fig, ax = plt.subplots()
+    plt.subplots_adjust(left=0.10, right=0.975)
+    lstLines = [ax.plot([], [], marker=".")[0] for _ in range(stream.nColSize)]
+    ax.legend(loc='best', labels=stream.lstGraphLabels, prop={"size":8})
+    ax.set_xlabel("Samples")
+    szTitle = datetime.now().strftime("LIVE_%Y%m%d_%HH%MM%SS")
+    ax.set_title(szTitle)
+    ax.minorticks_on()
+    ax.grid(which='major', color='#CCCCCC', linestyle='--')
+    ax.grid(which='minor', color='#CCCCCC', linestyle=':')
+    dPlotMs = (time.perf_counter() - dStart) * 1e3
+    # The stream is open once the ring is mapped and the figure exists
+    pipe.updateStatus(proto.getReadTime(), dPlotMs)
+
+    # Last rows of the stream, the newest at the end, nShown of them valid
+    aaHistory = np.empty((stream.nCapacity, stream.nColSize), dtype=np.double)
+    nShown = 0
+    nTotal = 0
+    dDecodeMs = dSaveMs = 0.0
+    dFramePeriod = 1.0 / stream.nMaxFps
+    dNextFrame = time.perf_counter()
+    bDirty = False
+    szError = None
+    bEnd = False
+    while not bEnd:
+        dNow = time.perf_counter()
+        dWait = min(max(dNextFrame - dNow, 0.0), LIVE_POLL_S) if bDirty else LIVE_POLL_S
+        bEnd = pipe.waitStreamEnd(dWait)
+
+        # Rows appended before STREAM_END are in the ring by now, this read takes the last of them
+        dStart = time.perf_counter()
+        aRows = stream.read()
+        nRows = aRows.shape[0]
+        if nRows >= stream.nCapacity:
+            aaHistory[:] = aRows[-stream.nCapacity:]
+        elif nRows > 0:
+            aaHistory[:-nRows] = aaHistory[nRows:]
+            aaHistory[-nRows:] = aRows
+        nShown = min(nShown + nRows, stream.nCapacity)
+        nTotal += nRows
+        bDirty = bDirty or nRows > 0
+        dDecodeMs += (time.perf_counter() - dStart) * 1e3
+
+        if szError is not None or not bDirty or (time.perf_counter() < dNextFrame and not bEnd):
+            continue
+        try:
+            dStart = time.perf_counter()
+            aXValues = np.arange(nTotal - nShown, nTotal)
+            for i, line in enumerate(lstLines):
+                line.set_data(aXValues, aaHistory[-nShown:, i])
+            nDropped = stream.getDropped()
+            ax.set_title(szTitle if nDropped == 0 else "%s (%d rows dropped)" % (szTitle, nDropped))
+            ax.relim()
+            ax.autoscale_view()
+            dPlotted = time.perf_counter()
+            # Written aside and renamed, the image in place is always complete
+            fig.savefig(szTitle + ".png.tmp", format="png", dpi=LIVE_DPI)
+            os.replace(szTitle + ".png.tmp", szTitle + ".png")
+            dPlotMs += (dPlotted - dStart) * 1e3
+            dSaveMs += (time.perf_counter() - dPlotted) * 1e3
+        except Exception as e:
+            # Reported once the stream ends, the C/C++ application keeps appending meanwhile
+            szError = repr(e)
+        bDirty = False
+        dNextFrame = dStart + dFramePeriod
+
+    if szError is not None:
+        pipe.reportError(szError)
+    else:
+        pipe.updateStatus(dDecodeMs, dPlotMs, dSaveMs)
+
 def main():
     """
-    Retrieves data from the named pipe for plotting and then saves figure 
-    as an image before updating C/C++ application success status.
+    Request loop of the Python tool. Retrieves data from the named pipe (or 
+    the socket and shared memory on POSIX) for plotting and then saves figure 
+    as an image before updating C/C++ application success status, until the 
+    C/C++ application closes the session.
 
     """
-    nColSize, nRowSize, lstData, lstGraphLabels = pipe.retrieveData()
-    aaData = _processData(nColSize, nRowSize, lstData) 
-    _saveImage(aaData, lstGraphLabels)
-    pipe.updateStatus()
+    # Matplotlib is imported by now, the first request will not wait for it
+    pipe.reportReady()
+    while True:
+        try:
+            tupleData = pipe.retrieveData()
+        except proto.ProtocolError as e:
+            # The stream can not be resynchronised, give up on the session
+            pipe.reportError(repr(e), proto.LIB_ERR_PROTOCOL)
+            break
+        if tupleData is None:
+            break
+        if isinstance(tupleData, proto.LiveStream):
+            try:
+                _runStream(tupleData)
+            except proto.ProtocolError as e:
+                pipe.reportError(repr(e), proto.LIB_ERR_PROTOCOL)
+                break
+            except Exception as e:
+                # Failing to open the figure fails the stream, the session is not resumed after it
+                pipe.reportError(repr(e))
+                break
+            finally:
+                tupleData.close()
+                plt.close("all")
+            continue
+        nColSize, nRowSize, aData, lstGraphLabels, nXMode = tupleData
+        try:
+            dStart = time.perf_counter()
+            aaData, aaXData = _shapeData(nColSize, nRowSize, aData, nXMode)
+            dDecodeMs = proto.getReadTime() + (time.perf_counter() - dStart) * 1e3
+            nOutput, nDpi = proto.getOutput()
+            dPlotMs, dSaveMs, tupleImage = _saveImage(aaData, lstGraphLabels, aaXData, nOutput, nDpi)
+        except Exception as e:
+            plt.close("all")
+            pipe.reportError(repr(e))
+            continue
+        if tupleImage is not None:
+            nWidth, nHeight, abImage = tupleImage
+            pipe.sendImage(nOutput, nWidth, nHeight, abImage)
+        # Figures are not reused between requests, the RGBA pixels are sent by now
+        plt.close("all")
+        pipe.updateStatus(dDecodeMs, dPlotMs, dSaveMs)
 
 if __name__ == '__main__':
     """ Entry point """
-    main()
\ No newline at end of file
+    main()
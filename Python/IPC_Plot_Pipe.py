@@ -5,20 +5,21 @@ Summary
 -------
 This script acts as a client for a named pipe between a Windows C/C++ application (server) and this Python tool.
 
-In the C/C++ application, a struct or an array of structs is created and passed to Python using named pipes in a 
-byte stream. The Python tool then decodes the bytes stream and converts members of the struct to Python native 
-types e.g. char buffer in C/C++ becomes string type in Python.
+The C/C++ application writes framed messages to a byte-mode named pipe, refer to IPC_Plot_Protocol.py. 
+The Python tool reads exactly the bytes of each frame and decodes the data buffer straight into a NumPy array.
 
-The client disconnects from the named pipe after all data has been sent and received. The client needs to 
-create the thread and reconnect to the named pipe to send/receive more data.
+The client connects once and stays connected for the whole session, reading one buffer per request until 
+the C/C++ application disconnects the named pipe. It connects as soon as its modules are imported and 
+sends a READY frame, which is what the C/C++ application waits for after starting it.
+
+The ring buffer of a live stream is a named file mapping, its name comes in the STREAM frame.
 
 """
 # Standard libraries
-import ctypes
+import mmap
 import os
-import threading
+import sys
 import time
-from io import BytesIO
 
 # Modules for interfacing with Windows APIs
 import win32file
@@ -26,63 +27,102 @@ import win32pipe
 # Only import this after the first 2 imports
 import pywintypes
 
-# Constants to define size of struct and pipe
-LIB_MAX_DATA_SIZE = 131072 # 1 MB of doubles over pipe
-SIZEOF_1024CHAR_BUFFER = 1024
-SIZEOF_512CHAR_BUFFER = 512
-SIZEOF_128CHAR_BUFFER = 128
-SIZEOF_UINT = 4
-SIZEOF_DOUBLE = 8
+import IPC_Plot_Protocol as proto
+
+# Largest single ReadFile(), matches LIB_PIPE_BUFFER_SIZE of the C/C++ library
+LIB_PIPE_BUFFER_SIZE = 65536
+
+# Longest wait for the named pipe to accept the connection
+LIB_PIPE_WAIT_MS = 10000
 
-# Define char array buffer sizes
-CHAR_ARR_1024 = ctypes.c_char * 1024
-CHAR_ARR_512 = ctypes.c_char * 512
-CHAR_ARR_128 = ctypes.c_char * 128
+# Polling period of waitStreamEnd(), named pipes can not be waited on together with a timeout
+LIB_PIPE_POLL_S = 0.005
 
-# Templates of structs for decoding the byte stream 
-class LIB_ERR_INFO(ctypes.Structure):
-    """ 
-    Error information structure 
+# Handle to the named pipe, connected on first use and kept for the whole session
+_handle = None
 
+def _getHandle():
     """
-    _fields_ = [('u32ErrCode', ctypes.c_uint),
-                ('szErrMsg', CHAR_ARR_1024), 
-                ('szErrHelp', CHAR_ARR_1024),
-                ('szRuntime', CHAR_ARR_1024)]
+    Connect to the named pipe given by the "--pipe" argument. The C/C++ application
+    creates the pipe before starting this Python tool and picks a unique name, so that
+    multiple instances of the Python tool can be executed concurrently.
 
-class LIB_INPUT(ctypes.Structure):
-    """ 
-    Input structure 
+    """
+    global _handle
+    if _handle is None:
+        szNamedPipe = sys.argv[sys.argv.index("--pipe") + 1]
+        # Only this Python tool opens the pipe, busy can only be a connection still being set up
+        win32pipe.WaitNamedPipe(szNamedPipe, LIB_PIPE_WAIT_MS)
+        # A handle to the named pipe is returned
+        handle = win32file.CreateFile(
+            szNamedPipe,
+            win32file.GENERIC_READ | win32file.GENERIC_WRITE,
+            0,
+            None,
+            win32file.OPEN_EXISTING,
+            0,
+            None
+        )
+
+        # Set the named pipe to read mode using the handle
+        win32pipe.SetNamedPipeHandleState(
+            handle, 
+            win32pipe.PIPE_READMODE_BYTE | win32pipe.PIPE_WAIT, 
+            None, 
+            None)
+        _handle = handle
+    return _handle
+
+def _recvInto(mvBuffer):
+    """
+    Fill the writable memoryview with bytes from the named pipe, at most
+    LIB_PIPE_BUFFER_SIZE bytes at a time.
 
     """
-    _fields_ = [('u32ColSize', ctypes.c_uint),
-                ('u32RowSize', ctypes.c_uint), 
-                ('prgszLabels', ctypes.POINTER(ctypes.POINTER(ctypes.c_char))),
-                ('prgdBuffer', ctypes.POINTER(ctypes.c_double))]
+    handle = _getHandle()
+    nSize = len(mvBuffer)
+    nOffset = 0
+    while nOffset < nSize:
+        # ReadFile() returns a tuple
+        # First item is integer denoting return value (success or failure)
+        # Second item in the tuple is the bytes read
+        _, abChunk = win32file.ReadFile(handle, min(nSize - nOffset, LIB_PIPE_BUFFER_SIZE))
+        mvBuffer[nOffset : nOffset + len(abChunk)] = abChunk
+        nOffset += len(abChunk)
+
+def _recvExact(nSize):
+    """
+    Read exactly nSize bytes from the named pipe.
+
+    """
+    abBuffer = bytearray(nSize)
+    _recvInto(memoryview(abBuffer))
+    return abBuffer
 
-class LIB_BUFFER_ST(ctypes.Structure):
-    """ 
-    Data
-    Maximum buffer size defined by LIB_MAX_DATA_SIZE
+def _send(abData):
+    """
+    Write all bytes to the named pipe.
 
     """
-    _fields_ = [('dData', ctypes.c_double)]
+    win32file.WriteFile(_getHandle(), abData)
 
-class LIB_LABEL_ST(ctypes.Structure):
-    """ 
-    User labels
+def _mapRing(stStream):
+    """
+    Open the named file mapping of a live stream, read-write as the tail is moved here.
 
     """
-    _fields_ = [('szLabel', CHAR_ARR_128)]
+    return mmap.mmap(-1, stStream.u64ShmSize, tagname=stStream.szShmName.decode("ascii"))
 
 def retrieveData():
     """
-    Initial connection to named pipe to retrieve data
-    Create the thread to send data back to application. Thread blocks until 
-    client pipe is disconnected.    
+    Read the next plot or stream request from the named pipe, refer to IPC_Plot_Protocol.py.
+    Blocks until the C/C++ application sends the next buffer.
 
     Returns
     -------
+    None when the C/C++ application has closed the session, a proto.LiveStream for a stream
+    request, otherwise a tuple of:
+
     nColSize : int
         Number of columns in the data buffer. Corresponds to number of
         lines plotted on the figure
@@ -90,133 +130,127 @@ def retrieveData():
     nRowSize : int
         Number of rows of data for each column.
 
-    lstData : list
+    aData : numpy array
         The data buffer containing doubles only
 
     lstGraphLabels : list
         A list of user labels to be displayed on the legend of the 
         figure  
 
+    nXMode : int
+        proto.X_PER_COLUMN if each column in aData is preceded by a column of
+        its X values, e.g. after decimation by the C/C++ library,
+        proto.X_SHARED if aData starts with one column of X values for every
+        column, e.g. timestamps, else proto.X_NONE
+
     """
-    stErrInfo = LIB_ERR_INFO() 
-    lstData = []
-    lstColRowSize = []
-    lstGraphLabels = []
-    thread = threading.Thread(target=_createPipe, args=(stErrInfo, lstData, 
-        lstColRowSize, lstGraphLabels, ))
-    thread.start() 
-    thread.join() 
-    nColSize = lstColRowSize[0]
-    nRowSize = lstColRowSize[1]
-    return nColSize, nRowSize, lstData, lstGraphLabels
+    try:
+        stFrame = proto.unpackFrame(_recvExact(proto.SIZEOF_FRAME_HDR))
+    except pywintypes.error as e:            
+        if e.args[0] in (2, 109):
+            # Pipe not found, or the server closed the session (broken pipe)
+            return None
+        raise
+
+    if stFrame.u16Type == proto.LIB_MSG_STREAM:
+        return proto.readStream(_recvExact, stFrame, _mapRing)
+
+    # Named pipes can not pass shared memory, the data always follows in DATA frames
+    return proto.readPlot(_recvExact, _recvInto, _send, stFrame, None)
 
-def updateStatus():
+def waitStreamEnd(dTimeout):
+    """
+    Wait for the end of the live stream in progress.
+
+    Parameters
+    ----------
+    dTimeout : float
+        Longest wait in seconds
+
+    Returns
+    -------
+    True once the C/C++ application has ended the stream or closed the session, False after the
+    timeout
+
+    """
+    handle = _getHandle()
+    dEnd = time.perf_counter() + dTimeout
+    while True:
+        try:
+            _, nAvailable, _ = win32pipe.PeekNamedPipe(handle, 0)
+        except pywintypes.error as e:
+            if e.args[0] == 109:
+                # Broken pipe, the session is over
+                return True
+            raise
+        if nAvailable >= proto.SIZEOF_FRAME_HDR:
+            proto.checkStreamEnd(proto.unpackFrame(_recvExact(proto.SIZEOF_FRAME_HDR)))
+            return True
+        dLeft = dEnd - time.perf_counter()
+        if dLeft <= 0:
+            return False
+        time.sleep(min(dLeft, LIB_PIPE_POLL_S))
+
+def reportReady():
+    """
+    Tell the C/C++ application this Python tool has started and imported its modules.
+    Sent once, before the first request is read.
+
+    """
+    _send(proto.packReady(os.getpid()))
+
+def updateStatus(dDecodeMs=0.0, dPlotMs=0.0, dSaveMs=0.0):
     """
     Update status of Python tool upon completion
-    Create the thread to send data back to application. Thread blocks until 
-    client pipe is disconnected.      
+
+    Parameters
+    ----------
+    dDecodeMs, dPlotMs, dSaveMs : float
+        Time in milliseconds spent decoding the request, creating the figure and saving it,
+        returned to the C/C++ application in its plot statistics
 
     """
-    stErrInfo = LIB_ERR_INFO() 
-    stErrInfo.u32ErrCode = 0x0000FFFF
-    thread = threading.Thread(target=_createPipe, args=(stErrInfo,))
-    thread.start() 
-    thread.join() 
+    _send(proto.packAck(dDecodeMs, dPlotMs, dSaveMs))
 
-def _createPipe(stErrInfo, lstData=None, lstColRowSize=None, lstGraphLabels=None):
+def sendImage(nFormat, nWidth, nHeight, abImage):
     """
-    Connect to the existing named pipe based on the process ID of this Python tool.
-    The process ID is used for naming the named pipe so that multiple instances of
-    the Python tool can be executed concurrently.
+    Return the image of the last request, sent before updateStatus()
 
+    Parameters
+    ----------
+    nFormat : int
+        proto.LIB_OUTPUT_PNG or proto.LIB_OUTPUT_RGBA
+
+    nWidth, nHeight : int
+        Size of the image in pixels
+
+    abImage : bytes-like
+        PNG file or RGBA pixels
+
+    """
+    _send(proto.packImage(nFormat, nWidth, nHeight, len(abImage)))
+    _send(abImage)
+
+def reportError(szRuntime, nErrCode=proto.LIB_ERR_CLIENT_ERROR):
     """
-    bIsComplete = False
-    pid = os.getpid() 
-    # Maximum size of pipe is the data structs of doubles
-    nSizeofPipe = LIB_MAX_DATA_SIZE * (SIZEOF_DOUBLE)
-    szNamedPipe = "\\\\.\\pipe\\" + str(pid)
+    Report a failure to plot the last buffer, the session stays usable
 
-    stInput = LIB_INPUT() 
-    stData = LIB_BUFFER_ST() 
-    stLabel = LIB_LABEL_ST()
+    Parameters
+    ----------
+    szRuntime : string
+        Details of the failure, usually the Python exception
 
-    # Only close the pipe once the data is successfully received, or some error happened
-    while not bIsComplete:
-        try:
-            # A handle to the named pipe is returned
-            handle = win32file.CreateFile(
-                szNamedPipe,
-                win32file.GENERIC_READ | win32file.GENERIC_WRITE,
-                0,
-                None,
-                win32file.OPEN_EXISTING,
-                0,
-                None
-            )
-
-            # Set the named pipe to read mode using the handle
-            bResult = win32pipe.SetNamedPipeHandleState(
-                handle, 
-                win32pipe.PIPE_READMODE_MESSAGE | win32pipe.PIPE_WAIT, 
-                None, 
-                None)
-
-            # ReadFile() returns a tuple
-            # First item is integer denoting return value (success or failure)
-            # Second item in the tuple is the byte stream of struct
-            tupleBytesStream = win32file.ReadFile(handle, nSizeofPipe)
-
-            # Create a buffered stream using the bytes stream from the named pipe 
-            file = BytesIO(tupleBytesStream[1])
-            # Get the number of rows and columns from input struct
-            file.readinto(stInput)   
-            if (lstColRowSize is not None):
-                lstColRowSize.append(stInput.u32ColSize)
-                lstColRowSize.append(stInput.u32RowSize)     
-
-            # Retrieving all data from array of structs
-            tupleBytesStream = win32file.ReadFile(handle, nSizeofPipe)
-            file = BytesIO(tupleBytesStream[1])            
-            if (lstData is not None):
-                while file.readinto(stData):
-                    lstData.append(stData.dData)                    
-                    if (len(lstData) == stInput.u32ColSize * stInput.u32RowSize):
-                        break
-            
-            # Retrieving all user labels from array of structs
-            tupleBytesStream = win32file.ReadFile(handle, nSizeofPipe)
-            file = BytesIO(tupleBytesStream[1])            
-            if (lstGraphLabels is not None):
-                while file.readinto(stLabel):
-                    lstGraphLabels.append(stLabel.szLabel.decode("utf-8"))
-                    if (len(lstGraphLabels) == stInput.u32ColSize):
-                        break
-
-            # Write to named pipe error info struct
-            win32file.WriteFile(handle, stErrInfo)
-            bIsComplete = True
-
-        except pywintypes.error as e:            
-            if e.args[0] == 2:
-                # Named pipe connected but server not found
-                print("Pipe not found, exiting")
-                bIsComplete = True
-            elif e.args[0] == 109:
-                # If the server terminates the named pipe while the client is still connected
-                print("Broken pipe, exiting")
-                bIsComplete = True
-            elif e.args[0] == 231:
-                # Pipe busy, timeout before trying again
-                time.sleep(0.5)
-            else:
-                # Some other exception while ReadFile() or WriteFile()
-                print("Exception: ", e)
-                bIsComplete = True
+    nErrCode : int
+        Error code from IPC_Plot_Error.h
+
+    """
+    _send(proto.packError(nErrCode, szRuntime))
 
 if __name__ == '__main__':
     """ Unit testing """
-    nColSize, nRowSize, lstData, lstGraphLabels = retrieveData()
+    reportReady()
+    nColSize, nRowSize, aData, lstGraphLabels, nXMode = retrieveData()
     print(nColSize, nRowSize)
-    print(lstData)
+    print(aData)
     print(lstGraphLabels)
     updateStatus()
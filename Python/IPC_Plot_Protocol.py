@@ -0,0 +1,544 @@
+"""
+IPC_Plot_Protocol.py
+
+Summary
+-------
+Wire protocol shared by IPC_Plot_Pipe.py and IPC_Plot_Socket.py, refer to IPC_Plot_Protocol.h.
+
+Every message is a frame: a 16 byte header with magic, version, type and payload length, followed
+by the payload. A request is a PLOT frame describing the data, a LABELS frame and the raw doubles in
+DATA frames of up to 1 MB each (left out when the data is passed in shared memory). Typed columns
+(float32, int16, ...) are described by a COLUMNS frame after the LABELS frame and sent in their own
+type, they are converted to doubles here with their scale and offset. Each DATA frame
+is read straight into the NumPy array and answered with a CREDIT frame, the C/C++ library keeps at
+most a few frames in flight. The Python tool answers each request with an ACK frame carrying the
+status and its own decode, plot and savefig timings, or an ERROR frame carrying an error code and
+message. When the PLOT frame asks for the image in memory instead of a file, an IMAGE frame with the
+PNG or RGBA bytes comes before the ACK frame.
+
+Before the first request the Python tool sends a READY frame with its process ID, once its modules are
+imported, so the C/C++ library knows the first plot will not wait for Python to start.
+
+A live figure is opened by a STREAM frame and a LABELS frame instead of a plot request. The rows are
+not sent as frames but appended by the C/C++ library to a ring buffer in shared memory, which the
+Python tool drains at its own pace; the stream is answered once when opened and once after the
+STREAM_END frame.
+
+The transports only move bytes, decoding is done here so that both transports behave the same.
+
+"""
+# Standard libraries
+import ctypes
+import struct
+import time
+
+# Third-party library imports
+import numpy as np
+
+# Protocol identification, refer to IPC_Plot_Protocol.h
+LIB_PROTO_MAGIC = 0x50435049
+LIB_PROTO_VERSION = 9
+
+# Frame types
+LIB_MSG_PLOT = 1
+LIB_MSG_LABELS = 2
+LIB_MSG_DATA = 3
+LIB_MSG_ACK = 4
+LIB_MSG_ERROR = 5
+LIB_MSG_CREDIT = 6
+LIB_MSG_COLUMNS = 7
+LIB_MSG_READY = 8
+LIB_MSG_STREAM = 9
+LIB_MSG_STREAM_END = 10
+LIB_MSG_IMAGE = 11
+
+# LIB_PLOT_HDR flags and data types
+LIB_PLOT_FLAG_SHM = 0x1
+LIB_PLOT_FLAG_XY = 0x2
+LIB_PLOT_FLAG_COLUMNS = 0x4
+LIB_PLOT_FLAG_X = 0x8
+LIB_DTYPE_FLOAT64 = 0
+LIB_DTYPE_FLOAT32 = 1
+LIB_DTYPE_INT16 = 2
+LIB_DTYPE_INT32 = 3
+
+# Destination of the figure, refer to IPC_Plot.h
+LIB_OUTPUT_FILE = 0
+LIB_OUTPUT_PNG = 1
+LIB_OUTPUT_RGBA = 2
+LIB_DEFAULT_DPI = 200
+
+# Where the X values of a plot request are, returned by readPlot()
+X_NONE = 0       # Not sent, the X value is the row number
+X_PER_COLUMN = 1 # Each column is preceded by a column of its X values (LIB_PLOT_FLAG_XY)
+X_SHARED = 2     # One column of X values for every column comes first (LIB_PLOT_FLAG_X)
+
+# NumPy type of each LIB_DTYPE_*
+DICT_DTYPES = {LIB_DTYPE_FLOAT64: np.dtype(np.float64),
+               LIB_DTYPE_FLOAT32: np.dtype(np.float32),
+               LIB_DTYPE_INT16: np.dtype(np.int16),
+               LIB_DTYPE_INT32: np.dtype(np.int32)}
+
+# Ring buffer of a live stream, refer to LIB_RING_HDR. The indices count 64-bit words from the
+# start of the shared memory, the rows follow the header.
+LIB_RING_MAGIC = 0x474E4952
+SIZEOF_RING_HDR = 192
+RING_IDX_DROPPED = 2
+RING_IDX_HEAD = 8
+RING_IDX_TAIL = 16
+
+# Status codes, refer to IPC_Plot_Error.h
+LIB_STATUS_DONE = 0x0000FFFF
+LIB_ERR_CLIENT_ERROR = 0x00090000
+LIB_ERR_PROTOCOL = 0x000A0000
+
+# Longest runtime message accepted by the C/C++ library in an ERROR frame
+LIB_MAX_ERROR_TEXT = 4096 - 4
+
+# Templates of structs for decoding the byte stream
+class LIB_FRAME_HDR(ctypes.Structure):
+    """
+    Header in front of every frame
+
+    """
+    _fields_ = [('u32Magic', ctypes.c_uint32),
+                ('u16Version', ctypes.c_uint16),
+                ('u16Type', ctypes.c_uint16),
+                ('u64Length', ctypes.c_uint64)]
+
+class LIB_PLOT_HDR(ctypes.Structure):
+    """
+    Payload of the PLOT frame
+
+    """
+    _fields_ = [('u32ColSize', ctypes.c_uint32),
+                ('u32RowSize', ctypes.c_uint32),
+                ('u32Dtype', ctypes.c_uint32),
+                ('u32Flags', ctypes.c_uint32),
+                ('u64PayloadSize', ctypes.c_uint64),
+                ('u64ShmOffset', ctypes.c_uint64),
+                ('u32Output', ctypes.c_uint32),
+                ('u32Dpi', ctypes.c_uint32)]
+
+class LIB_IMAGE_HDR(ctypes.Structure):
+    """
+    Start of the IMAGE frame, followed by the image bytes
+
+    """
+    _fields_ = [('u32Format', ctypes.c_uint32),
+                ('u32Width', ctypes.c_uint32),
+                ('u32Height', ctypes.c_uint32),
+                ('u32Reserved', ctypes.c_uint32),
+                ('u64Size', ctypes.c_uint64)]
+
+class LIB_COLUMN_HDR(ctypes.Structure):
+    """
+    Entry of the COLUMNS frame, one per typed column
+
+    """
+    _fields_ = [('u32Dtype', ctypes.c_uint32),
+                ('u32Stride', ctypes.c_uint32),
+                ('dScale', ctypes.c_double),
+                ('dOffset', ctypes.c_double),
+                ('u64Offset', ctypes.c_uint64)]
+
+class LIB_STREAM_HDR(ctypes.Structure):
+    """
+    Payload of the STREAM frame
+
+    """
+    _fields_ = [('u32ColSize', ctypes.c_uint32),
+                ('u32MaxFps', ctypes.c_uint32),
+                ('u64Capacity', ctypes.c_uint64),
+                ('u64ShmSize', ctypes.c_uint64),
+                ('szShmName', ctypes.c_char * 64)]
+
+class LIB_ACK_PAYLOAD(ctypes.Structure):
+    """
+    Payload of the ACK frame, status and timings of the Python tool in milliseconds
+
+    """
+    _fields_ = [('u32Status', ctypes.c_uint32),
+                ('u32Reserved', ctypes.c_uint32),
+                ('dDecodeMs', ctypes.c_double),
+                ('dPlotMs', ctypes.c_double),
+                ('dSaveMs', ctypes.c_double)]
+
+class ProtocolError(Exception):
+    """
+    Raised when the C/C++ application sends something this version does not understand
+
+    """
+    pass
+
+SIZEOF_FRAME_HDR = ctypes.sizeof(LIB_FRAME_HDR)
+
+# Time spent in the last readPlot(), reported in the ACK frame
+_dReadMs = 0.0
+
+# Output and resolution asked for by the last readPlot()
+_nOutput = LIB_OUTPUT_FILE
+_nDpi = LIB_DEFAULT_DPI
+
+def unpackFrame(abHeader):
+    """
+    Decode and check a frame header.
+
+    Parameters
+    ----------
+    abHeader : bytes-like
+        SIZEOF_FRAME_HDR bytes from the transport
+
+    Returns
+    -------
+    stFrame : LIB_FRAME_HDR
+
+    """
+    stFrame = LIB_FRAME_HDR.from_buffer_copy(abHeader)
+    if stFrame.u32Magic != LIB_PROTO_MAGIC or stFrame.u16Version != LIB_PROTO_VERSION:
+        raise ProtocolError("Frame with magic 0x%08X version %d, expected 0x%08X version %d" %
+                            (stFrame.u32Magic, stFrame.u16Version, LIB_PROTO_MAGIC, LIB_PROTO_VERSION))
+    return stFrame
+
+def _expectFrame(fnRecv, nType):
+    """
+    Read the next frame header and check its type.
+
+    """
+    stFrame = unpackFrame(fnRecv(SIZEOF_FRAME_HDR))
+    if stFrame.u16Type != nType:
+        raise ProtocolError("Frame type %d, expected %d" % (stFrame.u16Type, nType))
+    return stFrame
+
+def _decodeLabels(abLabels, nColSize):
+    """
+    Split the LABELS payload, a 16-bit length followed by the bytes of each label.
+
+    """
+    lstGraphLabels = []
+    nOffset = 0
+    for _ in range(nColSize):
+        (nLength,) = struct.unpack_from("<H", abLabels, nOffset)
+        nOffset += 2
+        lstGraphLabels.append(bytes(abLabels[nOffset : nOffset + nLength]).decode("utf-8", "replace"))
+        nOffset += nLength
+    return lstGraphLabels
+
+def _recvStream(fnRecv, fnRecvInto, fnSend, nPayloadSize, dtype=np.double):
+    """
+    Receive the DATA frames of a request into a preallocated array, returning credit for each.
+
+    """
+    aData = np.empty(nPayloadSize // np.dtype(dtype).itemsize, dtype=dtype)
+    mvData = memoryview(aData).cast("B")
+    nOffset = 0
+    while nOffset < nPayloadSize:
+        stData = _expectFrame(fnRecv, LIB_MSG_DATA)
+        if stData.u64Length == 0 or nOffset + stData.u64Length > nPayloadSize:
+            raise ProtocolError("DATA frame of %d bytes at offset %d of %d" %
+                                (stData.u64Length, nOffset, nPayloadSize))
+        fnRecvInto(mvData[nOffset : nOffset + stData.u64Length])
+        nOffset += stData.u64Length
+        fnSend(packFrame(LIB_MSG_CREDIT, struct.pack("<I", 1)))
+    return aData
+
+def _decodeColumns(abColumns, nColSize, nRowSize, nPayloadSize):
+    """
+    Split the COLUMNS payload and check every sample of every column lies inside the payload.
+
+    """
+    if len(abColumns) != nColSize * ctypes.sizeof(LIB_COLUMN_HDR):
+        raise ProtocolError("COLUMNS frame of %d bytes for %d columns" % (len(abColumns), nColSize))
+    lstColumns = []
+    for i in range(nColSize):
+        stColumn = LIB_COLUMN_HDR.from_buffer_copy(abColumns, i * ctypes.sizeof(LIB_COLUMN_HDR))
+        if stColumn.u32Dtype not in DICT_DTYPES:
+            raise ProtocolError("Data type %d of column %d is not supported" % (stColumn.u32Dtype, i))
+        nItemSize = DICT_DTYPES[stColumn.u32Dtype].itemsize
+        if stColumn.u32Stride < nItemSize:
+            raise ProtocolError("Stride of %d bytes of column %d is less than a sample" % (stColumn.u32Stride, i))
+        if nRowSize > 0 and stColumn.u64Offset + (nRowSize - 1) * stColumn.u32Stride + nItemSize > nPayloadSize:
+            raise ProtocolError("Column %d at offset %d does not fit in %d bytes" %
+                                (i, stColumn.u64Offset, nPayloadSize))
+        lstColumns.append(stColumn)
+    return lstColumns
+
+def _convertColumns(abPayload, lstColumns, nRowSize):
+    """
+    Convert typed columns to one array of doubles, column after column, applying the
+    scale and offset of each in place. Strided columns are read through a strided view
+    of the payload, they are only copied by the conversion.
+
+    """
+    aData = np.empty(len(lstColumns) * nRowSize, dtype=np.double)
+    for i, stColumn in enumerate(lstColumns):
+        aRaw = np.ndarray((nRowSize,), dtype=DICT_DTYPES[stColumn.u32Dtype], buffer=abPayload,
+                          offset=stColumn.u64Offset, strides=(stColumn.u32Stride,))
+        aColumn = aData[i * nRowSize : (i + 1) * nRowSize]
+        if stColumn.dScale == 1.0 and stColumn.dOffset == 0.0:
+            aColumn[:] = aRaw
+        else:
+            np.multiply(aRaw, stColumn.dScale, out=aColumn, dtype=np.double)
+            aColumn += stColumn.dOffset
+    return aData
+
+def _mapShm(fnMapShm, stPlot, dtype):
+    """
+    Map the payload of a plot request passed in shared memory.
+
+    """
+    if fnMapShm is None:
+        raise ProtocolError("Shared memory is not supported by this transport")
+    return fnMapShm(stPlot.u64ShmOffset, stPlot.u64PayloadSize, dtype)
+
+def readPlot(fnRecv, fnRecvInto, fnSend, stFrame, fnMapShm):
+    """
+    Read the rest of a plot request once the transport has received its first frame header.
+
+    Parameters
+    ----------
+    fnRecv : function
+        fnRecv(nSize) returns exactly nSize bytes from the transport
+
+    fnRecvInto : function
+        fnRecvInto(mvBuffer) fills the writable memoryview with bytes from the transport
+
+    fnSend : function
+        fnSend(abData) writes all bytes to the transport
+
+    stFrame : LIB_FRAME_HDR
+        Header of the PLOT frame, already checked with unpackFrame()
+
+    fnMapShm : function or None
+        fnMapShm(nOffset, nSize, dtype) returns the data in shared memory, or in the file mapped
+        by the C/C++ library, as a NumPy array of dtype. None if the transport cannot pass
+        shared memory.
+
+    Returns
+    -------
+    A tuple of nColSize, nRowSize, aData, lstGraphLabels and nXMode, refer to retrieveData()
+
+    """
+    global _dReadMs, _nOutput, _nDpi
+    dStart = time.perf_counter()
+    if stFrame.u16Type != LIB_MSG_PLOT or stFrame.u64Length != ctypes.sizeof(LIB_PLOT_HDR):
+        raise ProtocolError("Frame type %d with %d bytes, expected a plot request" %
+                            (stFrame.u16Type, stFrame.u64Length))
+    stPlot = LIB_PLOT_HDR.from_buffer_copy(fnRecv(ctypes.sizeof(LIB_PLOT_HDR)))
+    if stPlot.u32Flags & LIB_PLOT_FLAG_XY:
+        nXMode = X_PER_COLUMN
+    elif stPlot.u32Flags & LIB_PLOT_FLAG_X:
+        nXMode = X_SHARED
+    else:
+        nXMode = X_NONE
+    if stPlot.u32Output > LIB_OUTPUT_RGBA or stPlot.u32Dpi == 0:
+        raise ProtocolError("Output %d at %d dpi is not supported" % (stPlot.u32Output, stPlot.u32Dpi))
+    _nOutput, _nDpi = stPlot.u32Output, stPlot.u32Dpi
+    bTyped = bool(stPlot.u32Flags & LIB_PLOT_FLAG_COLUMNS)
+    if bTyped:
+        if stPlot.u32Flags & LIB_PLOT_FLAG_XY:
+            raise ProtocolError("Typed columns with flags 0x%X are not supported" % stPlot.u32Flags)
+    else:
+        if stPlot.u32Dtype != LIB_DTYPE_FLOAT64 or stPlot.u32Flags & LIB_PLOT_FLAG_X:
+            raise ProtocolError("Data type %d with flags 0x%X is not supported" % (stPlot.u32Dtype, stPlot.u32Flags))
+        nValues = stPlot.u32ColSize * stPlot.u32RowSize * (2 if nXMode == X_PER_COLUMN else 1)
+        if stPlot.u64PayloadSize != nValues * np.dtype(np.double).itemsize:
+            raise ProtocolError("Payload of %d bytes for %d x %d doubles" %
+                                (stPlot.u64PayloadSize, stPlot.u32RowSize, stPlot.u32ColSize))
+
+    stLabels = _expectFrame(fnRecv, LIB_MSG_LABELS)
+    lstGraphLabels = _decodeLabels(fnRecv(stLabels.u64Length), stPlot.u32ColSize)
+
+    if bTyped:
+        # The X column shared by every column comes first
+        stColumns = _expectFrame(fnRecv, LIB_MSG_COLUMNS)
+        lstColumns = _decodeColumns(fnRecv(stColumns.u64Length),
+                                    stPlot.u32ColSize + (1 if nXMode == X_SHARED else 0),
+                                    stPlot.u32RowSize, stPlot.u64PayloadSize)
+        if stPlot.u32Flags & LIB_PLOT_FLAG_SHM:
+            # Only the pages holding samples are read by the conversion
+            abPayload = _mapShm(fnMapShm, stPlot, np.uint8)
+        else:
+            abPayload = _recvStream(fnRecv, fnRecvInto, fnSend, stPlot.u64PayloadSize, np.uint8)
+        aData = _convertColumns(abPayload, lstColumns, stPlot.u32RowSize)
+    elif stPlot.u32Flags & LIB_PLOT_FLAG_SHM:
+        aData = _mapShm(fnMapShm, stPlot, np.double)
+    else:
+        aData = _recvStream(fnRecv, fnRecvInto, fnSend, stPlot.u64PayloadSize)
+    _dReadMs = (time.perf_counter() - dStart) * 1e3
+    return stPlot.u32ColSize, stPlot.u32RowSize, aData, lstGraphLabels, nXMode
+
+class LiveStream:
+    """
+    Consumer side of the ring buffer of a live stream. The head is read before the rows it
+    publishes and the tail is moved only once the rows are copied out, so the C/C++ library never
+    overwrites rows still being read.
+
+    Attributes
+    ----------
+    nColSize : int
+        Values in each row
+
+    nMaxFps : int
+        Highest frame rate of the live figure
+
+    nCapacity : int
+        Rows of the ring, also the rows shown
+
+    lstGraphLabels : list of str
+        Label of each column
+
+    """
+    def __init__(self, stStream, lstGraphLabels, mmRing):
+        self.nColSize = stStream.u32ColSize
+        self.nMaxFps = stStream.u32MaxFps
+        self.nCapacity = stStream.u64Capacity
+        self.lstGraphLabels = lstGraphLabels
+        self._mmRing = mmRing
+        self._aIndex = np.frombuffer(mmRing, dtype=np.uint64, count=SIZEOF_RING_HDR // 8)
+        self._aRows = np.frombuffer(mmRing, dtype=np.double, count=self.nCapacity * self.nColSize,
+                                    offset=SIZEOF_RING_HDR).reshape(self.nCapacity, self.nColSize)
+
+    def read(self):
+        """
+        Take the rows appended since the last call out of the ring.
+
+        Returns
+        -------
+        aRows : NumPy array of shape (n, nColSize), a copy the ring no longer refers to
+
+        """
+        nHead = int(self._aIndex[RING_IDX_HEAD])
+        nTail = int(self._aIndex[RING_IDX_TAIL])
+        nCount = nHead - nTail
+        nSlot = nTail % self.nCapacity
+        nFirst = min(nCount, self.nCapacity - nSlot)
+        aRows = np.concatenate((self._aRows[nSlot : nSlot + nFirst], self._aRows[: nCount - nFirst]))
+        self._aIndex[RING_IDX_TAIL] = nHead
+        return aRows
+
+    def getDropped(self):
+        """
+        Rows the C/C++ library could not append because the ring was full.
+
+        """
+        return int(self._aIndex[RING_IDX_DROPPED])
+
+    def close(self):
+        """
+        Unmap the ring, the NumPy views must go first as they export its buffer.
+
+        """
+        del self._aIndex
+        del self._aRows
+        self._mmRing.close()
+
+def readStream(fnRecv, stFrame, fnMapRing):
+    """
+    Read the rest of a stream request once the transport has received its first frame header.
+
+    Parameters
+    ----------
+    fnRecv : function
+        fnRecv(nSize) returns exactly nSize bytes from the transport
+
+    stFrame : LIB_FRAME_HDR
+        Header of the STREAM frame, already checked with unpackFrame()
+
+    fnMapRing : function
+        fnMapRing(stStream) maps the shared memory of the ring and returns the mmap object
+
+    Returns
+    -------
+    stream : LiveStream
+
+    """
+    if stFrame.u64Length != ctypes.sizeof(LIB_STREAM_HDR):
+        raise ProtocolError("STREAM frame of %d bytes, expected %d" %
+                            (stFrame.u64Length, ctypes.sizeof(LIB_STREAM_HDR)))
+    stStream = LIB_STREAM_HDR.from_buffer_copy(fnRecv(ctypes.sizeof(LIB_STREAM_HDR)))
+    stLabels = _expectFrame(fnRecv, LIB_MSG_LABELS)
+    lstGraphLabels = _decodeLabels(fnRecv(stLabels.u64Length), stStream.u32ColSize)
+    if stStream.u64ShmSize != SIZEOF_RING_HDR + stStream.u64Capacity * stStream.u32ColSize * 8:
+        raise ProtocolError("Ring of %d bytes for %d x %d doubles" %
+                            (stStream.u64ShmSize, stStream.u64Capacity, stStream.u32ColSize))
+    mmRing = fnMapRing(stStream)
+    (nMagic,) = struct.unpack_from("<I", mmRing, 0)
+    if nMagic != LIB_RING_MAGIC:
+        mmRing.close()
+        raise ProtocolError("Ring with magic 0x%08X, expected 0x%08X" % (nMagic, LIB_RING_MAGIC))
+    return LiveStream(stStream, lstGraphLabels, mmRing)
+
+def checkStreamEnd(stFrame):
+    """
+    Check the frame received while a live stream is open is its STREAM_END frame.
+
+    """
+    if stFrame.u16Type != LIB_MSG_STREAM_END or stFrame.u64Length != 0:
+        raise ProtocolError("Frame type %d with %d bytes, expected the end of the stream" %
+                            (stFrame.u16Type, stFrame.u64Length))
+
+def packFrame(nType, abPayload=b""):
+    """
+    Build a frame from its type and payload.
+
+    """
+    stFrame = LIB_FRAME_HDR(LIB_PROTO_MAGIC, LIB_PROTO_VERSION, nType, len(abPayload))
+    return bytes(stFrame) + bytes(abPayload)
+
+def getReadTime():
+    """
+    Time in milliseconds the last readPlot() took to receive and decode its request, waiting
+    for the first frame header excluded.
+
+    """
+    return _dReadMs
+
+def getOutput():
+    """
+    Output and resolution of the figure asked for by the last readPlot().
+
+    Returns
+    -------
+    nOutput : int
+        LIB_OUTPUT_FILE, or LIB_OUTPUT_PNG or LIB_OUTPUT_RGBA to send the image with packImage()
+
+    nDpi : int
+        Resolution of the figure
+
+    """
+    return _nOutput, _nDpi
+
+def packImage(nFormat, nWidth, nHeight, nSize):
+    """
+    Build the start of an IMAGE frame, the nSize bytes of the image are sent right after it
+    without being copied into the frame.
+
+    """
+    stImage = LIB_IMAGE_HDR(nFormat, nWidth, nHeight, 0, nSize)
+    stFrame = LIB_FRAME_HDR(LIB_PROTO_MAGIC, LIB_PROTO_VERSION, LIB_MSG_IMAGE, ctypes.sizeof(stImage) + nSize)
+    return bytes(stFrame) + bytes(stImage)
+
+def packReady(nPid):
+    """
+    Build the READY frame sent once the Python tool has started and imported its modules.
+
+    """
+    return packFrame(LIB_MSG_READY, struct.pack("<I", nPid))
+
+def packAck(dDecodeMs=0.0, dPlotMs=0.0, dSaveMs=0.0):
+    """
+    Build the ACK frame sent after a successful plot, with the timings of the Python tool in
+    milliseconds.
+
+    """
+    return packFrame(LIB_MSG_ACK, bytes(LIB_ACK_PAYLOAD(LIB_STATUS_DONE, 0, dDecodeMs, dPlotMs, dSaveMs)))
+
+def packError(nErrCode, szRuntime):
+    """
+    Build an ERROR frame. The C/C++ library adds the description and suggested solution
+    of the error code itself, only the runtime message is sent.
+
+    """
+    abRuntime = szRuntime.encode("utf-8", "replace")[:LIB_MAX_ERROR_TEXT]
+    return packFrame(LIB_MSG_ERROR, struct.pack("<I", nErrCode) + abRuntime)
@@ -0,0 +1,341 @@
+"""
+IPC_Plot_Replay.py
+
+Summary
+-------
+Renders the plots of a spool log, written by the C/C++ library while ipc_plot_spool_config() had
+it open, refer to IPC_Plot_Protocol.h for its layout. It only needs Python, NumPy and Matplotlib,
+so the log can be rendered on another machine than the one that spooled it, in parallel.
+
+Each plot record holds the frames the Python tool would have received, with the payload after
+them as if it were in shared memory, so the records are decoded by IPC_Plot_Protocol.readPlot()
+and drawn by IPC_Plot.py exactly as a live plot. The log is mapped, not read: a record is found
+through the index records, or by walking the record headers when the log was not closed, and
+only the pages of the plots rendered are read. Every image is saved as a PNG file named after
+the time of its ipc_plot() call, whatever output the call asked for.
+
+Usage
+-----
+python IPC_Plot_Replay.py LOG [--list] [--plots 0,3,10-20] [--jobs N] [--out DIR]
+
+"""
+
+# Standard libraries
+import argparse
+import ctypes
+import mmap
+import multiprocessing
+import os
+import sys
+import time
+from datetime import datetime
+
+# Third-party library imports
+import matplotlib.pyplot as plt
+import numpy as np
+
+import IPC_Plot as tool
+import IPC_Plot_Protocol as proto
+
+# Spool log identification and record types, refer to IPC_Plot_Protocol.h
+LIB_SPOOL_MAGIC = 0x4C4F5053
+LIB_SPOOL_VERSION = 1
+LIB_SPOOL_RECORD_MAGIC = 0x44524352
+LIB_SPOOL_TAIL_MAGIC = 0x4C494154
+LIB_SPOOL_ALIGN = 8
+LIB_SPOOL_PLOT = 1
+LIB_SPOOL_INDEX = 2
+
+class LIB_SPOOL_FILE_HDR(ctypes.Structure):
+    """
+    Start of the log
+
+    """
+    _fields_ = [('u32Magic', ctypes.c_uint32),
+                ('u16Version', ctypes.c_uint16),
+                ('u16ProtoVersion', ctypes.c_uint16),
+                ('u64CreatedUs', ctypes.c_uint64)]
+
+class LIB_SPOOL_RECORD_HDR(ctypes.Structure):
+    """
+    Start of every record, followed by u64Length bytes
+
+    """
+    _fields_ = [('u32Magic', ctypes.c_uint32),
+                ('u32Type', ctypes.c_uint32),
+                ('u64Length', ctypes.c_uint64),
+                ('u64TimeUs', ctypes.c_uint64)]
+
+class LIB_SPOOL_INDEX_HDR(ctypes.Structure):
+    """
+    Start of an index record, followed by u64Count entries and the tail
+
+    """
+    _fields_ = [('u64Previous', ctypes.c_uint64),
+                ('u64Count', ctypes.c_uint64)]
+
+class LIB_SPOOL_TAIL(ctypes.Structure):
+    """
+    End of an index record, the last bytes of a closed or flushed log
+
+    """
+    _fields_ = [('u64Index', ctypes.c_uint64),
+                ('u32Magic', ctypes.c_uint32),
+                ('u32Reserved', ctypes.c_uint32)]
+
+SIZEOF_FILE_HDR = ctypes.sizeof(LIB_SPOOL_FILE_HDR)
+SIZEOF_RECORD_HDR = ctypes.sizeof(LIB_SPOOL_RECORD_HDR)
+SIZEOF_INDEX_HDR = ctypes.sizeof(LIB_SPOOL_INDEX_HDR)
+SIZEOF_TAIL = ctypes.sizeof(LIB_SPOOL_TAIL)
+
+# An index entry is the offset and the time of a plot record
+DTYPE_INDEX_ENTRY = np.dtype([('u64Offset', np.uint64), ('u64TimeUs', np.uint64)])
+
+class SpoolLog:
+    """
+    Read-only mapping of a spool log.
+
+    Attributes
+    ----------
+    lstPlots : list of tuple
+        (nOffset, nTimeUs) of every plot record, in the order they were spooled
+
+    bIndexed : bool
+        The log ends with an index, it was closed or flushed last
+
+    """
+    def __init__(self, szPath):
+        with open(szPath, "rb") as fileLog:
+            if os.fstat(fileLog.fileno()).st_size < SIZEOF_FILE_HDR:
+                raise proto.ProtocolError("%s is not a spool log" % szPath)
+            self._mmLog = mmap.mmap(fileLog.fileno(), 0, access=mmap.ACCESS_READ)
+        stFile = LIB_SPOOL_FILE_HDR.from_buffer_copy(self._mmLog, 0)
+        if stFile.u32Magic != LIB_SPOOL_MAGIC:
+            if stFile.u32Magic == int.from_bytes(LIB_SPOOL_MAGIC.to_bytes(4, "little"), "big"):
+                raise proto.ProtocolError("%s was spooled on a machine of the other byte order" % szPath)
+            raise proto.ProtocolError("%s is not a spool log" % szPath)
+        if stFile.u16Version != LIB_SPOOL_VERSION or stFile.u16ProtoVersion != proto.LIB_PROTO_VERSION:
+            raise proto.ProtocolError("%s has version %d with protocol %d, expected version %d with protocol %d" %
+                                      (szPath, stFile.u16Version, stFile.u16ProtoVersion,
+                                       LIB_SPOOL_VERSION, proto.LIB_PROTO_VERSION))
+        self.lstPlots = self._readIndex()
+        self.bIndexed = self.lstPlots is not None
+        if not self.bIndexed:
+            self.lstPlots = self._walkRecords()
+
+    def _readRecord(self, nOffset):
+        """
+        Header of the record at nOffset, None if there is no whole record there.
+
+        """
+        nSize = len(self._mmLog)
+        if nOffset < SIZEOF_FILE_HDR or nOffset % LIB_SPOOL_ALIGN or nOffset + SIZEOF_RECORD_HDR > nSize:
+            return None
+        stRecord = LIB_SPOOL_RECORD_HDR.from_buffer_copy(self._mmLog, nOffset)
+        if (stRecord.u32Magic != LIB_SPOOL_RECORD_MAGIC or stRecord.u64Length % LIB_SPOOL_ALIGN
+                or stRecord.u64Length > nSize - nOffset - SIZEOF_RECORD_HDR):
+            return None
+        return stRecord
+
+    def _readIndex(self):
+        """
+        Follow the index records back from the tail at the end of the log, without touching
+        the plot records.
+
+        Returns
+        -------
+        lstPlots : list of tuple or None
+            (nOffset, nTimeUs) of every plot record, None if the log does not end with a tail
+
+        """
+        nSize = len(self._mmLog)
+        if nSize < SIZEOF_FILE_HDR + SIZEOF_RECORD_HDR + SIZEOF_TAIL:
+            return None
+        stTail = LIB_SPOOL_TAIL.from_buffer_copy(self._mmLog, nSize - SIZEOF_TAIL)
+        if stTail.u32Magic != LIB_SPOOL_TAIL_MAGIC:
+            return None
+        lstChunks = []
+        nIndex = stTail.u64Index
+        nEnd = nSize
+        while nIndex != 0:
+            stRecord = self._readRecord(nIndex)
+            if stRecord is None or stRecord.u32Type != LIB_SPOOL_INDEX or nIndex >= nEnd:
+                return None
+            nBody = nIndex + SIZEOF_RECORD_HDR
+            stIndex = LIB_SPOOL_INDEX_HDR.from_buffer_copy(self._mmLog, nBody)
+            if SIZEOF_INDEX_HDR + stIndex.u64Count * DTYPE_INDEX_ENTRY.itemsize + SIZEOF_TAIL != stRecord.u64Length:
+                return None
+            lstChunks.append(np.frombuffer(self._mmLog, dtype=DTYPE_INDEX_ENTRY, count=stIndex.u64Count,
+                                           offset=nBody + SIZEOF_INDEX_HDR).tolist())
+            nEnd = nIndex
+            nIndex = stIndex.u64Previous
+        return [tupleEntry for lstChunk in reversed(lstChunks) for tupleEntry in lstChunk]
+
+    def _walkRecords(self):
+        """
+        Find the plot records by reading every record header, up to the first record that was
+        not written in full.
+
+        """
+        lstPlots = []
+        nOffset = SIZEOF_FILE_HDR
+        stRecord = self._readRecord(nOffset)
+        while stRecord is not None:
+            if stRecord.u32Type == LIB_SPOOL_PLOT:
+                lstPlots.append((nOffset, stRecord.u64TimeUs))
+            nOffset += SIZEOF_RECORD_HDR + stRecord.u64Length
+            stRecord = self._readRecord(nOffset)
+        return lstPlots
+
+    def readPlotHeader(self, nOffset):
+        """
+        PLOT frame of the plot record at nOffset, without decoding the rest.
+
+        """
+        return proto.LIB_PLOT_HDR.from_buffer_copy(self._mmLog, nOffset + SIZEOF_RECORD_HDR + proto.SIZEOF_FRAME_HDR)
+
+    def readPlot(self, nOffset):
+        """
+        Decode the plot record at nOffset.
+
+        Returns
+        -------
+        A tuple of nColSize, nRowSize, aData, lstGraphLabels and nXMode, refer to
+        proto.readPlot(). The data are views of the mapping unless converted from typed columns.
+
+        """
+        stRecord = self._readRecord(nOffset)
+        if stRecord is None or stRecord.u32Type != LIB_SPOOL_PLOT:
+            raise proto.ProtocolError("No plot record at offset %d" % nOffset)
+        nEnd = nOffset + SIZEOF_RECORD_HDR + stRecord.u64Length
+        lstPos = [nOffset + SIZEOF_RECORD_HDR]
+
+        def fnRecv(nSize):
+            nPos = lstPos[0]
+            if nPos + nSize > nEnd:
+                raise proto.ProtocolError("Plot record at offset %d ends inside a frame" % nOffset)
+            lstPos[0] = nPos + nSize
+            return self._mmLog[nPos : nPos + nSize]
+
+        def fnNoStream(*args):
+            raise proto.ProtocolError("Plot record at offset %d has DATA frames" % nOffset)
+
+        def fnMapShm(nShmOffset, nSize, dtype):
+            # Relative to the start of the record
+            if nOffset + nShmOffset + nSize > nEnd:
+                raise proto.ProtocolError("Payload of %d bytes at %d is outside the plot record at offset %d" %
+                                          (nSize, nShmOffset, nOffset))
+            dtype = np.dtype(dtype)
+            return np.frombuffer(self._mmLog, dtype=dtype, count=nSize // dtype.itemsize, offset=nOffset + nShmOffset)
+
+        return proto.readPlot(fnRecv, fnNoStream, fnNoStream, proto.unpackFrame(fnRecv(proto.SIZEOF_FRAME_HDR)), fnMapShm)
+
+def _parsePlots(szPlots, nCount):
+    """
+    Numbers of the plots selected by a list such as "0,3,10-20", in the order given.
+
+    """
+    lstNumbers = []
+    for szItem in szPlots.split(","):
+        szFirst, _, szLast = szItem.partition("-")
+        nFirst = int(szFirst)
+        nLast = int(szLast) if szLast else nFirst
+        if nFirst < 0 or nLast < nFirst or nLast >= nCount:
+            raise ValueError("Plots %s not in 0-%d" % (szItem, nCount - 1))
+        lstNumbers.extend(range(nFirst, nLast + 1))
+    return lstNumbers
+
+# Log of the worker process, mapped once by _initWorker()
+_log = None
+
+def _initWorker(szPath, szOutDir):
+    """
+    Map the log in a worker process and save its images to szOutDir.
+
+    """
+    global _log
+    _log = SpoolLog(szPath)
+    os.chdir(szOutDir)
+
+def _renderPlot(tuplePlot):
+    """
+    Render one plot record of the log mapped by _initWorker().
+
+    Parameters
+    ----------
+    tuplePlot : tuple
+        (nNumber, nOffset, nTimeUs) of the plot record
+
+    Returns
+    -------
+    nNumber : int
+        Number of the plot in the log
+
+    szError : str or None
+        Why the plot failed, None once saved
+
+    """
+    nNumber, nOffset, nTimeUs = tuplePlot
+    try:
+        nColSize, nRowSize, aData, lstGraphLabels, nXMode = _log.readPlot(nOffset)
+        aaData, aaXData = tool._shapeData(nColSize, nRowSize, aData, nXMode)
+        _, nDpi = proto.getOutput()
+        tool._saveImage(aaData, lstGraphLabels, aaXData, proto.LIB_OUTPUT_FILE, nDpi,
+                        datetime.fromtimestamp(nTimeUs / 1e6))
+        return nNumber, None
+    except Exception as e:
+        return nNumber, repr(e)
+    finally:
+        plt.close("all")
+
+def main():
+    """
+    List or render the plots of a spool log.
+
+    """
+    parser = argparse.ArgumentParser(description="Render the plots of a spool log of ipc_plot()")
+    parser.add_argument("log", help="spool log written by ipc_plot_spool_config()")
+    parser.add_argument("--list", action="store_true", help="list the plots instead of rendering them")
+    parser.add_argument("--plots", help="plots to render by number, e.g. 0,3,10-20 (default all)")
+    parser.add_argument("--jobs", type=int, default=os.cpu_count(), help="processes rendering at once")
+    parser.add_argument("--out", default=".", help="directory of the images")
+    args = parser.parse_args()
+
+    szPath = os.path.abspath(args.log)
+    try:
+        log = SpoolLog(szPath)
+        nCount = len(log.lstPlots)
+        lstNumbers = _parsePlots(args.plots, nCount) if args.plots else list(range(nCount))
+    except (OSError, ValueError, proto.ProtocolError) as e:
+        print(e, file=sys.stderr)
+        return 2
+    if args.list:
+        print("%d plots, %s" % (nCount, "indexed" if log.bIndexed else "found by walking the records"))
+        for nNumber in lstNumbers:
+            nOffset, nTimeUs = log.lstPlots[nNumber]
+            stPlot = log.readPlotHeader(nOffset)
+            print("%8d  %s  offset %d  %d x %d  %d bytes" %
+                  (nNumber, datetime.fromtimestamp(nTimeUs / 1e6).isoformat(sep=" "), nOffset,
+                   stPlot.u32RowSize, stPlot.u32ColSize, stPlot.u64PayloadSize))
+        return 0
+
+    lstTasks = [(nNumber,) + tuple(log.lstPlots[nNumber]) for nNumber in lstNumbers]
+    os.makedirs(args.out, exist_ok=True)
+    szOutDir = os.path.abspath(args.out)
+    dStart = time.perf_counter()
+    if args.jobs <= 1:
+        _initWorker(szPath, szOutDir)
+        lstResults = [_renderPlot(tupleTask) for tupleTask in lstTasks]
+    else:
+        with multiprocessing.Pool(args.jobs, _initWorker, (szPath, szOutDir)) as pool:
+            lstResults = pool.map(_renderPlot, lstTasks, chunksize=1)
+    lstFailed = [tupleResult for tupleResult in lstResults if tupleResult[1] is not None]
+    for nNumber, szError in lstFailed:
+        print("Plot %d failed: %s" % (nNumber, szError), file=sys.stderr)
+    print("Rendered %d of %d plots in %.1f s" %
+          (len(lstTasks) - len(lstFailed), len(lstTasks), time.perf_counter() - dStart))
+    return 1 if lstFailed else 0
+
+if __name__ == '__main__':
+    """ Entry point """
+    sys.exit(main())
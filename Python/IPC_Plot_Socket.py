@@ -0,0 +1,244 @@
+"""
+IPC_Plot_Socket.py
+
+Summary
+-------
+This script acts as a client for the socket between a POSIX C/C++ application (server) and this Python tool.
+
+The C/C++ application starts this Python tool with one end of a socket pair at the descriptor given by the
+"--fd" argument. The data buffer is not sent over the socket: it lives in a shared memory segment whose
+descriptor is passed along with the PLOT frame, and it is mapped here directly as a NumPy array. Only the
+request frames, the user labels and the status are sent over the socket itself, refer to IPC_Plot_Protocol.py.
+The ring buffer of a live stream is passed the same way with its STREAM frame and mapped read-write.
+
+The public functions match IPC_Plot_Pipe.py so that IPC_Plot.py can use either module.
+
+"""
+# Standard libraries
+import mmap
+import os
+import select
+import socket
+import sys
+
+# Third-party library imports
+import numpy as np
+
+import IPC_Plot_Protocol as proto
+
+# Socket inherited from the C/C++ application, opened on first use
+_sock = None
+
+def _getSocket():
+    """
+    Wrap the descriptor passed with the "--fd" argument in a socket object.
+
+    """
+    global _sock
+    if _sock is None:
+        nFd = int(sys.argv[sys.argv.index("--fd") + 1])
+        _sock = socket.socket(fileno=nFd)
+    return _sock
+
+def _recvInto(mvBuffer):
+    """
+    Fill the writable memoryview with bytes from the socket.
+
+    """
+    sock = _getSocket()
+    nSize = len(mvBuffer)
+    nOffset = 0
+    while nOffset < nSize:
+        nRecv = sock.recv_into(mvBuffer[nOffset:])
+        if nRecv == 0:
+            raise ConnectionError("Socket closed by the C/C++ application")
+        nOffset += nRecv
+
+def _recvExact(nSize):
+    """
+    Read exactly nSize bytes from the socket.
+
+    """
+    abBuffer = bytearray(nSize)
+    _recvInto(memoryview(abBuffer))
+    return abBuffer
+
+def _send(abData):
+    """
+    Write all bytes to the socket.
+
+    """
+    _getSocket().sendall(abData)
+
+def _mapData(nFd, nOffset, nSize, dtype):
+    """
+    Map the shared memory segment, or the file of a file input, and view the data as a NumPy
+    array of dtype. The segment stays mapped for as long as the array is alive.
+
+    """
+    nCount = nSize // np.dtype(dtype).itemsize
+    if nCount == 0:
+        os.close(nFd)
+        return np.empty(0, dtype=dtype)
+    mmData = mmap.mmap(nFd, nOffset + nSize, flags=mmap.MAP_SHARED, prot=mmap.PROT_READ)
+    os.close(nFd)
+    return np.frombuffer(mmData, dtype=dtype, count=nCount, offset=nOffset)
+
+def _mapRing(nFd, stStream):
+    """
+    Map the ring buffer of a live stream, read-write as the tail is moved here.
+
+    """
+    mmRing = mmap.mmap(nFd, stStream.u64ShmSize, flags=mmap.MAP_SHARED,
+                       prot=mmap.PROT_READ | mmap.PROT_WRITE)
+    os.close(nFd)
+    return mmRing
+
+def retrieveData():
+    """
+    Receive the next plot or stream request. The shared memory segment descriptor, if any,
+    arrives with the first bytes of the PLOT frame.
+    Blocks until the C/C++ application sends the next buffer.
+
+    Returns
+    -------
+    None when the C/C++ application has closed the session, a proto.LiveStream for a stream
+    request, otherwise a tuple of:
+
+    nColSize : int
+        Number of columns in the data buffer. Corresponds to number of
+        lines plotted on the figure
+
+    nRowSize : int
+        Number of rows of data for each column.
+
+    aData : numpy array
+        The data buffer containing doubles only, converted from typed columns,
+        mapped from shared memory or a file, or filled from the socket
+
+    lstGraphLabels : list
+        A list of user labels to be displayed on the legend of the
+        figure
+
+    nXMode : int
+        proto.X_PER_COLUMN if each column in aData is preceded by a column of
+        its X values, e.g. after decimation by the C/C++ library,
+        proto.X_SHARED if aData starts with one column of X values for every
+        column, e.g. timestamps, else proto.X_NONE
+
+    """
+    abHeader, lstFds, _, _ = socket.recv_fds(_getSocket(), proto.SIZEOF_FRAME_HDR, 1)
+    if len(abHeader) == 0:
+        # Session closed
+        return None
+    try:
+        abHeader += _recvExact(proto.SIZEOF_FRAME_HDR - len(abHeader))
+        stFrame = proto.unpackFrame(abHeader)
+
+        def fnMapShm(nOffset, nSize, dtype):
+            if len(lstFds) == 0:
+                raise proto.ProtocolError("No shared memory segment from the C/C++ application")
+            return _mapData(lstFds.pop(), nOffset, nSize, dtype)
+
+        def fnMapRing(stStream):
+            if len(lstFds) == 0:
+                raise proto.ProtocolError("No ring buffer from the C/C++ application")
+            return _mapRing(lstFds.pop(), stStream)
+
+        if stFrame.u16Type == proto.LIB_MSG_STREAM:
+            return proto.readStream(_recvExact, stFrame, fnMapRing)
+        return proto.readPlot(_recvExact, _recvInto, _send, stFrame, fnMapShm)
+    finally:
+        # Descriptor not claimed by the request
+        for nFd in lstFds:
+            os.close(nFd)
+
+def waitStreamEnd(dTimeout):
+    """
+    Wait for the end of the live stream in progress.
+
+    Parameters
+    ----------
+    dTimeout : float
+        Longest wait in seconds
+
+    Returns
+    -------
+    True once the C/C++ application has ended the stream or closed the session, False after the
+    timeout
+
+    """
+    sock = _getSocket()
+    lstReady, _, _ = select.select([sock], [], [], dTimeout)
+    if len(lstReady) == 0:
+        return False
+    abHeader = sock.recv(proto.SIZEOF_FRAME_HDR)
+    if len(abHeader) == 0:
+        return True
+    abHeader += _recvExact(proto.SIZEOF_FRAME_HDR - len(abHeader))
+    proto.checkStreamEnd(proto.unpackFrame(abHeader))
+    return True
+
+def reportReady():
+    """
+    Tell the C/C++ application this Python tool has started and imported its modules.
+    Sent once, before the first request is read.
+
+    """
+    _send(proto.packReady(os.getpid()))
+
+def updateStatus(dDecodeMs=0.0, dPlotMs=0.0, dSaveMs=0.0):
+    """
+    Update status of Python tool upon completion
+
+    Parameters
+    ----------
+    dDecodeMs, dPlotMs, dSaveMs : float
+        Time in milliseconds spent decoding the request, creating the figure and saving it,
+        returned to the C/C++ application in its plot statistics
+
+    """
+    _send(proto.packAck(dDecodeMs, dPlotMs, dSaveMs))
+
+def sendImage(nFormat, nWidth, nHeight, abImage):
+    """
+    Return the image of the last request, sent before updateStatus()
+
+    Parameters
+    ----------
+    nFormat : int
+        proto.LIB_OUTPUT_PNG or proto.LIB_OUTPUT_RGBA
+
+    nWidth, nHeight : int
+        Size of the image in pixels
+
+    abImage : bytes-like
+        PNG file or RGBA pixels
+
+    """
+    _send(proto.packImage(nFormat, nWidth, nHeight, len(abImage)))
+    _send(abImage)
+
+def reportError(szRuntime, nErrCode=proto.LIB_ERR_CLIENT_ERROR):
+    """
+    Report a failure to plot the last buffer, the session stays usable
+
+    Parameters
+    ----------
+    szRuntime : string
+        Details of the failure, usually the Python exception
+
+    nErrCode : int
+        Error code from IPC_Plot_Error.h
+
+    """
+    _send(proto.packError(nErrCode, szRuntime))
+
+if __name__ == '__main__':
+    """ Unit testing """
+    reportReady()
+    nColSize, nRowSize, aData, lstGraphLabels, nXMode = retrieveData()
+    print(nColSize, nRowSize)
+    print(aData)
+    print(lstGraphLabels)
+    updateStatus()